@@ -2,13 +2,21 @@
 #include "ReadCliArgs.h"
 #include <array>
 #include <bee/Converter.h>
+#include <bee/TextureCache.h>
+#include <bee/TextureSearchIndex.h>
 #include <bee/polyfills/filesystem.h>
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <optional>
 #include <string>
+#include <vector>
+
+namespace fs = bee::filesystem;
 
 std::u8string relativeUriBetweenPath(const bee::filesystem::path &from_,
                                      const bee::filesystem::path &to_) {
@@ -52,9 +60,183 @@ private:
   bee::Json _messages = bee::Json::array();
 };
 
-int main(int argc_, const char *argv_[]) {
-  namespace fs = bee::filesystem;
+/// <summary>
+/// Serializes the calls into another logger, so that it can be shared between
+/// threads in parallel batch mode.
+/// </summary>
+class SynchronizedLogger : public bee::Logger {
+public:
+  SynchronizedLogger(bee::Logger &logger_) : _logger(logger_) {
+  }
+
+  void operator()(Level level_, bee::Json &&message_) override {
+    std::lock_guard lock{_mutex};
+    _logger(level_, std::move(message_));
+  }
+
+  void operator()(Level level_, std::u8string_view message_) override {
+    std::lock_guard lock{_mutex};
+    _logger(level_, message_);
+  }
+
+private:
+  bee::Logger &_logger;
+  std::mutex _mutex;
+};
+
+class MyWriter : public bee::GLTFWriter {
+public:
+  MyWriter(std::u8string_view in_file_, std::u8string_view out_file_)
+      : _inFile(in_file_), _outFile(out_file_) {
+  }
+
+  virtual std::optional<std::u8string> buffer(const std::byte *data_,
+                                              std::size_t size_,
+                                              std::uint32_t index_,
+                                              bool multi_) {
+    openBuffer(index_, multi_);
+    appendBuffer(index_, data_, size_);
+    return closeBuffer(index_);
+  }
+
+  bool supportsStreaming() const override {
+    return true;
+  }
+
+  void openBuffer(std::uint32_t index_, bool multi_) override {
+    const auto outFilePath = fs::path{_outFile};
+    const auto glTFOutBaseName = outFilePath.stem();
+    const auto glTFOutDir = outFilePath.parent_path();
+    auto bufferOutPath =
+        glTFOutDir /
+        (multi_ ? (glTFOutBaseName.string() + std::to_string(index_) + ".bin")
+                : (glTFOutBaseName.string() + ".bin"));
+    std::error_code errc;
+    fs::create_directories(bufferOutPath.parent_path(), errc);
+    if (errc) {
+      throw std::runtime_error("Failed to create directories for buffer " +
+                               bufferOutPath.string());
+    }
+
+    auto &openedBuffer = _openedBuffers[index_];
+    openedBuffer.stream.open(bufferOutPath.string(), std::ios::binary);
+    openedBuffer.stream.exceptions(std::ios::badbit | std::ios::failbit);
+    openedBuffer.path = std::move(bufferOutPath);
+  }
+
+  void appendBuffer(std::uint32_t index_,
+                    const std::byte *data_,
+                    std::size_t size_) override {
+    _openedBuffers.at(index_).stream.write(
+        reinterpret_cast<const char *>(data_), size_);
+  }
+
+  std::optional<std::u8string> closeBuffer(std::uint32_t index_) override {
+    auto openedBuffer = _openedBuffers.find(index_);
+    if (openedBuffer == _openedBuffers.end()) {
+      return {};
+    }
+    openedBuffer->second.stream.close();
+    const auto uri = relativeUriBetweenPath(fs::path{_outFile}.parent_path(),
+                                            openedBuffer->second.path);
+    _openedBuffers.erase(openedBuffer);
+    return uri;
+  }
+
+  void glb(std::span<const std::span<const std::byte>> pieces_) override {
+    const auto outFilePath = fs::path{_outFile};
+    std::error_code errc;
+    fs::create_directories(outFilePath.parent_path(), errc);
+    std::ofstream ofs(outFilePath.string(), std::ios::binary);
+    ofs.exceptions(std::ios::badbit | std::ios::failbit);
+    for (const auto piece : pieces_) {
+      ofs.write(reinterpret_cast<const char *>(piece.data()), piece.size());
+    }
+    ofs.flush();
+  }
+
+  bool json(const std::function<void(std::ostream &)> &write_) override {
+    const auto outFilePath = fs::path{_outFile};
+    std::error_code errc;
+    fs::create_directories(outFilePath.parent_path(), errc);
+    std::ofstream glTFJsonOStream(outFilePath.string());
+    glTFJsonOStream.exceptions(std::ios::badbit | std::ios::failbit);
+    write_(glTFJsonOStream);
+    glTFJsonOStream.flush();
+    return true;
+  }
+
+private:
+  struct OpenedBuffer {
+    fs::path path;
+    std::ofstream stream;
+  };
+
+  std::u8string _inFile;
+  std::u8string _outFile;
+  std::map<std::uint32_t, OpenedBuffer> _openedBuffers;
+};
+
+struct ConvertEntry {
+  std::u8string inputFile;
+  std::u8string outFile;
+};
+
+/// <summary>
+/// `<out-root>/<FBX-filename-basename>_glTF/<FBX-filename-basename>.gltf`
+/// </summary>
+std::u8string defaultOutFile(const fs::path &out_root_,
+                             std::u8string_view input_file_) {
+  const auto inputFilePath = fs::path{input_file_};
+  const auto inputBaseNameNoExt = inputFilePath.stem().string();
+  auto outFilePath = out_root_ / (inputBaseNameNoExt + "_glTF") /
+                     (inputBaseNameNoExt + ".gltf");
+  fs::create_directories(outFilePath.parent_path());
+  return outFilePath.u8string();
+}
+
+/// <summary>
+/// Reads the list file of batch mode. See the `--batch` option.
+/// </summary>
+std::vector<ConvertEntry> readBatchList(std::u8string_view batch_file_,
+                                        const fs::path &out_root_) {
+  const auto batchFilePath = fs::path{batch_file_};
+  const auto baseDir = batchFilePath.parent_path();
+  std::ifstream listStream(batchFilePath);
+  if (!listStream) {
+    throw std::runtime_error("Failed to open batch list file " +
+                             batchFilePath.string());
+  }
+
+  const auto resolve = [&baseDir](std::string_view path_) {
+    const auto path = fs::path{std::u8string_view{
+        reinterpret_cast<const char8_t *>(path_.data()), path_.size()}};
+    return path.is_absolute() ? path.u8string() : (baseDir / path).u8string();
+  };
+
+  std::vector<ConvertEntry> entries;
+  std::string line;
+  while (std::getline(listStream, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty() || line.front() == '#') {
+      continue;
+    }
+    ConvertEntry entry;
+    if (const auto tab = line.find('\t'); tab != std::string::npos) {
+      entry.inputFile = resolve(std::string_view{line}.substr(0, tab));
+      entry.outFile = resolve(std::string_view{line}.substr(tab + 1));
+    } else {
+      entry.inputFile = resolve(line);
+      entry.outFile = defaultOutFile(out_root_, entry.inputFile);
+    }
+    entries.push_back(std::move(entry));
+  }
+  return entries;
+}
 
+int main(int argc_, const char *argv_[]) {
   const auto argsU8 = beecli::getCommandLineArgsU8(argc_, argv_);
   if (!argsU8) {
     return -1;
@@ -75,65 +257,12 @@ int main(int argc_, const char *argv_[]) {
     cliOptions->convertOptions.fbmDir = cliOptions->fbmDir;
   }
 
-  if (cliOptions->outFile.empty()) {
-    const auto inputFilePath = fs::path{cliOptions->inputFile};
-    const auto inputBaseNameNoExt = inputFilePath.stem().string();
-    auto outFilePath = fs::current_path() / (inputBaseNameNoExt + "_glTF") /
-                       (inputBaseNameNoExt + ".gltf");
-    fs::create_directories(outFilePath.parent_path());
-    cliOptions->outFile = outFilePath.u8string();
-  }
-  cliOptions->convertOptions.out = cliOptions->outFile;
-
-  class MyWriter : public bee::GLTFWriter {
-  public:
-    MyWriter(std::u8string_view in_file_, std::u8string_view out_file_)
-        : _inFile(in_file_), _outFile(out_file_) {
-    }
-
-    virtual std::optional<std::u8string> buffer(const std::byte *data_,
-                                                std::size_t size_,
-                                                std::uint32_t index_,
-                                                bool multi_) {
-      const auto outFilePath = fs::path{_outFile};
-      const auto glTFOutBaseName = outFilePath.stem();
-      const auto glTFOutDir = outFilePath.parent_path();
-      const auto bufferOutPath =
-          glTFOutDir /
-          (multi_ ? (glTFOutBaseName.string() + std::to_string(index_) + ".bin")
-                  : (glTFOutBaseName.string() + ".bin"));
-      std::error_code errc;
-      fs::create_directories(bufferOutPath.parent_path(), errc);
-      if (errc) {
-        throw std::runtime_error("Failed to create directories for buffer " +
-                                 bufferOutPath.string());
-      }
-
-      std::ofstream ofs(bufferOutPath.string(), std::ios::binary);
-      ofs.exceptions(std::ios::badbit | std::ios::failbit);
-      ofs.write(reinterpret_cast<const char *>(data_), size_);
-      ofs.flush();
-
-      return relativeUriBetweenPath(glTFOutDir, bufferOutPath);
-    }
-
-  private:
-    std::u8string_view _inFile;
-    std::u8string_view _outFile;
-  };
-
-  MyWriter writer{cliOptions->inputFile, cliOptions->outFile};
-  cliOptions->convertOptions.useDataUriForBuffers = false;
-  cliOptions->convertOptions.writer = &writer;
-  cliOptions->convertOptions.pathMode = bee::ConvertOptions::PathMode::copy;
-
   std::unique_ptr<bee::Logger> logger;
   if (cliOptions->logFile) {
     logger = std::make_unique<JsonLogger>();
   } else {
     logger = std::make_unique<ConsoleLogger>();
   }
-  cliOptions->convertOptions.logger = logger.get();
 
   // `0` means success
   // `1` means error happened but it's captured and logged.
@@ -141,20 +270,150 @@ int main(int argc_, const char *argv_[]) {
   constexpr int exitFailureCaptured = 1;
   int retval = exitOk;
 
+  const auto batchMode = cliOptions->batchFile.has_value();
+  const auto parallel = batchMode && cliOptions->jobs != 1;
+
+  SynchronizedLogger synchronizedLogger{*logger};
+  bee::Logger *itemLogger = parallel ? &synchronizedLogger : logger.get();
+
+  std::vector<ConvertEntry> entries;
   try {
-    const auto glTFJson =
-        bee::convert(cliOptions->inputFile, cliOptions->convertOptions);
-    const auto outFilePath = fs::path{cliOptions->outFile};
-    std::ofstream glTFJsonOStream(outFilePath.string());
-    glTFJsonOStream.exceptions(std::ios::badbit | std::ios::failbit);
-    const auto glTFJsonText = glTFJson.dump(2);
-    glTFJsonOStream << glTFJsonText;
-    glTFJsonOStream.flush();
+    if (batchMode) {
+      entries = readBatchList(*cliOptions->batchFile,
+                              cliOptions->outFile.empty()
+                                  ? fs::current_path()
+                                  : fs::path{cliOptions->outFile});
+    } else {
+      ConvertEntry entry;
+      entry.inputFile = cliOptions->inputFile;
+      entry.outFile =
+          cliOptions->outFile.empty()
+              ? defaultOutFile(fs::current_path(), cliOptions->inputFile)
+              : cliOptions->outFile;
+      entries.push_back(std::move(entry));
+    }
   } catch (const std::exception &exception) {
     logger->operator()(bee::Logger::Level::fatal, exception.what());
     retval = exitFailureCaptured;
   }
 
+  // One index for all items, so that each search location is listed once.
+  const auto textureSearchIndex = std::make_shared<bee::TextureSearchIndex>();
+  if (cliOptions->textureSearchCache) {
+    textureSearchIndex->load(*cliOptions->textureSearchCache);
+  }
+  // Likewise, images shared by several items are transcoded once.
+  const auto textureCache = std::make_shared<bee::TextureCache>();
+
+  std::vector<std::unique_ptr<MyWriter>> writers;
+  std::vector<bee::ConvertSession::BatchItem> items;
+  writers.reserve(entries.size());
+  items.reserve(entries.size());
+  for (const auto &entry : entries) {
+    auto &writer = writers.emplace_back(
+        std::make_unique<MyWriter>(entry.inputFile, entry.outFile));
+    auto &item = items.emplace_back();
+    item.file = entry.inputFile;
+    item.options = cliOptions->convertOptions;
+    item.options.out = entry.outFile;
+    item.options.glb = fs::path{entry.outFile}.extension() == ".glb";
+    item.options.useDataUriForBuffers = false;
+    item.options.writer = writer.get();
+    item.options.pathMode = bee::ConvertOptions::PathMode::copy;
+    item.options.logger = itemLogger;
+    item.options.textureResolution.index = textureSearchIndex;
+    if (auto &textureTranscoding = item.options.textureTranscoding) {
+      textureTranscoding->cache = textureCache;
+    }
+    if (batchMode && item.options.traceFile) {
+      // Each file gets its own trace: `trace.json` becomes `trace.3.json`.
+      const auto traceFile = fs::path{*item.options.traceFile};
+      const auto index = std::to_string(items.size() - 1);
+      item.options.traceFile =
+          (traceFile.parent_path() /
+           (traceFile.stem().u8string() + u8"." +
+            std::u8string{index.begin(), index.end()} +
+            traceFile.extension().u8string()))
+              .u8string();
+    }
+    if (batchMode) {
+      // Relative search locations are relative to each input file.
+      const auto inputDir = fs::path{entry.inputFile}.parent_path();
+      for (auto &location : item.options.textureResolution.locations) {
+        if (const auto path = fs::path{location}; !path.is_absolute()) {
+          location = (inputDir / path).u8string();
+        }
+      }
+    }
+  }
+
+  std::size_t nSucceeded = 0;
+  std::chrono::duration<double> totalElapsed{0.0};
+  const auto batchStartTime = std::chrono::steady_clock::now();
+  if (!items.empty()) {
+    const auto onItemConverted =
+        [&](std::size_t index_, const bee::ConvertSession::BatchItem &item_,
+            bee::ConvertSession::BatchItemResult &&result_) {
+          // The glTF JSON has been written by the writer.
+          totalElapsed += result_.elapsed;
+          if (result_.error) {
+            itemLogger->operator()(bee::Logger::Level::fatal,
+                                   bee::Json(*result_.error));
+            retval = exitFailureCaptured;
+          } else {
+            ++nSucceeded;
+          }
+          if (batchMode) {
+            itemLogger->operator()(
+                bee::Logger::Level::info,
+                bee::Json{
+                    {"index", index_},
+                    {"file",
+                     std::string{item_.file.begin(), item_.file.end()}},
+                    {"out", std::string{item_.options.out.begin(),
+                                        item_.options.out.end()}},
+                    {"ok", !result_.error.has_value()},
+                    {"seconds", result_.elapsed.count()},
+                });
+          }
+        };
+    try {
+      if (parallel) {
+        bee::ParallelConvertOptions parallelOptions;
+        parallelOptions.jobs = cliOptions->jobs;
+        parallelOptions.memoryBudget = cliOptions->memoryBudget;
+        bee::convertParallel(items, onItemConverted, parallelOptions);
+      } else {
+        bee::ConvertSession convertSession;
+        convertSession.convert(items, onItemConverted);
+      }
+    } catch (const std::exception &exception) {
+      logger->operator()(bee::Logger::Level::fatal, exception.what());
+      retval = exitFailureCaptured;
+    }
+  }
+
+  if (cliOptions->textureSearchCache &&
+      !textureSearchIndex->save(*cliOptions->textureSearchCache)) {
+    logger->operator()(bee::Logger::Level::warning,
+                       u8"Failed to write the texture search cache.");
+  }
+
+  if (batchMode) {
+    logger->operator()(bee::Logger::Level::info,
+                       bee::Json{
+                           {"files", items.size()},
+                           {"succeeded", nSucceeded},
+                           {"failed", items.size() - nSucceeded},
+                           {"seconds", totalElapsed.count()},
+                           {"wallSeconds",
+                            std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() -
+                                batchStartTime)
+                                .count()},
+                       });
+  }
+
   if (cliOptions->logFile) {
     const auto jsonLogger = dynamic_cast<const JsonLogger *>(logger.get());
     assert(jsonLogger);
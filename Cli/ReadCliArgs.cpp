@@ -72,8 +72,23 @@ std::optional<CliArgs> readCliArgs(std::span<std::string_view> args_) {
   std::string outFile;
   std::string fbmDir;
   std::string logFile;
+  std::string batchFile;
+  std::string textureSearchCache;
+  std::string cacheDir;
+  std::string traceFile;
   std::string unitConversion;
+  std::string naming;
   std::vector<std::string> textureSearchLocations;
+  std::vector<std::string> meshQuantizationBits;
+  std::vector<std::string> meshoptExcluded;
+  std::vector<std::string> bufferPartitions;
+  std::vector<std::string> animationTolerance;
+  std::vector<std::string> animationQuantizationBits;
+  std::string ktx2Codec;
+  bool ktx2Mipmaps = false;
+  std::optional<std::uint32_t> ktx2MaxSize;
+  std::optional<std::uint32_t> ktx2Threads;
+  std::vector<std::string> nodeFilter;
 
   const std::array<std::u8string_view, 2> tslMacros = {u8"cwd",
                                                        u8"fileDirName"};
@@ -127,14 +142,187 @@ std::optional<CliArgs> readCliArgs(std::span<std::string_view> args_) {
       "path or relative path from input file's directory.",
       cxxopts::value<std::vector<std::string>>());
 
+  options.add_options()(
+      "texture-search-cache",
+      "A file to keep the listings of texture search locations in across "
+      "runs. It's read if it exists and written after converting; a listing "
+      "is reused only if its directory has not been modified since.",
+      cxxopts::value<std::string>());
+
+  options.add_options()(
+      "cache-dir",
+      "A directory to cache conversions in. Converting the same file content "
+      "with the same options again reproduces the outputs from there.",
+      cxxopts::value<std::string>());
+
   options.add_options()("verbose", "Verbose output.",
                         cxxopts::value<bool>()->default_value("false"));
+  options.add_options()(
+      "stats",
+      "Log one record of the time spent in each phase, the cost and vertex "
+      "counts of each mesh, the buffer bytes and the peak memory.",
+      cxxopts::value<bool>()->default_value("false"));
+  options.add_options()(
+      "trace-file",
+      "Write the phases of the conversion into the specified file, in the "
+      "Chrome trace event format. In batch mode, the index of each file is "
+      "appended to the name of the trace file.",
+      cxxopts::value<std::string>());
   options.add_options()(
       "log-file",
       "Specify the log file(logs are outputed as JSON). If not "
       "specified, logs're printed to "
       "console",
       cxxopts::value<std::string>());
+  options.add_options()(
+      "batch",
+      "Convert every file listed in the specified list file, reusing one FBX "
+      "SDK instance. Each line of the list file is an input path, optionally "
+      "followed by a tab and an output path; relative paths are resolved "
+      "against the list file's directory, empty lines and lines beginning "
+      "with `#` are ignored. When `--out` is also specified, it's taken as "
+      "the output root directory.",
+      cxxopts::value<std::string>());
+  options.add_options()(
+      "jobs",
+      "Number of files converted in parallel in batch mode. `0` means the "
+      "number of hardware threads.",
+      cxxopts::value<decltype(cliArgs.jobs)>()->default_value("1"));
+  options.add_options()(
+      "memory-budget",
+      "In batch mode, the maximum total size(in MiB) of the input files being "
+      "converted at the same time. `0` means unlimited.",
+      cxxopts::value<decltype(cliArgs.memoryBudget)>()->default_value("0"));
+  options.add_options()(
+      "mesh-threads",
+      "Number of threads used to convert meshes of a file. `0` means the "
+      "number of hardware threads.",
+      cxxopts::value<decltype(cliArgs.convertOptions.meshThreads)>()
+          ->default_value("1"));
+  options.add_options()(
+      "animation-tolerance",
+      "Tolerances of animation keyframe reduction, as a list of "
+      "`<channel>=<tolerance>` where channel is one of `translation`(in the "
+      "output unit, default 1e-4), `rotation`(in degrees, default 1e-2), "
+      "`scale`(default 1e-4) or `weight`(default 1e-4).",
+      cxxopts::value<std::vector<std::string>>());
+  options.add_options()(
+      "animation-quantization",
+      "Write rotations and morph weights of animations as normalized "
+      "integers.",
+      cxxopts::value<bool>()->default_value("false"));
+  options.add_options()(
+      "animation-quantization-bits",
+      "Bits of quantized animation outputs, as a list of `<output>=<bits>` "
+      "where output is `rotation` or `weight`(0, 8 or 16; defaults to 16). 0 "
+      "keeps the output as float. Implies `--animation-quantization`.",
+      cxxopts::value<std::vector<std::string>>());
+  options.add_options()(
+      "animation-threads",
+      "Number of threads used to sample animations of nodes. `0` means the "
+      "number of hardware threads.",
+      cxxopts::value<decltype(cliArgs.convertOptions.animationThreads)>()
+          ->default_value("1"));
+  options.add_options()(
+      "io-threads",
+      "Number of threads used to read, embed and copy image files. `0` means "
+      "the number of hardware threads.",
+      cxxopts::value<decltype(cliArgs.convertOptions.ioThreads)>()
+          ->default_value("1"));
+  options.add_options()(
+      "mesh-quantization",
+      "Quantize vertex attributes(KHR_mesh_quantization).",
+      cxxopts::value<bool>()->default_value("false"));
+  options.add_options()(
+      "mesh-quantization-bits",
+      "Bits of quantized vertex attributes, as a list of `<attribute>=<bits>` "
+      "where attribute is one of `position`(2-16, default 16), `normal`, "
+      "`texcoord`, `color` or `weight`(8 or 16; defaults to 8, 16, 8, 8). 0 "
+      "keeps the attribute as float. Implies `--mesh-quantization`.",
+      cxxopts::value<std::vector<std::string>>());
+  options.add_options()(
+      "no-mesh-optimization",
+      "Do not reorder triangles and vertices of primitives for GPU vertex "
+      "cache, overdraw and vertex fetch.",
+      cxxopts::value<bool>()->default_value("false"));
+  options.add_options()(
+      "sdk-triangulation",
+      "Triangulate and split meshes per material with the FBX SDK before "
+      "conversion.",
+      cxxopts::value<bool>()->default_value("false"));
+  options.add_options()("compact-json",
+                        "Write the glTF JSON without whitespace.",
+                        cxxopts::value<bool>()->default_value("false"));
+  options.add_options()(
+      "naming",
+      "Which objects to name.\n"
+      "  - `full` Name every object.\n"
+      "  - `nodes-and-meshes` Name only nodes and meshes.\n"
+      "  - `none` Name nothing.",
+      cxxopts::value<std::string>()->default_value("full"));
+  options.add_options()(
+      "gpu-instancing",
+      "Collapse sibling nodes sharing a mesh into a single "
+      "node(EXT_mesh_gpu_instancing).",
+      cxxopts::value<bool>()->default_value("false"));
+  options.add_options()(
+      "meshopt-compression",
+      "Compress vertex, index and animation buffer views with "
+      "meshoptimizer(EXT_meshopt_compression).",
+      cxxopts::value<bool>()->default_value("false"));
+  options.add_options()(
+      "meshopt-exclude",
+      "Leave buffer views holding these uncompressed: attribute semantics "
+      "like `TEXCOORD_0`, or `TEXCOORD` for all sets, `INDICES` and "
+      "`ANIMATION`. Implies `--meshopt-compression`.",
+      cxxopts::value<std::vector<std::string>>());
+  options.add_options()(
+      "buffer-partition",
+      "Split the binary data into buffers: `mesh` for one per mesh, "
+      "`morph-targets` to put morph targets apart from the base geometry and "
+      "`animation` for one per animation stack.",
+      cxxopts::value<std::vector<std::string>>());
+  options.add_options()(
+      "ktx2",
+      "Transcode embedded or copied images to KTX2(KHR_texture_basisu) with "
+      "the specified codec: `etc1s` or `uastc`.",
+      cxxopts::value<std::string>());
+  options.add_options()(
+      "ktx2-mipmaps", "Generate mip levels of KTX2 images. Implies `--ktx2`.",
+      cxxopts::value<bool>()->default_value("false"));
+  options.add_options()(
+      "ktx2-max-size",
+      "Halve images larger than this, in pixels, before transcoding them to "
+      "KTX2. Implies `--ktx2`.",
+      cxxopts::value<std::uint32_t>());
+  options.add_options()(
+      "ktx2-threads",
+      "Number of threads transcoding images to KTX2 while the scene is "
+      "converted. `0` means the number of hardware threads. Implies "
+      "`--ktx2`.",
+      cxxopts::value<std::uint32_t>());
+  options.add_options()(
+      "node-filter",
+      "Convert only the subtrees rooted at the nodes of these names, or at "
+      "the nodes having meshes of these names. Their ancestors and the joints "
+      "of their skins are kept without their meshes.",
+      cxxopts::value<std::vector<std::string>>());
+  options.add_options()("no-skin", "Do not import nor export skins.",
+                        cxxopts::value<bool>()->default_value("false"));
+  options.add_options()(
+      "max-skin-influences",
+      "Keep at most this many joints per vertex, those of the largest "
+      "weights. 0 keeps them all.",
+      cxxopts::value<std::uint32_t>()->default_value("0"));
+  options.add_options()("no-blend-shape",
+                        "Do not import nor export blend shapes.",
+                        cxxopts::value<bool>()->default_value("false"));
+  options.add_options()("no-animation",
+                        "Do not import nor export animations.",
+                        cxxopts::value<bool>()->default_value("false"));
+  options.add_options()("no-material",
+                        "Do not import nor export materials and textures.",
+                        cxxopts::value<bool>()->default_value("false"));
 
   options.parse_positional("input-file");
 
@@ -187,6 +375,15 @@ std::optional<CliArgs> readCliArgs(std::span<std::string_view> args_) {
                                    .as<std::vector<std::string>>();
     }
 
+    if (cliParseResult.count("texture-search-cache")) {
+      textureSearchCache =
+          cliParseResult["texture-search-cache"].as<std::string>();
+    }
+
+    if (cliParseResult.count("cache-dir")) {
+      cacheDir = cliParseResult["cache-dir"].as<std::string>();
+    }
+
     if (cliParseResult.count("prefer-local-time-span")) {
       cliArgs.convertOptions.prefer_local_time_span =
           cliParseResult["prefer-local-time-span"].as<bool>();
@@ -202,11 +399,162 @@ std::optional<CliArgs> readCliArgs(std::span<std::string_view> args_) {
       cliArgs.convertOptions.verbose = cliParseResult["verbose"].as<bool>();
     }
 
+    if (cliParseResult.count("stats")) {
+      cliArgs.convertOptions.stats = cliParseResult["stats"].as<bool>();
+    }
+
+    if (cliParseResult.count("trace-file")) {
+      traceFile = cliParseResult["trace-file"].as<std::string>();
+    }
+
     if (cliParseResult.count("log-file")) {
       logFile = cliParseResult["log-file"].as<std::string>();
     }
 
-    if (inputFile.empty()) {
+    if (cliParseResult.count("batch")) {
+      batchFile = cliParseResult["batch"].as<std::string>();
+    }
+
+    if (cliParseResult.count("jobs")) {
+      cliArgs.jobs = cliParseResult["jobs"].as<decltype(cliArgs.jobs)>();
+    }
+
+    if (cliParseResult.count("memory-budget")) {
+      cliArgs.memoryBudget =
+          cliParseResult["memory-budget"].as<decltype(cliArgs.memoryBudget)>() *
+          1024 * 1024;
+    }
+
+    if (cliParseResult.count("mesh-threads")) {
+      cliArgs.convertOptions.meshThreads =
+          cliParseResult["mesh-threads"]
+              .as<decltype(cliArgs.convertOptions.meshThreads)>();
+    }
+
+    if (cliParseResult.count("animation-tolerance")) {
+      animationTolerance =
+          cliParseResult["animation-tolerance"].as<std::vector<std::string>>();
+    }
+
+    if (cliParseResult.count("animation-quantization") &&
+        cliParseResult["animation-quantization"].as<bool>()) {
+      cliArgs.convertOptions.animationQuantization.emplace();
+    }
+
+    if (cliParseResult.count("animation-quantization-bits")) {
+      animationQuantizationBits = cliParseResult["animation-quantization-bits"]
+                                      .as<std::vector<std::string>>();
+    }
+
+    if (cliParseResult.count("animation-threads")) {
+      cliArgs.convertOptions.animationThreads =
+          cliParseResult["animation-threads"]
+              .as<decltype(cliArgs.convertOptions.animationThreads)>();
+    }
+
+    if (cliParseResult.count("io-threads")) {
+      cliArgs.convertOptions.ioThreads =
+          cliParseResult["io-threads"]
+              .as<decltype(cliArgs.convertOptions.ioThreads)>();
+    }
+
+    if (cliParseResult.count("mesh-quantization") &&
+        cliParseResult["mesh-quantization"].as<bool>()) {
+      cliArgs.convertOptions.meshQuantization.emplace();
+    }
+
+    if (cliParseResult.count("mesh-quantization-bits")) {
+      meshQuantizationBits = cliParseResult["mesh-quantization-bits"]
+                                 .as<std::vector<std::string>>();
+    }
+
+    if (cliParseResult.count("no-mesh-optimization")) {
+      cliArgs.convertOptions.noMeshOptimization =
+          cliParseResult["no-mesh-optimization"].as<bool>();
+    }
+
+    if (cliParseResult.count("sdk-triangulation")) {
+      cliArgs.convertOptions.sdkTriangulation =
+          cliParseResult["sdk-triangulation"].as<bool>();
+    }
+
+    if (cliParseResult.count("compact-json") &&
+        cliParseResult["compact-json"].as<bool>()) {
+      cliArgs.convertOptions.jsonIndent = -1;
+    }
+
+    if (cliParseResult.count("naming")) {
+      naming = cliParseResult["naming"].as<std::string>();
+    }
+
+    if (cliParseResult.count("gpu-instancing")) {
+      cliArgs.convertOptions.gpuInstancing =
+          cliParseResult["gpu-instancing"].as<bool>();
+    }
+
+    if (cliParseResult.count("meshopt-compression") &&
+        cliParseResult["meshopt-compression"].as<bool>()) {
+      cliArgs.convertOptions.meshoptCompression.emplace();
+    }
+
+    if (cliParseResult.count("meshopt-exclude")) {
+      meshoptExcluded =
+          cliParseResult["meshopt-exclude"].as<std::vector<std::string>>();
+    }
+
+    if (cliParseResult.count("buffer-partition")) {
+      bufferPartitions =
+          cliParseResult["buffer-partition"].as<std::vector<std::string>>();
+    }
+
+    if (cliParseResult.count("ktx2")) {
+      ktx2Codec = cliParseResult["ktx2"].as<std::string>();
+    }
+
+    if (cliParseResult.count("ktx2-mipmaps")) {
+      ktx2Mipmaps = cliParseResult["ktx2-mipmaps"].as<bool>();
+    }
+
+    if (cliParseResult.count("ktx2-max-size")) {
+      ktx2MaxSize = cliParseResult["ktx2-max-size"].as<std::uint32_t>();
+    }
+
+    if (cliParseResult.count("ktx2-threads")) {
+      ktx2Threads = cliParseResult["ktx2-threads"].as<std::uint32_t>();
+    }
+
+    if (cliParseResult.count("node-filter")) {
+      nodeFilter =
+          cliParseResult["node-filter"].as<std::vector<std::string>>();
+    }
+
+    if (cliParseResult.count("no-skin")) {
+      cliArgs.convertOptions.export_skin =
+          !cliParseResult["no-skin"].as<bool>();
+    }
+
+    if (cliParseResult.count("max-skin-influences")) {
+      cliArgs.convertOptions.maxSkinInfluences =
+          cliParseResult["max-skin-influences"].as<std::uint32_t>();
+    }
+
+    if (cliParseResult.count("no-blend-shape")) {
+      cliArgs.convertOptions.export_blend_shape =
+          !cliParseResult["no-blend-shape"].as<bool>();
+    }
+
+    if (cliParseResult.count("no-animation")) {
+      const auto noAnimation = cliParseResult["no-animation"].as<bool>();
+      cliArgs.convertOptions.export_trs_animation = !noAnimation;
+      cliArgs.convertOptions.export_blend_shape_animation = !noAnimation;
+    }
+
+    if (cliParseResult.count("no-material")) {
+      cliArgs.convertOptions.export_material =
+          !cliParseResult["no-material"].as<bool>();
+    }
+
+    if (inputFile.empty() && batchFile.empty()) {
       std::cerr << "Input file not specified." << std::endl;
       std::cerr << options.help() << std::endl;
       return {};
@@ -232,6 +580,164 @@ std::optional<CliArgs> readCliArgs(std::span<std::string_view> args_) {
     }
   }
 
+  if (!naming.empty()) {
+    if (naming == "full") {
+      cliArgs.convertOptions.naming = bee::ConvertOptions::NamingPolicy::full;
+    } else if (naming == "nodes-and-meshes") {
+      cliArgs.convertOptions.naming =
+          bee::ConvertOptions::NamingPolicy::nodesAndMeshes;
+    } else if (naming == "none") {
+      cliArgs.convertOptions.naming = bee::ConvertOptions::NamingPolicy::none;
+    } else {
+      std::cerr << "Unknown naming policy: " << naming << "\n";
+    }
+  }
+
+  if (!meshQuantizationBits.empty()) {
+    auto &meshQuantization = cliArgs.convertOptions.meshQuantization;
+    if (!meshQuantization) {
+      meshQuantization.emplace();
+    }
+    for (const auto &item : meshQuantizationBits) {
+      const auto iEqual = item.find('=');
+      const auto attribute = item.substr(0, iEqual);
+      std::uint32_t bits = 0;
+      try {
+        bits = iEqual == std::string::npos
+                   ? ~std::uint32_t{0}
+                   : static_cast<std::uint32_t>(
+                         std::stoul(item.substr(iEqual + 1)));
+      } catch (const std::exception &) {
+        bits = ~std::uint32_t{0};
+      }
+      const auto isByteOrShort = bits == 0 || bits == 8 || bits == 16;
+      std::uint32_t *target = nullptr;
+      if (attribute == "position") {
+        target = bits == 0 || (bits >= 2 && bits <= 16)
+                     ? &meshQuantization->positionBits
+                     : nullptr;
+      } else if (attribute == "normal") {
+        target = isByteOrShort ? &meshQuantization->normalBits : nullptr;
+      } else if (attribute == "texcoord") {
+        target = isByteOrShort ? &meshQuantization->texCoordBits : nullptr;
+      } else if (attribute == "color") {
+        target = isByteOrShort ? &meshQuantization->colorBits : nullptr;
+      } else if (attribute == "weight") {
+        target = isByteOrShort ? &meshQuantization->weightBits : nullptr;
+      }
+      if (target) {
+        *target = bits;
+      } else {
+        std::cerr << "Invalid mesh quantization bits: " << item << "\n";
+      }
+    }
+  }
+
+  for (const auto &item : animationTolerance) {
+    const auto iEqual = item.find('=');
+    const auto channel = item.substr(0, iEqual);
+    double tolerance = -1.0;
+    try {
+      if (iEqual != std::string::npos) {
+        tolerance = std::stod(item.substr(iEqual + 1));
+      }
+    } catch (const std::exception &) {
+      tolerance = -1.0;
+    }
+    auto &animationTolerances = cliArgs.convertOptions.animationTolerance;
+    double *target = nullptr;
+    if (channel == "translation") {
+      target = &animationTolerances.translation;
+    } else if (channel == "rotation") {
+      target = &animationTolerances.rotation;
+    } else if (channel == "scale") {
+      target = &animationTolerances.scale;
+    } else if (channel == "weight") {
+      target = &animationTolerances.weight;
+    }
+    if (target && tolerance >= 0.0) {
+      *target = tolerance;
+    } else {
+      std::cerr << "Invalid animation tolerance: " << item << "\n";
+    }
+  }
+
+  if (!animationQuantizationBits.empty()) {
+    auto &animationQuantization = cliArgs.convertOptions.animationQuantization;
+    if (!animationQuantization) {
+      animationQuantization.emplace();
+    }
+    for (const auto &item : animationQuantizationBits) {
+      const auto iEqual = item.find('=');
+      const auto output = item.substr(0, iEqual);
+      std::uint32_t bits = 0;
+      try {
+        bits = iEqual == std::string::npos
+                   ? ~std::uint32_t{0}
+                   : static_cast<std::uint32_t>(
+                         std::stoul(item.substr(iEqual + 1)));
+      } catch (const std::exception &) {
+        bits = ~std::uint32_t{0};
+      }
+      const auto isByteOrShort = bits == 0 || bits == 8 || bits == 16;
+      std::uint32_t *target = nullptr;
+      if (output == "rotation") {
+        target =
+            isByteOrShort ? &animationQuantization->rotationBits : nullptr;
+      } else if (output == "weight") {
+        target = isByteOrShort ? &animationQuantization->weightBits : nullptr;
+      }
+      if (target) {
+        *target = bits;
+      } else {
+        std::cerr << "Invalid animation quantization bits: " << item << "\n";
+      }
+    }
+  }
+
+  if (!meshoptExcluded.empty()) {
+    auto &meshoptCompression = cliArgs.convertOptions.meshoptCompression;
+    if (!meshoptCompression) {
+      meshoptCompression.emplace();
+    }
+    meshoptCompression->excluded = meshoptExcluded;
+  }
+
+  for (const auto &bufferPartition : bufferPartitions) {
+    auto &bufferPartitioning = cliArgs.convertOptions.bufferPartitioning;
+    if (bufferPartition == "mesh") {
+      bufferPartitioning.perMesh = true;
+    } else if (bufferPartition == "morph-targets") {
+      bufferPartitioning.morphTargets = true;
+    } else if (bufferPartition == "animation") {
+      bufferPartitioning.perAnimationStack = true;
+    } else {
+      std::cerr << "Unknown buffer partition: " << bufferPartition << "\n";
+    }
+  }
+
+  if (!ktx2Codec.empty() || ktx2Mipmaps || ktx2MaxSize || ktx2Threads) {
+    auto &textureTranscoding =
+        cliArgs.convertOptions.textureTranscoding.emplace();
+    if (ktx2Codec == "uastc") {
+      textureTranscoding.codec =
+          bee::ConvertOptions::TextureTranscoding::Codec::uastc;
+    } else if (!ktx2Codec.empty() && ktx2Codec != "etc1s") {
+      std::cerr << "Unknown KTX2 codec: " << ktx2Codec << "\n";
+    }
+    textureTranscoding.mipmaps = ktx2Mipmaps;
+    if (ktx2MaxSize) {
+      textureTranscoding.maxSize = *ktx2MaxSize;
+    }
+    if (ktx2Threads) {
+      textureTranscoding.threads = *ktx2Threads;
+    }
+  }
+
+  for (const auto &name : nodeFilter) {
+    cliArgs.convertOptions.nodeFilter.emplace_back(name.begin(), name.end());
+  }
+
   cliArgs.inputFile.assign(inputFile.begin(), inputFile.end());
   cliArgs.outFile.assign(outFile.begin(), outFile.end());
   cliArgs.fbmDir.assign(fbmDir.begin(), fbmDir.end());
@@ -239,6 +745,23 @@ std::optional<CliArgs> readCliArgs(std::span<std::string_view> args_) {
     cliArgs.logFile.emplace();
     cliArgs.logFile->assign(logFile.begin(), logFile.end());
   }
+  if (!batchFile.empty()) {
+    cliArgs.batchFile.emplace();
+    cliArgs.batchFile->assign(batchFile.begin(), batchFile.end());
+  }
+  if (!textureSearchCache.empty()) {
+    cliArgs.textureSearchCache.emplace();
+    cliArgs.textureSearchCache->assign(textureSearchCache.begin(),
+                                       textureSearchCache.end());
+  }
+  if (!traceFile.empty()) {
+    cliArgs.convertOptions.traceFile.emplace(traceFile.begin(),
+                                             traceFile.end());
+  }
+
+  if (!cacheDir.empty()) {
+    cliArgs.convertOptions.cacheDir.emplace(cacheDir.begin(), cacheDir.end());
+  }
   if (!textureSearchLocations.empty()) {
     const auto baseDir = bee::filesystem::path{inputFile}.parent_path();
     cliArgs.convertOptions.textureResolution.locations.resize(
@@ -259,4 +782,4 @@ std::optional<CliArgs> readCliArgs(std::span<std::string_view> args_) {
 
   return cliArgs;
 }
-} // namespace beecli
\ No newline at end of file
+} // namespace beecli
\ No newline at end of file
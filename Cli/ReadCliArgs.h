@@ -15,6 +15,10 @@ struct CliArgs {
   std::u8string outFile;
   std::u8string fbmDir;
   std::optional<std::u8string> logFile;
+  std::optional<std::u8string> batchFile;
+  std::optional<std::u8string> textureSearchCache;
+  std::uint32_t jobs = 1;
+  std::uintmax_t memoryBudget = 0;
   bee::ConvertOptions convertOptions;
 };
 
@@ -22,4 +26,4 @@ std::optional<std::vector<std::string>>
 getCommandLineArgsU8(int argc_, const char *argv_[]);
 
 std::optional<CliArgs> readCliArgs(std::span<std::string_view> args_);
-} // namespace beecli
\ No newline at end of file
+} // namespace beecli
\ No newline at end of file
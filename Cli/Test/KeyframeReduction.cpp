@@ -0,0 +1,81 @@
+#include <bee/Convert/KeyframeReduction.h>
+#include <cmath>
+#include <cstddef>
+#include <doctest/doctest.h>
+#include <vector>
+
+namespace {
+using Keys = std::vector<std::size_t>;
+
+using Values = std::vector<double>;
+
+/// <summary>
+/// Reduces a scalar curve interpolated linearly.
+/// </summary>
+std::vector<std::size_t> reduceLinear(const std::vector<double> &times_,
+                                      const std::vector<double> &values_,
+                                      double tolerance_) {
+  return bee::reduceKeyframes(
+      times_, tolerance_,
+      [&values_](std::size_t from_, std::size_t to_, std::size_t at_,
+                 double rate_) {
+        return std::abs(values_[from_] +
+                        (values_[to_] - values_[from_]) * rate_ -
+                        values_[at_]);
+      });
+}
+} // namespace
+
+TEST_CASE("Reduce keyframes") {
+  const std::vector<double> times{0.0, 1.0, 2.0, 3.0, 4.0};
+
+  { // Collinear keys are removed, the first and last ones are kept.
+    const std::vector<double> values{0.0, 0.5, 1.0, 1.5, 2.0};
+    CHECK_EQ(reduceLinear(times, values, 1e-4),
+             Keys({0, 4}));
+  }
+
+  { // A corner is kept, keys on either side of it are not.
+    const std::vector<double> values{0.0, 1.0, 2.0, 1.0, 0.0};
+    CHECK_EQ(reduceLinear(times, values, 1e-4),
+             Keys({0, 2, 4}));
+  }
+
+  { // Only the first key of a constant curve is kept.
+    const std::vector<double> values{1.0, 1.0, 1.0, 1.0, 1.0};
+    CHECK_EQ(reduceLinear(times, values, 1e-4), Keys({0}));
+  }
+
+  { // A tolerance of 0 keeps every key which is not exactly interpolated.
+    const std::vector<double> values{0.0, 0.1, 0.3, 0.2, 0.7};
+    CHECK_EQ(reduceLinear(times, values, 0.0),
+             Keys({0, 1, 2, 3, 4}));
+  }
+
+  { // Deviations within the tolerance are dropped, beyond it are kept.
+    const std::vector<double> values{0.0, 1.05, 2.0, 3.5, 4.0};
+    CHECK_EQ(reduceLinear(times, values, 0.1),
+             Keys({0, 2, 3, 4}));
+  }
+
+  { // Keys of a step curve hold their value until the next one: the step
+    // is not merged into the keys holding the previous value.
+    const std::vector<double> values{0.0, 0.0, 0.0, 1.0, 1.0};
+    const auto keys = bee::reduceKeyframes(
+        times, 1e-4,
+        [&values](std::size_t from_, std::size_t, std::size_t at_, double) {
+          return std::abs(values[at_] - values[from_]);
+        });
+    CHECK_EQ(keys, Keys({0, 3, 4}));
+  }
+
+  { // Keys kept are applied to the times and the values.
+    std::vector<double> keptTimes{times};
+    std::vector<double> values{0.0, 0.0, 1.0, 1.0, 2.0, 2.0, 3.0, 3.0, 4.0,
+                               4.0};
+    const std::vector<std::size_t> keys{0, 2, 4};
+    bee::keepKeyframes(keys, keptTimes, values, 2);
+    CHECK_EQ(keptTimes, Values({0.0, 2.0, 4.0}));
+    CHECK_EQ(values, Values({0.0, 0.0, 2.0, 2.0, 4.0, 4.0}));
+  }
+}
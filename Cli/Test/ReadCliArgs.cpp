@@ -45,13 +45,46 @@ TEST_CASE("Read CLI arguments") {
     CHECK_EQ(u8toexe(convertOptions->outFile), ""s);
     CHECK_EQ(u8toexe(convertOptions->fbmDir), "");
     CHECK_EQ(convertOptions->logFile, std::nullopt);
+    CHECK_EQ(convertOptions->batchFile, std::nullopt);
+    CHECK_EQ(convertOptions->textureSearchCache, std::nullopt);
+    CHECK_EQ(convertOptions->convertOptions.cacheDir, std::nullopt);
+    CHECK_EQ(convertOptions->convertOptions.stats, false);
+    CHECK_EQ(convertOptions->convertOptions.traceFile, std::nullopt);
+    CHECK_EQ(convertOptions->jobs, 1);
+    CHECK_EQ(convertOptions->memoryBudget, 0);
     CHECK_EQ(convertOptions->convertOptions.prefer_local_time_span, true);
     CHECK_EQ(convertOptions->convertOptions.animationBakeRate, 0);
+    CHECK_EQ(convertOptions->convertOptions.meshThreads, 1);
+    CHECK_EQ(convertOptions->convertOptions.animationThreads, 1);
+    CHECK_EQ(convertOptions->convertOptions.ioThreads, 1);
+    CHECK_EQ(convertOptions->convertOptions.animationQuantization.has_value(),
+             false);
+    CHECK_EQ(convertOptions->convertOptions.meshQuantization.has_value(),
+             false);
+    CHECK_EQ(convertOptions->convertOptions.noMeshOptimization, false);
+    CHECK_EQ(convertOptions->convertOptions.sdkTriangulation, false);
+    CHECK_EQ(convertOptions->convertOptions.jsonIndent, 2);
+    CHECK_EQ(convertOptions->convertOptions.gpuInstancing, false);
+    CHECK_EQ(convertOptions->convertOptions.meshoptCompression.has_value(),
+             false);
+    CHECK_EQ(convertOptions->convertOptions.bufferPartitioning.any(), false);
+    CHECK_EQ(convertOptions->convertOptions.textureTranscoding.has_value(),
+             false);
+    CHECK(convertOptions->convertOptions.nodeFilter.empty());
+    CHECK_EQ(convertOptions->convertOptions.export_skin, true);
+    CHECK_EQ(convertOptions->convertOptions.maxSkinInfluences, 0);
+    CHECK_EQ(convertOptions->convertOptions.export_blend_shape, true);
+    CHECK_EQ(convertOptions->convertOptions.export_trs_animation, true);
+    CHECK_EQ(convertOptions->convertOptions.export_blend_shape_animation,
+             true);
+    CHECK_EQ(convertOptions->convertOptions.export_material, true);
     CHECK_EQ(convertOptions->convertOptions.verbose, false);
     CHECK_EQ(convertOptions->convertOptions.noFlipV, false);
     CHECK_EQ(convertOptions->convertOptions.textureResolution.disabled, false);
     CHECK_EQ(convertOptions->convertOptions.unitConversion,
              bee::ConvertOptions::UnitConversion::geometryLevel);
+    CHECK_EQ(convertOptions->convertOptions.naming,
+             bee::ConvertOptions::NamingPolicy::full);
   }
 
   {// Input file
@@ -143,6 +176,33 @@ CHECK_EQ(u8toexe(args->convertOptions.textureResolution.locations[0]), "/a"s);
 }
 }
 
+{ // Texture search cache
+  const auto cacheFile = "cache.json"s;
+  CHECK_EQ(u8toexe(*read_cli_args_with_dummy_and("--texture-search-cache=" +
+                                                 cacheFile)
+                        ->textureSearchCache),
+           cacheFile);
+}
+
+{ // Cache directory
+  const auto cacheDir = "cache"s;
+  CHECK_EQ(u8toexe(*read_cli_args_with_dummy_and("--cache-dir=" + cacheDir)
+                        ->convertOptions.cacheDir),
+           cacheDir);
+}
+
+{ // Stats
+  CHECK_EQ(read_cli_args_with_dummy_and("--stats"sv)->convertOptions.stats,
+           true);
+}
+
+{ // Trace file
+  const auto traceFile = "trace.json"s;
+  CHECK_EQ(u8toexe(*read_cli_args_with_dummy_and("--trace-file=" + traceFile)
+                        ->convertOptions.traceFile),
+           traceFile);
+}
+
 { // Prefer local time span
   CHECK_EQ(read_cli_args_with_dummy_and("--prefer-local-time-span"sv)
                ->convertOptions.prefer_local_time_span,
@@ -188,4 +248,273 @@ CHECK_EQ(u8toexe(args->convertOptions.textureResolution.locations[0]), "/a"s);
       u8toexe(*read_cli_args_with_dummy_and("--log-file=" + logFile)->logFile),
       logFile);
 }
+{ // Batch
+  const auto batchFile = "666.txt"s;
+  CHECK_EQ(
+      u8toexe(*read_cli_args_with_dummy_and("--batch=" + batchFile)->batchFile),
+      batchFile);
+
+  // Input file is not required in batch mode
+  std::vector<std::string_view> args{dummyArg0, "--batch=list.txt"sv};
+  const auto cliArgs = beecli::readCliArgs(args);
+  CHECK(cliArgs.has_value());
+  CHECK_EQ(u8toexe(cliArgs->inputFile), ""s);
+  CHECK_EQ(u8toexe(*cliArgs->batchFile), "list.txt"s);
+}
+{ // Jobs
+  CHECK_EQ(read_cli_args_with_dummy_and("--jobs=8"sv)->jobs, 8);
+  CHECK_EQ(read_cli_args_with_dummy_and("--jobs=0"sv)->jobs, 0);
+}
+
+{ // Memory budget
+  CHECK_EQ(read_cli_args_with_dummy_and("--memory-budget=2048"sv)->memoryBudget,
+           2048ull * 1024 * 1024);
+}
+
+{ // Mesh threads
+  CHECK_EQ(read_cli_args_with_dummy_and("--mesh-threads=4"sv)
+               ->convertOptions.meshThreads,
+           4);
+  CHECK_EQ(read_cli_args_with_dummy_and("--mesh-threads=0"sv)
+               ->convertOptions.meshThreads,
+           0);
+}
+
+{ // Animation tolerance
+  {
+    const auto animationTolerance =
+        read_cli_args_with_dummy_and(
+            "--animation-tolerance=translation=0.001,rotation=0.5,weight=0"sv)
+            ->convertOptions.animationTolerance;
+    CHECK_EQ(animationTolerance.translation, 0.001);
+    CHECK_EQ(animationTolerance.rotation, 0.5);
+    CHECK_EQ(animationTolerance.scale, 1e-4);
+    CHECK_EQ(animationTolerance.weight, 0.0);
+  }
+
+  {
+    // Invalid tolerances are ignored.
+    const auto animationTolerance =
+        read_cli_args_with_dummy_and("--animation-tolerance=scale=-1"sv)
+            ->convertOptions.animationTolerance;
+    CHECK_EQ(animationTolerance.scale, 1e-4);
+  }
+}
+
+{ // Animation quantization
+  {
+    const auto animationQuantization =
+        read_cli_args_with_dummy_and("--animation-quantization"sv)
+            ->convertOptions.animationQuantization;
+    CHECK(animationQuantization.has_value());
+    CHECK_EQ(animationQuantization->rotationBits, 16);
+    CHECK_EQ(animationQuantization->weightBits, 16);
+  }
+
+  {
+    const auto animationQuantization =
+        read_cli_args_with_dummy_and(
+            "--animation-quantization-bits=rotation=0,weight=8"sv)
+            ->convertOptions.animationQuantization;
+    CHECK(animationQuantization.has_value());
+    CHECK_EQ(animationQuantization->rotationBits, 0);
+    CHECK_EQ(animationQuantization->weightBits, 8);
+  }
+
+  {
+    // Invalid bits are ignored.
+    const auto animationQuantization =
+        read_cli_args_with_dummy_and(
+            "--animation-quantization-bits=weight=12"sv)
+            ->convertOptions.animationQuantization;
+    CHECK_EQ(animationQuantization->weightBits, 16);
+  }
+}
+
+{ // Animation threads
+  CHECK_EQ(read_cli_args_with_dummy_and("--animation-threads=4"sv)
+               ->convertOptions.animationThreads,
+           4);
+  CHECK_EQ(read_cli_args_with_dummy_and("--animation-threads=0"sv)
+               ->convertOptions.animationThreads,
+           0);
+}
+{ // IO threads
+  CHECK_EQ(read_cli_args_with_dummy_and("--io-threads=4"sv)
+               ->convertOptions.ioThreads,
+           4);
+  CHECK_EQ(read_cli_args_with_dummy_and("--io-threads=0"sv)
+               ->convertOptions.ioThreads,
+           0);
+}
+{ // Mesh quantization
+  {
+    const auto meshQuantization =
+        read_cli_args_with_dummy_and("--mesh-quantization"sv)
+            ->convertOptions.meshQuantization;
+    CHECK(meshQuantization.has_value());
+    CHECK_EQ(meshQuantization->positionBits, 16);
+    CHECK_EQ(meshQuantization->normalBits, 8);
+    CHECK_EQ(meshQuantization->texCoordBits, 16);
+    CHECK_EQ(meshQuantization->colorBits, 8);
+    CHECK_EQ(meshQuantization->weightBits, 8);
+  }
+
+  {
+    const auto meshQuantization =
+        read_cli_args_with_dummy_and(
+            "--mesh-quantization-bits=position=12,normal=16,texcoord=0"sv)
+            ->convertOptions.meshQuantization;
+    CHECK(meshQuantization.has_value());
+    CHECK_EQ(meshQuantization->positionBits, 12);
+    CHECK_EQ(meshQuantization->normalBits, 16);
+    CHECK_EQ(meshQuantization->texCoordBits, 0);
+    CHECK_EQ(meshQuantization->colorBits, 8);
+  }
+
+  {
+    // Invalid bits are ignored.
+    const auto meshQuantization =
+        read_cli_args_with_dummy_and("--mesh-quantization-bits=normal=12"sv)
+            ->convertOptions.meshQuantization;
+    CHECK_EQ(meshQuantization->normalBits, 8);
+  }
+
+  {
+    const auto meshQuantization =
+        read_cli_args_with_dummy_and("--mesh-quantization-bits=position=1"sv)
+            ->convertOptions.meshQuantization;
+    CHECK_EQ(meshQuantization->positionBits, 16);
+  }
+}
+{ // No mesh optimization
+  CHECK_EQ(read_cli_args_with_dummy_and("--no-mesh-optimization"sv)
+               ->convertOptions.noMeshOptimization,
+           true);
+  CHECK_EQ(read_cli_args_with_dummy_and("--no-mesh-optimization=false"sv)
+               ->convertOptions.noMeshOptimization,
+           false);
+}
+{ // SDK triangulation
+  CHECK_EQ(read_cli_args_with_dummy_and("--sdk-triangulation"sv)
+               ->convertOptions.sdkTriangulation,
+           true);
+}
+{ // Compact JSON
+  CHECK_EQ(read_cli_args_with_dummy_and("--compact-json"sv)
+               ->convertOptions.jsonIndent,
+           -1);
+}
+{ // Naming
+  CHECK_EQ(
+      read_cli_args_with_dummy_and("--naming=full"sv)->convertOptions.naming,
+      bee::ConvertOptions::NamingPolicy::full);
+  CHECK_EQ(read_cli_args_with_dummy_and("--naming=nodes-and-meshes"sv)
+               ->convertOptions.naming,
+           bee::ConvertOptions::NamingPolicy::nodesAndMeshes);
+  CHECK_EQ(
+      read_cli_args_with_dummy_and("--naming=none"sv)->convertOptions.naming,
+      bee::ConvertOptions::NamingPolicy::none);
+}
+{ // GPU instancing
+  CHECK_EQ(read_cli_args_with_dummy_and("--gpu-instancing"sv)
+               ->convertOptions.gpuInstancing,
+           true);
+}
+{ // Meshopt compression
+  {
+    const auto meshoptCompression =
+        read_cli_args_with_dummy_and("--meshopt-compression"sv)
+            ->convertOptions.meshoptCompression;
+    CHECK(meshoptCompression.has_value());
+    CHECK(meshoptCompression->excluded.empty());
+  }
+
+  {
+    const auto meshoptCompression =
+        read_cli_args_with_dummy_and("--meshopt-exclude=TEXCOORD,ANIMATION"sv)
+            ->convertOptions.meshoptCompression;
+    CHECK(meshoptCompression.has_value());
+    CHECK_EQ(meshoptCompression->excluded,
+             (std::vector<std::string>{"TEXCOORD", "ANIMATION"}));
+  }
+}
+{ // Buffer partitioning
+  {
+    const auto bufferPartitioning =
+        read_cli_args_with_dummy_and("--buffer-partition=mesh,animation"sv)
+            ->convertOptions.bufferPartitioning;
+    CHECK_EQ(bufferPartitioning.perMesh, true);
+    CHECK_EQ(bufferPartitioning.morphTargets, false);
+    CHECK_EQ(bufferPartitioning.perAnimationStack, true);
+  }
+
+  {
+    const auto bufferPartitioning =
+        read_cli_args_with_dummy_and("--buffer-partition=morph-targets"sv)
+            ->convertOptions.bufferPartitioning;
+    CHECK_EQ(bufferPartitioning.perMesh, false);
+    CHECK_EQ(bufferPartitioning.morphTargets, true);
+    CHECK_EQ(bufferPartitioning.perAnimationStack, false);
+  }
+}
+{ // KTX2
+  using Codec = bee::ConvertOptions::TextureTranscoding::Codec;
+  {
+    const auto textureTranscoding =
+        read_cli_args_with_dummy_and("--ktx2=etc1s"sv)
+            ->convertOptions.textureTranscoding;
+    CHECK(textureTranscoding.has_value());
+    CHECK_EQ(textureTranscoding->codec, Codec::etc1s);
+    CHECK_EQ(textureTranscoding->mipmaps, false);
+    CHECK_EQ(textureTranscoding->maxSize, 0);
+    CHECK_EQ(textureTranscoding->threads, 1);
+  }
+
+  CHECK_EQ(read_cli_args_with_dummy_and("--ktx2=uastc"sv)
+               ->convertOptions.textureTranscoding->codec,
+           Codec::uastc);
+
+  {
+    const auto textureTranscoding =
+        read_cli_args_with_dummy_and("--ktx2-mipmaps"sv)
+            ->convertOptions.textureTranscoding;
+    CHECK(textureTranscoding.has_value());
+    CHECK_EQ(textureTranscoding->codec, Codec::etc1s);
+    CHECK_EQ(textureTranscoding->mipmaps, true);
+  }
+
+  CHECK_EQ(read_cli_args_with_dummy_and("--ktx2-max-size=1024"sv)
+               ->convertOptions.textureTranscoding->maxSize,
+           1024);
+  CHECK_EQ(read_cli_args_with_dummy_and("--ktx2-threads=0"sv)
+               ->convertOptions.textureTranscoding->threads,
+           0);
+}
+{ // Node filter
+  CHECK_EQ(read_cli_args_with_dummy_and("--node-filter=Body,LOD0"sv)
+               ->convertOptions.nodeFilter,
+           (std::vector<std::u8string>{u8"Body", u8"LOD0"}));
+}
+{ // Max skin influences
+  CHECK_EQ(read_cli_args_with_dummy_and("--max-skin-influences=4"sv)
+               ->convertOptions.maxSkinInfluences,
+           4);
+}
+{ // Selective import
+  CHECK_EQ(
+      read_cli_args_with_dummy_and("--no-skin"sv)->convertOptions.export_skin,
+      false);
+  CHECK_EQ(read_cli_args_with_dummy_and("--no-blend-shape"sv)
+               ->convertOptions.export_blend_shape,
+           false);
+  {
+    const auto args = read_cli_args_with_dummy_and("--no-animation"sv);
+    CHECK_EQ(args->convertOptions.export_trs_animation, false);
+    CHECK_EQ(args->convertOptions.export_blend_shape_animation, false);
+  }
+  CHECK_EQ(read_cli_args_with_dummy_and("--no-material"sv)
+               ->convertOptions.export_material,
+           false);
+}
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include <bee/Convert/TextureTranscoding.h>
+#include <bee/polyfills/filesystem.h>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <fstream>
+#include <vector>
+
+namespace {
+/// <summary>
+/// Writes an uncompressed, top-left origin, 32-bit TGA file.
+/// </summary>
+void writeTga(const bee::filesystem::path &path_,
+              std::uint16_t width_,
+              std::uint16_t height_) {
+  std::array<std::uint8_t, 18> header{};
+  header[2] = 2;
+  header[12] = static_cast<std::uint8_t>(width_ & 0xff);
+  header[13] = static_cast<std::uint8_t>(width_ >> 8);
+  header[14] = static_cast<std::uint8_t>(height_ & 0xff);
+  header[15] = static_cast<std::uint8_t>(height_ >> 8);
+  header[16] = 32;
+  header[17] = 0x28;
+  std::vector<std::uint8_t> pixels(std::size_t{width_} * height_ * 4);
+  for (std::size_t i = 0; i < pixels.size(); ++i) {
+    pixels[i] = static_cast<std::uint8_t>(i * 37);
+  }
+  std::ofstream stream{path_, std::ios::binary};
+  stream.write(reinterpret_cast<const char *>(header.data()), header.size());
+  stream.write(reinterpret_cast<const char *>(pixels.data()), pixels.size());
+}
+
+std::uint32_t readUint32(const std::vector<std::byte> &bytes_,
+                         std::size_t offset_) {
+  std::uint32_t value = 0;
+  std::memcpy(&value, bytes_.data() + offset_, sizeof(value));
+  return value;
+}
+} // namespace
+
+TEST_CASE("Transcode an odd-sized image") {
+  const auto path =
+      bee::filesystem::temp_directory_path() / "FBX-glTF-conv-test-5x3.tga";
+  writeTga(path, 5, 3);
+
+  bee::ConvertOptions::TextureTranscoding options;
+  options.mipmaps = true;
+  bee::TextureTranscoder transcoder{options};
+  const auto job = transcoder.submit(path, false);
+  transcoder.wait();
+  const auto &result = transcoder.result(job);
+  CHECK(transcoder.error(job).empty());
+  REQUIRE(result.size() >= 28);
+  // `pixelWidth` and `pixelHeight` follow the identifier, `vkFormat` and
+  // `typeSize` in the KTX2 header.
+  const auto width = readUint32(result, 20);
+  const auto height = readUint32(result, 24);
+  CHECK_EQ(width % 4, 0);
+  CHECK_EQ(height % 4, 0);
+  CHECK_EQ(width, 4);
+  CHECK_EQ(height, 4);
+
+  std::error_code err;
+  bee::filesystem::remove(path, err);
+}
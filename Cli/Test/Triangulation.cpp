@@ -0,0 +1,130 @@
+#include <bee/Convert/Triangulation.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <vector>
+
+namespace {
+using Position = std::array<double, 3>;
+
+/// <summary>
+/// Twice the signed area of the polygon, positive if counter-clockwise in XY.
+/// </summary>
+double signedArea(const std::vector<Position> &polygon_) {
+  double area = 0.0;
+  for (std::size_t i = 0; i < polygon_.size(); ++i) {
+    const auto &p = polygon_[i];
+    const auto &q = polygon_[(i + 1) % polygon_.size()];
+    area += p[0] * q[1] - q[0] * p[1];
+  }
+  return area;
+}
+
+/// <summary>
+/// Whether the point is inside the polygon, by the even-odd rule.
+/// </summary>
+bool inside(const std::vector<Position> &polygon_, double x_, double y_) {
+  bool in = false;
+  for (std::size_t i = 0, j = polygon_.size() - 1; i < polygon_.size();
+       j = i++) {
+    const auto &p = polygon_[i];
+    const auto &q = polygon_[j];
+    if ((p[1] > y_) != (q[1] > y_) &&
+        x_ < (q[0] - p[0]) * (y_ - p[1]) / (q[1] - p[1]) + p[0]) {
+      in = !in;
+    }
+  }
+  return in;
+}
+
+/// <summary>
+/// Triangulates a counter-clockwise polygon of the XY plane and checks that it
+/// gives n-2 triangles, keeping its winding, which cover the polygon exactly.
+/// </summary>
+void checkTriangulation(const std::vector<Position> &polygon_) {
+  std::vector<std::uint32_t> triangles;
+  bee::triangulatePolygon(polygon_, triangles);
+  REQUIRE_EQ(triangles.size(), 3 * (polygon_.size() - 2));
+
+  double coveredArea = 0.0;
+  for (std::size_t iTriangle = 0; iTriangle < triangles.size();
+       iTriangle += 3) {
+    std::vector<Position> triangle;
+    for (std::size_t iCorner = 0; iCorner < 3; ++iCorner) {
+      const auto corner = triangles[iTriangle + iCorner];
+      REQUIRE(corner < polygon_.size());
+      triangle.push_back(polygon_[corner]);
+    }
+    const auto area = signedArea(triangle);
+    CHECK(area >= 0.0);
+    coveredArea += area;
+    if (area > 0.0) {
+      // Triangles don't overlap if they sum up to the polygon; each one is
+      // then in the polygon if its centroid is.
+      CHECK(inside(polygon_,
+                   (triangle[0][0] + triangle[1][0] + triangle[2][0]) / 3.0,
+                   (triangle[0][1] + triangle[1][1] + triangle[2][1]) / 3.0));
+    }
+  }
+  CHECK_EQ(coveredArea, doctest::Approx(signedArea(polygon_)));
+}
+} // namespace
+
+TEST_CASE("Triangulate polygons") {
+  // Convex.
+  checkTriangulation({{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}});
+
+  // Concave: an L-shape, starting from its reflex corner or not.
+  checkTriangulation(
+      {{0, 0, 0}, {2, 0, 0}, {2, 1, 0}, {1, 1, 0}, {1, 2, 0}, {0, 2, 0}});
+  checkTriangulation(
+      {{1, 1, 0}, {1, 2, 0}, {0, 2, 0}, {0, 0, 0}, {2, 0, 0}, {2, 1, 0}});
+
+  // Concave: an arrow whose tip would be cut off by a fan.
+  checkTriangulation({{0, 0, 0}, {2, 1, 0}, {4, 0, 0}, {2, 3, 0}});
+
+  // Collinear corners.
+  checkTriangulation({{0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {2, 2, 0}, {0, 2, 0}});
+  checkTriangulation(
+      {{0, 0, 0}, {2, 0, 0}, {2, 1, 0}, {2, 2, 0}, {1, 2, 0}, {0, 2, 0}});
+
+  // Duplicate corners.
+  checkTriangulation({{0, 0, 0}, {1, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}});
+  checkTriangulation(
+      {{0, 0, 0}, {2, 0, 0}, {2, 1, 0}, {1, 1, 0}, {1, 1, 0}, {1, 2, 0},
+       {0, 2, 0}});
+
+  { // Degenerate: all corners on a line.
+    const std::vector<Position> polygon{
+        {0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {3, 0, 0}};
+    std::vector<std::uint32_t> triangles;
+    bee::triangulatePolygon(polygon, triangles);
+    CHECK_EQ(triangles.size(), 3 * (polygon.size() - 2));
+  }
+
+  { // Degenerate: all corners at the same position.
+    const std::vector<Position> polygon(5, Position{1, 1, 1});
+    std::vector<std::uint32_t> triangles;
+    bee::triangulatePolygon(polygon, triangles);
+    CHECK_EQ(triangles.size(), 3 * (polygon.size() - 2));
+  }
+
+  { // Concave, in the YZ plane: the triangles keep the winding of the
+    // polygon there.
+    const std::vector<Position> polygon{
+        {0, 0, 0}, {0, 1, 0}, {0, 1, 1}, {0, 0.5, 0.5}, {0, 0, 1}};
+    std::vector<std::uint32_t> triangles;
+    bee::triangulatePolygon(polygon, triangles);
+    REQUIRE_EQ(triangles.size(), 3 * (polygon.size() - 2));
+    for (std::size_t iTriangle = 0; iTriangle < triangles.size();
+         iTriangle += 3) {
+      std::vector<Position> triangle;
+      for (std::size_t iCorner = 0; iCorner < 3; ++iCorner) {
+        const auto &p = polygon[triangles[iTriangle + iCorner]];
+        triangle.push_back({p[1], p[2], 0});
+      }
+      CHECK(signedArea(triangle) > 0.0);
+    }
+  }
+}
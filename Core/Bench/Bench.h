@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <bee/Converter.h>
+#include <bee/polyfills/filesystem.h>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bee::bench {
+/// <summary>
+/// Collects the results of the benchmarks into a JSON array, so that runs
+/// can be compared over time.
+/// </summary>
+class Report {
+public:
+  struct Options {
+    /// <summary>
+    /// Only the benchmarks whose name contains this are run.
+    /// </summary>
+    std::string filter;
+
+    std::uint32_t minIterations = 3;
+
+    std::uint32_t maxIterations = 1000;
+
+    /// <summary>
+    /// A benchmark is repeated, up to `maxIterations`, until it has run for
+    /// this long.
+    /// </summary>
+    double minSeconds = 0.5;
+  };
+
+  explicit Report(const Options &options_) : _options(options_) {
+  }
+
+  /// <summary>
+  /// Whether the benchmark of this name passes the filter.
+  /// </summary>
+  bool matches(std::string_view name_) const {
+    return name_.find(_options.filter) != std::string_view::npos;
+  }
+
+  /// <summary>
+  /// Times `fn_` repeatedly. `fn_` returns the count of items it processed,
+  /// like vertices, from which the throughput is computed.
+  /// </summary>
+  /// <returns>The result, to which more fields may be added, or null if the
+  /// benchmark has been filtered out.</returns>
+  template <typename Fn_>
+  bee::Json *run(std::string_view name_, bee::Json params_, Fn_ &&fn_) {
+    if (!matches(name_)) {
+      return nullptr;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    std::vector<double> samples;
+    std::uint64_t items = 0;
+    double totalSeconds = 0.0;
+    while (samples.size() < _options.minIterations ||
+           (totalSeconds < _options.minSeconds &&
+            samples.size() < _options.maxIterations)) {
+      const auto start = Clock::now();
+      items = fn_();
+      const std::chrono::duration<double> elapsed = Clock::now() - start;
+      samples.push_back(elapsed.count());
+      totalSeconds += elapsed.count();
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const auto median = samples[samples.size() / 2];
+    std::cerr << name_ << ": " << median * 1000.0 << "ms" << std::endl;
+
+    _results.push_back(bee::Json{
+        {"name", name_},
+        {"params", std::move(params_)},
+        {"iterations", samples.size()},
+        {"items", items},
+        {"minSeconds", samples.front()},
+        {"medianSeconds", median},
+        {"meanSeconds", totalSeconds / samples.size()},
+        {"itemsPerSecond", median > 0.0 ? items / median : 0.0},
+    });
+    return &_results.back();
+  }
+
+  const bee::Json &results() const {
+    return _results;
+  }
+
+private:
+  Options _options;
+  bee::Json _results = bee::Json::array();
+};
+
+void runUntypedVertexBenchmarks(Report &report_);
+
+void runGLTFBuilderBenchmarks(Report &report_);
+
+void runLayerElementAccessorBenchmarks(Report &report_);
+
+/// <summary>
+/// Converts the files of the generated corpus, see `Corpus.h`.
+/// </summary>
+void runCorpusBenchmarks(Report &report_,
+                         const bee::filesystem::path &corpus_dir_,
+                         bool quick_);
+} // namespace bee::bench
@@ -0,0 +1,491 @@
+#include "Corpus.h"
+#include "Bench.h"
+#include <bee/Convert/fbxsdk/ObjectDestroyer.h>
+#include <bee/Converter.h>
+#include <cmath>
+#include <stdexcept>
+#include <streambuf>
+
+namespace bee::bench {
+namespace {
+constexpr double frameRate = 30.0;
+
+/// <summary>
+/// A unit grid of `grid_size_` x `grid_size_` quads in the XZ plane, with
+/// normals by control point and `uv_sets_` UV sets by polygon vertex.
+/// </summary>
+fbxsdk::FbxMesh *createGrid(fbxsdk::FbxScene &fbx_scene_,
+                            const char *name_,
+                            int grid_size_,
+                            int uv_sets_) {
+  const auto fbxMesh = fbxsdk::FbxMesh::Create(&fbx_scene_, name_);
+  const auto nSide = grid_size_ + 1;
+  fbxMesh->InitControlPoints(nSide * nSide);
+  for (int y = 0; y < nSide; ++y) {
+    for (int x = 0; x < nSide; ++x) {
+      fbxMesh->SetControlPointAt(
+          fbxsdk::FbxVector4(static_cast<double>(x) / grid_size_ - 0.5, 0.0,
+                             static_cast<double>(y) / grid_size_ - 0.5),
+          y * nSide + x);
+    }
+  }
+
+  const auto normalElement = fbxMesh->CreateElementNormal();
+  normalElement->SetMappingMode(fbxsdk::FbxLayerElement::eByControlPoint);
+  normalElement->SetReferenceMode(fbxsdk::FbxLayerElement::eDirect);
+  for (int iControlPoint = 0; iControlPoint < nSide * nSide; ++iControlPoint) {
+    normalElement->GetDirectArray().Add(fbxsdk::FbxVector4(0.0, 1.0, 0.0));
+  }
+
+  std::vector<fbxsdk::FbxGeometryElementUV *> uvElements;
+  for (int iUVSet = 0; iUVSet < uv_sets_; ++iUVSet) {
+    const auto uvElement =
+        fbxMesh->CreateElementUV(("UV" + std::to_string(iUVSet)).c_str());
+    uvElement->SetMappingMode(fbxsdk::FbxLayerElement::eByPolygonVertex);
+    uvElement->SetReferenceMode(fbxsdk::FbxLayerElement::eIndexToDirect);
+    for (int iControlPoint = 0; iControlPoint < nSide * nSide;
+         ++iControlPoint) {
+      uvElement->GetDirectArray().Add(fbxsdk::FbxVector2(
+          static_cast<double>(iControlPoint % nSide) / grid_size_ +
+              0.125 * iUVSet,
+          static_cast<double>(iControlPoint / nSide) / grid_size_));
+    }
+    uvElements.push_back(uvElement);
+  }
+
+  for (int y = 0; y < grid_size_; ++y) {
+    for (int x = 0; x < grid_size_; ++x) {
+      fbxMesh->BeginPolygon();
+      for (const auto controlPoint :
+           {y * nSide + x, (y + 1) * nSide + x, (y + 1) * nSide + x + 1,
+            y * nSide + x + 1}) {
+        fbxMesh->AddPolygon(controlPoint);
+        for (const auto uvElement : uvElements) {
+          uvElement->GetIndexArray().Add(controlPoint);
+        }
+      }
+      fbxMesh->EndPolygon();
+    }
+  }
+  return fbxMesh;
+}
+
+fbxsdk::FbxNode *addNode(fbxsdk::FbxNode &parent_,
+                         const char *name_,
+                         fbxsdk::FbxNodeAttribute *attribute_) {
+  const auto fbxNode = fbxsdk::FbxNode::Create(parent_.GetScene(), name_);
+  if (attribute_) {
+    fbxNode->SetNodeAttribute(attribute_);
+  }
+  parent_.AddChild(fbxNode);
+  return fbxNode;
+}
+
+fbxsdk::FbxAnimLayer *createAnimation(fbxsdk::FbxScene &fbx_scene_,
+                                      double seconds_) {
+  const auto fbxAnimStack =
+      fbxsdk::FbxAnimStack::Create(&fbx_scene_, "Take 001");
+  const auto fbxAnimLayer =
+      fbxsdk::FbxAnimLayer::Create(&fbx_scene_, "Base Layer");
+  fbxAnimStack->AddMember(fbxAnimLayer);
+  fbxsdk::FbxTime stop;
+  stop.SetSecondDouble(seconds_);
+  const fbxsdk::FbxTimeSpan timeSpan{fbxsdk::FbxTime{0}, stop};
+  fbxAnimStack->SetLocalTimeSpan(timeSpan);
+  fbxAnimStack->SetReferenceTimeSpan(timeSpan);
+  return fbxAnimLayer;
+}
+
+/// <summary>
+/// Keys the curve at each frame, as motion capture is.
+/// </summary>
+template <typename Value_>
+void keyEachFrame(fbxsdk::FbxAnimCurve &fbx_curve_,
+                  double seconds_,
+                  Value_ &&value_) {
+  const auto nFrames = static_cast<int>(seconds_ * frameRate);
+  fbx_curve_.KeyModifyBegin();
+  for (int iFrame = 0; iFrame <= nFrames; ++iFrame) {
+    const auto seconds = iFrame / frameRate;
+    fbxsdk::FbxTime time;
+    time.SetSecondDouble(seconds);
+    const auto iKey = fbx_curve_.KeyAdd(time);
+    fbx_curve_.KeySet(iKey, time, static_cast<float>(value_(seconds)),
+                      fbxsdk::FbxAnimCurveDef::eInterpolationLinear);
+  }
+  fbx_curve_.KeyModifyEnd();
+}
+
+void buildHighPoly(fbxsdk::FbxScene &fbx_scene_, int grid_size_) {
+  addNode(*fbx_scene_.GetRootNode(), "HighPoly",
+          createGrid(fbx_scene_, "HighPoly", grid_size_, 1));
+}
+
+void buildUVSets(fbxsdk::FbxScene &fbx_scene_, int grid_size_, int uv_sets_) {
+  addNode(*fbx_scene_.GetRootNode(), "UVSets",
+          createGrid(fbx_scene_, "UVSets", grid_size_, uv_sets_));
+}
+
+void buildBlendShapes(fbxsdk::FbxScene &fbx_scene_,
+                      int grid_size_,
+                      int blend_shapes_) {
+  const auto fbxMesh = createGrid(fbx_scene_, "Face", grid_size_, 1);
+  addNode(*fbx_scene_.GetRootNode(), "Face", fbxMesh);
+
+  // Each shape moves a band of rows, as each facial shape moves a region.
+  const auto nSide = grid_size_ + 1;
+  const auto fbxBlendShape =
+      fbxsdk::FbxBlendShape::Create(&fbx_scene_, "FaceShapes");
+  for (int iShape = 0; iShape < blend_shapes_; ++iShape) {
+    const auto name = "Shape" + std::to_string(iShape);
+    const auto fbxChannel =
+        fbxsdk::FbxBlendShapeChannel::Create(&fbx_scene_, name.c_str());
+    const auto fbxShape = fbxsdk::FbxShape::Create(&fbx_scene_, name.c_str());
+    fbxShape->InitControlPoints(fbxMesh->GetControlPointsCount());
+    const auto firstRow = iShape * nSide / blend_shapes_;
+    const auto lastRow = (iShape + 1) * nSide / blend_shapes_;
+    for (int iControlPoint = 0;
+         iControlPoint < fbxMesh->GetControlPointsCount(); ++iControlPoint) {
+      auto position = fbxMesh->GetControlPointAt(iControlPoint);
+      const auto row = iControlPoint / nSide;
+      if (row >= firstRow && row <= lastRow) {
+        position[1] += 0.1;
+      }
+      fbxShape->SetControlPointAt(position, iControlPoint);
+    }
+    fbxChannel->AddTargetShape(fbxShape);
+    fbxBlendShape->AddBlendShapeChannel(fbxChannel);
+  }
+  fbxMesh->AddDeformer(fbxBlendShape);
+
+  const auto fbxAnimLayer = createAnimation(fbx_scene_, 2.0);
+  for (int iShape = 0; iShape < blend_shapes_; ++iShape) {
+    const auto fbxCurve =
+        fbxMesh->GetShapeChannel(0, iShape, fbxAnimLayer, true);
+    keyEachFrame(*fbxCurve, 2.0, [iShape](double time_) {
+      return 50.0 + 50.0 * std::sin(time_ * 3.0 + iShape);
+    });
+  }
+}
+
+void buildMocap(fbxsdk::FbxScene &fbx_scene_,
+                int bones_,
+                int grid_size_,
+                double seconds_) {
+  // Five chains from the root, as limbs, spine and head are.
+  constexpr int nChains = 5;
+  std::vector<fbxsdk::FbxNode *> fbxBones;
+  for (int iBone = 0; iBone < bones_; ++iBone) {
+    const auto name = "Bone" + std::to_string(iBone);
+    const auto fbxSkeleton =
+        fbxsdk::FbxSkeleton::Create(&fbx_scene_, name.c_str());
+    fbxSkeleton->SetSkeletonType(iBone == 0 ? fbxsdk::FbxSkeleton::eRoot
+                                            : fbxsdk::FbxSkeleton::eLimbNode);
+    auto &parent = iBone == 0 ? *fbx_scene_.GetRootNode()
+                              : *fbxBones[std::max(0, iBone - nChains)];
+    const auto fbxBone = addNode(parent, name.c_str(), fbxSkeleton);
+    if (iBone != 0) {
+      fbxBone->LclTranslation.Set(fbxsdk::FbxDouble3(
+          iBone <= nChains ? 0.1 * (iBone - 3) : 0.0, 0.02, 0.0));
+    }
+    fbxBones.push_back(fbxBone);
+  }
+
+  const auto fbxMesh = createGrid(fbx_scene_, "Body", grid_size_, 1);
+  const auto fbxMeshNode =
+      addNode(*fbx_scene_.GetRootNode(), "Body", fbxMesh);
+
+  // Four influences per control point.
+  const auto fbxSkin = fbxsdk::FbxSkin::Create(&fbx_scene_, "BodySkin");
+  std::vector<fbxsdk::FbxCluster *> fbxClusters;
+  const auto meshTransform = fbxMeshNode->EvaluateGlobalTransform();
+  for (const auto fbxBone : fbxBones) {
+    const auto fbxCluster =
+        fbxsdk::FbxCluster::Create(&fbx_scene_, fbxBone->GetName());
+    fbxCluster->SetLink(fbxBone);
+    fbxCluster->SetLinkMode(fbxsdk::FbxCluster::eNormalize);
+    fbxCluster->SetTransformMatrix(meshTransform);
+    fbxCluster->SetTransformLinkMatrix(fbxBone->EvaluateGlobalTransform());
+    fbxClusters.push_back(fbxCluster);
+  }
+  constexpr double weights[] = {0.4, 0.3, 0.2, 0.1};
+  for (int iControlPoint = 0; iControlPoint < fbxMesh->GetControlPointsCount();
+       ++iControlPoint) {
+    for (int iInfluence = 0; iInfluence < 4; ++iInfluence) {
+      const auto iBone = (iControlPoint * 7 + iInfluence * 97) % bones_;
+      fbxClusters[iBone]->AddControlPointIndex(iControlPoint,
+                                               weights[iInfluence]);
+    }
+  }
+  for (const auto fbxCluster : fbxClusters) {
+    fbxSkin->AddCluster(fbxCluster);
+  }
+  fbxMesh->AddDeformer(fbxSkin);
+
+  const auto fbxBindPose = fbxsdk::FbxPose::Create(&fbx_scene_, "BindPose");
+  fbxBindPose->SetIsBindPose(true);
+  fbxBindPose->Add(fbxMeshNode, fbxsdk::FbxMatrix{meshTransform});
+  for (const auto fbxBone : fbxBones) {
+    fbxBindPose->Add(fbxBone,
+                     fbxsdk::FbxMatrix{fbxBone->EvaluateGlobalTransform()});
+  }
+  fbx_scene_.AddPose(fbxBindPose);
+
+  const auto fbxAnimLayer = createAnimation(fbx_scene_, seconds_);
+  for (int iBone = 0; iBone < bones_; ++iBone) {
+    auto &rotation = fbxBones[iBone]->LclRotation;
+    const char *components[] = {FBXSDK_CURVENODE_COMPONENT_X,
+                                FBXSDK_CURVENODE_COMPONENT_Y,
+                                FBXSDK_CURVENODE_COMPONENT_Z};
+    for (int iComponent = 0; iComponent < 3; ++iComponent) {
+      const auto fbxCurve =
+          rotation.GetCurve(fbxAnimLayer, components[iComponent], true);
+      keyEachFrame(*fbxCurve, seconds_, [=](double time_) {
+        return 10.0 * std::sin(time_ * (1.0 + iComponent) + iBone);
+      });
+    }
+  }
+  auto &rootTranslation = fbxBones[0]->LclTranslation;
+  keyEachFrame(*rootTranslation.GetCurve(fbxAnimLayer,
+                                         FBXSDK_CURVENODE_COMPONENT_X, true),
+               seconds_, [](double time_) { return time_; });
+}
+
+void buildInstancing(fbxsdk::FbxScene &fbx_scene_, int instances_) {
+  const auto fbxMesh = createGrid(fbx_scene_, "Rock", 16, 1);
+  const auto fbxParent =
+      addNode(*fbx_scene_.GetRootNode(), "Rocks", nullptr);
+  const auto nSide = static_cast<int>(std::ceil(std::sqrt(instances_)));
+  for (int iInstance = 0; iInstance < instances_; ++iInstance) {
+    const auto fbxNode = addNode(
+        *fbxParent, ("Rock" + std::to_string(iInstance)).c_str(), fbxMesh);
+    fbxNode->LclTranslation.Set(fbxsdk::FbxDouble3(
+        2.0 * (iInstance % nSide), 0.0, 2.0 * (iInstance / nSide)));
+    fbxNode->LclRotation.Set(fbxsdk::FbxDouble3(0.0, iInstance * 37.0, 0.0));
+    fbxNode->LclScaling.Set(
+        fbxsdk::FbxDouble3(1.0 + 0.1 * (iInstance % 5), 1.0, 1.0));
+  }
+}
+
+/// <summary>
+/// Only counts what's written into it.
+/// </summary>
+class CountingStreamBuffer : public std::streambuf {
+public:
+  std::uint64_t count = 0;
+
+protected:
+  int_type overflow(int_type ch_) override {
+    ++count;
+    return traits_type::not_eof(ch_);
+  }
+
+  std::streamsize xsputn(const char_type *, std::streamsize count_) override {
+    count += count_;
+    return count_;
+  }
+};
+
+/// <summary>
+/// Drops the output, keeping only its size.
+/// </summary>
+class CountingWriter : public bee::GLTFWriter {
+public:
+  std::uint64_t bufferBytes = 0;
+  std::uint64_t jsonBytes = 0;
+
+  std::optional<std::u8string> buffer(const std::byte *data_,
+                                      std::size_t size_,
+                                      std::uint32_t index_,
+                                      bool multi_) override {
+    bufferBytes += size_;
+    return u8"buffer.bin";
+  }
+
+  bool supportsStreaming() const override {
+    return true;
+  }
+
+  void appendBuffer(std::uint32_t index_,
+                    const std::byte *data_,
+                    std::size_t size_) override {
+    bufferBytes += size_;
+  }
+
+  std::optional<std::u8string> closeBuffer(std::uint32_t index_) override {
+    return u8"buffer.bin";
+  }
+
+  void glb(std::span<const std::span<const std::byte>> pieces_) override {
+    for (const auto piece : pieces_) {
+      bufferBytes += piece.size();
+    }
+  }
+
+  bool json(const std::function<void(std::ostream &)> &write_) override {
+    CountingStreamBuffer streamBuffer;
+    std::ostream stream{&streamBuffer};
+    write_(stream);
+    jsonBytes += streamBuffer.count;
+    return true;
+  }
+};
+
+/// <summary>
+/// Keeps the stats record of the last conversion, passes warnings and errors
+/// to the console.
+/// </summary>
+class StatsLogger : public bee::Logger {
+public:
+  bee::Json stats;
+
+  void operator()(Level level_, bee::Json &&message_) override {
+    if (message_.is_object() && message_.contains("stats")) {
+      stats = std::move(message_["stats"]);
+    } else if (level_ >= Level::warning) {
+      std::cerr << message_.dump() << std::endl;
+    }
+  }
+
+  void operator()(Level level_, std::u8string_view message_) override {
+    if (level_ >= Level::warning) {
+      std::cerr << std::string_view{reinterpret_cast<const char *>(
+                                        message_.data()),
+                                    message_.size()}
+                << std::endl;
+    }
+  }
+};
+} // namespace
+
+FbxManagerPtr createFbxManager() {
+  FbxManagerPtr fbxManager{fbxsdk::FbxManager::Create()};
+  if (!fbxManager) {
+    throw std::runtime_error("Failed to initialize FBX SDK.");
+  }
+  fbxManager->SetIOSettings(
+      fbxsdk::FbxIOSettings::Create(fbxManager.get(), IOSROOT));
+  return fbxManager;
+}
+
+std::vector<CorpusFile> getCorpus(bool quick_) {
+  const auto scale = [quick_](int size_, int quick_size_) {
+    return quick_ ? quick_size_ : size_;
+  };
+  std::vector<CorpusFile> corpus;
+
+  const auto highPolyGrid = scale(1024, 256);
+  corpus.push_back({"high-poly-" + std::to_string(highPolyGrid),
+                    bee::Json{{"gridSize", highPolyGrid}},
+                    [=](fbxsdk::FbxScene &fbx_scene_) {
+                      buildHighPoly(fbx_scene_, highPolyGrid);
+                    }});
+
+  const auto uvSetsGrid = scale(256, 64);
+  constexpr int nUVSets = 8;
+  corpus.push_back(
+      {"uv-sets-" + std::to_string(nUVSets) + "-" + std::to_string(uvSetsGrid),
+       bee::Json{{"gridSize", uvSetsGrid}, {"uvSets", nUVSets}},
+       [=](fbxsdk::FbxScene &fbx_scene_) {
+         buildUVSets(fbx_scene_, uvSetsGrid, nUVSets);
+       }});
+
+  const auto blendShapesGrid = scale(128, 32);
+  constexpr int nBlendShapes = 150;
+  corpus.push_back({"blend-shapes-" + std::to_string(nBlendShapes) + "-" +
+                        std::to_string(blendShapesGrid),
+                    bee::Json{{"gridSize", blendShapesGrid},
+                              {"blendShapes", nBlendShapes}},
+                    [=](fbxsdk::FbxScene &fbx_scene_) {
+                      buildBlendShapes(fbx_scene_, blendShapesGrid,
+                                       nBlendShapes);
+                    }});
+
+  const auto mocapGrid = scale(128, 32);
+  const auto mocapSeconds = scale(10, 2);
+  constexpr int nBones = 500;
+  corpus.push_back({"mocap-" + std::to_string(nBones) + "-" +
+                        std::to_string(mocapSeconds) + "s",
+                    bee::Json{{"gridSize", mocapGrid},
+                              {"bones", nBones},
+                              {"seconds", mocapSeconds},
+                              {"frameRate", frameRate}},
+                    [=](fbxsdk::FbxScene &fbx_scene_) {
+                      buildMocap(fbx_scene_, nBones, mocapGrid, mocapSeconds);
+                    }});
+
+  const auto nInstances = scale(10000, 1000);
+  corpus.push_back({"instancing-" + std::to_string(nInstances),
+                    bee::Json{{"instances", nInstances}},
+                    [=](fbxsdk::FbxScene &fbx_scene_) {
+                      buildInstancing(fbx_scene_, nInstances);
+                    }});
+
+  return corpus;
+}
+
+bee::filesystem::path generateCorpusFile(fbxsdk::FbxManager &fbx_manager_,
+                                         const CorpusFile &file_,
+                                         const bee::filesystem::path &dir_) {
+  const auto path = dir_ / (file_.name + ".fbx");
+  if (bee::filesystem::exists(path)) {
+    return path;
+  }
+  bee::filesystem::create_directories(dir_);
+
+  const auto fbxScene = fbxsdk::FbxScene::Create(&fbx_manager_, "");
+  FbxObjectDestroyer fbxSceneDestroyer{fbxScene};
+  auto &globalSettings = fbxScene->GetGlobalSettings();
+  globalSettings.SetTimeMode(fbxsdk::FbxTime::eFrames30);
+  globalSettings.SetSystemUnit(fbxsdk::FbxSystemUnit::m);
+  file_.build(*fbxScene);
+
+  const auto fbxExporter = fbxsdk::FbxExporter::Create(&fbx_manager_, "");
+  FbxObjectDestroyer fbxExporterDestroyer{fbxExporter};
+  const auto pathString = path.string();
+  if (!fbxExporter->Initialize(
+          pathString.c_str(),
+          fbx_manager_.GetIOPluginRegistry()->GetNativeWriterFormat(),
+          fbx_manager_.GetIOSettings()) ||
+      !fbxExporter->Export(fbxScene)) {
+    throw std::runtime_error("Failed to write " + pathString + ": " +
+                             fbxExporter->GetStatus().GetErrorString());
+  }
+  return path;
+}
+
+void runCorpusBenchmarks(Report &report_,
+                         const bee::filesystem::path &corpus_dir_,
+                         bool quick_) {
+  const auto fbxManager = createFbxManager();
+  bee::ConvertSession convertSession;
+  for (const auto &file : getCorpus(quick_)) {
+    const auto name = "convert/" + file.name;
+    if (!report_.matches(name)) {
+      continue;
+    }
+    const auto path = generateCorpusFile(*fbxManager, file, corpus_dir_);
+    const auto u8Path = path.u8string();
+
+    CountingWriter writer;
+    StatsLogger logger;
+    bee::ConvertOptions options;
+    options.out = (corpus_dir_ / (file.name + ".gltf")).u8string();
+    options.writer = &writer;
+    options.useDataUriForBuffers = false;
+    options.logger = &logger;
+    options.stats = true;
+
+    // The items are the converted files.
+    const auto result = report_.run(name, file.params, [&]() {
+      writer.bufferBytes = 0;
+      writer.jsonBytes = 0;
+      convertSession.convert(u8Path, options);
+      return std::uint64_t{1};
+    });
+    (*result)["bufferBytes"] = writer.bufferBytes;
+    (*result)["jsonBytes"] = writer.jsonBytes;
+    (*result)["stats"] = std::move(logger.stats);
+  }
+}
+} // namespace bee::bench
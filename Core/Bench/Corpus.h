@@ -0,0 +1,55 @@
+#pragma once
+
+#include <bee/polyfills/filesystem.h>
+#include <bee/polyfills/json.h>
+#include <fbxsdk.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bee::bench {
+struct FbxManagerDeleter {
+  void operator()(fbxsdk::FbxManager *fbx_manager_) const {
+    fbx_manager_->Destroy();
+  }
+};
+
+using FbxManagerPtr = std::unique_ptr<fbxsdk::FbxManager, FbxManagerDeleter>;
+
+/// <summary>
+/// Creates a manager with IO settings.
+/// </summary>
+FbxManagerPtr createFbxManager();
+
+/// <summary>
+/// A file of the corpus: a scene built through the FBX SDK to stress one part
+/// of the converter.
+/// </summary>
+struct CorpusFile {
+  /// <summary>
+  /// The file name, which includes the parameters, so that a file generated by
+  /// an earlier run can be reused.
+  /// </summary>
+  std::string name;
+
+  bee::Json params;
+
+  std::function<void(fbxsdk::FbxScene &)> build;
+};
+
+/// <summary>
+/// High-poly meshes, many UV sets, 150 blend shapes, a 500-bone motion capture
+/// and heavy instancing. With `quick_`, meshes and instance counts are
+/// smaller; the blend shape and bone counts are kept.
+/// </summary>
+std::vector<CorpusFile> getCorpus(bool quick_);
+
+/// <summary>
+/// Writes the file into `dir_`, unless it is there already.
+/// </summary>
+/// <returns>The path of the file.</returns>
+bee::filesystem::path generateCorpusFile(fbxsdk::FbxManager &fbx_manager_,
+                                         const CorpusFile &file_,
+                                         const bee::filesystem::path &dir_);
+} // namespace bee::bench
@@ -0,0 +1,55 @@
+#include "Bench.h"
+#include <bee/Convert/DirectSpreader.h>
+#include <bee/Convert/fbxsdk/Spreader.h>
+#include <bee/GLTFBuilder.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace bee::bench {
+void runGLTFBuilderBenchmarks(Report &report_) {
+  constexpr std::uint32_t nValues = 1 << 20;
+  // Many small accessors, as animation channels are.
+  constexpr std::uint32_t nChannelValues = 300;
+  const bee::Json params{{"values", nValues}};
+
+  std::vector<fbxsdk::FbxVector4> vectors(nValues);
+  std::vector<float> scalars(nValues);
+  for (std::uint32_t iValue = 0; iValue < nValues; ++iValue) {
+    const auto t = static_cast<double>(iValue);
+    vectors[iValue] = {std::sin(t), std::cos(t), t};
+    scalars[iValue] = static_cast<float>(t) / 30.0f;
+  }
+
+  report_.run("GLTFBuilder/createAccessor/vec3", params, [&]() {
+    bee::GLTFBuilder glTFBuilder;
+    glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec3,
+                               fx::gltf::Accessor::ComponentType::Float,
+                               bee::FbxVec3Spreader>(vectors, 0, 0);
+    return std::uint64_t{nValues};
+  });
+
+  report_.run("GLTFBuilder/createAccessor/vec3/minMax", params, [&]() {
+    bee::GLTFBuilder glTFBuilder;
+    glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec3,
+                               fx::gltf::Accessor::ComponentType::Float,
+                               bee::FbxVec3Spreader>(vectors, 0, 0, true);
+    return std::uint64_t{nValues};
+  });
+
+  const auto createChannels = [&]() {
+    bee::GLTFBuilder glTFBuilder;
+    for (std::uint32_t iValue = 0; iValue + nChannelValues <= nValues;
+         iValue += nChannelValues) {
+      glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Scalar,
+                                 fx::gltf::Accessor::ComponentType::Float,
+                                 bee::DirectSpreader<float>>(
+          std::span{scalars}.subspan(iValue, nChannelValues), 0, 0, true);
+    }
+    return std::uint64_t{nValues};
+  };
+  report_.run("GLTFBuilder/createAccessor/scalar/channels",
+              bee::Json{{"values", nValues}, {"channelValues", nChannelValues}},
+              createChannels);
+}
+} // namespace bee::bench
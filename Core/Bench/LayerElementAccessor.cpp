@@ -0,0 +1,105 @@
+#include "Bench.h"
+#include "Corpus.h"
+#include <bee/Convert/fbxsdk/LayerelementAccessor.h>
+#include <cstdint>
+#include <fbxsdk.h>
+
+namespace bee::bench {
+namespace {
+/// <summary>
+/// Reads the element for each polygon vertex of the mesh, the way vertices
+/// are staged.
+/// </summary>
+template <typename Value_>
+double readAll(const fbxsdk::FbxMesh &fbx_mesh_,
+               const FbxLayerElementAccessor<Value_> &accessor_) {
+  const auto polygonVertices = fbx_mesh_.GetPolygonVertices();
+  double sum = 0.0;
+  FbxLayerElementAccessParams params;
+  for (int iPolygon = 0; iPolygon < fbx_mesh_.GetPolygonCount();
+       ++iPolygon) {
+    params.polygonIndex = iPolygon;
+    const auto iFirstPolygonVertex = fbx_mesh_.GetPolygonVertexIndex(iPolygon);
+    for (int iCorner = 0; iCorner < fbx_mesh_.GetPolygonSize(iPolygon);
+         ++iCorner) {
+      params.polygonVertexIndex = iFirstPolygonVertex + iCorner;
+      params.controlPointIndex = polygonVertices[params.polygonVertexIndex];
+      sum += accessor_(params)[0];
+    }
+  }
+  return sum;
+}
+} // namespace
+
+void runLayerElementAccessorBenchmarks(Report &report_) {
+  constexpr int gridSize = 512;
+  const bee::Json params{{"gridSize", gridSize}};
+
+  const auto fbxManager = createFbxManager();
+  const auto fbxMesh = fbxsdk::FbxMesh::Create(fbxManager.get(), "Grid");
+
+  constexpr int nSide = gridSize + 1;
+  fbxMesh->InitControlPoints(nSide * nSide);
+  for (int y = 0; y < nSide; ++y) {
+    for (int x = 0; x < nSide; ++x) {
+      fbxMesh->SetControlPointAt(fbxsdk::FbxVector4(x, 0.0, y), y * nSide + x);
+    }
+  }
+
+  const auto normalElement = fbxMesh->CreateElementNormal();
+  normalElement->SetMappingMode(fbxsdk::FbxLayerElement::eByControlPoint);
+  normalElement->SetReferenceMode(fbxsdk::FbxLayerElement::eDirect);
+  const auto uvElement = fbxMesh->CreateElementUV("UV");
+  uvElement->SetMappingMode(fbxsdk::FbxLayerElement::eByPolygonVertex);
+  uvElement->SetReferenceMode(fbxsdk::FbxLayerElement::eIndexToDirect);
+  for (int iControlPoint = 0; iControlPoint < nSide * nSide; ++iControlPoint) {
+    normalElement->GetDirectArray().Add(fbxsdk::FbxVector4(0.0, 1.0, 0.0));
+    uvElement->GetDirectArray().Add(
+        fbxsdk::FbxVector2(static_cast<double>(iControlPoint % nSide) / nSide,
+                           static_cast<double>(iControlPoint / nSide) / nSide));
+  }
+  for (int y = 0; y < gridSize; ++y) {
+    for (int x = 0; x < gridSize; ++x) {
+      fbxMesh->BeginPolygon();
+      for (const auto controlPoint :
+           {y * nSide + x, y * nSide + x + 1, (y + 1) * nSide + x + 1,
+            (y + 1) * nSide + x}) {
+        fbxMesh->AddPolygon(controlPoint);
+        uvElement->GetIndexArray().Add(controlPoint);
+      }
+      fbxMesh->EndPolygon();
+    }
+  }
+  const auto nPolygonVertices =
+      static_cast<std::uint64_t>(fbxMesh->GetPolygonVertexCount());
+
+  double sink = 0.0;
+  report_.run("FbxLayerElementAccessor/byControlPoint/direct", params, [&]() {
+    const auto accessor = makeFbxLayerElementAccessor(*normalElement);
+    sink += readAll(*fbxMesh, accessor);
+    return nPolygonVertices;
+  });
+
+  report_.run("FbxLayerElementAccessor/byPolygonVertex/indexToDirect", params,
+              [&]() {
+                const auto accessor = makeFbxLayerElementAccessor(*uvElement);
+                sink += readAll(*fbxMesh, accessor);
+                return nPolygonVertices;
+              });
+
+  // What the accessor replaces: the FBX SDK's own lookup per element.
+  report_.run("FbxLayerElement/byPolygonVertex/indexToDirect", params, [&]() {
+    const auto &directArray = uvElement->GetDirectArray();
+    const auto &indexArray = uvElement->GetIndexArray();
+    for (int iPolygonVertex = 0; iPolygonVertex < indexArray.GetCount();
+         ++iPolygonVertex) {
+      sink += directArray.GetAt(indexArray.GetAt(iPolygonVertex))[0];
+    }
+    return nPolygonVertices;
+  });
+
+  if (sink == -1.0) {
+    std::cerr << "Unreachable" << std::endl;
+  }
+}
+} // namespace bee::bench
@@ -0,0 +1,73 @@
+#include "Bench.h"
+#include <bee/ConvertStats.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+namespace {
+void printUsage() {
+  std::cerr << "Usage: BeeCoreBench [--filter <name part>] [--out <file>] "
+               "[--corpus <dir>] [--quick]"
+            << std::endl;
+}
+} // namespace
+
+/// <summary>
+/// Runs the microbenchmarks, then converts the generated corpus, and prints
+/// the results as JSON, into `--out` or to the standard output.
+/// </summary>
+int main(int argc_, const char *argv_[]) {
+  bee::bench::Report::Options reportOptions;
+  std::optional<bee::filesystem::path> outFile;
+  auto corpusDir =
+      bee::filesystem::temp_directory_path() / "FBX-glTF-conv-bench-corpus";
+  bool quick = false;
+  for (int iArg = 1; iArg < argc_; ++iArg) {
+    const std::string_view arg = argv_[iArg];
+    const auto hasValue = iArg + 1 < argc_;
+    if (arg == "--filter" && hasValue) {
+      reportOptions.filter = argv_[++iArg];
+    } else if (arg == "--out" && hasValue) {
+      outFile = argv_[++iArg];
+    } else if (arg == "--corpus" && hasValue) {
+      corpusDir = argv_[++iArg];
+    } else if (arg == "--quick") {
+      quick = true;
+    } else {
+      printUsage();
+      return EXIT_FAILURE;
+    }
+  }
+  if (quick) {
+    reportOptions.minIterations = 1;
+    reportOptions.minSeconds = 0.0;
+  }
+
+  bee::bench::Report report{reportOptions};
+  try {
+    bee::bench::runUntypedVertexBenchmarks(report);
+    bee::bench::runGLTFBuilderBenchmarks(report);
+    bee::bench::runLayerElementAccessorBenchmarks(report);
+    bee::bench::runCorpusBenchmarks(report, corpusDir, quick);
+  } catch (const std::exception &exception_) {
+    std::cerr << exception_.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bee::Json output{{"benchmarks", report.results()}};
+  if (const auto peakResidentSetSize = bee::getPeakResidentSetSize()) {
+    output["peakResidentSetSize"] = *peakResidentSetSize;
+  }
+  if (outFile) {
+    std::ofstream stream{*outFile};
+    stream << output.dump(2) << std::endl;
+    if (!stream) {
+      std::cerr << "Failed to write " << outFile->string() << std::endl;
+      return EXIT_FAILURE;
+    }
+  } else {
+    std::cout << output.dump(2) << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+#include "Bench.h"
+#include <bee/UntypedVertex.h>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace bee::bench {
+namespace {
+/// <summary>
+/// Polygon vertices of a `gridSize` x `gridSize` triangulated grid, as
+/// position, normal and UV. UVs are split every `seamInterval` cells so that
+/// there're seams, as in real meshes.
+/// </summary>
+struct GridCorners {
+  constexpr static std::uint32_t vertexSize = sizeof(float) * 8;
+
+  std::uint32_t count = 0;
+  std::vector<float> data;
+
+  GridCorners(std::uint32_t grid_size_, std::uint32_t seam_interval_) {
+    const auto addCorner = [&](std::uint32_t x_, std::uint32_t y_,
+                               std::uint32_t cell_x_) {
+      const auto u = static_cast<float>(x_) / grid_size_ +
+                     ((cell_x_ / seam_interval_) % 2 ? 0.5f : 0.0f);
+      const float corner[8] = {static_cast<float>(x_),
+                               0.0f,
+                               static_cast<float>(y_),
+                               0.0f,
+                               1.0f,
+                               0.0f,
+                               u,
+                               static_cast<float>(y_) / grid_size_};
+      data.insert(data.end(), std::begin(corner), std::end(corner));
+      ++count;
+    };
+    for (std::uint32_t y = 0; y < grid_size_; ++y) {
+      for (std::uint32_t x = 0; x < grid_size_; ++x) {
+        addCorner(x, y, x);
+        addCorner(x + 1, y, x);
+        addCorner(x + 1, y + 1, x);
+        addCorner(x, y, x);
+        addCorner(x + 1, y + 1, x);
+        addCorner(x, y + 1, x);
+      }
+    }
+  }
+
+  const std::byte *at(std::uint32_t index_) const {
+    return reinterpret_cast<const std::byte *>(data.data()) +
+           vertexSize * index_;
+  }
+};
+} // namespace
+
+void runUntypedVertexBenchmarks(Report &report_) {
+  constexpr std::uint32_t gridSize = 1000;
+  const GridCorners corners{gridSize, 8};
+  const auto vertexSize = GridCorners::vertexSize;
+  const bee::Json params{{"gridSize", gridSize}, {"vertexSize", vertexSize}};
+
+  report_.run("UntypedVertexVector/allocate", params, [&]() {
+    bee::UntypedVertexVector vertices{vertexSize};
+    for (std::uint32_t iCorner = 0; iCorner < corners.count; ++iCorner) {
+      auto [vertexData, vertexIndex] = vertices.allocate();
+      std::memcpy(vertexData, corners.at(iCorner), vertexSize);
+    }
+    return std::uint64_t{vertices.size()};
+  });
+
+  report_.run("UntypedVertexVector/reserveAndAllocate", params, [&]() {
+    bee::UntypedVertexVector vertices{vertexSize};
+    vertices.reserve(corners.count);
+    for (std::uint32_t iCorner = 0; iCorner < corners.count; ++iCorner) {
+      auto [vertexData, vertexIndex] = vertices.allocate();
+      std::memcpy(vertexData, corners.at(iCorner), vertexSize);
+    }
+    return std::uint64_t{vertices.size()};
+  });
+
+  // The weld benchmarks process the corners; their items are the corners.
+  report_.run("UntypedVertexWeld/std::unordered_map", params, [&]() {
+    bee::UntypedVertexVector vertices{vertexSize};
+    // The map holds vertex pointers, which must not be moved.
+    vertices.reserve(corners.count + 1);
+    std::unordered_map<bee::UntypedVertex, std::uint32_t,
+                       bee::UntypedVertexHasher, bee::UntypedVertexEqual>
+        uniqueVertices({}, 0, bee::UntypedVertexHasher{},
+                       bee::UntypedVertexEqual{vertexSize});
+    auto stagingVertex = vertices.allocate();
+    for (std::uint32_t iCorner = 0; iCorner < corners.count; ++iCorner) {
+      auto [stagingVertexData, stagingVertexIndex] = stagingVertex;
+      std::memcpy(stagingVertexData, corners.at(iCorner), vertexSize);
+      if (uniqueVertices.try_emplace(stagingVertexData, stagingVertexIndex)
+              .second) {
+        stagingVertex = vertices.allocate();
+      }
+    }
+    vertices.pop_back();
+    return std::uint64_t{corners.count};
+  });
+
+  report_.run("UntypedVertexWeld/bee::UntypedVertexDedup", params, [&]() {
+    bee::UntypedVertexVector vertices{vertexSize};
+    vertices.reserve(corners.count + 1);
+    bee::UntypedVertexDedup uniqueVertices{vertices, vertexSize,
+                                           corners.count};
+    auto stagingVertex = vertices.allocate();
+    for (std::uint32_t iCorner = 0; iCorner < corners.count; ++iCorner) {
+      auto [stagingVertexData, stagingVertexIndex] = stagingVertex;
+      std::memcpy(stagingVertexData, corners.at(iCorner), vertexSize);
+      if (std::get<1>(uniqueVertices.tryEmplace(stagingVertexIndex))) {
+        stagingVertex = vertices.allocate();
+      }
+    }
+    vertices.pop_back();
+    return std::uint64_t{corners.count};
+  });
+}
+} // namespace bee::bench
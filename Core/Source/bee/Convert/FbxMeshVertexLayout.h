@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <utility>
 #include <unordered_map>
 #include <vector>
 
@@ -17,7 +18,7 @@ template <typename Element_> struct FbxMeshAttributeLayout {
   FbxMeshAttributeLayout() = default;
 
   FbxMeshAttributeLayout(std::uint32_t offset_, Element_ element_)
-      : offset(offset_), element(element_) {
+      : offset(offset_), element(std::move(element_)) {
   }
 };
 
@@ -50,8 +51,18 @@ struct FbxMeshVertexLayout {
 
   std::optional<Skinning> skinning;
 
+  /// <summary>
+  /// Layout offset of the control point index, a `std::uint32_t`. Set if the
+  /// position deltas of some shapes are not staged.
+  /// </summary>
+  std::optional<std::uint32_t> controlPointIndex;
+
   struct ShapeLayout {
-    FbxMeshAttributeLayout<fbxsdk::FbxVector4 *> constrolPoints;
+    /// <summary>
+    /// Absent if the position deltas are not staged; they're then looked up
+    /// by the control point index.
+    /// </summary>
+    std::optional<FbxMeshAttributeLayout<fbxsdk::FbxVector4 *>> constrolPoints;
 
     std::optional<FbxMeshAttributeLayout<FbxLayerElementAccessor<
         fbxsdk::FbxLayerElementNormal::ArrayElementType>>>
@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <fx/gltf.h>
 
 namespace bee {
@@ -27,7 +29,16 @@ struct GLTFSamplerKeys {
 
 struct GLTFSamplerHash {
   std::size_t operator()(const GLTFSamplerKeys &sampler_) const {
-    return 0;
+    std::size_t seed = 0;
+    const auto combine = [&seed](auto value_) {
+      seed ^= std::hash<decltype(value_)>{}(value_) + 0x9e3779b9 +
+              (seed << 6) + (seed >> 2);
+    };
+    combine(sampler_.magFilter);
+    combine(sampler_.minFilter);
+    combine(sampler_.wrapS);
+    combine(sampler_.wrapT);
+    return seed;
   }
 };
 } // namespace bee
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include <bee/Convert/ImageIO.h>
+#include <bee/Parallel.h>
+#include <bee/UntypedVertex.h>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bee {
+namespace fs = bee::filesystem;
+
+std::optional<MappedFile> MappedFile::open(const fs::path &path_) {
+  MappedFile file;
+
+#ifdef _WIN32
+  const auto handle = CreateFileW(path_.wstring().c_str(), GENERIC_READ,
+                                  FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (handle != INVALID_HANDLE_VALUE) {
+    LARGE_INTEGER size;
+    const auto sized = GetFileSizeEx(handle, &size);
+    // Empty files can't be mapped.
+    if (sized && size.QuadPart == 0) {
+      CloseHandle(handle);
+      return file;
+    }
+    if (const auto mapping =
+            sized ? CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0,
+                                       nullptr)
+                  : nullptr) {
+      // The view keeps the mapping alive.
+      if (const auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) {
+        file._data = static_cast<const std::byte *>(view);
+        file._size = static_cast<std::size_t>(size.QuadPart);
+        file._mapped = true;
+      }
+      CloseHandle(mapping);
+    }
+    CloseHandle(handle);
+  }
+#else
+  const auto fd = ::open(path_.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    struct stat status;
+    const auto sized = ::fstat(fd, &status) == 0;
+    // Empty files can't be mapped.
+    if (sized && status.st_size == 0) {
+      ::close(fd);
+      return file;
+    }
+    if (sized) {
+      const auto size = static_cast<std::size_t>(status.st_size);
+      const auto view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (view != MAP_FAILED) {
+        file._data = static_cast<const std::byte *>(view);
+        file._size = size;
+        file._mapped = true;
+      }
+    }
+    ::close(fd);
+  }
+#endif
+
+  if (file._mapped) {
+    return file;
+  }
+
+  std::ifstream stream(path_, std::ios::binary);
+  if (!stream) {
+    return {};
+  }
+  stream.seekg(0, stream.end);
+  const auto size = static_cast<std::size_t>(stream.tellg());
+  stream.seekg(0, stream.beg);
+  file._buffer = std::make_unique<std::byte[]>(size);
+  stream.read(reinterpret_cast<char *>(file._buffer.get()),
+              static_cast<std::streamsize>(size));
+  if (!stream) {
+    return {};
+  }
+  file._data = file._buffer.get();
+  file._size = size;
+  return file;
+}
+
+MappedFile::MappedFile(MappedFile &&other_) noexcept {
+  *this = std::move(other_);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other_) noexcept {
+  if (this != &other_) {
+    _release();
+    _data = std::exchange(other_._data, nullptr);
+    _size = std::exchange(other_._size, 0);
+    _mapped = std::exchange(other_._mapped, false);
+    _buffer = std::move(other_._buffer);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  _release();
+}
+
+void MappedFile::_release() {
+  if (_mapped) {
+#ifdef _WIN32
+    UnmapViewOfFile(_data);
+#else
+    ::munmap(const_cast<std::byte *>(_data), _size);
+#endif
+  }
+  _data = nullptr;
+  _size = 0;
+  _mapped = false;
+  _buffer.reset();
+}
+
+bool copyFileIfChanged(const fs::path &from_, const fs::path &to_) {
+  std::error_code err;
+  const auto fromSize = fs::file_size(from_, err);
+  if (err) {
+    return false;
+  }
+  const auto fromTime = fs::last_write_time(from_, err);
+  if (err) {
+    return false;
+  }
+
+  std::error_code toErr;
+  if (fs::file_size(to_, toErr) == fromSize && !toErr &&
+      fs::last_write_time(to_, toErr) == fromTime && !toErr) {
+    return true;
+  }
+
+  fs::copy_file(from_, to_, fs::copy_options::overwrite_existing, err);
+  if (err) {
+    return false;
+  }
+  // Not being able to set the time only costs a copy next time.
+  fs::last_write_time(to_, fromTime, err);
+  return true;
+}
+
+std::size_t ImageBatch::add(const fs::path &path_) {
+  const auto normalized = path_.lexically_normal();
+  const auto [rIndex, inserted] =
+      _indices.emplace(normalized.generic_u8string(), _paths.size());
+  if (inserted) {
+    _paths.push_back(normalized);
+  }
+  return rIndex->second;
+}
+
+void ImageBatch::load(std::uint32_t thread_count_) {
+  const auto nFiles = _paths.size();
+  _files.resize(nFiles);
+  _canonicals.assign(nFiles, std::nullopt);
+  std::vector<std::uint64_t> hashes(nFiles);
+  parallelFor(nFiles, thread_count_, [&](std::size_t iFile_) {
+    auto &file = _files[iFile_];
+    file = MappedFile::open(_paths[iFile_]);
+    if (file) {
+      const auto bytes = file->bytes();
+      hashes[iFile_] = hashUntypedVertex(bytes.data(), bytes.size());
+    }
+  });
+
+  std::unordered_map<std::uint64_t, std::vector<std::size_t>> contents;
+  for (std::size_t iFile = 0; iFile < nFiles; ++iFile) {
+    if (!_files[iFile]) {
+      continue;
+    }
+    const auto bytes = _files[iFile]->bytes();
+    auto &sameHash = contents[hashes[iFile]];
+    for (const auto iOther : sameHash) {
+      const auto otherBytes = _files[iOther]->bytes();
+      if (otherBytes.size() == bytes.size() &&
+          (bytes.empty() || std::memcmp(otherBytes.data(), bytes.data(),
+                                        bytes.size()) == 0)) {
+        _canonicals[iFile] = iOther;
+        break;
+      }
+    }
+    if (!_canonicals[iFile]) {
+      _canonicals[iFile] = iFile;
+      sameHash.push_back(iFile);
+    }
+  }
+}
+} // namespace bee
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <bee/polyfills/filesystem.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// Read-only content of a whole file, memory-mapped where supported and read
+/// otherwise.
+/// </summary>
+class MappedFile {
+public:
+  /// <summary>
+  /// Returns nothing if the file can't be opened.
+  /// </summary>
+  static std::optional<MappedFile> open(const bee::filesystem::path &path_);
+
+  MappedFile(MappedFile &&other_) noexcept;
+
+  MappedFile &operator=(MappedFile &&other_) noexcept;
+
+  ~MappedFile();
+
+  std::span<const std::byte> bytes() const {
+    return {_data, _size};
+  }
+
+private:
+  const std::byte *_data = nullptr;
+  std::size_t _size = 0;
+  bool _mapped = false;
+  std::unique_ptr<std::byte[]> _buffer;
+
+  MappedFile() = default;
+
+  void _release();
+};
+
+/// <summary>
+/// Copies `from_` to `to_` unless `to_` already has the size and modification
+/// time of `from_`. The copy is given the modification time of `from_` so
+/// that it's skipped next time. Returns false on failure.
+/// </summary>
+bool copyFileIfChanged(const bee::filesystem::path &from_,
+                       const bee::filesystem::path &to_);
+
+/// <summary>
+/// The image files referenced by a conversion. References to the same path
+/// share a file; after `load()`, files with the same content share their
+/// first file's content.
+/// </summary>
+class ImageBatch {
+public:
+  /// <summary>
+  /// Returns the index of the file at `path_`.
+  /// </summary>
+  std::size_t add(const bee::filesystem::path &path_);
+
+  std::size_t size() const {
+    return _paths.size();
+  }
+
+  const bee::filesystem::path &path(std::size_t file_) const {
+    return _paths[file_];
+  }
+
+  /// <summary>
+  /// Maps and hashes the files with `thread_count_` threads, then groups them
+  /// by content.
+  /// </summary>
+  void load(std::uint32_t thread_count_);
+
+  /// <summary>
+  /// The first file having the content of `file_`, which may be `file_`
+  /// itself. Nothing if `file_` can't be read.
+  /// </summary>
+  std::optional<std::size_t> canonical(std::size_t file_) const {
+    return _canonicals[file_];
+  }
+
+  std::span<const std::byte> content(std::size_t file_) const {
+    return _files[file_] ? _files[file_]->bytes()
+                         : std::span<const std::byte>{};
+  }
+
+private:
+  std::vector<bee::filesystem::path> _paths;
+  std::unordered_map<std::u8string, std::size_t> _indices;
+  std::vector<std::optional<MappedFile>> _files;
+  std::vector<std::optional<std::size_t>> _canonicals;
+};
+} // namespace bee
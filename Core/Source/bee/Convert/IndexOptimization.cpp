@@ -0,0 +1,63 @@
+#include <bee/Convert/IndexOptimization.h>
+#include <cstring>
+#include <limits>
+#include <meshoptimizer.h>
+#include <vector>
+
+namespace bee {
+void optimizeVertexCache(std::span<std::uint32_t> indices_,
+                         std::uint32_t vertex_count_) {
+  meshopt_optimizeVertexCache(indices_.data(), indices_.data(), indices_.size(),
+                              vertex_count_);
+}
+
+void optimizeOverdraw(std::span<std::uint32_t> indices_,
+                      const std::byte *vertices_,
+                      std::uint32_t vertex_size_,
+                      std::uint32_t vertex_count_) {
+  // meshoptimizer takes strides of up to 256 bytes only.
+  std::vector<float> positions(std::size_t{3} * vertex_count_);
+  for (std::uint32_t iVertex = 0; iVertex < vertex_count_; ++iVertex) {
+    std::memcpy(positions.data() + std::size_t{3} * iVertex,
+                vertices_ + static_cast<std::size_t>(vertex_size_) * iVertex,
+                sizeof(float) * 3);
+  }
+  // Allows the vertex cache efficiency to get 5% worse.
+  constexpr float threshold = 1.05f;
+  meshopt_optimizeOverdraw(indices_.data(), indices_.data(), indices_.size(),
+                           positions.data(), vertex_count_, sizeof(float) * 3,
+                           threshold);
+}
+
+void optimizeVertexFetch(std::span<std::uint32_t> indices_,
+                         std::byte *vertices_,
+                         std::uint32_t vertex_size_,
+                         std::uint32_t vertex_count_) {
+  std::vector<unsigned int> remap(vertex_count_);
+  // Vertices not referenced are left unmapped, they go to the end.
+  auto nextVertex =
+      static_cast<std::uint32_t>(meshopt_optimizeVertexFetchRemap(
+          remap.data(), indices_.data(), indices_.size(), vertex_count_));
+  for (auto &newIndex : remap) {
+    if (newIndex == std::numeric_limits<unsigned int>::max()) {
+      newIndex = nextVertex++;
+    }
+  }
+  meshopt_remapIndexBuffer(indices_.data(), indices_.data(), indices_.size(),
+                           remap.data());
+  meshopt_remapVertexBuffer(vertices_, vertices_, vertex_count_, vertex_size_,
+                            remap.data());
+}
+
+fx::gltf::Accessor::ComponentType
+getIndexComponentType(std::uint32_t vertex_count_) {
+  using ComponentType = fx::gltf::Accessor::ComponentType;
+  if (vertex_count_ <= std::numeric_limits<std::uint8_t>::max()) {
+    return ComponentType::UnsignedByte;
+  } else if (vertex_count_ <= std::numeric_limits<std::uint16_t>::max()) {
+    return ComponentType::UnsignedShort;
+  } else {
+    return ComponentType::UnsignedInt;
+  }
+}
+} // namespace bee
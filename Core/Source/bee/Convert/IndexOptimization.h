@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fx/gltf.h>
+#include <span>
+
+namespace bee {
+/// <summary>
+/// Reorders the triangles of a triangle list so that their vertices are
+/// likely to hit the post-transform vertex cache, with meshoptimizer.
+/// </summary>
+void optimizeVertexCache(std::span<std::uint32_t> indices_,
+                         std::uint32_t vertex_count_);
+
+/// <summary>
+/// Reorders clusters of vertex-cache-ordered triangles so that the ones
+/// facing outwards are drawn first, which reduces overdraw, at the cost of
+/// at most 5% of the cache efficiency. Positions are the first 3 floats of
+/// each vertex.
+/// </summary>
+void optimizeOverdraw(std::span<std::uint32_t> indices_,
+                      const std::byte *vertices_,
+                      std::uint32_t vertex_size_,
+                      std::uint32_t vertex_count_);
+
+/// <summary>
+/// Reorders vertices into the order they are first referenced by the
+/// indices, which are rewritten accordingly. Vertices not referenced at all
+/// are moved to the end.
+/// </summary>
+void optimizeVertexFetch(std::span<std::uint32_t> indices_,
+                         std::byte *vertices_,
+                         std::uint32_t vertex_size_,
+                         std::uint32_t vertex_count_);
+
+/// <summary>
+/// Gets the narrowest component type able to index `vertex_count_` vertices.
+/// The maximum value of a type is never used since it may be taken as a
+/// primitive restart.
+/// </summary>
+fx::gltf::Accessor::ComponentType
+getIndexComponentType(std::uint32_t vertex_count_);
+} // namespace bee
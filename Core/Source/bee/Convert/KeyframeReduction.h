@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// Selects the keys of a sampled curve to keep so that interpolating between
+/// kept keys deviates from every dropped sample by at most `tolerance_`
+/// (Ramer-Douglas-Peucker). `error_(from, to, at, rate)` measures how far
+/// sample `at` is from the interpolation of samples `from` and `to` at `rate`.
+/// Returns the ascending indices of kept keys: only the first one if the
+/// curve is constant within `tolerance_`, otherwise the first and last ones
+/// and those in between that are required.
+/// </summary>
+template <typename Error_>
+std::vector<std::size_t> reduceKeyframes(std::span<const double> times_,
+                                         double tolerance_,
+                                         Error_ &&error_) {
+  const auto nKeys = times_.size();
+  if (nKeys == 0) {
+    return {};
+  }
+
+  bool constant = true;
+  for (std::size_t at = 1; at < nKeys && constant; ++at) {
+    constant = !(error_(std::size_t{0}, std::size_t{0}, at, 0.0) > tolerance_);
+  }
+  if (constant) {
+    return {0};
+  }
+
+  std::vector<bool> kept(nKeys, false);
+  kept.front() = true;
+  kept.back() = true;
+  std::vector<std::pair<std::size_t, std::size_t>> segments{{0, nKeys - 1}};
+  while (!segments.empty()) {
+    const auto [from, to] = segments.back();
+    segments.pop_back();
+    if (to - from < 2) {
+      continue;
+    }
+
+    const auto duration = times_[to] - times_[from];
+    double maxError = 0.0;
+    std::size_t atMaxError = from;
+    for (auto at = from + 1; at < to; ++at) {
+      const auto rate =
+          duration > 0.0 ? (times_[at] - times_[from]) / duration : 0.0;
+      if (const auto error = error_(from, to, at, rate); error > maxError) {
+        maxError = error;
+        atMaxError = at;
+      }
+    }
+    if (maxError > tolerance_) {
+      kept[atMaxError] = true;
+      segments.emplace_back(from, atMaxError);
+      segments.emplace_back(atMaxError, to);
+    }
+  }
+
+  std::vector<std::size_t> keys;
+  for (std::size_t iKey = 0; iKey < nKeys; ++iKey) {
+    if (kept[iKey]) {
+      keys.push_back(iKey);
+    }
+  }
+  return keys;
+}
+
+/// <summary>
+/// Keeps only the keys `keys_`, as returned by `reduceKeyframes()`, of a curve
+/// whose values have `stride_` elements per key.
+/// </summary>
+template <typename Value_>
+void keepKeyframes(std::span<const std::size_t> keys_,
+                   std::vector<double> &times_,
+                   std::vector<Value_> &values_,
+                   std::size_t stride_ = 1) {
+  // Keys are ascending, so they are never overwritten before being read.
+  for (std::size_t iKey = 0; iKey < keys_.size(); ++iKey) {
+    const auto key = keys_[iKey];
+    times_[iKey] = times_[key];
+    for (std::size_t iElement = 0; iElement < stride_; ++iElement) {
+      values_[stride_ * iKey + iElement] = values_[stride_ * key + iElement];
+    }
+  }
+  times_.resize(keys_.size());
+  values_.resize(stride_ * keys_.size());
+}
+} // namespace bee
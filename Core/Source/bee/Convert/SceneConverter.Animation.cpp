@@ -1,29 +1,17 @@
 
 #include <bee/Convert/ConvertError.h>
 #include <bee/Convert/DirectSpreader.h>
+#include <bee/Convert/KeyframeReduction.h>
 #include <bee/Convert/SceneConverter.h>
+#include <bee/Convert/fbxsdk/LocalTransformSampler.h>
+#include <bee/Convert/fbxsdk/ObjectDestroyer.h>
 #include <bee/Convert/fbxsdk/Spreader.h>
+#include <bee/Parallel.h>
+#include <bee/UntypedVertex.h>
 #include <fmt/format.h>
-
-constexpr static auto defaultEplislon = static_cast<fbxsdk::FbxDouble>(1e-6);
-
-bool isApproximatelyEqual(fbxsdk::FbxDouble from_,
-                          fbxsdk::FbxDouble to_,
-                          fbxsdk::FbxDouble eplislon_ = defaultEplislon) {
-  return std::abs(from_ - to_) < eplislon_;
-}
-
-template <int Size_>
-bool isApproximatelyEqual(const fbxsdk::FbxDouble *from_,
-                          const fbxsdk::FbxDouble *to_,
-                          fbxsdk::FbxDouble eplislon_ = defaultEplislon) {
-  for (int i = 0; i < Size_; ++i) {
-    if (!isApproximatelyEqual(from_[i], to_[i], eplislon_)) {
-      return false;
-    }
-  }
-  return true;
-}
+#include <limits>
+#include <list>
+#include <numbers>
 
 fbxsdk::FbxDouble
 lerp(fbxsdk::FbxDouble from_, fbxsdk::FbxDouble to_, fbxsdk::FbxDouble rate_) {
@@ -44,6 +32,41 @@ fbxsdk::FbxQuaternion slerp(const fbxsdk::FbxQuaternion &from_,
   return from_.Slerp(to_, rate_);
 }
 
+fbxsdk::FbxDouble distance3(const fbxsdk::FbxVector4 &from_,
+                            const fbxsdk::FbxVector4 &to_) {
+  fbxsdk::FbxDouble squared = 0.0;
+  for (int i = 0; i < 3; ++i) {
+    squared += (to_[i] - from_[i]) * (to_[i] - from_[i]);
+  }
+  return std::sqrt(squared);
+}
+
+fbxsdk::FbxDouble maxDifference3(const fbxsdk::FbxVector4 &from_,
+                                 const fbxsdk::FbxVector4 &to_) {
+  fbxsdk::FbxDouble result = 0.0;
+  for (int i = 0; i < 3; ++i) {
+    result = std::max(result, std::abs(to_[i] - from_[i]));
+  }
+  return result;
+}
+
+fbxsdk::FbxDouble dot4(const fbxsdk::FbxQuaternion &from_,
+                       const fbxsdk::FbxQuaternion &to_) {
+  fbxsdk::FbxDouble result = 0.0;
+  for (int i = 0; i < 4; ++i) {
+    result += from_[i] * to_[i];
+  }
+  return result;
+}
+
+/// <summary>
+/// Angle, in radians, of the rotation between two unit quaternions.
+/// </summary>
+fbxsdk::FbxDouble angleBetween(const fbxsdk::FbxQuaternion &from_,
+                               const fbxsdk::FbxQuaternion &to_) {
+  return 2.0 * std::acos(std::min(1.0, std::abs(dot4(from_, to_))));
+}
+
 namespace bee {
 /// <summary>
 /// Animation on node {} has too long animation. Usually because negative timeline
@@ -76,6 +99,107 @@ void to_json(nlohmann::json &j_, const InvalidNodeAnimationRange &error_) {
   j_["received"] = error_.received;
 }
 
+namespace {
+template <typename Integer_> Integer_ toNormalized(fbxsdk::FbxDouble value_) {
+  constexpr auto lowest = std::is_signed_v<Integer_> ? -1.0 : 0.0;
+  return static_cast<Integer_>(
+      std::round(std::clamp(value_, lowest, 1.0) *
+                 static_cast<double>(std::numeric_limits<Integer_>::max())));
+}
+
+template <typename Integer_>
+fbxsdk::FbxDouble fromNormalized(Integer_ value_) {
+  return std::max(static_cast<double>(value_) /
+                      static_cast<double>(std::numeric_limits<Integer_>::max()),
+                  -1.0);
+}
+
+/// <summary>
+/// Spreads as `Spreader_` does, then maps each component to a normalized
+/// integer.
+/// </summary>
+template <typename Spreader_> struct NormalizedSpreader {
+  using type = typename Spreader_::type;
+
+  constexpr static auto size = Spreader_::size;
+
+  template <typename TargetTy_>
+  static void spread(const type &in_, TargetTy_ *out_) {
+    std::array<fbxsdk::FbxDouble, static_cast<std::size_t>(size)> components;
+    Spreader_::spread(in_, components.data());
+    for (std::size_t i = 0; i < components.size(); ++i) {
+      out_[i] = toNormalized<TargetTy_>(components[i]);
+    }
+  }
+};
+
+/// <summary>
+/// Writes `values_` as normalized `ComponentType_` integers if each value is
+/// restored within `tolerance_`, as measured by `error_(value, restored)`
+/// where `restored` are the decoded components; returns nothing otherwise.
+/// </summary>
+template <fx::gltf::Accessor::Type Type_,
+          fx::gltf::Accessor::ComponentType ComponentType_,
+          typename Spreader_,
+          typename Error_>
+std::optional<GLTFBuilder::XXIndex>
+createNormalizedAccessor(GLTFBuilder &glTF_builder_,
+                         std::span<const typename Spreader_::type> values_,
+                         fbxsdk::FbxDouble tolerance_,
+                         const Error_ &error_,
+                         GLTFBuilder::XXIndex buffer_) {
+  using Integer = GLTFComponentTypeStorage<ComponentType_>;
+  for (const auto &value : values_) {
+    std::array<fbxsdk::FbxDouble, static_cast<std::size_t>(Spreader_::size)>
+        components;
+    Spreader_::spread(value, components.data());
+    for (auto &component : components) {
+      component = fromNormalized(toNormalized<Integer>(component));
+    }
+    if (error_(value, components) > tolerance_) {
+      return {};
+    }
+  }
+
+  const auto accessorIndex =
+      glTF_builder_.createAccessor<Type_, ComponentType_,
+                                   NormalizedSpreader<Spreader_>>(values_, 0,
+                                                                  buffer_);
+  glTF_builder_.get(&fx::gltf::Document::accessors)[accessorIndex].normalized =
+      true;
+  return accessorIndex;
+}
+
+/// <summary>
+/// Writes `values_` as normalized integers of `bits_` bits, see
+/// `createNormalizedAccessor()`; returns nothing if `bits_` is neither 8 or
+/// 16 or if they can't be written so.
+/// </summary>
+template <fx::gltf::Accessor::Type Type_,
+          fx::gltf::Accessor::ComponentType ByteType_,
+          fx::gltf::Accessor::ComponentType ShortType_,
+          typename Spreader_,
+          typename Error_>
+std::optional<GLTFBuilder::XXIndex>
+createQuantizedOutput(GLTFBuilder &glTF_builder_,
+                      std::span<const typename Spreader_::type> values_,
+                      std::uint32_t bits_,
+                      fbxsdk::FbxDouble tolerance_,
+                      const Error_ &error_,
+                      GLTFBuilder::XXIndex buffer_) {
+  switch (bits_) {
+  case 8:
+    return createNormalizedAccessor<Type_, ByteType_, Spreader_>(
+        glTF_builder_, values_, tolerance_, error_, buffer_);
+  case 16:
+    return createNormalizedAccessor<Type_, ShortType_, Spreader_>(
+        glTF_builder_, values_, tolerance_, error_, buffer_);
+  default:
+    return {};
+  }
+}
+} // namespace
+
 void SceneConverter::_convertAnimation(fbxsdk::FbxScene &fbx_scene_) {
   if (_animationTimeMode == fbxsdk::FbxTime::eDefaultMode) {
     _log(Logger::Level::error, "The FBX model did not specify a valid time "
@@ -97,6 +221,7 @@ void SceneConverter::_convertAnimation(fbxsdk::FbxScene &fbx_scene_) {
       continue;
     }
 
+    _checkLimits();
     const auto timeSpan = _getAnimStackTimeSpan(*animStack, fbx_scene_);
     if (timeSpan.GetDuration() == 0) {
       if (_options.verbose) {
@@ -104,6 +229,8 @@ void SceneConverter::_convertAnimation(fbxsdk::FbxScene &fbx_scene_) {
       }
       continue;
     }
+    const auto stackStart = _stats ? ConvertStats::Clock::now()
+                                   : ConvertStats::Clock::time_point{};
     const auto usedAnimationTimeMode = _animationTimeMode;
     _log(Logger::Level::verbose,
          fmt::format("Frame rate: {}",
@@ -125,6 +252,11 @@ void SceneConverter::_convertAnimation(fbxsdk::FbxScene &fbx_scene_) {
          fmt::format("Take {}: {}s", animName,
                      timeSpan.GetDuration().GetSecondDouble()));
 
+    if (_options.bufferPartitioning.perAnimationStack) {
+      _animationBuffer = _glTFBuilder.createBuffer(animName);
+    }
+
+    _animationTimeAccessors.clear();
     fbx_scene_.SetCurrentAnimationStack(animStack);
     for (std::remove_const_t<decltype(nAnimLayers)> iAnimLayer = 0;
          iAnimLayer < nAnimLayers; ++iAnimLayer) {
@@ -132,10 +264,22 @@ void SceneConverter::_convertAnimation(fbxsdk::FbxScene &fbx_scene_) {
           animStack->GetMember<fbxsdk::FbxAnimLayer>(iAnimLayer);
       _convertAnimationLayer(glTFAnimation, *animLayer, fbx_scene_, animRange);
     }
+    if (_stats) {
+      const ConvertStats::Span stackSpan{stackStart,
+                                         ConvertStats::Clock::now()};
+      _stats->addEvent(animName, "animationStack", stackSpan);
+      ConvertStats::AnimationStack animationStackStats;
+      animationStackStats.name = animName;
+      animationStackStats.elapsed = stackSpan.end - stackSpan.start;
+      animationStackStats.channels = glTFAnimation.channels.size();
+      _stats->addAnimationStack(std::move(animationStackStats));
+    }
     if (!glTFAnimation.samplers.empty()) {
       _glTFBuilder.add(&fx::gltf::Document::animations,
                        std::move(glTFAnimation));
     }
+    _reportProgress(ConvertProgress::Stage::animationStack, animName,
+                    iAnimStack + 1, nAnimStacks);
   }
 }
 
@@ -213,100 +357,235 @@ void SceneConverter::_convertAnimationLayer(
     fbxsdk::FbxAnimLayer &fbx_anim_layer_,
     fbxsdk::FbxScene &fbx_scene_,
     const AnimRange &anim_range_) {
-  const auto nNodes = fbx_scene_.GetNodeCount();
-  for (std::remove_const_t<decltype(nNodes)> iNode = 0; iNode < nNodes;
-       ++iNode) {
-    auto fbxNode = fbx_scene_.GetNode(iNode);
-    _convertAnimationLayer(glTF_animation_, fbx_anim_layer_, *fbxNode,
-                           anim_range_);
+  const auto nNodes = static_cast<std::size_t>(fbx_scene_.GetNodeCount());
+  std::vector<fbxsdk::FbxNode *> fbxNodes(nNodes);
+  for (std::size_t iNode = 0; iNode < nNodes; ++iNode) {
+    fbxNodes[iNode] = fbx_scene_.GetNode(static_cast<int>(iNode));
+  }
+
+  const auto nThreads = resolveThreadCount(_options.animationThreads);
+
+  // The calling thread evaluates with the scene's evaluator, other threads
+  // with their own since evaluators cache evaluation states.
+  std::vector<fbxsdk::FbxAnimEvaluator *> fbxEvaluators(nThreads);
+  std::list<FbxObjectDestroyer> fbxEvaluatorDestroyers;
+  fbxEvaluators[0] = fbx_scene_.GetAnimationEvaluator();
+  for (std::uint32_t iThread = 1; iThread < nThreads; ++iThread) {
+    const auto fbxEvaluator =
+        fbxsdk::FbxAnimEvalClassic::Create(&_fbxManager, "");
+    fbxEvaluatorDestroyers.emplace_back(fbxEvaluator);
+    fbxEvaluators[iThread] = fbxEvaluator;
+  }
+
+  // Baked nodes are kept only until their window is written; with a single
+  // thread, a window is a single node, as before.
+  const std::size_t windowNodes = nThreads == 1 ? 1 : nThreads * 4;
+  std::vector<NodeAnimationBake> bakes;
+  for (std::size_t iWindow = 0; iWindow < nNodes; iWindow += windowNodes) {
+    const auto nWindowNodes = std::min(windowNodes, nNodes - iWindow);
+    bakes.clear();
+    bakes.resize(nWindowNodes);
+    parallelForWorkers(nWindowNodes, nThreads,
+                       [&](std::size_t iNode_, std::uint32_t iWorker_) {
+                         _checkLimits();
+                         bakes[iNode_] = _bakeNodeAnimation(
+                             fbx_anim_layer_, *fbxNodes[iWindow + iNode_],
+                             anim_range_, *fbxEvaluators[iWorker_]);
+                       });
+
+    // Written in node order so that the output does not depend on threads.
+    for (const auto &bake : bakes) {
+      _writeNodeAnimation(glTF_animation_, bake);
+    }
   }
 }
 
-void SceneConverter::_convertAnimationLayer(
-    fx::gltf::Animation &glTF_animation_,
-    fbxsdk::FbxAnimLayer &fbx_anim_layer_,
-    fbxsdk::FbxNode &fbx_node_,
-    const AnimRange &anim_range_) {
+SceneConverter::NodeAnimationBake
+SceneConverter::_bakeNodeAnimation(fbxsdk::FbxAnimLayer &fbx_anim_layer_,
+                                   fbxsdk::FbxNode &fbx_node_,
+                                   const AnimRange &anim_range_,
+                                   fbxsdk::FbxAnimEvaluator &fbx_evaluator_) {
+  NodeAnimationBake bake;
+  bake.fbxNode = &fbx_node_;
   if (_options.export_trs_animation) {
-    _extractTrsAnimation(glTF_animation_, fbx_anim_layer_, fbx_node_,
-                         anim_range_);
+    bake.trs = _extractTrsAnimation(fbx_anim_layer_, fbx_node_, anim_range_,
+                                    fbx_evaluator_);
   }
-
   if (_options.export_blend_shape_animation) {
-    _extractWeightsAnimation(glTF_animation_, fbx_anim_layer_, fbx_node_,
-                             anim_range_);
+    bake.morphAnimations =
+        _extractWeightsAnimation(fbx_anim_layer_, fbx_node_, anim_range_);
   }
+  return bake;
 }
 
-void SceneConverter::_extractWeightsAnimation(
-    fx::gltf::Animation &glTF_animation_,
-    fbxsdk::FbxAnimLayer &fbx_anim_layer_,
-    fbxsdk::FbxNode &fbx_node_,
-    const AnimRange &anim_range_) {
+void SceneConverter::_writeNodeAnimation(fx::gltf::Animation &glTF_animation_,
+                                         const NodeAnimationBake &bake_) {
+  if (_options.export_trs_animation) {
+    if (bake_.trs) {
+      _writeTrsAnimation(glTF_animation_, *bake_.fbxNode, *bake_.trs);
+    }
+    _glTFBuilder.flush();
+  }
+
+  if (!bake_.morphAnimations.empty()) {
+    _writeWeightsAnimation(glTF_animation_, *bake_.fbxNode,
+                           bake_.morphAnimations);
+  }
+}
+
+std::vector<SceneConverter::MorphAnimation>
+SceneConverter::_extractWeightsAnimation(fbxsdk::FbxAnimLayer &fbx_anim_layer_,
+                                         fbxsdk::FbxNode &fbx_node_,
+                                         const AnimRange &anim_range_) {
   auto rNodeBumpMeta = _nodeDumpMetaMap.find(&fbx_node_);
   if (rNodeBumpMeta == _nodeDumpMetaMap.end()) {
-    return;
+    return {};
   }
 
   const auto &nodeBumpMeta = rNodeBumpMeta->second;
   if (!nodeBumpMeta.meshes) {
-    return;
+    return {};
   }
 
   auto &blendShapeMeta = nodeBumpMeta.meshes->blendShapeMeta;
   if (!blendShapeMeta) {
-    return;
+    return {};
   }
 
   auto &fbxMeshes = nodeBumpMeta.meshes->meshes;
-  if (!fbxMeshes.empty()) {
-    std::vector<MorphAnimation> morphAnimations{fbxMeshes.size()};
-    for (decltype(fbxMeshes.size()) iMesh = 0; iMesh < fbxMeshes.size();
-         ++iMesh) {
-      const auto &blendShapeData = blendShapeMeta->blendShapeDatas[iMesh];
-      morphAnimations[iMesh] = _extractWeightsAnimation(
-          fbx_anim_layer_, fbx_node_, *fbxMeshes[iMesh], blendShapeData,
-          anim_range_);
+  std::vector<MorphAnimation> morphAnimations{fbxMeshes.size()};
+  for (decltype(fbxMeshes.size()) iMesh = 0; iMesh < fbxMeshes.size();
+       ++iMesh) {
+    const auto &blendShapeData = blendShapeMeta->blendShapeDatas[iMesh];
+    auto &morphAnimation = morphAnimations[iMesh];
+    morphAnimation =
+        _extractWeightsAnimation(fbx_anim_layer_, fbx_node_, *fbxMeshes[iMesh],
+                                 blendShapeData, anim_range_);
+
+    auto &times = morphAnimation.times;
+    auto &values = morphAnimation.values;
+    const auto nWeights = times.empty() ? 0 : values.size() / times.size();
+    const auto keys = reduceKeyframes(
+        times, _options.animationTolerance.weight,
+        [nWeights, &values](std::size_t from_, std::size_t to_,
+                            std::size_t at_, double rate_) {
+          double error = 0.0;
+          for (std::size_t iWeight = 0; iWeight < nWeights; ++iWeight) {
+            error = std::max(error,
+                             std::abs(lerp(values[nWeights * from_ + iWeight],
+                                           values[nWeights * to_ + iWeight],
+                                           rate_) -
+                                      values[nWeights * at_ + iWeight]));
+          }
+          return error;
+        });
+    keepKeyframes(keys, times, values, nWeights);
+  }
+  return morphAnimations;
+}
+
+void SceneConverter::_writeWeightsAnimation(
+    fx::gltf::Animation &glTF_animation_,
+    const fbxsdk::FbxNode &fbx_node_,
+    std::span<const MorphAnimation> morph_animations_) {
+  const auto &nodeBumpMeta = _nodeDumpMetaMap.at(&fbx_node_);
+  if (const auto &first = morph_animations_.front(); std::all_of(
+          std::next(morph_animations_.begin()), morph_animations_.end(),
+          [&first](const MorphAnimation &anim_) {
+            return anim_.times == first.times && anim_.values == first.values;
+          })) {
+    // A channel reduced to a single key is not needed if all weights in it
+    // are the default ones, 0.
+    if (first.times.size() == 1 &&
+        std::all_of(first.values.begin(), first.values.end(),
+                    [this](double weight_) {
+                      return std::abs(weight_) <=
+                             _options.animationTolerance.weight;
+                    })) {
+      return;
     }
+    _writeMorphAnimtion(
+        glTF_animation_, first,
+        nodeBumpMeta.glTFMeshNodeIndex.value_or(nodeBumpMeta.glTFNodeIndex),
+        fbx_node_);
+  } else {
+    _log(Logger::Level::warning,
+         fmt::format("Sub-meshes use different morph animation. We can't "
+                     "handle that case."));
+  }
+}
 
-    if (const auto &first = morphAnimations.front(); std::all_of(
-            std::next(morphAnimations.begin()), morphAnimations.end(),
-            [&first](const MorphAnimation &anim_) {
-              return anim_.times == first.times && anim_.values == first.values;
-            })) {
-      _writeMorphAnimtion(glTF_animation_, first, nodeBumpMeta.glTFNodeIndex,
-                          fbx_node_);
-    } else {
-      _log(Logger::Level::warning,
-           fmt::format("Sub-meshes use different morph animation. We can't "
-                       "handle that case."));
+GLTFBuilder::XXIndex
+SceneConverter::_getAnimationTimeAccessor(
+    const fx::gltf::Animation &glTF_animation_,
+    std::span<const double> times_) {
+  const auto hash = hashUntypedVertex(
+      reinterpret_cast<const std::byte *>(times_.data()), times_.size_bytes());
+  auto &candidates = _animationTimeAccessors[hash];
+  for (const auto &[times, accessorIndex] : candidates) {
+    if (std::equal(times.begin(), times.end(), times_.begin(), times_.end())) {
+      return accessorIndex;
     }
   }
+
+  auto timeAccessorIndex = _glTFBuilder.createAccessor<
+      fx::gltf::Accessor::Type::Scalar,
+      fx::gltf::Accessor::ComponentType::Float, DirectSpreader<double>>(
+      times_, 0, _animationBuffer, true);
+  if (_namesBufferObjects()) {
+    _glTFBuilder.get(&fx::gltf::Document::accessors)[timeAccessorIndex].name =
+        fmt::format("{}/{}Keys/Input", glTF_animation_.name, times_.size());
+  }
+  candidates.emplace_back(std::vector<double>{times_.begin(), times_.end()},
+                          timeAccessorIndex);
+  return timeAccessorIndex;
 }
 
 void SceneConverter::_writeMorphAnimtion(fx::gltf::Animation &glTF_animation_,
                                          const MorphAnimation &morph_animtion_,
                                          std::uint32_t glTF_node_index_,
                                          const fbxsdk::FbxNode &fbx_node_) {
-  auto timeAccessorIndex = _glTFBuilder.createAccessor<
-      fx::gltf::Accessor::Type::Scalar,
-      fx::gltf::Accessor::ComponentType::Float,
-      DirectSpreader<decltype(morph_animtion_.times)::value_type>>(
-      std::span{morph_animtion_.times}, 0, 0, true);
-  _glTFBuilder.get(&fx::gltf::Document::accessors)[timeAccessorIndex].name =
-      fmt::format("{}/weights/Input", fbx_node_.GetName());
-
-  auto weightsAccessorIndex = _glTFBuilder.createAccessor<
-      fx::gltf::Accessor::Type::Scalar,
-      fx::gltf::Accessor::ComponentType::Float,
-      DirectSpreader<decltype(morph_animtion_.values)::value_type>>(
-      morph_animtion_.values, 0, 0);
-  _glTFBuilder.get(&fx::gltf::Document::accessors)[weightsAccessorIndex].name =
-      fmt::format("{}/weights/Output", fbx_node_.GetName());
+  const auto timeAccessorIndex =
+      _getAnimationTimeAccessor(glTF_animation_, morph_animtion_.times);
+
+  using WeightSpreader =
+      DirectSpreader<decltype(morph_animtion_.values)::value_type>;
+  const auto weightBits = _options.animationQuantization
+                              ? _options.animationQuantization->weightBits
+                              : 0;
+  auto weightsAccessorIndex =
+      createQuantizedOutput<fx::gltf::Accessor::Type::Scalar,
+                            fx::gltf::Accessor::ComponentType::UnsignedByte,
+                            fx::gltf::Accessor::ComponentType::UnsignedShort,
+                            WeightSpreader>(
+          _glTFBuilder, morph_animtion_.values, weightBits,
+          _options.animationTolerance.weight,
+          [](fbxsdk::FbxDouble weight_,
+             const std::array<fbxsdk::FbxDouble, 1> &restored_) {
+            return std::abs(restored_[0] - weight_);
+          },
+          _animationBuffer);
+  if (!weightsAccessorIndex) {
+    if (weightBits) {
+      _log(Logger::Level::verbose,
+           fmt::format("Morph weights of {} are kept as float since they "
+                       "can't be quantized within the weight tolerance.",
+                       fbx_node_.GetName()));
+    }
+    weightsAccessorIndex =
+        _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Scalar,
+                                    fx::gltf::Accessor::ComponentType::Float,
+                                    WeightSpreader>(morph_animtion_.values, 0,
+                                                    _animationBuffer);
+  }
+  if (_namesBufferObjects()) {
+    _glTFBuilder.get(&fx::gltf::Document::accessors)[*weightsAccessorIndex]
+        .name = fmt::format("{}/weights/Output", fbx_node_.GetName());
+  }
 
   fx::gltf::Animation::Sampler sampler;
   sampler.input = timeAccessorIndex;
-  sampler.output = weightsAccessorIndex;
+  sampler.output = *weightsAccessorIndex;
   auto samplerIndex = glTF_animation_.samplers.size();
   glTF_animation_.samplers.emplace_back(std::move(sampler));
   fx::gltf::Animation::Channel channel;
@@ -342,6 +621,7 @@ SceneConverter::MorphAnimation SceneConverter::_extractWeightsAnimation(
   auto extractFrame =
       [](decltype(MorphAnimation::values)::iterator out_weights_,
          fbxsdk::FbxTime time_, fbxsdk::FbxAnimCurve *shape_channel_,
+         int &last_key_index_,
          const decltype(FbxBlendShapeData::Channel::targetShapes)
              &target_shapes_) {
         if (target_shapes_.empty()) {
@@ -354,8 +634,11 @@ SceneConverter::MorphAnimation SceneConverter::_extractWeightsAnimation(
         const auto iFrameWeightsBeg = out_weights_;
         const auto iFrameWeightsEnd = iFrameWeightsBeg + target_shapes_.size();
 
+        // The last key index is kept by the caller rather than by the curve,
+        // which may be shared by nodes baked on other threads.
         const auto animWeight =
-            shape_channel_ ? shape_channel_->Evaluate(time_) : defaultWeight;
+            shape_channel_ ? shape_channel_->Evaluate(time_, &last_key_index_)
+                           : defaultWeight;
 
         // The target shape 'fullWeight' values are
         // a strictly ascending list of floats (between 0 and 100), forming a
@@ -386,6 +669,15 @@ SceneConverter::MorphAnimation SceneConverter::_extractWeightsAnimation(
         }
       };
 
+  std::vector<fbxsdk::FbxAnimCurve *> shapeChannels;
+  shapeChannels.reserve(blend_shape_data_.channels.size());
+  for (const auto &channel : blend_shape_data_.channels) {
+    shapeChannels.push_back(fbx_mesh_.GetShapeChannel(
+        channel.blendShapeIndex, channel.blendShapeChannelIndex,
+        &fbx_anim_layer_));
+  }
+  std::vector<int> lastKeyIndices(shapeChannels.size(), 0);
+
   const auto firstTimeDouble = anim_range_.first_frame_seconds();
   for (decltype(morphAnimation.times.size()) iFrame = 0;
        iFrame < morphAnimation.times.size(); ++iFrame) {
@@ -394,14 +686,14 @@ SceneConverter::MorphAnimation SceneConverter::_extractWeightsAnimation(
     morphAnimation.times[iFrame] = time.GetSecondDouble() - firstTimeDouble;
 
     TargetWeightsCount offset = 0;
-    for (const auto &[blendShapeIndex, blendShapeChannelIndex, name,
-                      deformPercent, targetShapes] :
-         blend_shape_data_.channels) {
-      auto shapeChannel = fbx_mesh_.GetShapeChannel(
-          blendShapeIndex, blendShapeChannelIndex, &fbx_anim_layer_);
+    for (std::size_t iChannel = 0; iChannel < shapeChannels.size();
+         ++iChannel) {
+      const auto &targetShapes =
+          blend_shape_data_.channels[iChannel].targetShapes;
       const auto outWeights =
           morphAnimation.values.begin() + nTargetWeights * iFrame + offset;
-      extractFrame(outWeights, time, shapeChannel, targetShapes);
+      extractFrame(outWeights, time, shapeChannels[iChannel],
+                   lastKeyIndices[iChannel], targetShapes);
       offset += targetShapes.size();
     }
   }
@@ -409,13 +701,15 @@ SceneConverter::MorphAnimation SceneConverter::_extractWeightsAnimation(
   return morphAnimation;
 }
 
-void SceneConverter::_extractTrsAnimation(fx::gltf::Animation &glTF_animation_,
-                                          fbxsdk::FbxAnimLayer &fbx_anim_layer_,
-                                          fbxsdk::FbxNode &fbx_node_,
-                                          const AnimRange &anim_range_) {
+std::optional<SceneConverter::TrsAnimation>
+SceneConverter::_extractTrsAnimation(
+    fbxsdk::FbxAnimLayer &fbx_anim_layer_,
+    fbxsdk::FbxNode &fbx_node_,
+    const AnimRange &anim_range_,
+    fbxsdk::FbxAnimEvaluator &fbx_evaluator_) {
   const auto glTFNodeIndex = _getNodeMap(fbx_node_);
   if (!glTFNodeIndex) {
-    return;
+    return {};
   }
 
   const auto isTranslationAnimated =
@@ -425,152 +719,208 @@ void SceneConverter::_extractTrsAnimation(fx::gltf::Animation &glTF_animation_,
   const auto isScaleAnimated =
       fbx_node_.LclScaling.IsAnimated(&fbx_anim_layer_);
   if (!isTranslationAnimated && !isRotationAnimated && !isScaleAnimated) {
-    return;
+    return {};
   }
 
   const auto nFrames = anim_range_.frames_count();
-  std::vector<double> times;
-  std::vector<fbxsdk::FbxVector4> translations;
-  std::vector<fbxsdk::FbxQuaternion> rotations;
-  std::vector<fbxsdk::FbxVector4> scales;
-
-  const auto firstTimeDouble = anim_range_.first_frame_seconds();
+  std::vector<fbxsdk::FbxTime> fbxTimes(static_cast<std::size_t>(nFrames));
   for (std::remove_const_t<decltype(nFrames)> iFrame = 0; iFrame < nFrames;
        ++iFrame) {
-    const auto fbxTime = anim_range_.at(iFrame);
+    fbxTimes[iFrame] = anim_range_.at(iFrame);
+  }
 
-    const auto &localTransform = fbx_node_.EvaluateLocalTransform(fbxTime);
+  // Nodes driven by their Lcl curves only are sampled directly; others go
+  // through the evaluator frame by frame.
+  std::vector<fbxsdk::FbxAMatrix> localTransforms;
+  const std::array<fbxsdk::FbxTime, 3> checkTimes = {
+      fbxTimes.front(), fbxTimes[fbxTimes.size() / 2], fbxTimes.back()};
+  if (const auto sampler = FbxLocalTransformSampler::create(
+          fbx_node_, fbx_anim_layer_, fbx_evaluator_, checkTimes)) {
+    localTransforms = sampler->sample(fbxTimes);
+  } else {
+    localTransforms.resize(fbxTimes.size());
+    std::transform(
+        fbxTimes.begin(), fbxTimes.end(), localTransforms.begin(),
+        [&fbx_node_, &fbx_evaluator_](const fbxsdk::FbxTime &fbx_time_) {
+          return fbx_evaluator_.GetNodeLocalTransform(&fbx_node_, fbx_time_);
+        });
+  }
 
-    const auto time = fbxTime.GetSecondDouble() - firstTimeDouble;
-    fbxsdk::FbxVector4 translation;
-    if (isTranslationAnimated) {
-      translation = _applyUnitScaleFactorV3(localTransform.GetT());
-    }
-    fbxsdk::FbxQuaternion rotation;
-    if (isRotationAnimated) {
-      rotation = localTransform.GetQ();
+  const auto firstTimeDouble = anim_range_.first_frame_seconds();
+  std::vector<double> times(fbxTimes.size());
+  std::transform(fbxTimes.begin(), fbxTimes.end(), times.begin(),
+                 [firstTimeDouble](const fbxsdk::FbxTime &fbx_time_) {
+                   return fbx_time_.GetSecondDouble() - firstTimeDouble;
+                 });
+
+  const auto &tolerance = _options.animationTolerance;
+  TrsAnimation trsAnimation;
+  trsAnimation.glTFNodeIndex = *glTFNodeIndex;
+  if (isTranslationAnimated) {
+    auto &curve = trsAnimation.translation.emplace();
+    curve.times = times;
+    auto &translations = curve.values;
+    translations.resize(localTransforms.size());
+    std::transform(localTransforms.begin(), localTransforms.end(),
+                   translations.begin(),
+                   [this](const fbxsdk::FbxAMatrix &local_transform_) {
+                     return _applyUnitScaleFactorV3(local_transform_.GetT());
+                   });
+    const auto keys = reduceKeyframes(
+        curve.times, tolerance.translation,
+        [&translations](std::size_t from_, std::size_t to_, std::size_t at_,
+                        double rate_) {
+          return distance3(lerp(translations[from_], translations[to_], rate_),
+                           translations[at_]);
+        });
+    keepKeyframes(keys, curve.times, translations);
+  }
+  if (isRotationAnimated) {
+    auto &curve = trsAnimation.rotation.emplace();
+    curve.times = times;
+    auto &rotations = curve.values;
+    rotations.resize(localTransforms.size());
+    for (std::size_t iFrame = 0; iFrame < rotations.size(); ++iFrame) {
+      auto &rotation = rotations[iFrame];
+      rotation = localTransforms[iFrame].GetQ();
       rotation.Normalize();
-    }
-    fbxsdk::FbxVector4 scale;
-    if (isScaleAnimated) {
-      scale = localTransform.GetS();
-    }
-
-    const auto lastFrameMayBeOptOut = [&]() {
-      // We have to admit that we at least get 3 frames
-      // even they are linear at all.
-      if (times.size() < 2) {
-        return false;
-      }
-
-      const auto iLast = times.size() - 1;
-      const auto iLastLast = times.size() - 2;
-      const auto lastTime = times[iLast];
-      const auto lastLastTime = times[iLastLast];
-      const auto dTime = time - lastTime;
-      if (isApproximatelyEqual(dTime, 0.0)) {
-        // If current frame time is indistinguishable from previous frame time,
-        // we can omit it.
-        return true;
-      }
-      const auto rate = (lastTime - lastLastTime) / dTime;
-      if (isApproximatelyEqual(rate, 0.0)) {
-        // If two previous frame times are indistinguishable, we shall not omit
-        // current frame.
-        return false;
-      }
-      if (isTranslationAnimated &&
-          !isApproximatelyEqual<3>(
-              lerp(translations[iLastLast], translation, rate),
-              translations[iLast])) {
-        return false;
-      }
-      if (isRotationAnimated &&
-          !isApproximatelyEqual<4>(slerp(rotations[iLastLast], rotation, rate),
-                                   rotations[iLast])) {
-        return false;
-      }
-      if (isScaleAnimated &&
-          !isApproximatelyEqual<3>(lerp(scales[iLastLast], scale, rate),
-                                   scales[iLast])) {
-        return false;
-      }
-      return true;
-    };
-
-    const auto replaceLastFrame = lastFrameMayBeOptOut();
-    if (replaceLastFrame) {
-      assert(!times.empty());
-      times.back() = time;
-      if (isTranslationAnimated) {
-        translations.back() = translation;
-      }
-      if (isRotationAnimated) {
-        rotations.back() = rotation;
-      }
-      if (isScaleAnimated) {
-        scales.back() = scale;
-      }
-    } else {
-      times.push_back(time);
-      if (isTranslationAnimated) {
-        translations.push_back(translation);
-      }
-      if (isRotationAnimated) {
-        rotations.push_back(rotation);
-      }
-      if (isScaleAnimated) {
-        scales.push_back(scale);
+      // Keep neighbours in the same hemisphere so that the keys left
+      // interpolate along the shorter arc.
+      if (iFrame != 0 && dot4(rotations[iFrame - 1], rotation) < 0.0) {
+        for (int i = 0; i < 4; ++i) {
+          rotation[i] = -rotation[i];
+        }
       }
     }
+    const auto keys = reduceKeyframes(
+        curve.times, tolerance.rotation * std::numbers::pi / 180.0,
+        [&rotations](std::size_t from_, std::size_t to_, std::size_t at_,
+                     double rate_) {
+          return angleBetween(slerp(rotations[from_], rotations[to_], rate_),
+                              rotations[at_]);
+        });
+    keepKeyframes(keys, curve.times, rotations);
   }
+  if (isScaleAnimated) {
+    auto &curve = trsAnimation.scale.emplace();
+    curve.times = times;
+    auto &scales = curve.values;
+    scales.resize(localTransforms.size());
+    std::transform(localTransforms.begin(), localTransforms.end(),
+                   scales.begin(),
+                   [](const fbxsdk::FbxAMatrix &local_transform_) {
+                     return local_transform_.GetS();
+                   });
+    const auto keys = reduceKeyframes(
+        curve.times, tolerance.scale,
+        [&scales](std::size_t from_, std::size_t to_, std::size_t at_,
+                  double rate_) {
+          return maxDifference3(lerp(scales[from_], scales[to_], rate_),
+                                scales[at_]);
+        });
+    keepKeyframes(keys, curve.times, scales);
+  }
+  return trsAnimation;
+}
+
+void SceneConverter::_writeTrsAnimation(fx::gltf::Animation &glTF_animation_,
+                                        const fbxsdk::FbxNode &fbx_node_,
+                                        const TrsAnimation &trs_animation_) {
+  const auto glTFNodeIndex = trs_animation_.glTFNodeIndex;
+  const auto &tolerance = _options.animationTolerance;
 
-  auto timeAccessorIndex =
-      _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Scalar,
-                                  fx::gltf::Accessor::ComponentType::Float,
-                                  DirectSpreader<decltype(times)::value_type>>(
-          times, 0, 0, true);
-  _glTFBuilder.get(&fx::gltf::Document::accessors)[timeAccessorIndex].name =
-      fmt::format("{}/Trs/Input", fbx_node_.GetName());
-  auto addChannel = [timeAccessorIndex, &glTF_animation_, glTFNodeIndex, this,
+  auto addChannel = [&glTF_animation_, glTFNodeIndex, this,
                      &fbx_node_](std::string_view path_,
+                                 std::uint32_t time_accessor_index_,
                                  std::uint32_t value_accessor_index_) {
-    _glTFBuilder.get(&fx::gltf::Document::accessors)[value_accessor_index_]
-        .name = fmt::format("{}/{}/Output", fbx_node_.GetName(), path_);
+    if (_namesBufferObjects()) {
+      _glTFBuilder.get(&fx::gltf::Document::accessors)[value_accessor_index_]
+          .name = fmt::format("{}/{}/Output", fbx_node_.GetName(), path_);
+    }
     fx::gltf::Animation::Sampler sampler;
-    sampler.input = timeAccessorIndex;
+    sampler.input = time_accessor_index_;
     sampler.output = value_accessor_index_;
     auto samplerIndex = glTF_animation_.samplers.size();
     glTF_animation_.samplers.emplace_back(std::move(sampler));
     fx::gltf::Animation::Channel channel;
-    channel.target.node = *glTFNodeIndex;
+    channel.target.node = glTFNodeIndex;
     channel.target.path = path_;
     channel.sampler = static_cast<std::int32_t>(samplerIndex);
     glTF_animation_.channels.push_back(channel);
   };
 
-  using ComponentType =
-      GLTFComponentTypeStorage<fx::gltf::Accessor::ComponentType::Float>;
-  if (isTranslationAnimated) {
-    auto valueAccessorIndex =
-        _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec3,
-                                    fx::gltf::Accessor::ComponentType::Float,
-                                    FbxVec3Spreader>(translations, 0, 0);
-    addChannel("translation", valueAccessorIndex);
+  // A channel reduced to a single key is not needed if that key is the
+  // node's own value.
+  const auto &glTFNode =
+      _glTFBuilder.get(&fx::gltf::Document::nodes)[glTFNodeIndex];
+  const auto &restT = glTFNode.translation;
+  const auto &restR = glTFNode.rotation;
+  const auto &restS = glTFNode.scale;
+
+  if (const auto &translation = trs_animation_.translation;
+      translation &&
+      !(translation->values.size() == 1 &&
+        distance3(translation->values.front(),
+                  fbxsdk::FbxVector4{restT[0], restT[1], restT[2]}) <=
+            tolerance.translation)) {
+    const auto timeAccessorIndex =
+        _getAnimationTimeAccessor(glTF_animation_, translation->times);
+    auto valueAccessorIndex = _glTFBuilder.createAccessor<
+        fx::gltf::Accessor::Type::Vec3,
+        fx::gltf::Accessor::ComponentType::Float, FbxVec3Spreader>(
+        translation->values, 0, _animationBuffer);
+    addChannel("translation", timeAccessorIndex, valueAccessorIndex);
   }
-  if (isRotationAnimated) {
+  if (const auto &rotation = trs_animation_.rotation;
+      rotation &&
+      !(rotation->values.size() == 1 &&
+        angleBetween(rotation->values.front(),
+                     fbxsdk::FbxQuaternion{restR[0], restR[1], restR[2],
+                                           restR[3]}) <=
+            tolerance.rotation * std::numbers::pi / 180.0)) {
+    const auto timeAccessorIndex =
+        _getAnimationTimeAccessor(glTF_animation_, rotation->times);
+    const auto rotationBits = _options.animationQuantization
+                                  ? _options.animationQuantization->rotationBits
+                                  : 0;
     auto valueAccessorIndex =
-        _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec4,
-                                    fx::gltf::Accessor::ComponentType::Float,
-                                    FbxQuatSpreader>(rotations, 0, 0);
-    addChannel("rotation", valueAccessorIndex);
+        createQuantizedOutput<fx::gltf::Accessor::Type::Vec4,
+                              fx::gltf::Accessor::ComponentType::Byte,
+                              fx::gltf::Accessor::ComponentType::Short,
+                              FbxQuatSpreader>(
+            _glTFBuilder, rotation->values, rotationBits,
+            tolerance.rotation * std::numbers::pi / 180.0,
+            [](const fbxsdk::FbxQuaternion &rotation_,
+               const std::array<fbxsdk::FbxDouble, 4> &restored_) {
+              fbxsdk::FbxQuaternion restored{restored_[0], restored_[1],
+                                             restored_[2], restored_[3]};
+              restored.Normalize();
+              return angleBetween(rotation_, restored);
+            },
+            _animationBuffer);
+    if (!valueAccessorIndex) {
+      valueAccessorIndex =
+          _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec4,
+                                      fx::gltf::Accessor::ComponentType::Float,
+                                      FbxQuatSpreader>(rotation->values, 0,
+                                                       _animationBuffer);
+    }
+    addChannel("rotation", timeAccessorIndex, *valueAccessorIndex);
   }
-  if (isScaleAnimated) {
+  if (const auto &scale = trs_animation_.scale;
+      scale && !(scale->values.size() == 1 &&
+                 maxDifference3(scale->values.front(),
+                                fbxsdk::FbxVector4{restS[0], restS[1],
+                                                   restS[2]}) <=
+                     tolerance.scale)) {
+    const auto timeAccessorIndex =
+        _getAnimationTimeAccessor(glTF_animation_, scale->times);
     auto valueAccessorIndex =
         _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec3,
                                     fx::gltf::Accessor::ComponentType::Float,
-                                    FbxVec3Spreader>(scales, 0, 0);
-    addChannel("scale", valueAccessorIndex);
+                                    FbxVec3Spreader>(scale->values, 0,
+                                                     _animationBuffer);
+    addChannel("scale", timeAccessorIndex, valueAccessorIndex);
   }
 }
 } // namespace bee
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include <bee/Convert/SceneConverter.h>
+#include <bee/Convert/fbxsdk/Spreader.h>
+#include <fmt/format.h>
+
+namespace bee {
+namespace {
+fbxsdk::FbxAMatrix getTrs(const fx::gltf::Node &glTF_node_) {
+  const auto &t = glTF_node_.translation;
+  const auto &r = glTF_node_.rotation;
+  const auto &s = glTF_node_.scale;
+  fbxsdk::FbxAMatrix trs;
+  trs.SetTQS(fbxsdk::FbxVector4{t[0], t[1], t[2]},
+             fbxsdk::FbxQuaternion{r[0], r[1], r[2], r[3]},
+             fbxsdk::FbxVector4{s[0], s[1], s[2]});
+  return trs;
+}
+
+bool hasTrsOnly(const fx::gltf::Node &glTF_node_) {
+  return glTF_node_.camera < 0 && glTF_node_.skin < 0 &&
+         glTF_node_.matrix == fx::gltf::defaults::IdentityMatrix &&
+         glTF_node_.weights.empty() && glTF_node_.extensionsAndExtras.empty();
+}
+
+/// <summary>
+/// The buffer holding the vertices of the mesh, where its instance
+/// attributes go too, see `ConvertOptions::bufferPartitioning`.
+/// </summary>
+std::uint32_t getMeshBuffer(const fx::gltf::Document &glTF_document_,
+                            std::int32_t glTF_mesh_index_) {
+  for (const auto &glTFPrimitive :
+       glTF_document_.meshes[glTF_mesh_index_].primitives) {
+    const auto rPosition = glTFPrimitive.attributes.find("POSITION");
+    if (rPosition == glTFPrimitive.attributes.end()) {
+      continue;
+    }
+    const auto &glTFAccessor = glTF_document_.accessors[rPosition->second];
+    if (glTFAccessor.bufferView >= 0) {
+      return glTF_document_.bufferViews[glTFAccessor.bufferView].buffer;
+    }
+  }
+  return 0;
+}
+} // namespace
+
+void SceneConverter::_instanceSiblingNodes() {
+  auto &document = _glTFBuilder.document();
+  auto &glTFNodes = document.nodes;
+  const auto nNodes = glTFNodes.size();
+
+  // Nodes referenced other than as a child keep their index.
+  std::vector<bool> pinned(nNodes, false);
+  for (const auto &glTFSkin : document.skins) {
+    for (const auto joint : glTFSkin.joints) {
+      pinned[joint] = true;
+    }
+    if (glTFSkin.skeleton >= 0) {
+      pinned[glTFSkin.skeleton] = true;
+    }
+  }
+  for (const auto &glTFAnimation : document.animations) {
+    for (const auto &glTFChannel : glTFAnimation.channels) {
+      if (glTFChannel.target.node >= 0) {
+        pinned[glTFChannel.target.node] = true;
+      }
+    }
+  }
+
+  // The mesh drawn by a node and where, if the node may be an instance: it's
+  // either a leaf holding the mesh or a node whose single child is, like a
+  // node and the child restoring its quantized positions.
+  const auto getInstance = [&](std::int32_t glTF_node_index_)
+      -> std::optional<std::pair<std::int32_t, fbxsdk::FbxAMatrix>> {
+    const auto &glTFNode = glTFNodes[glTF_node_index_];
+    if (pinned[glTF_node_index_] || !hasTrsOnly(glTFNode)) {
+      return {};
+    }
+    if (glTFNode.mesh >= 0) {
+      if (!glTFNode.children.empty()) {
+        return {};
+      }
+      return std::make_pair(glTFNode.mesh, getTrs(glTFNode));
+    }
+    if (glTFNode.children.size() != 1) {
+      return {};
+    }
+    const auto glTFChildIndex = glTFNode.children.front();
+    const auto &glTFChild = glTFNodes[glTFChildIndex];
+    // A rotated child would make the product no longer a TRS.
+    if (pinned[glTFChildIndex] || !hasTrsOnly(glTFChild) ||
+        glTFChild.mesh < 0 || !glTFChild.children.empty() ||
+        glTFChild.rotation != fx::gltf::defaults::IdentityRotation) {
+      return {};
+    }
+    return std::make_pair(glTFChild.mesh,
+                          getTrs(glTFNode) * getTrs(glTFChild));
+  };
+
+  std::vector<bool> removed(nNodes, false);
+  std::uint32_t nCollapsed = 0;
+  const auto collapseSiblings = [&](std::vector<std::int32_t> &siblings_) {
+    std::map<std::int32_t, std::vector<std::size_t>> meshSiblings;
+    std::vector<std::optional<fbxsdk::FbxAMatrix>> transforms(
+        siblings_.size());
+    for (std::size_t iSibling = 0; iSibling < siblings_.size(); ++iSibling) {
+      if (auto instance = getInstance(siblings_[iSibling])) {
+        meshSiblings[instance->first].push_back(iSibling);
+        transforms[iSibling] = instance->second;
+      }
+    }
+
+    for (const auto &[glTFMeshIndex, iSiblings] : meshSiblings) {
+      if (iSiblings.size() < 2) {
+        continue;
+      }
+
+      std::vector<fbxsdk::FbxVector4> translations;
+      std::vector<fbxsdk::FbxQuaternion> rotations;
+      std::vector<fbxsdk::FbxVector4> scales;
+      for (const auto iSibling : iSiblings) {
+        const auto &transform = *transforms[iSibling];
+        translations.push_back(transform.GetT());
+        rotations.push_back(transform.GetQ());
+        scales.push_back(transform.GetS());
+      }
+
+      // The first instance holds them all; the others go away.
+      const auto glTFNodeIndex = siblings_[iSiblings.front()];
+      for (const auto iSibling : iSiblings) {
+        const auto glTFSiblingIndex = siblings_[iSibling];
+        for (const auto glTFChildIndex : glTFNodes[glTFSiblingIndex].children) {
+          removed[glTFChildIndex] = true;
+        }
+        if (glTFSiblingIndex != glTFNodeIndex) {
+          removed[glTFSiblingIndex] = true;
+        }
+      }
+
+      auto &glTFNode = glTFNodes[glTFNodeIndex];
+      glTFNode.mesh = glTFMeshIndex;
+      glTFNode.children.clear();
+      glTFNode.translation = fx::gltf::defaults::NullVec3;
+      glTFNode.rotation = fx::gltf::defaults::IdentityRotation;
+      glTFNode.scale = fx::gltf::defaults::IdentityVec3;
+      const auto glTFBufferIndex = getMeshBuffer(document, glTFMeshIndex);
+      auto &attributes = glTFNode.extensionsAndExtras["extensions"]
+                                                     ["EXT_mesh_gpu_instancing"]
+                                                     ["attributes"];
+      attributes["TRANSLATION"] =
+          _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec3,
+                                      fx::gltf::Accessor::ComponentType::Float,
+                                      FbxVec3Spreader>(
+              translations, 0, glTFBufferIndex);
+      attributes["ROTATION"] =
+          _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec4,
+                                      fx::gltf::Accessor::ComponentType::Float,
+                                      FbxQuatSpreader>(
+              rotations, 0, glTFBufferIndex);
+      attributes["SCALE"] =
+          _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec3,
+                                      fx::gltf::Accessor::ComponentType::Float,
+                                      FbxVec3Spreader>(
+              scales, 0, glTFBufferIndex);
+      nCollapsed += static_cast<std::uint32_t>(iSiblings.size());
+    }
+
+    std::erase_if(siblings_, [&](std::int32_t glTF_node_index_) {
+      return removed[glTF_node_index_];
+    });
+  };
+
+  for (auto &glTFScene : document.scenes) {
+    collapseSiblings(glTFScene.nodes);
+  }
+  for (std::size_t iNode = 0; iNode < nNodes; ++iNode) {
+    if (!removed[iNode]) {
+      collapseSiblings(glTFNodes[iNode].children);
+    }
+  }
+  if (nCollapsed == 0) {
+    return;
+  }
+  _glTFBuilder.useExtension("EXT_mesh_gpu_instancing", true);
+
+  // Removed nodes are only referenced by other removed nodes.
+  std::vector<std::int32_t> newIndices(nNodes, -1);
+  std::int32_t nKeptNodes = 0;
+  for (std::size_t iNode = 0; iNode < nNodes; ++iNode) {
+    if (!removed[iNode]) {
+      newIndices[iNode] = nKeptNodes++;
+      if (static_cast<std::size_t>(newIndices[iNode]) != iNode) {
+        glTFNodes[newIndices[iNode]] = std::move(glTFNodes[iNode]);
+      }
+    }
+  }
+  glTFNodes.resize(nKeptNodes);
+  for (auto &glTFNode : glTFNodes) {
+    for (auto &child : glTFNode.children) {
+      child = newIndices[child];
+    }
+  }
+  for (auto &glTFScene : document.scenes) {
+    for (auto &node : glTFScene.nodes) {
+      node = newIndices[node];
+    }
+  }
+  for (auto &glTFSkin : document.skins) {
+    for (auto &joint : glTFSkin.joints) {
+      joint = newIndices[joint];
+    }
+    if (glTFSkin.skeleton >= 0) {
+      glTFSkin.skeleton = newIndices[glTFSkin.skeleton];
+    }
+  }
+  for (auto &glTFAnimation : document.animations) {
+    for (auto &glTFChannel : glTFAnimation.channels) {
+      if (glTFChannel.target.node >= 0) {
+        glTFChannel.target.node = newIndices[glTFChannel.target.node];
+      }
+    }
+  }
+
+  _log(Logger::Level::verbose,
+       fmt::format("{} nodes have been collapsed into instances.",
+                   nCollapsed));
+}
+} // namespace bee
@@ -1,6 +1,7 @@
 
 #include <bee/Convert/ConvertError.h>
 #include <bee/Convert/SceneConverter.h>
+#include <algorithm>
 #include <fmt/format.h>
 #include <glm/gtx/compatibility.hpp>
 #include <glm/vec3.hpp>
@@ -309,7 +310,8 @@ template <typename T_> static T_ getMetalnessFromSpecular(const T_ *specular_) {
 std::optional<GLTFBuilder::XXIndex>
 SceneConverter::_convertMaterial(fbxsdk::FbxSurfaceMaterial &fbx_material_,
                                  const MaterialUsage &material_usage_) {
-  MaterialConvertKey convertKey{fbx_material_, material_usage_};
+  MaterialConvertKey convertKey{fbx_material_, material_usage_,
+                                _getMaterialUVSets(fbx_material_)};
   auto r = _materialConvertCache.find(convertKey);
   if (r == _materialConvertCache.end()) {
     const auto glTFMaterialIndex =
@@ -327,6 +329,33 @@ SceneConverter::_convertMaterial(fbxsdk::FbxSurfaceMaterial &fbx_material_,
   return r->second;
 }
 
+const std::vector<std::string> &SceneConverter::_getMaterialUVSets(
+    const fbxsdk::FbxSurfaceMaterial &fbx_material_) {
+  const auto [rUVSets, inserted] =
+      _materialUVSets.try_emplace(fbx_material_.GetUniqueID());
+  if (!inserted) {
+    return rUVSets->second;
+  }
+  auto &uvSets = rUVSets->second;
+  for (auto fbxProperty = fbx_material_.GetFirstProperty();
+       fbxProperty.IsValid();
+       fbxProperty = fbx_material_.GetNextProperty(fbxProperty)) {
+    const auto nTextures =
+        fbxProperty.GetSrcObjectCount<fbxsdk::FbxFileTexture>();
+    for (int iTexture = 0; iTexture < nTextures; ++iTexture) {
+      const auto fbxUVSet =
+          fbxProperty.GetSrcObject<fbxsdk::FbxFileTexture>(iTexture)
+              ->UVSet.Get();
+      if (!fbxUVSet.IsEmpty() && fbxUVSet != "default") {
+        uvSets.emplace_back(static_cast<const char *>(fbxUVSet));
+      }
+    }
+  }
+  std::sort(uvSets.begin(), uvSets.end());
+  uvSets.erase(std::unique(uvSets.begin(), uvSets.end()), uvSets.end());
+  return uvSets;
+}
+
 std::optional<GLTFBuilder::XXIndex> SceneConverter::_convertLambertMaterial(
     fbxsdk::FbxSurfaceLambert &fbx_material_,
     const MaterialUsage &material_usage_) {
@@ -345,8 +374,9 @@ std::optional<GLTFBuilder::XXIndex> SceneConverter::_convertLambertMaterial(
   std::array<float, 3> transparentColor = {1.0f, 1.0f, 1.0f};
   {
     const auto fbxTransparencyFactor = fbx_material_.TransparencyFactor.Get();
-    if (const auto glTFOpacityTextureIndex = _convertTextureProperty(
-            fbx_material_.TransparentColor, material_usage_.texture_context)) {
+    if (const auto glTFOpacityTextureIndex =
+            _convertTextureProperty(fbx_material_.TransparentColor,
+                                    material_usage_.texture_context, false)) {
       forbidTextureProperty(u8"Transparent color");
     } else {
       const auto fbxTransparentColor = fbx_material_.TransparentColor.Get();
@@ -371,7 +401,7 @@ std::optional<GLTFBuilder::XXIndex> SceneConverter::_convertLambertMaterial(
           static_cast<float>(diffuseFactor);
     }
     if (const auto glTFDiffuseTexture = _convertTextureProperty(
-            fbx_material_.Diffuse, material_usage_.texture_context)) {
+            fbx_material_.Diffuse, material_usage_.texture_context, false)) {
       glTFPbrMetallicRoughness.baseColorTexture = *glTFDiffuseTexture;
     } else {
       const auto fbxDiffuseColor = fbx_material_.Diffuse.Get();
@@ -399,7 +429,7 @@ std::optional<GLTFBuilder::XXIndex> SceneConverter::_convertLambertMaterial(
   {
     const auto emissiveFactor = fbx_material_.EmissiveFactor.Get();
     if (const auto glTFEmissiveTexture = _convertTextureProperty(
-            fbx_material_.Emissive, material_usage_.texture_context)) {
+            fbx_material_.Emissive, material_usage_.texture_context, false)) {
       glTFMaterial.emissiveTexture = *glTFEmissiveTexture;
       for (int i = 0; i < 3; ++i) {
         glTFMaterial.emissiveFactor[i] = static_cast<float>(emissiveFactor);
@@ -568,7 +598,7 @@ std::optional<GLTFBuilder::XXIndex> SceneConverter::_convertUnknownMaterial(
             fbx_property_.GetSrcObject<fbxsdk::FbxFileTexture>();
         if (fbxFileTexture) {
           const auto glTFTexture = _convertFileTextureShared(
-              *fbxFileTexture, material_usage_.texture_context);
+              *fbxFileTexture, material_usage_.texture_context, false);
           if (glTFTexture) {
             return *glTFTexture;
           } else {
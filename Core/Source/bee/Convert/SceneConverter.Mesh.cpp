@@ -1,7 +1,10 @@
 
 #include <bee/Convert/ConvertError.h>
+#include <bee/Convert/IndexOptimization.h>
 #include <bee/Convert/SceneConverter.h>
+#include <bee/Convert/Triangulation.h>
 #include <bee/Convert/fbxsdk/Spreader.h>
+#include <bee/Parallel.h>
 #include <bee/UntypedVertex.h>
 #include <fmt/format.h>
 
@@ -20,85 +23,294 @@ void to_json(nlohmann::json &j_, const MultiMaterialLayersError &error_) {
   to_json(j_, static_cast<const MeshError<MultiMaterialLayersError> &>(error_));
 }
 
-template <typename Dst_, typename Src_, std::size_t N_>
-static void untypedVertexCopy(std::byte *out_, const std::byte *in_) {
-  auto in = reinterpret_cast<const Src_ *>(in_);
-  auto out = reinterpret_cast<Dst_ *>(out_);
-  for (int i = 0; i < N_; ++i) {
-    out[i] = static_cast<Dst_>(in[i]);
+void SceneConverter::_convertNodesMeshes(std::span<NodeMeshesJob> jobs_) {
+  const auto nThreads = resolveThreadCount(_options.meshThreads);
+
+  // Staged primitives are kept only until their window is committed; with a
+  // single thread, a window is a single node, as before.
+  const std::size_t windowPrimitives = nThreads == 1 ? 1 : nThreads * 4;
+
+  std::size_t iWindowBegin = 0;
+  while (iWindowBegin < jobs_.size()) {
+    auto iWindowEnd = iWindowBegin;
+    std::vector<std::pair<std::size_t, std::size_t>> stagingTasks;
+    while (iWindowEnd < jobs_.size() &&
+           (iWindowEnd == iWindowBegin ||
+            stagingTasks.size() < windowPrimitives)) {
+      auto &job = jobs_[iWindowEnd];
+      job.instanceKey = _getNodeMeshesInstanceKey(job);
+      // The first node of a key converts the meshes, the others reuse them.
+      job.instance =
+          !_nodeMeshesInstances.try_emplace(job.instanceKey).second;
+      if (!job.instance) {
+        _prepareNodeMeshes(job);
+        job.primitives.resize(job.fbxMeshes.size());
+        if (_stats) {
+          job.stagingSpans.resize(job.fbxMeshes.size());
+        }
+        for (decltype(job.fbxMeshes.size()) iFbxMesh = 0;
+             iFbxMesh < job.fbxMeshes.size(); ++iFbxMesh) {
+          stagingTasks.emplace_back(iWindowEnd, iFbxMesh);
+        }
+      }
+      ++iWindowEnd;
+    }
+
+    const auto stage = [&](std::size_t i_, std::uint32_t worker_) {
+      _checkLimits();
+      const auto [iJob, iFbxMesh] = stagingTasks[i_];
+      auto &job = jobs_[iJob];
+      const auto stagingStart = _stats ? ConvertStats::Clock::now()
+                                       : ConvertStats::Clock::time_point{};
+
+      const MeshSkinData::Influences *skinInfluences = nullptr;
+      if (job.skinData &&
+          job.skinData->meshInfluences[iFbxMesh].channelCount != 0) {
+        skinInfluences = &job.skinData->meshInfluences[iFbxMesh];
+      }
+
+      job.primitives[iFbxMesh] = _stageMeshAsPrimitives(
+          *job.fbxMeshes[iFbxMesh],
+          job.vertexTransform ? &*job.vertexTransform : nullptr,
+          job.normalTransform ? &*job.normalTransform : nullptr,
+          job.meshShapes[iFbxMesh], skinInfluences,
+          job.materialLayers[iFbxMesh]);
+      if (_stats) {
+        job.stagingSpans[iFbxMesh] = {stagingStart, ConvertStats::Clock::now(),
+                                      worker_};
+      }
+    };
+    parallelForWorkers(stagingTasks.size(), nThreads, stage);
+
+    for (auto iJob = iWindowBegin; iJob < iWindowEnd; ++iJob) {
+      _checkLimits();
+      auto &job = jobs_[iJob];
+      if (!job.instance) {
+        std::optional<ConvertStats::Mesh> meshStats;
+        if (_stats) {
+          meshStats = _countNodeMeshes(job);
+        }
+        const auto commitStart = _stats ? ConvertStats::Clock::now()
+                                        : ConvertStats::Clock::time_point{};
+        _commitNodeMeshes(job);
+        if (meshStats) {
+          const ConvertStats::Span commitSpan{commitStart,
+                                              ConvertStats::Clock::now()};
+          _stats->addEvent(job.meshName, "meshCommit", commitSpan);
+          meshStats->elapsed += commitSpan.end - commitSpan.start;
+          _stats->addMesh(std::move(*meshStats));
+        }
+      }
+      const auto &instance = *_nodeMeshesInstances.at(job.instanceKey);
+      _attachNodeMeshes(*job.fbxNode, instance);
+      _reportProgress(ConvertProgress::Stage::mesh, instance.meshName,
+                      iJob + 1, jobs_.size());
+    }
+
+    iWindowBegin = iWindowEnd;
+  }
+}
+
+SceneConverter::NodeMeshesInstanceKey
+SceneConverter::_getNodeMeshesInstanceKey(const NodeMeshesJob &job_) {
+  auto &fbxNode = *job_.fbxNode;
+
+  NodeMeshesInstanceKey key;
+  for (const auto fbxMesh : job_.fbxMeshes) {
+    key.meshes.push_back(fbxMesh->GetUniqueID());
+  }
+  if (_options.export_material) {
+    for (int iMaterial = 0; iMaterial < fbxNode.GetMaterialCount();
+         ++iMaterial) {
+      const auto fbxMaterial = fbxNode.GetMaterial(iMaterial);
+      key.materials.push_back(fbxMaterial ? fbxMaterial->GetUniqueID() : 0);
+    }
+  }
+  const auto [vertexTransform, normalTransform] =
+      _getGeometrixTransform(fbxNode);
+  for (int iRow = 0; iRow < 4; ++iRow) {
+    for (int iColumn = 0; iColumn < 4; ++iColumn) {
+      key.geometricTransform[iRow * 4 + iColumn] =
+          vertexTransform.Get(iRow, iColumn);
+    }
   }
+  return key;
 }
 
-template <typename Dst_, typename Src_>
-static std::function<void(std::byte *out_, const std::byte *in_)>
-makeUntypedVertexCopyN(std::size_t n_) {
-  return [n_](std::byte *out_, const std::byte *in_) {
-    auto in = reinterpret_cast<const Src_ *>(in_);
-    auto out = reinterpret_cast<Dst_ *>(out_);
-    for (int i = 0; i < n_; ++i) {
-      out[i] = static_cast<Dst_>(in[i]);
+ConvertStats::Mesh
+SceneConverter::_countNodeMeshes(const NodeMeshesJob &job_) {
+  ConvertStats::Mesh meshStats;
+  meshStats.name = job_.meshName;
+  for (const auto fbxMesh : job_.fbxMeshes) {
+    meshStats.polygons += std::max(fbxMesh->GetPolygonCount(), 0);
+    meshStats.polygonVertices += std::max(fbxMesh->GetPolygonVertexCount(), 0);
+  }
+  for (const auto &meshPrimitives : job_.primitives) {
+    for (const auto &stagedPrimitive : meshPrimitives) {
+      meshStats.vertices += stagedPrimitive.vertexCount;
+      meshStats.triangles += stagedPrimitive.indices.size() / 3;
     }
-  };
+  }
+  for (const auto &stagingSpan : job_.stagingSpans) {
+    _stats->addEvent(job_.meshName, "meshStaging", stagingSpan);
+    meshStats.elapsed += stagingSpan.end - stagingSpan.start;
+  }
+  return meshStats;
 }
 
-std::optional<SceneConverter::ConvertMeshResult>
-SceneConverter::_convertNodeMeshes(
-    FbxNodeDumpMeta &node_meta_,
-    const std::vector<fbxsdk::FbxMesh *> &fbx_meshes_,
-    fbxsdk::FbxNode &fbx_node_) {
-  assert(!fbx_meshes_.empty());
+void SceneConverter::_prepareNodeMeshes(NodeMeshesJob &job_) {
+  assert(!job_.fbxMeshes.empty());
+  auto &fbxNode = *job_.fbxNode;
 
-  auto meshName = _getName(*fbx_meshes_.front(), fbx_node_);
-  auto [vertexTransform, normalTransform] = _getGeometrixTransform(fbx_node_);
-  auto vertexTransformX =
-      (vertexTransform == fbxsdk::FbxMatrix{}) ? nullptr : &vertexTransform;
-  auto normalTransformX =
-      (normalTransform == fbxsdk::FbxMatrix{}) ? nullptr : &normalTransform;
+  job_.meshName = _getName(*job_.fbxMeshes.front(), fbxNode);
 
-  std::optional<NodeMeshesSkinData> nodeMeshesSkinData;
-  nodeMeshesSkinData = _extractNodeMeshesSkinData(fbx_meshes_);
+  auto [vertexTransform, normalTransform] = _getGeometrixTransform(fbxNode);
+  if (vertexTransform != fbxsdk::FbxMatrix{}) {
+    job_.vertexTransform = vertexTransform;
+  }
+  if (normalTransform != fbxsdk::FbxMatrix{}) {
+    job_.normalTransform = normalTransform;
+  }
+
+  if (_options.export_skin) {
+    job_.skinData = _extractNodeMeshesSkinData(job_.fbxMeshes);
+  }
 
-  FbxNodeMeshesBumpMeta myMeta;
   if (_options.export_blend_shape) {
-    myMeta.blendShapeMeta = _extractNodeMeshesBlendShape(fbx_meshes_);
+    job_.meta.blendShapeMeta = _extractNodeMeshesBlendShape(job_.fbxMeshes);
   }
 
-  std::optional<std::uint32_t> glTFSkinIndex;
+  job_.meshShapes.resize(job_.fbxMeshes.size());
+  if (job_.meta.blendShapeMeta) {
+    for (decltype(job_.fbxMeshes.size()) iFbxMesh = 0;
+         iFbxMesh < job_.fbxMeshes.size(); ++iFbxMesh) {
+      job_.meshShapes[iFbxMesh] =
+          job_.meta.blendShapeMeta->blendShapeDatas[iFbxMesh].getShapes();
+    }
+  }
 
-  fx::gltf::Mesh glTFMesh;
-  glTFMesh.name = meshName;
+  job_.materialLayers.resize(job_.fbxMeshes.size(), nullptr);
+  if (_options.export_material) {
+    for (decltype(job_.fbxMeshes.size()) iFbxMesh = 0;
+         iFbxMesh < job_.fbxMeshes.size(); ++iFbxMesh) {
+      job_.materialLayers[iFbxMesh] =
+          _getMaterialLayer(*job_.fbxMeshes[iFbxMesh]);
+    }
+  }
+}
 
-  for (decltype(fbx_meshes_.size()) iFbxMesh = 0; iFbxMesh < fbx_meshes_.size();
-       ++iFbxMesh) {
-    const auto fbxMesh = fbx_meshes_[iFbxMesh];
+void SceneConverter::_commitNodeMeshes(NodeMeshesJob &job_) {
+  auto &fbxNode = *job_.fbxNode;
 
-    std::vector<fbxsdk::FbxShape *> fbxShapes;
-    if (myMeta.blendShapeMeta) {
-      fbxShapes = myMeta.blendShapeMeta->blendShapeDatas[iFbxMesh].getShapes();
+  // Quantized positions of all primitives share a grid over the bounds of
+  // the mesh; a node transform restores them.
+  std::optional<std::tuple<fbxsdk::FbxVector4, double>> dequantization;
+  std::vector<StagedPrimitive *> stagedPrimitives;
+  for (auto &meshPrimitives : job_.primitives) {
+    for (auto &stagedPrimitive : meshPrimitives) {
+      stagedPrimitives.push_back(&stagedPrimitive);
+    }
+  }
+  if (std::any_of(stagedPrimitives.begin(), stagedPrimitives.end(),
+                  [](const StagedPrimitive *staged_primitive_) {
+                    return staged_primitive_->positionQuantizationBits
+                        .has_value();
+                  })) {
+    fbxsdk::FbxVector4 min{std::numeric_limits<double>::infinity(),
+                           std::numeric_limits<double>::infinity(),
+                           std::numeric_limits<double>::infinity()};
+    fbxsdk::FbxVector4 max{-std::numeric_limits<double>::infinity(),
+                           -std::numeric_limits<double>::infinity(),
+                           -std::numeric_limits<double>::infinity()};
+    for (const auto stagedPrimitive : stagedPrimitives) {
+      const auto bounds = computeUntypedBounds(
+          stagedPrimitive->vertices.get(), stagedPrimitive->vertexSize,
+          stagedPrimitive->vertexCount, 0, 3);
+      for (int i = 0; i < 3; ++i) {
+        min[i] = std::min(min[i], static_cast<double>(bounds.min[i]));
+        max[i] = std::max(max[i], static_cast<double>(bounds.max[i]));
+      }
+    }
+    const auto center = (min + max) * 0.5;
+    auto halfExtent = std::max({max[0] - center[0], max[1] - center[1],
+                                max[2] - center[2]});
+    if (!(halfExtent > 0.0) || !std::isfinite(halfExtent)) {
+      halfExtent = 1.0;
     }
 
-    std::span<MeshSkinData::InfluenceChannel> skinInfluenceChannels;
-    if (nodeMeshesSkinData) {
-      skinInfluenceChannels = nodeMeshesSkinData->meshChannels[iFbxMesh];
+    for (const auto stagedPrimitive : stagedPrimitives) {
+      if (!stagedPrimitive->positionQuantizationBits) {
+        continue;
+      }
+      const auto bits =
+          std::clamp(*stagedPrimitive->positionQuantizationBits, 2u, 16u);
+      const auto gridMax = static_cast<double>((1u << (bits - 1)) - 1);
+      const auto typeMax = bits <= 8 ? 127.0 : 32767.0;
+      // position = stored / typeMax * scale + center
+      const auto scale = halfExtent * typeMax / gridMax;
+      dequantization.emplace(center, scale);
+
+      for (auto &bulk : stagedPrimitive->bulks) {
+        for (auto &channel : bulk.channels) {
+          if (channel.name != "POSITION") {
+            continue;
+          }
+          auto &transform = channel.transform.emplace();
+          if (!channel.target) {
+            for (int i = 0; i < 3; ++i) {
+              transform.offset[i] = static_cast<float>(-center[i]);
+              transform.scale[i] = static_cast<float>(gridMax / halfExtent);
+            }
+          } else {
+            transform.scale.fill(static_cast<float>(1.0 / scale));
+          }
+        }
+      }
     }
+  }
 
-    MaterialUsage materialUsage;
-    auto glTFPrimitive = _convertMeshAsPrimitive(
-        *fbxMesh, meshName, vertexTransformX, normalTransformX, fbxShapes,
-        skinInfluenceChannels, materialUsage);
+  if (_options.bufferPartitioning.perMesh) {
+    // Buffers left empty, for a mesh without morph target, are dropped.
+    _geometryBuffer = _glTFBuilder.createBuffer(job_.meshName);
+    _morphTargetBuffer = _geometryBuffer;
+    if (_options.bufferPartitioning.morphTargets) {
+      _morphTargetBuffer =
+          _glTFBuilder.createBuffer(job_.meshName + "/morphTargets");
+    }
+  }
 
-    if (auto fbxMaterial = _getTheUniqueMaterial(*fbxMesh, fbx_node_)) {
-      if (auto glTFMaterialIndex =
-              _convertMaterial(*fbxMaterial, materialUsage)) {
-        glTFPrimitive.material = *glTFMaterialIndex;
+  fx::gltf::Mesh glTFMesh;
+  glTFMesh.name = job_.meshName;
+
+  for (decltype(job_.fbxMeshes.size()) iFbxMesh = 0;
+       iFbxMesh < job_.fbxMeshes.size(); ++iFbxMesh) {
+    for (auto &stagedPrimitive : job_.primitives[iFbxMesh]) {
+      auto glTFPrimitive = _createPrimitive(
+          stagedPrimitive.bulks,
+          static_cast<std::uint32_t>(job_.meshShapes[iFbxMesh].size()),
+          stagedPrimitive.vertexCount, stagedPrimitive.vertices.get(),
+          stagedPrimitive.vertexSize, stagedPrimitive.indices, job_.meshName);
+      _createMorphTargets(glTFPrimitive, stagedPrimitive, job_.meshName);
+      _glTFBuilder.flush();
+
+      if (stagedPrimitive.materialIndex >= 0) {
+        if (auto fbxMaterial =
+                fbxNode.GetMaterial(stagedPrimitive.materialIndex)) {
+          if (auto glTFMaterialIndex = _convertMaterial(
+                  *fbxMaterial, stagedPrimitive.materialUsage)) {
+            glTFPrimitive.material = *glTFMaterialIndex;
+          }
+        }
       }
+
+      glTFMesh.primitives.emplace_back(std::move(glTFPrimitive));
     }
 
-    glTFMesh.primitives.emplace_back(std::move(glTFPrimitive));
+    job_.primitives[iFbxMesh] = {};
   }
 
-  if (myMeta.blendShapeMeta &&
-      !myMeta.blendShapeMeta->blendShapeDatas.empty()) {
+  if (job_.meta.blendShapeMeta &&
+      !job_.meta.blendShapeMeta->blendShapeDatas.empty()) {
     // https://github.com/KhronosGroup/glTF/tree/master/specification/2.0#morph-targets
     // > Implementation note: A significant number of authoring and client
     // implementations associate names with morph targets. > While the
@@ -107,24 +319,49 @@ SceneConverter::_convertNodeMeshes(
     // mesh.extras.targetNames, for this purpose. The targetNames array
     // and all primitive targets arrays must have the same length.
     const auto fbxShapeNames =
-        myMeta.blendShapeMeta->blendShapeDatas.front().getShapeNames();
+        job_.meta.blendShapeMeta->blendShapeDatas.front().getShapeNames();
     glTFMesh.extensionsAndExtras["extras"]["targetNames"] = fbxShapeNames;
   }
 
-  const auto glTFMeshIndex =
+  NodeMeshesInstance instance;
+  instance.meshName = job_.meshName;
+  instance.glTFMeshIndex =
       _glTFBuilder.add(&fx::gltf::Document::meshes, std::move(glTFMesh));
-
-  ConvertMeshResult convertMeshResult;
-  convertMeshResult.glTFMeshIndex = glTFMeshIndex;
-  if (nodeMeshesSkinData) {
-    const auto glTFSkinIndex = _createGLTFSkin(*nodeMeshesSkinData);
-    convertMeshResult.glTFSkinIndex = glTFSkinIndex;
+  if (job_.skinData) {
+    instance.glTFSkinIndex = _createGLTFSkin(*job_.skinData);
   }
+  instance.dequantization = dequantization;
+  instance.meta = std::move(job_.meta);
+  instance.meta.meshes = job_.fbxMeshes;
+  _nodeMeshesInstances.at(job_.instanceKey) = std::move(instance);
+}
 
-  myMeta.meshes = fbx_meshes_;
-  node_meta_.meshes = myMeta;
-
-  return convertMeshResult;
+void SceneConverter::_attachNodeMeshes(fbxsdk::FbxNode &fbx_node_,
+                                       const NodeMeshesInstance &instance_) {
+  auto &nodeMeta = _nodeDumpMetaMap.at(&fbx_node_);
+  nodeMeta.meshes = instance_.meta;
+
+  if (instance_.dequantization) {
+    const auto &[center, scale] = *instance_.dequantization;
+    fx::gltf::Node glTFMeshNode;
+    glTFMeshNode.name = instance_.meshName;
+    glTFMeshNode.mesh = instance_.glTFMeshIndex;
+    FbxVec3Spreader::spread(center, glTFMeshNode.translation.data());
+    glTFMeshNode.scale.fill(static_cast<float>(scale));
+    const auto glTFMeshNodeIndex =
+        _glTFBuilder.add(&fx::gltf::Document::nodes, std::move(glTFMeshNode));
+    _glTFBuilder.get(&fx::gltf::Document::nodes)[nodeMeta.glTFNodeIndex]
+        .children.push_back(glTFMeshNodeIndex);
+    nodeMeta.glTFMeshNodeIndex = glTFMeshNodeIndex;
+  } else {
+    auto &glTFNode =
+        _glTFBuilder.get(&fx::gltf::Document::nodes)[nodeMeta.glTFNodeIndex];
+    glTFNode.mesh = instance_.glTFMeshIndex;
+  }
+  if (instance_.glTFSkinIndex) {
+    _glTFBuilder.get(&fx::gltf::Document::nodes)[nodeMeta.glTFNodeIndex].skin =
+        *instance_.glTFSkinIndex;
+  }
 }
 
 std::string SceneConverter::_getName(fbxsdk::FbxMesh &fbx_mesh_,
@@ -153,33 +390,85 @@ SceneConverter::_getGeometrixTransform(fbxsdk::FbxNode &fbx_node_) {
   return {vertexTransform, normalTransformIT};
 }
 
-fx::gltf::Primitive SceneConverter::_convertMeshAsPrimitive(
+std::vector<SceneConverter::StagedPrimitive>
+SceneConverter::_stageMeshAsPrimitives(
     fbxsdk::FbxMesh &fbx_mesh_,
-    std::string_view mesh_name_,
-    fbxsdk::FbxMatrix *vertex_transform_,
-    fbxsdk::FbxMatrix *normal_transform_,
+    const fbxsdk::FbxMatrix *vertex_transform_,
+    const fbxsdk::FbxMatrix *normal_transform_,
     std::span<fbxsdk::FbxShape *> fbx_shapes_,
-    std::span<MeshSkinData::InfluenceChannel> skin_influence_channels_,
-    MaterialUsage &material_usage_) {
-  const auto vertexLayout =
-      _getFbxMeshVertexLayout(fbx_mesh_, fbx_shapes_, skin_influence_channels_);
-  material_usage_.texture_context.channel_index_map =
-      vertexLayout.uv_channel_index_map;
-
-  const auto vertexSize = vertexLayout.size;
-
+    const MeshSkinData::Influences *skin_influences_,
+    const fbxsdk::FbxLayerElementMaterial *material_layer_) {
   using UniqueVertexIndex = std::uint32_t;
 
-  UntypedVertexVector untypedVertexAllocator{vertexSize};
-  std::unordered_map<UntypedVertex, UniqueVertexIndex, UntypedVertexHasher,
-                     UntypedVertexEqual>
-      uniqueVertices({}, 0, UntypedVertexHasher{},
-                     UntypedVertexEqual{vertexSize});
-  bool hasTransparentVertex = false;
-
   const auto nMeshPolygonVertices = fbx_mesh_.GetPolygonVertexCount();
+
   const auto meshPolygonVertices = fbx_mesh_.GetPolygonVertices();
+  const auto nControlPoints = fbx_mesh_.GetControlPointsCount();
   const auto controlPoints = fbx_mesh_.GetControlPoints();
+
+  // Positions and shape deltas only depend on the control point. They're
+  // transformed once per control point here, rather than once per polygon
+  // vertex, and then only copied into the staging vertices.
+  std::vector<NeutralVertexComponent> transformedPositions(
+      static_cast<std::size_t>(nControlPoints) * 3);
+  std::vector<std::vector<NeutralVertexComponent>> transformedShapeDeltas(
+      fbx_shapes_.size());
+  // Whether the position deltas of each shape are staged in the vertices.
+  // Those of shapes that move few control points are only kept by control
+  // point: they would mostly stage zeros otherwise.
+  std::vector<bool> stagedShapes(fbx_shapes_.size(), true);
+  {
+    std::vector<fbxsdk::FbxVector4> basePositions(nControlPoints);
+    for (std::remove_const_t<decltype(nControlPoints)> iControlPoint = 0;
+         iControlPoint < nControlPoints; ++iControlPoint) {
+      auto position = _applyUnitScaleFactorV3(controlPoints[iControlPoint]);
+      if (vertex_transform_) {
+        position = vertex_transform_->MultNormalize(position);
+      }
+      basePositions[iControlPoint] = position;
+      FbxVec3Spreader::spread(position,
+                              transformedPositions.data() + 3 * iControlPoint);
+    }
+
+    for (decltype(fbx_shapes_.size()) iShape = 0; iShape < fbx_shapes_.size();
+         ++iShape) {
+      const auto shapeControlPoints = fbx_shapes_[iShape]->GetControlPoints();
+      auto &shapeDeltas = transformedShapeDeltas[iShape];
+      std::remove_const_t<decltype(nControlPoints)> nMovedControlPoints = 0;
+      shapeDeltas.resize(static_cast<std::size_t>(nControlPoints) * 3);
+      for (std::remove_const_t<decltype(nControlPoints)> iControlPoint = 0;
+           iControlPoint < nControlPoints; ++iControlPoint) {
+        auto shapePosition =
+            _applyUnitScaleFactorV3(shapeControlPoints[iControlPoint]);
+        if (vertex_transform_) {
+          shapePosition = vertex_transform_->MultNormalize(shapePosition);
+        }
+        const auto shapeDiff = shapePosition - basePositions[iControlPoint];
+        const auto pDelta = shapeDeltas.data() + 3 * iControlPoint;
+        FbxVec3Spreader::spread(shapeDiff, pDelta);
+        if (pDelta[0] != 0.0f || pDelta[1] != 0.0f || pDelta[2] != 0.0f) {
+          ++nMovedControlPoints;
+        }
+      }
+      stagedShapes[iShape] = nMovedControlPoints * 4 > nControlPoints;
+    }
+  }
+
+  const auto vertexLayout = _getFbxMeshVertexLayout(
+      fbx_mesh_, fbx_shapes_, skin_influences_, stagedShapes);
+
+  const auto vertexSize = vertexLayout.size;
+
+  UntypedVertexVector untypedVertexAllocator{vertexSize};
+  // One more for the staging vertex.
+  untypedVertexAllocator.reserve(
+      static_cast<std::uint32_t>(std::max(nMeshPolygonVertices, 0)) + 1);
+  UntypedVertexDedup uniqueVertices{
+      untypedVertexAllocator, vertexSize,
+      static_cast<std::size_t>(std::max(nMeshPolygonVertices, 0))};
+  // Whether each unique vertex has a transparent color.
+  std::vector<bool> transparentVertices;
+
   auto stagingVertex = untypedVertexAllocator.allocate();
   const auto processPolygonVertex =
       [&](const FbxLayerElementAccessParams &vertex_access_params_)
@@ -187,24 +476,17 @@ fx::gltf::Primitive SceneConverter::_convertMeshAsPrimitive(
     const auto iControlPoint = vertex_access_params_.controlPointIndex;
     auto [stagingVertexData, stagingVertexIndex] = stagingVertex;
 
-    fbxsdk::FbxVector4 transformedBasePosition;
     fbxsdk::FbxVector4 transformedBaseNormal;
+    bool transparent = false;
 
     // Position
-    {
-      auto position = _applyUnitScaleFactorV3(controlPoints[iControlPoint]);
-      if (vertex_transform_) {
-        position = vertex_transform_->MultNormalize(position);
-      }
-      transformedBasePosition = position;
-      auto pPosition =
-          reinterpret_cast<NeutralVertexComponent *>(stagingVertexData);
-      FbxVec3Spreader::spread(position, pPosition);
-    }
+    std::memcpy(stagingVertexData,
+                transformedPositions.data() + 3 * iControlPoint,
+                sizeof(NeutralVertexComponent) * 3);
 
     // Normal
     if (vertexLayout.normal) {
-      auto [offset, element] = *vertexLayout.normal;
+      const auto &[offset, element] = *vertexLayout.normal;
       auto normal = element(vertex_access_params_);
       if (normal_transform_) {
         normal = normal_transform_->MultNormalize(normal);
@@ -216,7 +498,7 @@ fx::gltf::Primitive SceneConverter::_convertMeshAsPrimitive(
     }
 
     // UV
-    for (auto [offset, element] : vertexLayout.uvs) {
+    for (const auto &[offset, element] : vertexLayout.uvs) {
       auto uv = element(vertex_access_params_);
       if (!_options.noFlipV) {
         uv[1] = 1.0 - uv[1];
@@ -227,10 +509,10 @@ fx::gltf::Primitive SceneConverter::_convertMeshAsPrimitive(
     }
 
     // Vertex color
-    for (auto [offset, element] : vertexLayout.colors) {
+    for (const auto &[offset, element] : vertexLayout.colors) {
       auto color = element(vertex_access_params_);
-      if (!hasTransparentVertex && color.mAlpha != 1.0) {
-        hasTransparentVertex = true;
+      if (color.mAlpha != 1.0) {
+        transparent = true;
       }
       auto pColor = reinterpret_cast<NeutralVertexColorComponent *>(
           stagingVertexData + offset);
@@ -244,30 +526,31 @@ fx::gltf::Primitive SceneConverter::_convertMeshAsPrimitive(
           stagingVertexData + jointsOffset);
       auto pWeights = reinterpret_cast<NeutralVertexWeightComponent *>(
           stagingVertexData + weightsOffset);
-      for (decltype(nChannels) iChannel = 0; iChannel < nChannels; ++iChannel) {
-        pJoints[iChannel] =
-            skin_influence_channels_[iChannel].joints[iControlPoint];
-        pWeights[iChannel] =
-            skin_influence_channels_[iChannel].weights[iControlPoint];
-      }
+      const auto iFirstInfluence =
+          static_cast<std::size_t>(iControlPoint) * nChannels;
+      std::memcpy(pJoints, skin_influences_->joints.data() + iFirstInfluence,
+                  sizeof(NeutralVertexJointComponent) * nChannels);
+      std::memcpy(pWeights, skin_influences_->weights.data() + iFirstInfluence,
+                  sizeof(NeutralVertexWeightComponent) * nChannels);
     }
 
     // Shapes
-    for (auto &[controlPoints, normalElement] : vertexLayout.shapes) {
-      {
-        auto shapePosition =
-            _applyUnitScaleFactorV3(controlPoints.element[iControlPoint]);
-        if (vertex_transform_) {
-          shapePosition = vertex_transform_->MultNormalize(shapePosition);
-        }
-        auto shapeDiff = shapePosition - transformedBasePosition;
-        auto pPosition = reinterpret_cast<NeutralVertexComponent *>(
-            stagingVertexData + controlPoints.offset);
-        FbxVec3Spreader::spread(shapeDiff, pPosition);
+    if (vertexLayout.controlPointIndex) {
+      const auto controlPointIndex = static_cast<std::uint32_t>(iControlPoint);
+      std::memcpy(stagingVertexData + *vertexLayout.controlPointIndex,
+                  &controlPointIndex, sizeof(controlPointIndex));
+    }
+    for (decltype(vertexLayout.shapes.size()) iShape = 0;
+         iShape < vertexLayout.shapes.size(); ++iShape) {
+      const auto &[controlPoints, normalElement] = vertexLayout.shapes[iShape];
+      if (controlPoints) {
+        std::memcpy(stagingVertexData + controlPoints->offset,
+                    transformedShapeDeltas[iShape].data() + 3 * iControlPoint,
+                    sizeof(NeutralVertexComponent) * 3);
       }
 
       if (normalElement && vertexLayout.normal) {
-        auto [offset, element] = *normalElement;
+        const auto &[offset, element] = *normalElement;
         auto normal = element(vertex_access_params_);
         if (normal_transform_) {
           normal = normal_transform_->MultNormalize(normal);
@@ -279,72 +562,194 @@ fx::gltf::Primitive SceneConverter::_convertMeshAsPrimitive(
       }
     }
 
-    auto [rInserted, success] =
-        uniqueVertices.try_emplace(stagingVertexData, stagingVertexIndex);
-    auto [insertedVertex, uniqueVertexIndex] = *rInserted;
+    auto [uniqueVertexIndex, success] =
+        uniqueVertices.tryEmplace(stagingVertexIndex);
     if (success) {
       stagingVertex = untypedVertexAllocator.allocate();
+      transparentVertices.push_back(transparent);
     }
 
     return uniqueVertexIndex;
   };
 
-  std::vector<UniqueVertexIndex> indices(nMeshPolygonVertices);
-  for (std::remove_const_t<decltype(nMeshPolygonVertices)> iPolygonVertex = 0;
-       iPolygonVertex < nMeshPolygonVertices; ++iPolygonVertex) {
-    const auto iControlPoint = meshPolygonVertices[iPolygonVertex];
+  // Polygons are triangulated here, and their triangles partitioned by
+  // material, rather than by the FBX SDK on the whole scene beforehand.
+  std::optional<FbxLayerElementAccessor<int>> materialIndexAccessor;
+  if (material_layer_) {
+    materialIndexAccessor = makeLayerElementMaterialAccessor(*material_layer_);
+  }
+  std::map<int, std::vector<UniqueVertexIndex>> materialIndices;
+  std::vector<UniqueVertexIndex> polygonVertices;
+  std::vector<std::array<double, 3>> polygonPositions;
+  std::vector<std::uint32_t> polygonTriangles;
+  const auto nPolygons = fbx_mesh_.GetPolygonCount();
+  for (std::remove_const_t<decltype(nPolygons)> iPolygon = 0;
+       iPolygon < nPolygons; ++iPolygon) {
+    const auto polygonSize = fbx_mesh_.GetPolygonSize(iPolygon);
+    // Points and lines.
+    if (polygonSize < 3) {
+      continue;
+    }
+    const auto iFirstPolygonVertex = fbx_mesh_.GetPolygonVertexIndex(iPolygon);
     FbxLayerElementAccessParams params;
-    params.controlPointIndex = iControlPoint;
-    params.polygonVertexIndex = iPolygonVertex;
-    params.polygonIndex = iPolygonVertex / 3;
-    indices[iPolygonVertex] = processPolygonVertex(params);
+    params.polygonIndex = iPolygon;
+    polygonVertices.resize(polygonSize);
+    for (std::remove_const_t<decltype(polygonSize)> iCorner = 0;
+         iCorner < polygonSize; ++iCorner) {
+      const auto iPolygonVertex = iFirstPolygonVertex + iCorner;
+      params.controlPointIndex = meshPolygonVertices[iPolygonVertex];
+      params.polygonVertexIndex = iPolygonVertex;
+      polygonVertices[iCorner] = processPolygonVertex(params);
+    }
+
+    auto &indices = materialIndices[materialIndexAccessor
+                                        ? (*materialIndexAccessor)(params)
+                                        : -1];
+    if (polygonSize == 3) {
+      indices.insert(indices.end(), polygonVertices.begin(),
+                     polygonVertices.end());
+      continue;
+    }
+    polygonPositions.resize(polygonSize);
+    for (std::remove_const_t<decltype(polygonSize)> iCorner = 0;
+         iCorner < polygonSize; ++iCorner) {
+      const auto position =
+          transformedPositions.data() +
+          3 * meshPolygonVertices[iFirstPolygonVertex + iCorner];
+      polygonPositions[iCorner] = {position[0], position[1], position[2]};
+    }
+    polygonTriangles.clear();
+    triangulatePolygon(polygonPositions, polygonTriangles);
+    for (const auto iCorner : polygonTriangles) {
+      indices.push_back(polygonVertices[iCorner]);
+    }
+  }
+  // An empty mesh still gets its primitive.
+  if (materialIndices.empty()) {
+    materialIndices[-1];
   }
 
   untypedVertexAllocator.pop_back();
   const auto nUniqueVertices = untypedVertexAllocator.size();
-  auto uniqueVerticesData = untypedVertexAllocator.merge();
-
-  // Debug blend shape data
-  /*std::vector<std::vector<std::array<NeutralVertexComponent, 3>>>
-      shapePositions;
-  std::vector<std::vector<std::array<NeutralNormalComponent, 3>>>
-      shapeNormals;
-  if (!vertexLayout.shapes.empty()) {
-    shapePositions.resize(nUniqueVertices);
-    shapeNormals.resize(nUniqueVertices);
-    for (std::remove_const_t<decltype(nUniqueVertices)> iVertex = 0;
-         iVertex < nUniqueVertices; ++iVertex) {
-      shapePositions[iVertex].resize(vertexLayout.shapes.size());
-      shapeNormals[iVertex].resize(vertexLayout.shapes.size());
-      for (int iShape = 0; iShape < vertexLayout.shapes.size(); ++iShape) {
-        auto p = reinterpret_cast<NeutralVertexComponent *>(
-            uniqueVerticesData.get() + vertexLayout.size * iVertex +
-            vertexLayout.shapes[iShape].constrolPoints.offset);
-        shapePositions[iVertex][iShape] = {p[0], p[1], p[2]};
-        if (vertexLayout.shapes[iShape].normal) {
-          auto n = reinterpret_cast<NeutralNormalComponent *>(
-              uniqueVerticesData.get() + vertexLayout.size * iVertex +
-              vertexLayout.shapes[iShape].normal->offset);
-          shapeNormals[iVertex][iShape] = {n[0], n[1], n[2]};
+  auto uniqueVerticesData = untypedVertexAllocator.release();
+
+  std::vector<StagedPrimitive> stagedPrimitives;
+  for (auto rMaterial = materialIndices.begin();
+       rMaterial != materialIndices.end(); ++rMaterial) {
+    auto &[materialIndex, indices] = *rMaterial;
+    const auto isLastPrimitive = std::next(rMaterial) == materialIndices.end();
+
+    std::unique_ptr<std::byte[]> primitiveVerticesData;
+    std::uint32_t nPrimitiveVertices = 0;
+    bool hasTransparentVertex = false;
+    if (materialIndices.size() == 1) {
+      primitiveVerticesData = std::move(uniqueVerticesData);
+      nPrimitiveVertices = nUniqueVertices;
+      hasTransparentVertex =
+          std::find(transparentVertices.begin(), transparentVertices.end(),
+                    true) != transparentVertices.end();
+    } else {
+      // Each primitive only gets the vertices its triangles use.
+      constexpr auto unused = std::numeric_limits<UniqueVertexIndex>::max();
+      std::vector<UniqueVertexIndex> primitiveVertexIndices(nUniqueVertices,
+                                                            unused);
+      for (auto &index : indices) {
+        auto &primitiveVertexIndex = primitiveVertexIndices[index];
+        if (primitiveVertexIndex == unused) {
+          primitiveVertexIndex = nPrimitiveVertices++;
+        }
+        index = primitiveVertexIndex;
+      }
+      primitiveVerticesData = std::make_unique<std::byte[]>(
+          static_cast<std::size_t>(nPrimitiveVertices) * vertexSize);
+      for (std::uint32_t iVertex = 0; iVertex < nUniqueVertices; ++iVertex) {
+        const auto primitiveVertexIndex = primitiveVertexIndices[iVertex];
+        if (primitiveVertexIndex == unused) {
+          continue;
+        }
+        std::memcpy(primitiveVerticesData.get() +
+                        static_cast<std::size_t>(primitiveVertexIndex) *
+                            vertexSize,
+                    uniqueVerticesData.get() +
+                        static_cast<std::size_t>(iVertex) * vertexSize,
+                    vertexSize);
+        if (transparentVertices[iVertex]) {
+          hasTransparentVertex = true;
         }
       }
     }
-  }*/
 
-  auto bulks = _typeVertices(vertexLayout);
-  auto glTFPrimitive = _createPrimitive(
-      bulks, static_cast<std::uint32_t>(fbx_shapes_.size()), nUniqueVertices,
-      uniqueVerticesData.get(), vertexLayout.size, indices, mesh_name_);
+    if (!_options.noMeshOptimization) {
+      optimizeVertexCache(indices, nPrimitiveVertices);
+      optimizeOverdraw(indices, primitiveVerticesData.get(), vertexLayout.size,
+                       nPrimitiveVertices);
+      optimizeVertexFetch(indices, primitiveVerticesData.get(),
+                          vertexLayout.size, nPrimitiveVertices);
+    }
 
-  material_usage_.hasTransparentVertex = hasTransparentVertex;
+    // Debug blend shape data
+    /*std::vector<std::vector<std::array<NeutralVertexComponent, 3>>>
+        shapePositions;
+    std::vector<std::vector<std::array<NeutralNormalComponent, 3>>>
+        shapeNormals;
+    if (!vertexLayout.shapes.empty()) {
+      shapePositions.resize(nPrimitiveVertices);
+      shapeNormals.resize(nPrimitiveVertices);
+      for (std::remove_const_t<decltype(nPrimitiveVertices)> iVertex = 0;
+           iVertex < nPrimitiveVertices; ++iVertex) {
+        shapePositions[iVertex].resize(vertexLayout.shapes.size());
+        shapeNormals[iVertex].resize(vertexLayout.shapes.size());
+        for (int iShape = 0; iShape < vertexLayout.shapes.size(); ++iShape) {
+          auto p = reinterpret_cast<NeutralVertexComponent *>(
+              primitiveVerticesData.get() + vertexLayout.size * iVertex +
+              vertexLayout.shapes[iShape].constrolPoints.offset);
+          shapePositions[iVertex][iShape] = {p[0], p[1], p[2]};
+          if (vertexLayout.shapes[iShape].normal) {
+            auto n = reinterpret_cast<NeutralNormalComponent *>(
+                primitiveVerticesData.get() + vertexLayout.size * iVertex +
+                vertexLayout.shapes[iShape].normal->offset);
+            shapeNormals[iVertex][iShape] = {n[0], n[1], n[2]};
+          }
+        }
+      }
+    }*/
+
+    auto &stagedPrimitive = stagedPrimitives.emplace_back();
+    stagedPrimitive.materialIndex = materialIndex;
+    stagedPrimitive.materialUsage.texture_context.channel_index_map =
+        vertexLayout.uv_channel_index_map;
+    stagedPrimitive.bulks = _typeVertices(
+        vertexLayout, primitiveVerticesData.get(), nPrimitiveVertices,
+        stagedPrimitive.positionQuantizationBits);
+    stagedPrimitive.vertexCount = nPrimitiveVertices;
+    stagedPrimitive.vertexSize = vertexLayout.size;
+    stagedPrimitive.vertices = std::move(primitiveVerticesData);
+    stagedPrimitive.indices = std::move(indices);
+    stagedPrimitive.materialUsage.hasTransparentVertex = hasTransparentVertex;
+    stagedPrimitive.controlPointIndexOffset = vertexLayout.controlPointIndex;
+    stagedPrimitive.shapeDeltas.resize(fbx_shapes_.size());
+    for (decltype(fbx_shapes_.size()) iShape = 0; iShape < fbx_shapes_.size();
+         ++iShape) {
+      if (stagedShapes[iShape]) {
+        continue;
+      }
+      if (isLastPrimitive) {
+        stagedPrimitive.shapeDeltas[iShape] =
+            std::move(transformedShapeDeltas[iShape]);
+      } else {
+        stagedPrimitive.shapeDeltas[iShape] = transformedShapeDeltas[iShape];
+      }
+    }
+  }
 
-  return glTFPrimitive;
+  return stagedPrimitives;
 }
 
 FbxMeshVertexLayout SceneConverter::_getFbxMeshVertexLayout(
     fbxsdk::FbxMesh &fbx_mesh_,
     std::span<fbxsdk::FbxShape *> fbx_shapes_,
-    std::span<MeshSkinData::InfluenceChannel> skin_influence_channels_) {
+    const MeshSkinData::Influences *skin_influences_,
+    const std::vector<bool> &staged_shapes_) {
   FbxMeshVertexLayout vertexLaytout;
 
   auto normalElement0 = fbx_mesh_.GetElementNormal(0);
@@ -387,11 +792,10 @@ FbxMeshVertexLayout SceneConverter::_getFbxMeshVertexLayout(
     }
   }
 
-  if (!skin_influence_channels_.empty()) {
+  if (skin_influences_) {
     vertexLaytout.skinning.emplace();
 
-    const auto nChannels =
-        static_cast<std::uint32_t>(skin_influence_channels_.size());
+    const auto nChannels = skin_influences_->channelCount;
     vertexLaytout.skinning->channelCount =
         static_cast<std::uint32_t>(nChannels);
 
@@ -402,15 +806,23 @@ FbxMeshVertexLayout SceneConverter::_getFbxMeshVertexLayout(
     vertexLaytout.size += sizeof(NeutralVertexWeightComponent) * nChannels;
   }
 
+  if (std::find(staged_shapes_.begin(), staged_shapes_.end(), false) !=
+      staged_shapes_.end()) {
+    vertexLaytout.controlPointIndex = vertexLaytout.size;
+    vertexLaytout.size += sizeof(std::uint32_t);
+  }
+
   vertexLaytout.shapes.reserve(fbx_shapes_.size());
   for (std::remove_cv_t<decltype(fbx_shapes_.size())> iShape = 0;
        iShape < fbx_shapes_.size(); ++iShape) {
     auto fbxShape = fbx_shapes_[iShape];
     FbxMeshVertexLayout::ShapeLayout shapeLayout;
 
-    shapeLayout.constrolPoints = {vertexLaytout.size,
-                                  fbxShape->GetControlPoints()};
-    vertexLaytout.size += sizeof(NeutralVertexComponent) * 3;
+    if (staged_shapes_[iShape]) {
+      shapeLayout.constrolPoints.emplace(vertexLaytout.size,
+                                         fbxShape->GetControlPoints());
+      vertexLaytout.size += sizeof(NeutralVertexComponent) * 3;
+    }
 
     if (auto normalLayer = fbxShape->GetElementNormal()) {
       shapeLayout.normal.emplace(vertexLaytout.size,
@@ -434,65 +846,93 @@ SceneConverter::_createPrimitive(std::list<VertexBulk> &bulks_,
   fx::gltf::Primitive glTFPrimitive;
   glTFPrimitive.targets.resize(target_count_);
 
+  struct BulkPacking {
+    const VertexBulk *bulk;
+    std::byte *data;
+    GLTFBuilder::XXIndex bufferView;
+    std::vector<VertexPackChannel> channels;
+    std::vector<PackedChannelBounds> bounds;
+  };
+
+  std::vector<BulkPacking> bulkPackings;
+  bulkPackings.reserve(bulks_.size());
   for (const auto &bulk : bulks_) {
+    // Morph targets are written by `_createMorphTargets()`.
+    if (bulk.morphTargetHint) {
+      continue;
+    }
     auto [bufferViewData, bufferViewIndex] =
-        _glTFBuilder.createBufferView(bulk.stride * vertex_count_, 0, 0);
+        _glTFBuilder.createBufferView(bulk.stride * vertex_count_, 4,
+                                      _geometryBuffer);
     auto &glTFBufferView =
         _glTFBuilder.get(&fx::gltf::Document::bufferViews)[bufferViewIndex];
-    if (bulk.morphTargetHint) {
-      glTFBufferView.name =
-          fmt::format("{}/Target-{}", primitive_name_, *bulk.morphTargetHint);
-    } else {
-      glTFBufferView.name = fmt::format("{}", primitive_name_);
+    if (_namesBufferObjects()) {
+      glTFBufferView.name = primitive_name_;
     }
     if (bulk.vertexBuffer) {
       glTFBufferView.target = fx::gltf::BufferView::TargetType::ArrayBuffer;
     }
     glTFBufferView.byteStride = bulk.stride;
 
+    auto &bulkPacking = bulkPackings.emplace_back();
+    bulkPacking.bulk = &bulk;
+    bulkPacking.data = bufferViewData;
+    bulkPacking.bufferView = bufferViewIndex;
+    bulkPacking.bounds.resize(bulk.channels.size());
     for (const auto &channel : bulk.channels) {
-      for (decltype(vertex_count_) iVertex = 0; iVertex < vertex_count_;
-           ++iVertex) {
-        channel.writer(
-            bufferViewData + bulk.stride * iVertex + channel.outOffset,
-            untyped_vertices_ + vertex_size_ * iVertex + channel.inOffset);
+      auto &packChannel = bulkPacking.channels.emplace_back();
+      packChannel.inType = channel.inType;
+      packChannel.outType = channel.componentType;
+      packChannel.componentCount = channel.inComponentCount;
+      packChannel.inOffset = channel.inOffset;
+      packChannel.outOffset = channel.outOffset;
+      packChannel.transform = channel.transform;
+      packChannel.renormalize = channel.renormalize;
+      if ((channel.name == "POSITION" || channel.name == "NORMAL") &&
+          channel.componentType != fx::gltf::Accessor::ComponentType::Float) {
+        _glTFBuilder.useExtension("KHR_mesh_quantization", true);
+      }
+      if (channel.name == "POSITION") {
+        packChannel.bounds =
+            &bulkPacking.bounds[bulkPacking.channels.size() - 1];
       }
+    }
+  }
+
+  // Bulks go into distinct buffer views.
+  parallelFor(bulkPackings.size(), _options.meshThreads,
+              [&](std::size_t iBulk_) {
+                const auto &bulkPacking = bulkPackings[iBulk_];
+                packVertices(bulkPacking.data, bulkPacking.bulk->stride,
+                             untyped_vertices_, vertex_size_, vertex_count_,
+                             bulkPacking.channels);
+              });
+
+  for (const auto &bulkPacking : bulkPackings) {
+    std::size_t iChannel = 0;
+    for (const auto &channel : bulkPacking.bulk->channels) {
+      const auto &packChannel = bulkPacking.channels[iChannel++];
 
       fx::gltf::Accessor glTFAccessor;
-      glTFAccessor.name = fmt::format(
-          "{0}{1}/{2}", primitive_name_,
-          channel.target ? fmt::format("/Target-{}", *channel.target) : "",
-          channel.name);
-      glTFAccessor.bufferView = bufferViewIndex;
+      if (_namesBufferObjects()) {
+        glTFAccessor.name = fmt::format(
+            "{0}{1}/{2}", primitive_name_,
+            channel.target ? fmt::format("/Target-{}", *channel.target) : "",
+            channel.name);
+      }
+      glTFAccessor.bufferView = bulkPacking.bufferView;
       glTFAccessor.byteOffset = channel.outOffset;
       glTFAccessor.count = vertex_count_;
       glTFAccessor.type = channel.type;
       glTFAccessor.componentType = channel.componentType;
-
-      if (channel.name == "POSITION") {
-        std::array<NeutralVertexComponent, 3> minPos, maxPos;
-        std::fill(minPos.begin(), minPos.end(),
-                  std::numeric_limits<NeutralVertexComponent>::infinity());
-        std::fill(maxPos.begin(), maxPos.end(),
-                  -std::numeric_limits<NeutralVertexComponent>::infinity());
-        for (decltype(vertex_count_) iVertex = 0; iVertex < vertex_count_;
-             ++iVertex) {
-          auto pPosition = reinterpret_cast<const NeutralVertexComponent *>(
-              untyped_vertices_ + vertex_size_ * iVertex + channel.inOffset);
-          for (auto i = 0; i < 3; ++i) {
-            minPos[i] = std::min(pPosition[i], minPos[i]);
-            maxPos[i] = std::max(pPosition[i], maxPos[i]);
-          }
-        }
-        auto typeCast = [](NeutralVertexComponent v_) {
-          return static_cast<float>(v_);
-        };
-        glTFAccessor.min.resize(minPos.size());
-        std::transform(minPos.begin(), minPos.end(), glTFAccessor.min.begin(),
-                       typeCast);
-        glTFAccessor.max.resize(maxPos.size());
-        std::transform(maxPos.begin(), maxPos.end(), glTFAccessor.max.begin(),
-                       typeCast);
+      glTFAccessor.normalized = channel.normalized;
+
+      if (packChannel.bounds) {
+        const auto nComponents = countComponents(channel.type);
+        glTFAccessor.min.assign(packChannel.bounds->min.begin(),
+                                packChannel.bounds->min.begin() + nComponents);
+        glTFAccessor.max.assign(packChannel.bounds->max.begin(),
+                                packChannel.bounds->max.begin() + nComponents);
       }
 
       auto glTFAccessorIndex = _glTFBuilder.add(&fx::gltf::Document::accessors,
@@ -509,20 +949,38 @@ SceneConverter::_createPrimitive(std::list<VertexBulk> &bulks_,
   }
 
   {
-    using IndexUnit = GLTFComponentTypeStorage<
-        fx::gltf::Accessor::ComponentType::UnsignedInt>;
+    using ComponentType = fx::gltf::Accessor::ComponentType;
+    const auto indexComponentType = getIndexComponentType(vertex_count_);
+    const auto indexSize = countBytes(indexComponentType);
     auto [bufferViewData, bufferViewIndex] = _glTFBuilder.createBufferView(
-        static_cast<std::uint32_t>(indices_.size_bytes()), 0, 0);
-    std::memcpy(bufferViewData, indices_.data(), indices_.size_bytes());
+        static_cast<std::uint32_t>(indexSize * indices_.size()), indexSize,
+        _geometryBuffer);
+    switch (indexComponentType) {
+    case ComponentType::UnsignedByte:
+      std::copy(indices_.begin(), indices_.end(),
+                reinterpret_cast<std::uint8_t *>(bufferViewData));
+      break;
+    case ComponentType::UnsignedShort:
+      std::copy(indices_.begin(), indices_.end(),
+                reinterpret_cast<std::uint16_t *>(bufferViewData));
+      break;
+    default:
+      std::memcpy(bufferViewData, indices_.data(), indices_.size_bytes());
+      break;
+    }
     auto &glTFBufferView =
         _glTFBuilder.get(&fx::gltf::Document::bufferViews)[bufferViewIndex];
+    glTFBufferView.target =
+        fx::gltf::BufferView::TargetType::ElementArrayBuffer;
 
     fx::gltf::Accessor glTFAccessor;
-    glTFAccessor.name = fmt::format("{0}/INDICES", primitive_name_);
+    if (_namesBufferObjects()) {
+      glTFAccessor.name = fmt::format("{0}/INDICES", primitive_name_);
+    }
     glTFAccessor.bufferView = bufferViewIndex;
     glTFAccessor.count = static_cast<std::uint32_t>(indices_.size());
     glTFAccessor.type = fx::gltf::Accessor::Type::Scalar;
-    glTFAccessor.componentType = fx::gltf::Accessor::ComponentType::UnsignedInt;
+    glTFAccessor.componentType = indexComponentType;
 
     auto glTFAccessorIndex = _glTFBuilder.add(&fx::gltf::Document::accessors,
                                               std::move(glTFAccessor));
@@ -532,50 +990,296 @@ SceneConverter::_createPrimitive(std::list<VertexBulk> &bulks_,
   return glTFPrimitive;
 }
 
-std::list<SceneConverter::VertexBulk>
-SceneConverter::_typeVertices(const FbxMeshVertexLayout &vertex_layout_) {
+void SceneConverter::_createMorphTargets(
+    fx::gltf::Primitive &glTF_primitive_,
+    const StagedPrimitive &staged_primitive_,
+    std::string_view primitive_name_) {
+  struct TargetChannel {
+    const VertexBulk::Channel *channel;
+    std::vector<NeutralVertexComponent> deltas;
+    /// <summary>
+    /// Vertices whose delta is not zero.
+    /// </summary>
+    std::vector<std::uint32_t> movedVertices;
+    PackedChannelBounds bounds;
+  };
+
+  std::vector<TargetChannel> targetChannels;
+  for (const auto &bulk : staged_primitive_.bulks) {
+    if (!bulk.morphTargetHint) {
+      continue;
+    }
+    for (const auto &channel : bulk.channels) {
+      targetChannels.emplace_back().channel = &channel;
+    }
+  }
+
+  const auto nVertices = staged_primitive_.vertexCount;
+  const auto vertices = staged_primitive_.vertices.get();
+  const auto vertexSize = staged_primitive_.vertexSize;
+
+  const auto gather = [&](TargetChannel &target_channel_) {
+    const auto &channel = *target_channel_.channel;
+    auto &deltas = target_channel_.deltas;
+    deltas.resize(static_cast<std::size_t>(nVertices) * 3);
+    if (channel.byControlPoint) {
+      const auto &shapeDeltas = staged_primitive_.shapeDeltas[*channel.target];
+      for (std::uint32_t iVertex = 0; iVertex < nVertices; ++iVertex) {
+        std::uint32_t iControlPoint = 0;
+        std::memcpy(&iControlPoint,
+                    vertices + vertexSize * iVertex +
+                        *staged_primitive_.controlPointIndexOffset,
+                    sizeof(iControlPoint));
+        for (int iComponent = 0; iComponent < 3; ++iComponent) {
+          auto delta = shapeDeltas[3 * iControlPoint + iComponent];
+          if (channel.transform) {
+            delta = (delta + channel.transform->offset[iComponent]) *
+                    channel.transform->scale[iComponent];
+          }
+          deltas[3 * iVertex + iComponent] = delta;
+        }
+      }
+    } else {
+      VertexPackChannel packChannel;
+      packChannel.inType = channel.inType;
+      packChannel.outType = channel.componentType;
+      packChannel.componentCount = channel.inComponentCount;
+      packChannel.inOffset = channel.inOffset;
+      packChannel.outOffset = 0;
+      packChannel.transform = channel.transform;
+      packVertices(reinterpret_cast<std::byte *>(deltas.data()),
+                   sizeof(NeutralVertexComponent) * 3, vertices, vertexSize,
+                   nVertices, {&packChannel, 1});
+    }
+
+    for (std::uint32_t iVertex = 0; iVertex < nVertices; ++iVertex) {
+      const auto delta = deltas.data() + 3 * iVertex;
+      if (delta[0] != 0.0f || delta[1] != 0.0f || delta[2] != 0.0f) {
+        target_channel_.movedVertices.push_back(iVertex);
+      }
+      for (int iComponent = 0; iComponent < 3; ++iComponent) {
+        auto &bounds = target_channel_.bounds;
+        bounds.min[iComponent] =
+            std::min(bounds.min[iComponent], delta[iComponent]);
+        bounds.max[iComponent] =
+            std::max(bounds.max[iComponent], delta[iComponent]);
+      }
+    }
+  };
+
+  const auto write = [&](const TargetChannel &target_channel_) {
+    const auto &channel = *target_channel_.channel;
+    const auto targetIndex = *channel.target;
+    const auto &movedVertices = target_channel_.movedVertices;
+    if (movedVertices.empty() && channel.name != "POSITION") {
+      return;
+    }
+
+    fx::gltf::Accessor glTFAccessor;
+    std::string bufferViewName;
+    if (_namesBufferObjects()) {
+      glTFAccessor.name = fmt::format("{}/Target-{}/{}", primitive_name_,
+                                      targetIndex, channel.name);
+      bufferViewName =
+          fmt::format("{}/Target-{}", primitive_name_, targetIndex);
+    }
+    glTFAccessor.count = nVertices;
+    glTFAccessor.type = channel.type;
+    glTFAccessor.componentType = channel.componentType;
+    if (channel.name == "POSITION") {
+      if (nVertices == 0) {
+        glTFAccessor.min.assign(3, 0.0f);
+        glTFAccessor.max.assign(3, 0.0f);
+      } else {
+        const auto &bounds = target_channel_.bounds;
+        glTFAccessor.min.assign(bounds.min.begin(), bounds.min.begin() + 3);
+        glTFAccessor.max.assign(bounds.max.begin(), bounds.max.begin() + 3);
+      }
+    }
+
+    constexpr auto elementSize = sizeof(NeutralVertexComponent) * 3;
+    const auto indexComponentType = getIndexComponentType(nVertices);
+    const auto indexSize = countBytes(indexComponentType);
+    const auto nMovedVertices = movedVertices.size();
+    if (nMovedVertices == 0) {
+      // All zeros, which is what an accessor without buffer view, nor sparse
+      // storage, holds.
+    } else if (nMovedVertices * (indexSize + elementSize) <
+               std::size_t{nVertices} * elementSize) {
+      using ComponentType = fx::gltf::Accessor::ComponentType;
+      auto [indicesData, indicesBufferViewIndex] =
+          _glTFBuilder.createBufferView(
+              static_cast<std::uint32_t>(indexSize * nMovedVertices),
+              indexSize, _morphTargetBuffer);
+      switch (indexComponentType) {
+      case ComponentType::UnsignedByte:
+        std::copy(movedVertices.begin(), movedVertices.end(),
+                  reinterpret_cast<std::uint8_t *>(indicesData));
+        break;
+      case ComponentType::UnsignedShort:
+        std::copy(movedVertices.begin(), movedVertices.end(),
+                  reinterpret_cast<std::uint16_t *>(indicesData));
+        break;
+      default:
+        std::memcpy(indicesData, movedVertices.data(),
+                    sizeof(std::uint32_t) * nMovedVertices);
+        break;
+      }
+      auto [valuesData, valuesBufferViewIndex] = _glTFBuilder.createBufferView(
+          static_cast<std::uint32_t>(elementSize * nMovedVertices), 4,
+          _morphTargetBuffer);
+      auto values = reinterpret_cast<NeutralVertexComponent *>(valuesData);
+      for (const auto iVertex : movedVertices) {
+        values = std::copy_n(target_channel_.deltas.data() + 3 * iVertex, 3,
+                             values);
+      }
+
+      auto &glTFBufferViews =
+          _glTFBuilder.get(&fx::gltf::Document::bufferViews);
+      glTFBufferViews[indicesBufferViewIndex].name = bufferViewName;
+      glTFBufferViews[valuesBufferViewIndex].name = bufferViewName;
+
+      auto &sparse = glTFAccessor.sparse;
+      sparse.count = static_cast<std::int32_t>(nMovedVertices);
+      sparse.indices.bufferView = indicesBufferViewIndex;
+      sparse.indices.componentType = indexComponentType;
+      sparse.values.bufferView = valuesBufferViewIndex;
+    } else {
+      auto [bufferViewData, bufferViewIndex] = _glTFBuilder.createBufferView(
+          static_cast<std::uint32_t>(elementSize * nVertices), 4,
+          _morphTargetBuffer);
+      std::memcpy(bufferViewData, target_channel_.deltas.data(),
+                  elementSize * nVertices);
+      auto &glTFBufferView =
+          _glTFBuilder.get(&fx::gltf::Document::bufferViews)[bufferViewIndex];
+      glTFBufferView.name = bufferViewName;
+      glTFBufferView.target = fx::gltf::BufferView::TargetType::ArrayBuffer;
+      glTFBufferView.byteStride = elementSize;
+      glTFAccessor.bufferView = bufferViewIndex;
+    }
+
+    const auto glTFAccessorIndex = _glTFBuilder.add(
+        &fx::gltf::Document::accessors, std::move(glTFAccessor));
+    glTF_primitive_.targets[targetIndex].emplace(channel.name,
+                                                 glTFAccessorIndex);
+  };
+
+  // Target channels are gathered as dense deltas a window at a time, then
+  // written in order, so that only a window of them is held at once.
+  const auto windowSize = std::size_t{resolveThreadCount(_options.meshThreads)};
+  for (std::size_t iWindow = 0; iWindow < targetChannels.size();
+       iWindow += windowSize) {
+    const auto nWindow = std::min(windowSize, targetChannels.size() - iWindow);
+    parallelFor(nWindow, _options.meshThreads, [&](std::size_t i_) {
+      gather(targetChannels[iWindow + i_]);
+    });
+    for (std::size_t i = 0; i < nWindow; ++i) {
+      auto &targetChannel = targetChannels[iWindow + i];
+      write(targetChannel);
+      targetChannel = {};
+    }
+  }
+}
+
+std::list<SceneConverter::VertexBulk> SceneConverter::_typeVertices(
+    const FbxMeshVertexLayout &vertex_layout_,
+    const std::byte *untyped_vertices_,
+    std::uint32_t vertex_count_,
+    std::optional<std::uint32_t> &position_quantization_bits_) {
+  using ComponentType = fx::gltf::Accessor::ComponentType;
+
   std::list<VertexBulk> bulks;
 
+  const auto &quantization = _options.meshQuantization;
+
+  // Normalized integers of `bits_` bits, or nothing if the attribute is not
+  // quantized. The transform maps [0, 1], or [-1, 1] if `signed_`, onto the
+  // range of the type.
+  const auto quantize =
+      [&quantization](std::uint32_t bits_, bool signed_)
+      -> std::optional<std::tuple<ComponentType, VertexPackChannel::Transform>> {
+    if (!quantization || bits_ == 0) {
+      return {};
+    }
+    const auto componentType =
+        bits_ <= 8 ? (signed_ ? ComponentType::Byte : ComponentType::UnsignedByte)
+                   : (signed_ ? ComponentType::Short
+                              : ComponentType::UnsignedShort);
+    VertexPackChannel::Transform transform;
+    transform.scale.fill(static_cast<float>(
+        (std::uint32_t{1} << (countBytes(componentType) * 8 - signed_)) - 1));
+    return std::tuple{componentType, transform};
+  };
+
+  const auto addQuantizableChannel =
+      [&quantize](VertexBulk &bulk_, const std::string &name_,
+                  fx::gltf::Accessor::Type type_, std::uint32_t in_offset_,
+                  std::uint32_t in_component_count_, std::uint32_t bits_,
+                  bool signed_) -> VertexBulk::Channel & {
+    if (const auto quantized = quantize(bits_, signed_)) {
+      const auto &[componentType, transform] = *quantized;
+      auto &channel = bulk_.addChannel(name_, type_, componentType, in_offset_,
+                                       UntypedComponentType::float32,
+                                       in_component_count_);
+      channel.normalized = true;
+      channel.transform = transform;
+      return channel;
+    }
+    return bulk_.addChannel(name_, type_, ComponentType::Float, in_offset_,
+                            UntypedComponentType::float32,
+                            in_component_count_);
+  };
+
   auto &defaultBulk = bulks.emplace_back();
   defaultBulk.vertexBuffer = true;
 
   {
-    defaultBulk.addChannel(
-        "POSITION",                               // name
-        fx::gltf::Accessor::Type::Vec3,           // type
-        fx::gltf::Accessor::ComponentType::Float, // component type
-        0,                                        // in offset
-        untypedVertexCopy<
-            GLTFComponentTypeStorage<fx::gltf::Accessor::ComponentType::Float>,
-            NeutralVertexComponent, 3> // writer
+    // The node transforms of skinned meshes are ignored: positions can't be
+    // restored from the quantization grid then.
+    auto positionComponentType = ComponentType::Float;
+    if (quantization && quantization->positionBits &&
+        !vertex_layout_.skinning) {
+      position_quantization_bits_ = quantization->positionBits;
+      positionComponentType = quantization->positionBits <= 8
+                                  ? ComponentType::Byte
+                                  : ComponentType::Short;
+    }
+    auto &positionChannel = defaultBulk.addChannel(
+        "POSITION",                     // name
+        fx::gltf::Accessor::Type::Vec3, // type
+        positionComponentType,          // component type
+        0,                              // in offset
+        UntypedComponentType::float32,  // in type
+        3                               // in component count
     );
+    positionChannel.normalized = position_quantization_bits_.has_value();
   }
 
   if (vertex_layout_.normal) {
-    defaultBulk.addChannel(
-        "NORMAL",                                 // name
-        fx::gltf::Accessor::Type::Vec3,           // type
-        fx::gltf::Accessor::ComponentType::Float, // component type
-        vertex_layout_.normal->offset,            // in offset
-        untypedVertexCopy<
-            GLTFComponentTypeStorage<fx::gltf::Accessor::ComponentType::Float>,
-            NeutralNormalComponent, 3> // writer
-    );
+    addQuantizableChannel(
+        defaultBulk, "NORMAL", fx::gltf::Accessor::Type::Vec3,
+        vertex_layout_.normal->offset, 3,
+        quantization ? quantization->normalBits : 0, true);
   }
 
   {
     auto nUV = vertex_layout_.uvs.size();
     for (decltype(nUV) iUV = 0; iUV < nUV; ++iUV) {
       auto &uvLayout = vertex_layout_.uvs[iUV];
-      defaultBulk.addChannel(
-          "TEXCOORD_" + std::to_string(iUV),        // name
-          fx::gltf::Accessor::Type::Vec2,           // type
-          fx::gltf::Accessor::ComponentType::Float, // component type
-          uvLayout.offset,                          // in offset
-          untypedVertexCopy<GLTFComponentTypeStorage<
-                                fx::gltf::Accessor::ComponentType::Float>,
-                            NeutralUVComponent, 2> // writer
-      );
+      std::uint32_t bits = 0;
+      if (quantization && quantization->texCoordBits) {
+        // Normalized integers can only hold [0, 1].
+        const auto bounds = computeUntypedBounds(
+            untyped_vertices_, vertex_layout_.size, vertex_count_,
+            uvLayout.offset, 2);
+        if (bounds.min[0] >= 0.0f && bounds.min[1] >= 0.0f &&
+            bounds.max[0] <= 1.0f && bounds.max[1] <= 1.0f) {
+          bits = quantization->texCoordBits;
+        }
+      }
+      addQuantizableChannel(defaultBulk, "TEXCOORD_" + std::to_string(iUV),
+                            fx::gltf::Accessor::Type::Vec2, uvLayout.offset, 2,
+                            bits, false);
     }
   }
 
@@ -583,15 +1287,10 @@ SceneConverter::_typeVertices(const FbxMeshVertexLayout &vertex_layout_) {
     auto nColor = vertex_layout_.colors.size();
     for (decltype(nColor) iColor = 0; iColor < nColor; ++iColor) {
       auto &colorLayout = vertex_layout_.colors[iColor];
-      defaultBulk.addChannel(
-          "COLOR_" + std::to_string(iColor),        // name
-          fx::gltf::Accessor::Type::Vec4,           // type
-          fx::gltf::Accessor::ComponentType::Float, // component type
-          colorLayout.offset,                       // in offset
-          untypedVertexCopy<GLTFComponentTypeStorage<
-                                fx::gltf::Accessor::ComponentType::Float>,
-                            NeutralVertexColorComponent, 4> // writer
-      );
+      addQuantizableChannel(defaultBulk, "COLOR_" + std::to_string(iColor),
+                            fx::gltf::Accessor::Type::Vec4, colorLayout.offset,
+                            4, quantization ? quantization->colorBits : 0,
+                            false);
     }
   }
 
@@ -612,22 +1311,16 @@ SceneConverter::_typeVertices(const FbxMeshVertexLayout &vertex_layout_) {
           fx::gltf::Accessor::ComponentType::UnsignedShort, // component type
           jointsOffset + sizeof(NeutralVertexJointComponent) * setCapacity *
                              iSet, // in offset
-          makeUntypedVertexCopyN<
-              GLTFComponentTypeStorage<
-                  fx::gltf::Accessor::ComponentType::UnsignedShort>,
-              NeutralVertexJointComponent>(nSetElements) // writer
-      );
-      defaultBulk.addChannel(
-          "WEIGHTS_" + std::to_string(iSet),        // name
-          glTFType,                                 // type
-          fx::gltf::Accessor::ComponentType::Float, // component type
-          weightsOffset + sizeof(NeutralVertexWeightComponent) * setCapacity *
-                              iSet, // in offset
-          makeUntypedVertexCopyN<GLTFComponentTypeStorage<
-                                     fx::gltf::Accessor::ComponentType::Float>,
-                                 NeutralVertexWeightComponent>(
-              nSetElements) // writer
+          UntypedComponentType::uint32, // in type
+          nSetElements                  // in component count
       );
+      auto &weightsChannel = addQuantizableChannel(
+          defaultBulk, "WEIGHTS_" + std::to_string(iSet), glTFType,
+          weightsOffset +
+              sizeof(NeutralVertexWeightComponent) * setCapacity * iSet,
+          nSetElements, quantization ? quantization->weightBits : 0, false);
+      // Rounding errors can only be fixed when there is a single set.
+      weightsChannel.renormalize = set == 1;
     }
   }
 
@@ -637,17 +1330,20 @@ SceneConverter::_typeVertices(const FbxMeshVertexLayout &vertex_layout_) {
     auto &shapeBulk = bulks.emplace_back();
     shapeBulk.morphTargetHint = static_cast<GLTFBuilder::XXIndex>(iShape);
 
+    // Morph targets are kept as float: deltas do not fit a normalized range.
     {
-      shapeBulk.addChannel(
+      const auto inOffset =
+          shape.constrolPoints ? shape.constrolPoints->offset : 0;
+      auto &positionChannel = shapeBulk.addChannel(
           "POSITION",                               // name
           fx::gltf::Accessor::Type::Vec3,           // type
           fx::gltf::Accessor::ComponentType::Float, // component type
-          shape.constrolPoints.offset,              // in offset
-          untypedVertexCopy<GLTFComponentTypeStorage<
-                                fx::gltf::Accessor::ComponentType::Float>,
-                            NeutralVertexComponent, 3>, // writer
-          static_cast<std::uint32_t>(iShape)            // target index
+          inOffset,                                 // in offset
+          UntypedComponentType::float32,            // in type
+          3,                                        // in component count
+          static_cast<std::uint32_t>(iShape)        // target index
       );
+      positionChannel.byControlPoint = !shape.constrolPoints;
     }
 
     if (shape.normal) {
@@ -656,10 +1352,9 @@ SceneConverter::_typeVertices(const FbxMeshVertexLayout &vertex_layout_) {
           fx::gltf::Accessor::Type::Vec3,           // type
           fx::gltf::Accessor::ComponentType::Float, // component type
           shape.normal->offset,                     // in offset
-          untypedVertexCopy<GLTFComponentTypeStorage<
-                                fx::gltf::Accessor::ComponentType::Float>,
-                            NeutralNormalComponent, 3>, // writer
-          static_cast<std::uint32_t>(iShape)            // target index
+          UntypedComponentType::float32,            // in type
+          3,                                        // in component count
+          static_cast<std::uint32_t>(iShape)        // target index
       );
     }
   }
@@ -667,9 +1362,8 @@ SceneConverter::_typeVertices(const FbxMeshVertexLayout &vertex_layout_) {
   return bulks;
 }
 
-fbxsdk::FbxSurfaceMaterial *
-SceneConverter::_getTheUniqueMaterial(fbxsdk::FbxMesh &fbx_mesh_,
-                                      fbxsdk::FbxNode &fbx_node_) {
+const fbxsdk::FbxLayerElementMaterial *
+SceneConverter::_getMaterialLayer(fbxsdk::FbxMesh &fbx_mesh_) {
   const auto nElementMaterialCount = fbx_mesh_.GetElementMaterialCount();
   if (!nElementMaterialCount) {
     return nullptr;
@@ -695,35 +1389,7 @@ SceneConverter::_getTheUniqueMaterial(fbxsdk::FbxMesh &fbx_mesh_,
       continue;
     }
 
-    if (mappingMode != fbxsdk::FbxLayerElement::eAllSame) {
-      // It might be a BUG of FBX SDK.
-      // We perform the `splitMeshesByMaterial()` and it should be all same
-      // then. But as FBX SDK 2020, the mapping mode is not changed but all
-      // elements are same. Let's ignore it.
-      _log(Logger::Level::verbose,
-           u8"The material mapping mode is not AllSame, even if it should be "
-           u8"since we splited it previously.");
-    }
-
-    const auto nodeMaterialIndexAccessor =
-        makeLayerElementMaterialAccessor(*elementMaterial);
-
-    FbxLayerElementAccessParams params;
-    params.controlPointIndex = 0;
-    params.polygonIndex = 0;
-    params.polygonVertexIndex = 0;
-    const auto nodeMaterialIndex = nodeMaterialIndexAccessor(params);
-
-    // It maybe invalid, see `makeLayerElementMaterialAccessor`.
-    if (nodeMaterialIndex < 0) {
-      _log(Logger::Level::verbose,
-           u8"We can not get the associated material for some reasons.");
-      continue;
-    }
-
-    auto material = fbx_mesh_.GetNode()->GetMaterial(nodeMaterialIndex);
-
-    return material;
+    return elementMaterial;
   }
 
   return nullptr;
@@ -3,6 +3,7 @@
 #include <bee/Convert/SceneConverter.h>
 #include <bee/Convert/fbxsdk/Spreader.h>
 #include <fmt/format.h>
+#include <unordered_map>
 
 namespace bee {
 /// <summary>
@@ -61,12 +62,13 @@ std::optional<SceneConverter::NodeMeshesSkinData>
 SceneConverter::_extractNodeMeshesSkinData(
     const std::vector<fbxsdk::FbxMesh *> &fbx_meshes_) {
   NodeMeshesSkinData nodeMeshesSkinData;
-  nodeMeshesSkinData.meshChannels.resize(fbx_meshes_.size());
+  nodeMeshesSkinData.meshInfluences.resize(fbx_meshes_.size());
 
   auto &newBones = nodeMeshesSkinData.bones;
-  auto &meshChannels = nodeMeshesSkinData.meshChannels;
+  auto &meshInfluences = nodeMeshesSkinData.meshInfluences;
+  // Index of each joint into `newBones`, by glTF node.
+  std::unordered_map<std::uint32_t, NeutralVertexJointComponent> newIndices;
 
-  decltype(fbx_meshes_.size()) nSkinnedMeshes = 0;
   for (decltype(fbx_meshes_.size()) iFbxMesh = 0; iFbxMesh < fbx_meshes_.size();
        ++iFbxMesh) {
     const auto &fbxMesh = *fbx_meshes_[iFbxMesh];
@@ -74,48 +76,31 @@ SceneConverter::_extractNodeMeshesSkinData(
     if (!meshSkinData || meshSkinData->bones.empty()) {
       continue;
     }
-    ++nSkinnedMeshes;
-    auto &partBones = meshSkinData->bones;
-    auto &partChannels = meshSkinData->channels;
-    if (nSkinnedMeshes == 1) {
-      newBones = std::move(partBones);
-      meshChannels[iFbxMesh] = std::move(partChannels);
-    } else {
-      // Merge into new skin
-      for (decltype(partBones.size()) iBone = 0; iBone < partBones.size();
-           ++iBone) {
-        const auto &partBone = partBones[iBone];
-        auto rNewBone =
-            std::find_if(newBones.begin(), newBones.end(),
-                         [&partBone](const MeshSkinData::Bone &new_bone_) {
-                           return partBone.glTFNode == new_bone_.glTFNode;
-                         });
-        NeutralVertexJointComponent newIndex = 0;
-        if (rNewBone != newBones.end()) {
-          newIndex =
-              static_cast<decltype(newIndex)>(rNewBone - newBones.begin());
-          if (rNewBone->inverseBindMatrix != partBone.inverseBindMatrix) {
-            _log(Logger::Level::warning,
-                 SkinMergeError{
-                     _glTFBuilder
-                         .get(&fx::gltf::Document::nodes)[partBone.glTFNode]
-                         .name});
-          }
-        } else {
-          newIndex = static_cast<NeutralVertexJointComponent>(newBones.size());
-          newBones.emplace_back(partBone);
-        }
-        for (auto &partChannel : partChannels) {
-          for (auto &i : partChannel.joints) {
-            if (i == iBone) {
-              i = newIndex;
-            }
-          }
-        }
+    // Merge into new skin
+    const auto &partBones = meshSkinData->bones;
+    std::vector<NeutralVertexJointComponent> partNewIndices(partBones.size());
+    for (decltype(partBones.size()) iBone = 0; iBone < partBones.size();
+         ++iBone) {
+      const auto &partBone = partBones[iBone];
+      const auto [rNewIndex, inserted] = newIndices.try_emplace(
+          partBone.glTFNode,
+          static_cast<NeutralVertexJointComponent>(newBones.size()));
+      if (inserted) {
+        newBones.emplace_back(partBone);
+      } else if (newBones[rNewIndex->second].inverseBindMatrix !=
+                 partBone.inverseBindMatrix) {
+        const auto &glTFNodes = _glTFBuilder.get(&fx::gltf::Document::nodes);
+        _log(Logger::Level::warning,
+             SkinMergeError{glTFNodes[partBone.glTFNode].name});
       }
-      // Remap joint indices in channel to new
-      meshChannels[iFbxMesh] = std::move(partChannels);
+      partNewIndices[iBone] = rNewIndex->second;
+    }
+    // Remap joint indices in channel to new
+    auto &partInfluences = meshSkinData->influences;
+    for (auto &joint : partInfluences.joints) {
+      joint = partNewIndices[joint];
     }
+    meshInfluences[iFbxMesh] = std::move(partInfluences);
   }
 
   if (nodeMeshesSkinData.bones.empty()) {
@@ -127,23 +112,21 @@ SceneConverter::_extractNodeMeshesSkinData(
 
 std::optional<SceneConverter::MeshSkinData>
 SceneConverter::_extractSkinData(const fbxsdk::FbxMesh &fbx_mesh_) {
-  using ResultJointType =
-      decltype(MeshSkinData::InfluenceChannel::joints)::value_type;
-  using ResultWeightType =
-      decltype(MeshSkinData::InfluenceChannel::weights)::value_type;
-
   MeshSkinData skinData;
-  auto &[skinName, skinJoints, skinChannels] = skinData;
+  auto &[skinName, skinJoints, skinInfluences] = skinData;
 
   const auto nControlPoints = fbx_mesh_.GetControlPointsCount();
-  std::vector<decltype(MeshSkinData::channels)::size_type> channelsCount(
-      nControlPoints);
-
-  auto allocateOneChannel = [&skinData, nControlPoints]() {
-    auto &channel = skinData.channels.emplace_back();
-    channel.joints.resize(nControlPoints);
-    channel.weights.resize(nControlPoints);
+  // Influences in cluster order, and their count by control point.
+  struct Influence {
+    int controlPoint;
+    NeutralVertexJointComponent joint;
+    NeutralVertexWeightComponent weight;
   };
+  std::vector<Influence> influences;
+  std::vector<std::uint32_t> influenceCounts(nControlPoints);
+  // Index of each joint into `skinJoints`, by node unique ID.
+  std::unordered_map<fbxsdk::FbxUInt64, NeutralVertexJointComponent>
+      jointIndices;
 
   struct ApplyUnitScale {
   private:
@@ -223,12 +206,10 @@ SceneConverter::_extractSkinData(const fbxsdk::FbxMesh &fbx_mesh_) {
       }
 
       // Index this node to joint array
-      auto rJointIndex =
-          std::find_if(skinJoints.begin(), skinJoints.end(),
-                       [&glTFNodeIndex](const MeshSkinData::Bone &joint_) {
-                         return joint_.glTFNode == *glTFNodeIndex;
-                       });
-      if (rJointIndex == skinJoints.end()) {
+      const auto [rJointIndex, inserted] = jointIndices.try_emplace(
+          jointNode->GetUniqueID(),
+          static_cast<NeutralVertexJointComponent>(skinJoints.size()));
+      if (inserted) {
         fbxsdk::FbxAMatrix transformMatrix;
         cluster->GetTransformMatrix(transformMatrix);
 
@@ -252,10 +233,8 @@ SceneConverter::_extractSkinData(const fbxsdk::FbxMesh &fbx_mesh_) {
 
         skinJoints.emplace_back(
             MeshSkinData::Bone{*glTFNodeIndex, inverseBindMatrixScaled});
-        rJointIndex = std::prev(skinJoints.end());
       }
-      const auto jointId =
-          static_cast<std::uint32_t>(rJointIndex - skinJoints.begin());
+      const auto jointId = rJointIndex->second;
 
       const auto nControlPointIndices = cluster->GetControlPointIndicesCount();
       const auto controlPointIndices = cluster->GetControlPointIndices();
@@ -269,15 +248,11 @@ SceneConverter::_extractSkinData(const fbxsdk::FbxMesh &fbx_mesh_) {
           continue;
         }
         const auto controlPointIndex = controlPointIndices[iControlPointIndex];
-        auto &nChannels = channelsCount[controlPointIndex];
-        assert(nChannels <= skinData.channels.size());
-        if (nChannels == skinData.channels.size()) {
-          allocateOneChannel();
+        if (controlPointIndex < 0 || controlPointIndex >= nControlPoints) {
+          continue;
         }
-        auto &[joints, weights] = skinData.channels[nChannels];
-        joints[controlPointIndex] = jointId;
-        weights[controlPointIndex] = weight;
-        ++nChannels;
+        influences.push_back({controlPointIndex, jointId, weight});
+        ++influenceCounts[controlPointIndex];
       }
     }
   }
@@ -286,30 +261,80 @@ SceneConverter::_extractSkinData(const fbxsdk::FbxMesh &fbx_mesh_) {
     return {};
   }
 
-  // Normalize weights
-  for (std::remove_const_t<decltype(nControlPoints)> iControlPoint = 0;
-       iControlPoint < nControlPoints; ++iControlPoint) {
-    const auto nChannels = channelsCount[iControlPoint];
-    bool zeroSum = true;
-    if (nChannels != 0) {
-      auto sum = static_cast<ResultWeightType>(0.0);
-      for (std::remove_const_t<decltype(nChannels)> iChannel = 0;
-           iChannel < nChannels; ++iChannel) {
-        sum += skinData.channels[iChannel].weights[iControlPoint];
-      }
-      if (sum != 0.0) {
-        zeroSum = false;
-        for (std::remove_const_t<decltype(nChannels)> iChannel = 0;
-             iChannel < nChannels; ++iChannel) {
-          skinData.channels[iChannel].weights[iControlPoint] /= sum;
-        }
-      }
+  const auto maxInfluenceCount =
+      influenceCounts.empty()
+          ? 0u
+          : *std::max_element(influenceCounts.begin(), influenceCounts.end());
+  auto nChannels = std::max(1u, maxInfluenceCount);
+  if (_options.maxSkinInfluences != 0 &&
+      nChannels > _options.maxSkinInfluences) {
+    nChannels = _options.maxSkinInfluences;
+  }
+
+  // Group the influences by control point, keeping the cluster order.
+  std::vector<std::size_t> firstInfluences(nControlPoints + 1);
+  for (int iControlPoint = 0; iControlPoint < nControlPoints;
+       ++iControlPoint) {
+    firstInfluences[iControlPoint + 1] =
+        firstInfluences[iControlPoint] + influenceCounts[iControlPoint];
+  }
+  std::vector<std::pair<NeutralVertexJointComponent,
+                        NeutralVertexWeightComponent>>
+      groupedInfluences(influences.size());
+  {
+    auto cursors = firstInfluences;
+    for (const auto &influence : influences) {
+      groupedInfluences[cursors[influence.controlPoint]++] = {
+          influence.joint, influence.weight};
+    }
+  }
+
+  skinInfluences.channelCount = nChannels;
+  skinInfluences.joints.assign(std::size_t{nChannels} * nControlPoints, 0);
+  skinInfluences.weights.assign(std::size_t{nChannels} * nControlPoints, 0);
+  std::uint32_t nTruncatedControlPoints = 0;
+  for (int iControlPoint = 0; iControlPoint < nControlPoints;
+       ++iControlPoint) {
+    const auto begin =
+        groupedInfluences.begin() +
+        static_cast<std::ptrdiff_t>(firstInfluences[iControlPoint]);
+    auto end = groupedInfluences.begin() +
+               static_cast<std::ptrdiff_t>(firstInfluences[iControlPoint + 1]);
+    if (static_cast<std::uint32_t>(end - begin) > nChannels) {
+      // Keep the largest weights.
+      std::stable_sort(begin, end, [](const auto &a_, const auto &b_) {
+        return a_.second > b_.second;
+      });
+      end = begin + nChannels;
+      ++nTruncatedControlPoints;
+    }
+
+    // Normalize weights
+    const auto iFirstInfluence =
+        static_cast<std::size_t>(iControlPoint) * nChannels;
+    auto joints = skinInfluences.joints.data() + iFirstInfluence;
+    auto weights = skinInfluences.weights.data() + iFirstInfluence;
+    auto sum = static_cast<NeutralVertexWeightComponent>(0.0);
+    for (auto rInfluence = begin; rInfluence != end; ++rInfluence) {
+      sum += rInfluence->second;
     }
-    if (zeroSum) {
-      skinData.channels[0].weights[iControlPoint] = 1.0;
+    if (sum != 0.0) {
+      for (auto rInfluence = begin; rInfluence != end; ++rInfluence) {
+        *joints++ = rInfluence->first;
+        *weights++ = rInfluence->second / sum;
+      }
+    } else {
+      weights[0] = 1.0;
     }
   }
 
+  if (nTruncatedControlPoints != 0) {
+    _log(Logger::Level::verbose,
+         fmt::format("{} control points of mesh {} have more than {} joints; "
+                     "the ones of the smallest weights are dropped.",
+                     nTruncatedControlPoints, fbx_mesh_.GetName(), nChannels));
+  }
+
   return skinData;
 }
 
@@ -326,10 +351,12 @@ SceneConverter::_createGLTFSkin(const NodeMeshesSkinData &skin_data_) {
       _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Mat4,
                                   fx::gltf::Accessor::ComponentType::Float,
                                   MeshSkinData::Bone::IBMSpreader>(
-          skin_data_.bones, 0, 0);
-  auto &ibmAccessor =
-      _glTFBuilder.get(&fx::gltf::Document::accessors)[ibmAccessorIndex];
-  ibmAccessor.name = fmt::format("{}/InverseBindMatrices", skin_data_.name);
+          skin_data_.bones, 0, _geometryBuffer);
+  if (_namesBufferObjects()) {
+    auto &ibmAccessor =
+        _glTFBuilder.get(&fx::gltf::Document::accessors)[ibmAccessorIndex];
+    ibmAccessor.name = fmt::format("{}/InverseBindMatrices", skin_data_.name);
+  }
   glTFSkin.inverseBindMatrices = ibmAccessorIndex;
 
   const auto glTFSkinIndex =
@@ -1,12 +1,15 @@
 
 #include <bee/Convert/SceneConverter.h>
+#include <bee/Parallel.h>
 #include <bee/polyfills/filesystem.h>
 #include <cppcodec/base64_default_rfc4648.hpp>
 #include <fmt/format.h>
+#include <fstream>
 #include <glm/gtx/euler_angles.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
 #include <glm/trigonometric.hpp>
 #include <regex>
+#include <unordered_set>
 
 namespace {
 using glm_fbx_vec3 = glm::tvec3<fbxsdk::FbxDouble>;
@@ -54,17 +57,46 @@ glm_fbx_mat4 compute_fbx_texture_transform(glm_fbx_vec3 pivot_center_,
          (scalePivotTransform * scale * invScalePivotTransform) *
          invPivotTransform;
 };
+
+/// <summary>
+/// A 1x1 image for images that could not be resolved.
+/// </summary>
+constexpr std::string_view fallbackImageUri =
+    "data:image/"
+    "png;base64,"
+    "iVBORw0KGgoAAAANSUhEUgAAAAEAAAABCAYAAAAfFcSJAAAADUlEQVR42m"
+    "P8/5+hHgAHggJ/PchI7wAAAABJRU5ErkJggg==";
+
+constexpr std::string_view ktx2MimeType = "image/ktx2";
+
+/// <summary>
+/// `file_name_`, suffixed with `-N` before its extension if it's in `taken_`.
+/// The result is added to `taken_`.
+/// </summary>
+std::u8string takeFileName(const bee::filesystem::path &file_name_,
+                           std::unordered_set<std::u8string> &taken_) {
+  auto fileName = file_name_.u8string();
+  for (int suffix = 1; !taken_.insert(fileName).second; ++suffix) {
+    const auto suffixString = fmt::format("-{}", suffix);
+    fileName = file_name_.stem().u8string();
+    fileName.append(suffixString.begin(), suffixString.end());
+    fileName += file_name_.extension().u8string();
+  }
+  return fileName;
+}
 } // namespace
 
 namespace bee {
 std::optional<fx::gltf::Material::Texture>
 SceneConverter::_convertTextureProperty(
     fbxsdk::FbxProperty &fbx_property_,
-    const TextureContext &texture_context_) {
+    const TextureContext &texture_context_,
+    bool normal_map_) {
   const auto fbxFileTexture =
       fbx_property_.GetSrcObject<fbxsdk::FbxFileTexture>();
   if (fbxFileTexture) {
-    return _convertFileTextureShared(*fbxFileTexture, texture_context_);
+    return _convertFileTextureShared(*fbxFileTexture, texture_context_,
+                                     normal_map_);
   } else {
     const auto fbxTexture = fbx_property_.GetSrcObject<fbxsdk::FbxTexture>();
     if (fbxTexture) {
@@ -78,13 +110,15 @@ SceneConverter::_convertTextureProperty(
 std::optional<fx::gltf::Material::Texture>
 SceneConverter::_convertFileTextureShared(
     fbxsdk::FbxFileTexture &fbx_file_texture_,
-    const TextureContext &texture_context_) {
+    const TextureContext &texture_context_,
+    bool normal_map_) {
   auto materialTexture = [&]() -> std::optional<fx::gltf::Material::Texture> {
     auto fbxTextureId = fbx_file_texture_.GetUniqueID();
     if (auto r = _textureMap.find(fbxTextureId); r != _textureMap.end()) {
       return r->second;
     } else {
-      auto glTFTextureIndex = _convertFileTexture(fbx_file_texture_);
+      auto glTFTextureIndex =
+          _convertFileTexture(fbx_file_texture_, normal_map_);
       if (!glTFTextureIndex) {
         _textureMap.emplace(fbxTextureId, std::nullopt);
         return std::nullopt;
@@ -108,8 +142,9 @@ SceneConverter::_convertFileTextureShared(
   return materialTexture;
 }
 
-std::optional<GLTFBuilder::XXIndex> SceneConverter::_convertFileTexture(
-    const fbxsdk::FbxFileTexture &fbx_texture_) {
+std::optional<GLTFBuilder::XXIndex>
+SceneConverter::_convertFileTexture(const fbxsdk::FbxFileTexture &fbx_texture_,
+                                    bool normal_map_) {
   const auto textureName = fbx_texture_.GetName();
 
   fx::gltf::Texture glTFTexture;
@@ -119,12 +154,19 @@ std::optional<GLTFBuilder::XXIndex> SceneConverter::_convertFileTexture(
     glTFTexture.sampler = *glTFSamplerIndex;
   }
 
-  if (const auto glTFImageIndex = _convertTextureSource(fbx_texture_)) {
+  const auto glTFImageIndex = _convertTextureSource(fbx_texture_, normal_map_);
+  if (glTFImageIndex) {
     glTFTexture.source = *glTFImageIndex;
   }
 
   auto glTFTextureIndex =
       _glTFBuilder.add(&fx::gltf::Document::textures, std::move(glTFTexture));
+  if (glTFImageIndex) {
+    if (const auto rTranscoded = _transcodedImages.find(*glTFImageIndex);
+        rTranscoded != _transcodedImages.end()) {
+      rTranscoded->second.texture = glTFTextureIndex;
+    }
+  }
   return glTFTextureIndex;
 }
 
@@ -133,7 +175,7 @@ SceneConverter::_convertTexturePropertyAsNormalTexture(
     fbxsdk::FbxProperty &fbx_property_,
     const TextureContext &texture_context_) {
   const auto materialTexture =
-      _convertTextureProperty(fbx_property_, texture_context_);
+      _convertTextureProperty(fbx_property_, texture_context_, true);
   if (!materialTexture) {
     return std::nullopt;
   }
@@ -147,7 +189,7 @@ SceneConverter::_convertFileTextureAsNormalTexture(
     fbxsdk::FbxFileTexture &fbx_file_texture_,
     const TextureContext &texture_context_) {
   const auto materialTexture =
-      _convertFileTextureShared(fbx_file_texture_, texture_context_);
+      _convertFileTextureShared(fbx_file_texture_, texture_context_, true);
   if (!materialTexture) {
     return std::nullopt;
   }
@@ -255,10 +297,14 @@ void SceneConverter::_convertTextureUVTransform(
 }
 
 bool SceneConverter::_hasValidImageExtension(
-    const bee::filesystem::path &path_) {
+    const bee::filesystem::path &path_) const {
   const auto extName = path_.extension().string();
-  const std::array<std::string, 3> validExtensions{".jpg", ".jpeg", ".png"};
-  return std::any_of(validExtensions.begin(), validExtensions.end(),
+  // Transcoded images need not be of a glTF image format.
+  const std::array<std::string, 4> validExtensions{".jpg", ".jpeg", ".png",
+                                                   ".tga"};
+  const auto nValidExtensions = _textureTranscoder ? 4 : 3;
+  return std::any_of(validExtensions.begin(),
+                     validExtensions.begin() + nValidExtensions,
                      [&extName](const std::string &valid_extension_) {
                        return std::equal(
                            valid_extension_.begin(), valid_extension_.end(),
@@ -269,7 +315,7 @@ bool SceneConverter::_hasValidImageExtension(
 }
 
 std::optional<GLTFBuilder::XXIndex> SceneConverter::_convertTextureSource(
-    const fbxsdk::FbxFileTexture &fbx_texture_) {
+    const fbxsdk::FbxFileTexture &fbx_texture_, bool normal_map_) {
   namespace fs = bee::filesystem;
 
   const auto imageName = fbx_texture_.GetName();
@@ -286,15 +332,11 @@ std::optional<GLTFBuilder::XXIndex> SceneConverter::_convertTextureSource(
   }
 
   if (imageFilePath && !_options.textureResolution.disabled) {
-    const auto exists = [&imageFilePath] {
-      std::error_code err;
-      const auto status = fs::status(*imageFilePath, err);
-      return !err && status.type() == fs::file_type::regular;
-    };
-    if (!_hasValidImageExtension(*imageFilePath) || !exists()) {
-      auto image = _searchImage(imageFilePath->stem().string());
+    if (!_hasValidImageExtension(*imageFilePath) ||
+        !_textureSearchIndex->isRegularFile(imageFilePath->u8string())) {
+      auto image = _searchImage(imageFilePath->stem().u8string());
       if (image) {
-        imageFilePath = image;
+        imageFilePath = fs::path{*image};
       }
     }
   }
@@ -303,22 +345,32 @@ std::optional<GLTFBuilder::XXIndex> SceneConverter::_convertTextureSource(
     imageFilePath.reset();
   }
 
+  // Whether it's read or only referenced, the output depends on the file.
+  if (imageFilePath && _sideEffects) {
+    _sideEffects->dependencies.push_back(*imageFilePath);
+  }
+
   fx::gltf::Image glTFImage;
   glTFImage.name = imageName;
+  std::optional<std::size_t> imageFile;
+  std::optional<std::size_t> transcodeJob;
   if (imageFilePath) {
-    auto reference = _processPath(*imageFilePath);
-    if (reference) {
+    if (_textureTranscoder) {
+      // Transcoded from now on, and written by `_writeTranscodedImages()`.
+      transcodeJob = _textureTranscoder->submit(*imageFilePath, normal_map_);
+    } else if (_options.pathMode == ConvertOptions::PathMode::embedded ||
+        _options.pathMode == ConvertOptions::PathMode::copy) {
+      // The file is read, or copied, by `_writeImages()`.
+      imageFile = _imageBatch.add(*imageFilePath);
+    } else if (auto reference = _processPath(*imageFilePath)) {
       glTFImage.uri.assign(reference->begin(), reference->end());
     }
   }
 
-  if (glTFImage.uri.empty()) {
+  if (!imageFile && !transcodeJob && glTFImage.uri.empty()) {
     // Or we got `bufferView: 0`.
     // glTFImage.bufferView = -1;
-    glTFImage.uri = "data:image/"
-                    "png;base64,"
-                    "iVBORw0KGgoAAAANSUhEUgAAAAEAAAABCAYAAAAfFcSJAAAADUlEQVR42m"
-                    "P8/5+hHgAHggJ/PchI7wAAAABJRU5ErkJggg==";
+    glTFImage.uri = fallbackImageUri;
   }
 
   glTFImage.extensionsAndExtras["extras"]["FBX-glTF-conv"]["fileName"] =
@@ -328,25 +380,23 @@ std::optional<GLTFBuilder::XXIndex> SceneConverter::_convertTextureSource(
 
   auto glTFImageIndex =
       _glTFBuilder.add(&fx::gltf::Document::images, std::move(glTFImage));
+  if (imageFile) {
+    _pendingImages.emplace_back(glTFImageIndex, *imageFile);
+  }
+  if (transcodeJob) {
+    _transcodedImages.emplace(glTFImageIndex, TranscodedImage{*transcodeJob});
+  }
 
   return glTFImageIndex;
 }
 
-std::optional<std::string>
-SceneConverter::_searchImage(const std::string_view name_) {
+std::optional<std::u8string>
+SceneConverter::_searchImage(std::u8string_view name_) {
   namespace fs = bee::filesystem;
   for (const auto &location : _options.textureResolution.locations) {
-    std::error_code err;
-    fs::directory_iterator dirIter{fs::path{location}, err};
-    if (err) {
-      continue;
-    }
-    for (const auto &dirEntry : dirIter) {
-      if (dirEntry.is_regular_file()) {
-        if (auto path = dirEntry.path(); path.stem() == std::string{name_} &&
-                                         _hasValidImageExtension(path)) {
-          return path.string();
-        }
+    for (auto &image : _textureSearchIndex->findByStem(location, name_)) {
+      if (_hasValidImageExtension(fs::path{image})) {
+        return std::move(image);
       }
     }
   }
@@ -379,41 +429,6 @@ SceneConverter::_processPath(const bee::filesystem::path &path_) {
     const auto fileName = normalizedPath.filename();
     return fileName.u8string();
   }
-  case ConvertOptions::PathMode::copy: {
-    const auto outDir = getOutDirNormalized();
-    const auto target = outDir / normalizedPath.filename();
-    std::error_code err;
-    fs::create_directories(target.parent_path(), err);
-    if (err) {
-      return {};
-    }
-    fs::copy_file(normalizedPath, target, fs::copy_options::overwrite_existing,
-                  err);
-    if (err) {
-      return {};
-    }
-    return toRelative(target);
-  }
-  case ConvertOptions::PathMode::embedded: {
-    std::ifstream ifstream(normalizedPath);
-    if (!ifstream.good()) {
-      return {};
-    }
-    std::vector<char> fileContent;
-    ifstream.seekg(0, ifstream.end);
-    auto fileSize =
-        static_cast<decltype(fileContent)::size_type>(ifstream.tellg());
-    ifstream.seekg(0, ifstream.beg);
-    fileContent.resize(fileSize);
-    ifstream.read(fileContent.data(), fileContent.size());
-    const auto base64Data = cppcodec::base64_rfc4648::encode(
-        reinterpret_cast<const char *>(fileContent.data()), fileContent.size());
-    const auto mimeType =
-        _getMimeTypeFromExtension(normalizedPath.extension().u8string());
-    const auto chars = fmt::format("data:{};base64,{}",
-                                   forceTreatAsPlain(mimeType), base64Data);
-    return std::u8string(reinterpret_cast<const char8_t *>(chars.data()));
-  }
   case ConvertOptions::PathMode::prefer_relative: {
     const auto relativePath =
         normalizedPath.lexically_relative(getOutDirNormalized());
@@ -436,6 +451,7 @@ SceneConverter::_processPath(const bee::filesystem::path &path_) {
     break;
   }
   default: {
+    // `copy` and `embedded` are handled by `_writeImages()`.
     assert(false);
     break;
   }
@@ -443,6 +459,224 @@ SceneConverter::_processPath(const bee::filesystem::path &path_) {
   return {};
 }
 
+void SceneConverter::_writeImages() {
+  namespace fs = bee::filesystem;
+  if (_pendingImages.empty()) {
+    return;
+  }
+
+  _imageBatch.load(_options.ioThreads);
+
+  // Files whose content is first seen, the only ones to be written.
+  std::vector<std::size_t> contents;
+  for (std::size_t iFile = 0; iFile < _imageBatch.size(); ++iFile) {
+    if (_imageBatch.canonical(iFile) == iFile) {
+      contents.push_back(iFile);
+    }
+  }
+
+  std::vector<std::optional<GLTFBuilder::XXIndex>> bufferViews(
+      _imageBatch.size());
+  std::vector<std::optional<std::u8string>> uris(_imageBatch.size());
+  if (_options.pathMode == ConvertOptions::PathMode::copy) {
+    const auto outDir =
+        fs::path(_options.out).parent_path().lexically_normal();
+    std::error_code err;
+    fs::create_directories(outDir, err);
+    if (!err) {
+      // Different contents of the same file name are given distinct names,
+      // rather than being copied over each other.
+      std::unordered_set<std::u8string> targetNames;
+      std::vector<fs::path> targets(_imageBatch.size());
+      for (const auto iFile : contents) {
+        targets[iFile] =
+            outDir / fs::path{takeFileName(
+                         _imageBatch.path(iFile).filename(), targetNames)};
+      }
+      parallelFor(contents.size(), _options.ioThreads, [&](std::size_t i_) {
+        const auto iFile = contents[i_];
+        if (copyFileIfChanged(_imageBatch.path(iFile), targets[iFile])) {
+          uris[iFile] =
+              targets[iFile].lexically_relative(outDir).generic_u8string();
+        }
+      });
+      if (_sideEffects) {
+        for (const auto iFile : contents) {
+          if (uris[iFile]) {
+            _sideEffects->copies.emplace_back(_imageBatch.path(iFile),
+                                              targets[iFile]);
+          }
+        }
+      }
+    }
+  } else if (_options.glb) {
+    std::vector<std::byte *> bufferViewDatas(_imageBatch.size());
+    for (const auto iFile : contents) {
+      const auto content = _imageBatch.content(iFile);
+      auto [bufferViewData, bufferViewIndex] = _glTFBuilder.createBufferView(
+          static_cast<std::uint32_t>(content.size()), 0, _imageBuffer);
+      bufferViews[iFile] = bufferViewIndex;
+      bufferViewDatas[iFile] = bufferViewData;
+    }
+    parallelFor(contents.size(), _options.ioThreads, [&](std::size_t i_) {
+      const auto iFile = contents[i_];
+      const auto content = _imageBatch.content(iFile);
+      std::copy(content.begin(), content.end(), bufferViewDatas[iFile]);
+    });
+  } else {
+    parallelFor(contents.size(), _options.ioThreads, [&](std::size_t i_) {
+      const auto iFile = contents[i_];
+      const auto content = _imageBatch.content(iFile);
+      const auto base64Data = cppcodec::base64_rfc4648::encode(
+          reinterpret_cast<const char *>(content.data()), content.size());
+      const auto mimeType = _getMimeTypeFromExtension(
+          _imageBatch.path(iFile).extension().u8string());
+      const auto chars = fmt::format("data:{};base64,{}",
+                                     forceTreatAsPlain(mimeType), base64Data);
+      uris[iFile].emplace(chars.begin(), chars.end());
+    });
+  }
+
+  auto &glTFImages = _glTFBuilder.get(&fx::gltf::Document::images);
+  for (const auto &[glTFImageIndex, iFile] : _pendingImages) {
+    auto &glTFImage = glTFImages[glTFImageIndex];
+    const auto canonical = _imageBatch.canonical(iFile);
+    if (canonical && bufferViews[*canonical]) {
+      glTFImage.bufferView = *bufferViews[*canonical];
+      const auto mimeType = _getMimeTypeFromExtension(
+          _imageBatch.path(*canonical).extension().u8string());
+      glTFImage.mimeType.assign(mimeType.begin(), mimeType.end());
+    } else if (canonical && uris[*canonical]) {
+      glTFImage.uri.assign(uris[*canonical]->begin(), uris[*canonical]->end());
+    } else {
+      _log(Logger::Level::warning,
+           fmt::format("Failed to read image {}",
+                       _imageBatch.path(iFile).string()));
+      glTFImage.uri = fallbackImageUri;
+    }
+  }
+  _pendingImages.clear();
+}
+
+void SceneConverter::_writeTranscodedImages() {
+  namespace fs = bee::filesystem;
+  if (_transcodedImages.empty()) {
+    return;
+  }
+
+  _textureTranscoder->wait();
+
+  std::vector<std::size_t> jobs;
+  for (std::size_t iJob = 0; iJob < _textureTranscoder->size(); ++iJob) {
+    if (!_textureTranscoder->result(iJob).empty()) {
+      jobs.push_back(iJob);
+    }
+  }
+
+  std::vector<std::optional<GLTFBuilder::XXIndex>> bufferViews(
+      _textureTranscoder->size());
+  std::vector<std::optional<std::u8string>> uris(_textureTranscoder->size());
+  if (_options.pathMode == ConvertOptions::PathMode::copy) {
+    const auto outDir =
+        fs::path(_options.out).parent_path().lexically_normal();
+    std::error_code err;
+    fs::create_directories(outDir, err);
+    if (!err) {
+      std::unordered_set<std::u8string> targetNames;
+      std::vector<fs::path> targets(_textureTranscoder->size());
+      for (const auto iJob : jobs) {
+        auto fileName = _textureTranscoder->path(iJob).filename();
+        fileName.replace_extension(".ktx2");
+        targets[iJob] = outDir / fs::path{takeFileName(fileName, targetNames)};
+      }
+      parallelFor(jobs.size(), _options.ioThreads, [&](std::size_t i_) {
+        const auto iJob = jobs[i_];
+        const auto &result = _textureTranscoder->result(iJob);
+        std::ofstream stream(targets[iJob], std::ios::binary);
+        stream.write(reinterpret_cast<const char *>(result.data()),
+                     static_cast<std::streamsize>(result.size()));
+        if (stream) {
+          uris[iJob] =
+              targets[iJob].lexically_relative(outDir).generic_u8string();
+        }
+      });
+      if (_sideEffects) {
+        for (const auto iJob : jobs) {
+          if (uris[iJob]) {
+            _sideEffects->writes.emplace_back(
+                targets[iJob], _textureTranscoder->result(iJob));
+          }
+        }
+      }
+    }
+  } else if (_options.glb) {
+    std::vector<std::byte *> bufferViewDatas(_textureTranscoder->size());
+    for (const auto iJob : jobs) {
+      const auto &result = _textureTranscoder->result(iJob);
+      auto [bufferViewData, bufferViewIndex] = _glTFBuilder.createBufferView(
+          static_cast<std::uint32_t>(result.size()), 0, _imageBuffer);
+      bufferViews[iJob] = bufferViewIndex;
+      bufferViewDatas[iJob] = bufferViewData;
+    }
+    parallelFor(jobs.size(), _options.ioThreads, [&](std::size_t i_) {
+      const auto iJob = jobs[i_];
+      const auto &result = _textureTranscoder->result(iJob);
+      std::copy(result.begin(), result.end(), bufferViewDatas[iJob]);
+    });
+  } else {
+    parallelFor(jobs.size(), _options.ioThreads, [&](std::size_t i_) {
+      const auto iJob = jobs[i_];
+      const auto &result = _textureTranscoder->result(iJob);
+      const auto base64Data = cppcodec::base64_rfc4648::encode(
+          reinterpret_cast<const char *>(result.data()), result.size());
+      const auto chars =
+          fmt::format("data:{};base64,{}", ktx2MimeType, base64Data);
+      uris[iJob].emplace(chars.begin(), chars.end());
+    });
+  }
+
+  auto &glTFImages = _glTFBuilder.get(&fx::gltf::Document::images);
+  bool transcoded = false;
+  for (const auto &[glTFImageIndex, transcodedImage] : _transcodedImages) {
+    auto &glTFImage = glTFImages[glTFImageIndex];
+    const auto iJob = transcodedImage.job;
+    if (bufferViews[iJob]) {
+      glTFImage.bufferView = *bufferViews[iJob];
+      glTFImage.mimeType = ktx2MimeType;
+    } else if (uris[iJob]) {
+      glTFImage.uri.assign(uris[iJob]->begin(), uris[iJob]->end());
+    } else {
+      const auto &path = _textureTranscoder->path(iJob);
+      const auto &error = _textureTranscoder->error(iJob);
+      _log(Logger::Level::warning,
+           fmt::format("Failed to transcode image {}: {}", path.string(),
+                       error.empty() ? "Failed to write the image" : error));
+      // The texture keeps referencing the image, which is written as it is
+      // if it's of a glTF image format.
+      if (_getMimeTypeFromExtension(path.extension().u8string()) !=
+          u8"application/octet-stream") {
+        _pendingImages.emplace_back(glTFImageIndex, _imageBatch.add(path));
+      } else {
+        glTFImage.uri = fallbackImageUri;
+      }
+      continue;
+    }
+
+    transcoded = true;
+    if (transcodedImage.texture) {
+      auto &glTFTexture = _glTFBuilder.get(
+          &fx::gltf::Document::textures)[*transcodedImage.texture];
+      glTFTexture.source = -1;
+      glTFTexture.extensionsAndExtras["extensions"]["KHR_texture_basisu"]
+                                     ["source"] = glTFImageIndex;
+    }
+  }
+  if (transcoded) {
+    _glTFBuilder.useExtension("KHR_texture_basisu", true);
+  }
+  _transcodedImages.clear();
+}
+
 std::u8string
 SceneConverter::_getMimeTypeFromExtension(std::u8string_view ext_name_) {
   auto lower = std::u8string{ext_name_};
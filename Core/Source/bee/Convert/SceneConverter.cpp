@@ -3,6 +3,8 @@
 #include <bee/Convert/SceneConverter.h>
 #include <bee/Convert/fbxsdk/Spreader.h>
 #include <fmt/format.h>
+#include <functional>
+#include <unordered_set>
 
 namespace bee {
 /// <summary>
@@ -46,10 +48,28 @@ SceneConverter::SceneConverter(fbxsdk::FbxManager &fbx_manager_,
                                fbxsdk::FbxScene &fbx_scene_,
                                const ConvertOptions &options_,
                                std::u8string_view fbx_file_name_,
-                               GLTFBuilder &glTF_builder_)
+                               GLTFBuilder &glTF_builder_,
+                               ConvertSideEffects *side_effects_,
+                               ConvertStats *stats_,
+                               const ConvertLimits *limits_)
     : _glTFBuilder(glTF_builder_), _fbxManager(fbx_manager_),
       _fbxScene(fbx_scene_), _options(options_), _fbxFileName(fbx_file_name_),
-      _fbxGeometryConverter(&fbx_manager_) {
+      _sideEffects(side_effects_), _stats(stats_), _limits(limits_),
+      _fbxGeometryConverter(&fbx_manager_),
+      _textureSearchIndex(options_.textureResolution.index) {
+  if (!_textureSearchIndex) {
+    _textureSearchIndex = std::make_shared<TextureSearchIndex>();
+  }
+  if (options_.textureTranscoding) {
+    if (options_.pathMode == ConvertOptions::PathMode::embedded ||
+        options_.pathMode == ConvertOptions::PathMode::copy) {
+      _textureTranscoder =
+          std::make_unique<TextureTranscoder>(*options_.textureTranscoding);
+    } else {
+      _log(Logger::Level::warning,
+           u8"Images are transcoded only if they're embedded or copied.");
+    }
+  }
   const auto &globalSettings = fbx_scene_.GetGlobalSettings();
   if (!options_.animationBakeRate) {
     _animationTimeMode = globalSettings.GetTimeMode();
@@ -61,18 +81,60 @@ SceneConverter::SceneConverter(fbxsdk::FbxManager &fbx_manager_,
   const auto frameRate = fbxsdk::FbxTime::GetFrameRate(_animationTimeMode);
   _log(Logger::Level::verbose, fmt::format("Frame rate: {}", frameRate));
 
+  if (options_.bufferPartitioning.any()) {
+    glTF_builder_.expectMultipleBuffers();
+  }
+  if (options_.bufferPartitioning.morphTargets &&
+      !options_.bufferPartitioning.perMesh) {
+    _morphTargetBuffer = glTF_builder_.createBuffer("morphTargets");
+  }
+  if (options_.bufferPartitioning.any()) {
+    _imageBuffer = glTF_builder_.createBuffer("images");
+  }
+
   auto &documentExtras = glTF_builder_.document().extensionsAndExtras;
   documentExtras["extras"]["FBX-glTF-conv"]["animationFrameRate"] = frameRate;
 }
 
 void SceneConverter::convert() {
-  _prepareScene();
-  _announceNodes(_fbxScene);
-  for (auto fbxNode : _anncouncedfbxNodes) {
-    _convertNode(*fbxNode);
+  {
+    ConvertStats::Phase phase{_stats, "prepareScene"};
+    _prepareScene();
+  }
+  std::vector<NodeMeshesJob> nodeMeshesJobs;
+  {
+    ConvertStats::Phase phase{_stats, "convertNodes"};
+    _announceNodes(_fbxScene);
+    const auto nNodes = _anncouncedfbxNodes.size();
+    for (decltype(_anncouncedfbxNodes.size()) iNode = 0; iNode < nNodes;
+         ++iNode) {
+      _checkLimits();
+      const auto fbxNode = _anncouncedfbxNodes[iNode];
+      if (auto nodeMeshesJob = _convertNode(*fbxNode)) {
+        nodeMeshesJobs.push_back(std::move(*nodeMeshesJob));
+      }
+      _reportProgress(ConvertProgress::Stage::node, fbxNode->GetName(),
+                      iNode + 1, nNodes);
+    }
+  }
+  {
+    ConvertStats::Phase phase{_stats, "convertMeshes"};
+    _convertNodesMeshes(nodeMeshesJobs);
   }
   _convertScene(_fbxScene);
-  _convertAnimation(_fbxScene);
+  {
+    ConvertStats::Phase phase{_stats, "convertAnimation"};
+    _convertAnimation(_fbxScene);
+  }
+  if (_options.gpuInstancing) {
+    ConvertStats::Phase phase{_stats, "instanceNodes"};
+    _instanceSiblingNodes();
+  }
+  {
+    ConvertStats::Phase phase{_stats, "writeImages"};
+    _writeTranscodedImages();
+    _writeImages();
+  }
 }
 
 void to_json(Json &j_, bee::Logger::Level level_) {
@@ -92,6 +154,17 @@ void SceneConverter::_log(bee::Logger::Level level_, Json &&message_) {
   }
 }
 
+void SceneConverter::_reportProgress(ConvertProgress::Stage stage_,
+                                     std::string_view name_,
+                                     std::size_t done_,
+                                     std::size_t total_) const {
+  if (_options.progress) {
+    _options.progress(ConvertProgress{stage_, std::string{name_},
+                                      static_cast<std::uint32_t>(done_),
+                                      static_cast<std::uint32_t>(total_)});
+  }
+}
+
 fbxsdk::FbxGeometryConverter &SceneConverter::_getGeometryConverter() {
   return _fbxGeometryConverter;
 }
@@ -125,22 +198,122 @@ void SceneConverter::_prepareScene() {
     }
   }
 
-  // Trianglute the whole scene
-  _fbxGeometryConverter.Triangulate(&_fbxScene, true);
+  if (_options.sdkTriangulation) {
+    // Trianglute the whole scene
+    _fbxGeometryConverter.Triangulate(&_fbxScene, true);
 
-  // Split meshes per material
-  _fbxGeometryConverter.SplitMeshesPerMaterial(&_fbxScene, true);
+    // Split meshes per material
+    _fbxGeometryConverter.SplitMeshesPerMaterial(&_fbxScene, true);
+    return;
+  }
+
+  // Meshes are triangulated and split per material while their vertices are
+  // read. Other geometries still need the FBX SDK to become meshes.
+  std::vector<fbxsdk::FbxGeometry *> fbxNonMeshGeometries;
+  const auto nGeometries = _fbxScene.GetGeometryCount();
+  for (auto iGeometry = 0; iGeometry < nGeometries; ++iGeometry) {
+    const auto fbxGeometry = _fbxScene.GetGeometry(iGeometry);
+    switch (fbxGeometry->GetAttributeType()) {
+    case fbxsdk::FbxNodeAttribute::eNurbs:
+    case fbxsdk::FbxNodeAttribute::eNurbsSurface:
+    case fbxsdk::FbxNodeAttribute::ePatch:
+      fbxNonMeshGeometries.push_back(fbxGeometry);
+      break;
+    default:
+      break;
+    }
+  }
+  for (const auto fbxGeometry : fbxNonMeshGeometries) {
+    _fbxGeometryConverter.Triangulate(fbxGeometry, true);
+  }
 }
 
 void SceneConverter::_announceNodes(const fbxsdk::FbxScene &fbx_scene_) {
   auto rootNode = fbx_scene_.GetRootNode();
+  if (!_options.nodeFilter.empty()) {
+    _filterNodes(*rootNode);
+  }
   auto nChildren = rootNode->GetChildCount();
   for (auto iChild = 0; iChild < nChildren; ++iChild) {
     _announceNode(*rootNode->GetChild(iChild));
   }
 }
 
+void SceneConverter::_filterNodes(fbxsdk::FbxNode &fbx_root_node_) {
+  std::unordered_set<std::string> names;
+  for (const auto &name : _options.nodeFilter) {
+    names.emplace(name.begin(), name.end());
+  }
+
+  const auto keep = [this, &fbx_root_node_](fbxsdk::FbxNode &fbx_node_,
+                                            bool with_meshes_) {
+    if (with_meshes_) {
+      _keptNodes[&fbx_node_] = true;
+    } else if (!_keptNodes.emplace(&fbx_node_, false).second) {
+      return;
+    }
+    // Ancestors already kept have their own ancestors kept.
+    auto fbxParent = fbx_node_.GetParent();
+    while (fbxParent && fbxParent != &fbx_root_node_ &&
+           _keptNodes.emplace(fbxParent, false).second) {
+      fbxParent = fbxParent->GetParent();
+    }
+  };
+
+  std::vector<fbxsdk::FbxMesh *> fbxKeptMeshes;
+  const std::function<void(fbxsdk::FbxNode &, bool)> visit =
+      [&](fbxsdk::FbxNode &fbx_node_, bool in_kept_subtree_) {
+        auto kept = in_kept_subtree_ || names.count(fbx_node_.GetName()) != 0;
+        std::vector<fbxsdk::FbxMesh *> fbxMeshes;
+        for (auto nNodeAttributes = fbx_node_.GetNodeAttributeCount(),
+                  iNodeAttribute = 0;
+             iNodeAttribute < nNodeAttributes; ++iNodeAttribute) {
+          const auto nodeAttribute =
+              fbx_node_.GetNodeAttributeByIndex(iNodeAttribute);
+          if (nodeAttribute->GetAttributeType() ==
+              fbxsdk::FbxNodeAttribute::EType::eMesh) {
+            fbxMeshes.push_back(
+                static_cast<fbxsdk::FbxMesh *>(nodeAttribute));
+            kept = kept || names.count(nodeAttribute->GetName()) != 0;
+          }
+        }
+        if (kept) {
+          keep(fbx_node_, true);
+          fbxKeptMeshes.insert(fbxKeptMeshes.end(), fbxMeshes.begin(),
+                               fbxMeshes.end());
+        }
+        const auto nChildren = fbx_node_.GetChildCount();
+        for (auto iChild = 0; iChild < nChildren; ++iChild) {
+          visit(*fbx_node_.GetChild(iChild), kept);
+        }
+      };
+  const auto nChildren = fbx_root_node_.GetChildCount();
+  for (auto iChild = 0; iChild < nChildren; ++iChild) {
+    visit(*fbx_root_node_.GetChild(iChild), false);
+  }
+
+  if (!_options.export_skin) {
+    return;
+  }
+  for (const auto fbxMesh : fbxKeptMeshes) {
+    const auto nSkins = fbxMesh->GetDeformerCount(fbxsdk::FbxDeformer::eSkin);
+    for (auto iSkin = 0; iSkin < nSkins; ++iSkin) {
+      const auto fbxSkin = static_cast<fbxsdk::FbxSkin *>(
+          fbxMesh->GetDeformer(iSkin, fbxsdk::FbxDeformer::eSkin));
+      const auto nClusters = fbxSkin->GetClusterCount();
+      for (auto iCluster = 0; iCluster < nClusters; ++iCluster) {
+        if (const auto jointNode = fbxSkin->GetCluster(iCluster)->GetLink()) {
+          keep(*jointNode, false);
+        }
+      }
+    }
+  }
+}
+
 void SceneConverter::_announceNode(fbxsdk::FbxNode &fbx_node_) {
+  if (!_options.nodeFilter.empty() && !_keptNodes.contains(&fbx_node_)) {
+    return;
+  }
   _anncouncedfbxNodes.push_back(&fbx_node_);
   fx::gltf::Node glTFNode;
   auto glTFNodeIndex =
@@ -197,9 +370,10 @@ SceneConverter::_convertScene(fbxsdk::FbxScene &fbx_scene_) {
   auto rootNode = fbx_scene_.GetRootNode();
   auto nChildren = rootNode->GetChildCount();
   for (auto iChild = 0; iChild < nChildren; ++iChild) {
-    auto glTFNodeIndex = _getNodeMap(*rootNode->GetChild(iChild));
-    assert(glTFNodeIndex);
-    glTFScene.nodes.push_back(*glTFNodeIndex);
+    // Nodes may be filtered out.
+    if (auto glTFNodeIndex = _getNodeMap(*rootNode->GetChild(iChild))) {
+      glTFScene.nodes.push_back(*glTFNodeIndex);
+    }
   }
 
   auto glTFSceneIndex =
@@ -207,7 +381,8 @@ SceneConverter::_convertScene(fbxsdk::FbxScene &fbx_scene_) {
   return glTFSceneIndex;
 }
 
-void SceneConverter::_convertNode(fbxsdk::FbxNode &fbx_node_) {
+std::optional<SceneConverter::NodeMeshesJob>
+SceneConverter::_convertNode(fbxsdk::FbxNode &fbx_node_) {
   auto glTFNodeIndexX = _getNodeMap(fbx_node_);
   assert(glTFNodeIndexX);
   auto glTFNodeIndex = *glTFNodeIndexX;
@@ -218,9 +393,10 @@ void SceneConverter::_convertNode(fbxsdk::FbxNode &fbx_node_) {
 
   auto nChildren = fbx_node_.GetChildCount();
   for (auto iChild = 0; iChild < nChildren; ++iChild) {
-    auto glTFNodeIndex = _getNodeMap(*fbx_node_.GetChild(iChild));
-    assert(glTFNodeIndex);
-    glTFNode.children.push_back(*glTFNodeIndex);
+    // Nodes may be filtered out.
+    if (auto glTFNodeIndex = _getNodeMap(*fbx_node_.GetChild(iChild))) {
+      glTFNode.children.push_back(*glTFNodeIndex);
+    }
   }
 
   fbxsdk::FbxTransform::EInheritType inheritType;
@@ -325,18 +501,21 @@ void SceneConverter::_convertNode(fbxsdk::FbxNode &fbx_node_) {
     }
   }
 
-  if (!fbxMeshes.empty()) {
-    auto convertMeshResult =
-        _convertNodeMeshes(nodeBumpData, fbxMeshes, fbx_node_);
-    if (convertMeshResult) {
-      glTFNode.mesh = convertMeshResult->glTFMeshIndex;
-      if (convertMeshResult->glTFSkinIndex) {
-        glTFNode.skin = *convertMeshResult->glTFSkinIndex;
-      }
-    }
+  _nodeDumpMetaMap.emplace(&fbx_node_, nodeBumpData);
+
+  if (!_options.nodeFilter.empty() && !_keptNodes[&fbx_node_]) {
+    // Kept as an ancestor or a joint.
+    return {};
   }
 
-  _nodeDumpMetaMap.emplace(&fbx_node_, nodeBumpData);
+  if (fbxMeshes.empty()) {
+    return {};
+  }
+
+  NodeMeshesJob nodeMeshesJob;
+  nodeMeshesJob.fbxNode = &fbx_node_;
+  nodeMeshesJob.fbxMeshes = std::move(fbxMeshes);
+  return nodeMeshesJob;
 }
 
 std::string SceneConverter::_getName(fbxsdk::FbxNode &fbx_node_) {
@@ -2,17 +2,27 @@
 #pragma once
 
 #include <bee/Convert/FbxMeshVertexLayout.h>
+#include <bee/Convert/ImageIO.h>
 #include <bee/Convert/GLTFSamplerHash.h>
 #include <bee/Convert/NeutralType.h>
+#include <bee/Convert/TextureTranscoding.h>
+#include <bee/Convert/VertexPacking.h>
+#include <bee/ConvertCache.h>
+#include <bee/ConvertLimits.h>
+#include <bee/ConvertStats.h>
 #include <bee/Converter.h>
 #include <bee/GLTFBuilder.h>
 #include <bee/GLTFUtilities.h>
+#include <bee/TextureSearchIndex.h>
 #include <bee/polyfills/filesystem.h>
+#include <array>
 #include <compare>
 #include <fbxsdk.h>
 #include <list>
 #include <map>
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -28,11 +38,20 @@ inline std::string_view forceTreatAsPlain(std::u8string_view s_) {
 
 class SceneConverter {
 public:
+  /// <summary>
+  /// If `side_effects_` is not null, the files the conversion depends on,
+  /// copies and writes are recorded into it. If `stats_` is not null, the
+  /// phases, meshes and animation stacks are measured into it. If `limits_` is
+  /// not null, the conversion throws `ConvertAborted` once they're exceeded.
+  /// </summary>
   SceneConverter(fbxsdk::FbxManager &fbx_manager_,
                  fbxsdk::FbxScene &fbx_scene_,
                  const ConvertOptions &options_,
                  std::u8string_view fbx_file_name_,
-                 GLTFBuilder &glTF_builder_);
+                 GLTFBuilder &glTF_builder_,
+                 ConvertSideEffects *side_effects_ = nullptr,
+                 ConvertStats *stats_ = nullptr,
+                 const ConvertLimits *limits_ = nullptr);
 
   void convert();
 
@@ -85,7 +104,13 @@ private:
       struct IBMSpreader;
     };
 
-    struct InfluenceChannel {
+    /// <summary>
+    /// Joints and weights packed by control point: those of control point
+    /// `i` are at `[i * channelCount, (i + 1) * channelCount)`, following
+    /// the layout of a staged vertex. Unused slots have a zero weight.
+    /// </summary>
+    struct Influences {
+      std::uint32_t channelCount = 0;
       std::vector<NeutralVertexJointComponent> joints;
       std::vector<NeutralVertexWeightComponent> weights;
     };
@@ -94,7 +119,7 @@ private:
 
     std::vector<Bone> bones;
 
-    std::vector<InfluenceChannel> channels;
+    Influences influences;
   };
 
   struct NodeMeshesSkinData {
@@ -103,9 +128,10 @@ private:
     std::vector<MeshSkinData::Bone> bones;
 
     /// <summary>
-    /// Channels of each mesh.
+    /// Influences of each mesh, indexing `bones`. Meshes without skin have
+    /// no channel.
     /// </summary>
-    std::vector<std::vector<MeshSkinData::InfluenceChannel>> meshChannels;
+    std::vector<MeshSkinData::Influences> meshInfluences;
   };
 
   struct FbxNodeMeshesBumpMeta {
@@ -120,26 +146,36 @@ private:
 
   struct FbxNodeDumpMeta {
     std::uint32_t glTFNodeIndex;
+    /// <summary>
+    /// The node holding the mesh, if it's not the node itself. See
+    /// `ConvertOptions::MeshQuantization::positionBits`.
+    /// </summary>
+    std::optional<std::uint32_t> glTFMeshNodeIndex;
     std::optional<FbxNodeMeshesBumpMeta> meshes;
   };
 
-  struct ConvertMeshResult {
-    GLTFBuilder::XXIndex glTFMeshIndex;
-    std::optional<GLTFBuilder::XXIndex> glTFSkinIndex;
-  };
-
   struct VertexBulk {
-    using ChannelWriter =
-        std::function<void(std::byte *out_, const std::byte *in_)>;
-
     struct Channel {
       std::string name;
       fx::gltf::Accessor::Type type;
       fx::gltf::Accessor::ComponentType componentType;
       std::size_t inOffset;
       std::uint32_t outOffset;
-      ChannelWriter writer;
+      UntypedComponentType inType;
+      /// <summary>
+      /// Number of components read from the untyped vertex. It may be less
+      /// than the count of `type`, in which case the rest is zero.
+      /// </summary>
+      std::uint32_t inComponentCount;
       std::optional<std::uint32_t> target;
+      bool normalized = false;
+      std::optional<VertexPackChannel::Transform> transform;
+      bool renormalize = false;
+      /// <summary>
+      /// Set if the channel is not staged in the untyped vertices but is the
+      /// position deltas of its target, looked up by control point.
+      /// </summary>
+      bool byControlPoint = false;
     };
 
     std::optional<std::uint32_t> morphTargetHint;
@@ -147,15 +183,19 @@ private:
     std::list<Channel> channels;
     bool vertexBuffer = false;
 
-    void addChannel(const std::string &name_,
-                    fx::gltf::Accessor::Type type_,
-                    fx::gltf::Accessor::ComponentType component_type_,
-                    std::uint32_t in_offset_,
-                    ChannelWriter writer_,
-                    std::optional<std::uint32_t> target_ = {}) {
-      channels.emplace_back(Channel{name_, type_, component_type_, in_offset_,
-                                    stride, writer_, target_});
-      stride += countBytes(type_, component_type_);
+    Channel &addChannel(const std::string &name_,
+                        fx::gltf::Accessor::Type type_,
+                        fx::gltf::Accessor::ComponentType component_type_,
+                        std::uint32_t in_offset_,
+                        UntypedComponentType in_type_,
+                        std::uint32_t in_component_count_,
+                        std::optional<std::uint32_t> target_ = {}) {
+      auto &channel = channels.emplace_back(
+          Channel{name_, type_, component_type_, in_offset_, stride, in_type_,
+                  in_component_count_, target_});
+      // Vertex attributes are 4-byte aligned.
+      stride += (countBytes(type_, component_type_) + 3) / 4 * 4;
+      return channel;
     }
   };
 
@@ -197,52 +237,180 @@ private:
     std::vector<double> values;
   };
 
+  template <typename Value_> struct AnimationCurve {
+    std::vector<double> times;
+    std::vector<Value_> values;
+  };
+
+  struct TrsAnimation {
+    std::uint32_t glTFNodeIndex = 0;
+    /// <summary>
+    /// Absent if translation is not animated. So are the others.
+    /// </summary>
+    std::optional<AnimationCurve<fbxsdk::FbxVector4>> translation;
+    std::optional<AnimationCurve<fbxsdk::FbxQuaternion>> rotation;
+    std::optional<AnimationCurve<fbxsdk::FbxVector4>> scale;
+  };
+
+  /// <summary>
+  /// Animation of a node on a layer, sampled but not written yet.
+  /// </summary>
+  struct NodeAnimationBake {
+    fbxsdk::FbxNode *fbxNode = nullptr;
+    std::optional<TrsAnimation> trs;
+    std::vector<MorphAnimation> morphAnimations;
+  };
+
   struct TextureContext {
     std::unordered_map<std::string, std::uint32_t> channel_index_map;
-
-    bool compatible_with(const TextureContext &that_) const {
-      const auto &lhs = this->channel_index_map;
-      const auto &rhs = that_.channel_index_map;
-      for (const auto &[k, v] : lhs) {
-        if (const auto r = rhs.find(k); r != rhs.end() && r->second != v) {
-          return false;
-        }
-      }
-      return true;
-    }
   };
 
   struct MaterialUsage {
     bool hasTransparentVertex = false;
 
     TextureContext texture_context;
+  };
 
-    bool operator==(const MaterialUsage &that_) const {
-      return this->hasTransparentVertex == that_.hasTransparentVertex &&
-             this->texture_context.compatible_with(that_.texture_context);
-    }
+  /// <summary>
+  /// Vertices and indices of a primitive, typed but not yet committed into
+  /// the glTF builder.
+  /// </summary>
+  struct StagedPrimitive {
+    std::list<VertexBulk> bulks;
+    std::uint32_t vertexCount = 0;
+    std::uint32_t vertexSize = 0;
+    std::unique_ptr<std::byte[]> vertices;
+    std::vector<std::uint32_t> indices;
+    /// <summary>
+    /// Index of the material in the node, negative if there's none.
+    /// </summary>
+    int materialIndex = -1;
+    MaterialUsage materialUsage;
+    /// <summary>
+    /// Set if POSITION is quantized. Its transform is then decided by the
+    /// bounds of the whole mesh, when committing.
+    /// </summary>
+    std::optional<std::uint32_t> positionQuantizationBits;
+    /// <summary>
+    /// Position deltas, by control point, of the shapes that are not staged
+    /// in `vertices`; empty for the ones that are. The control point index of
+    /// each vertex is then staged at `controlPointIndexOffset`.
+    /// </summary>
+    std::vector<std::vector<NeutralVertexComponent>> shapeDeltas;
+    std::optional<std::uint32_t> controlPointIndexOffset;
+  };
+
+  /// <summary>
+  /// What makes nodes share the glTF mesh converted for the first of them.
+  /// </summary>
+  struct NodeMeshesInstanceKey {
+    std::vector<fbxsdk::FbxUInt64> meshes;
+    /// <summary>
+    /// Materials of the node, if they're exported.
+    /// </summary>
+    std::vector<fbxsdk::FbxUInt64> materials;
+    std::array<double, 16> geometricTransform;
+
+    auto operator<=>(const NodeMeshesInstanceKey &) const = default;
   };
 
+  /// <summary>
+  /// What's written for the meshes of a node, to be referenced by each node
+  /// having the same `NodeMeshesInstanceKey`.
+  /// </summary>
+  struct NodeMeshesInstance {
+    std::string meshName;
+    GLTFBuilder::XXIndex glTFMeshIndex = 0;
+    std::optional<GLTFBuilder::XXIndex> glTFSkinIndex;
+    /// <summary>
+    /// Center and scale restoring quantized positions, see
+    /// `FbxNodeDumpMeta::glTFMeshNodeIndex`.
+    /// </summary>
+    std::optional<std::tuple<fbxsdk::FbxVector4, double>> dequantization;
+    FbxNodeMeshesBumpMeta meta;
+  };
+
+  /// <summary>
+  /// Meshes attached to a node. They're converted in three steps:
+  /// `_prepareNodeMeshes()` gathers what's shared by the meshes,
+  /// `_stageMeshAsPrimitives()` may then run in parallel for each mesh and
+  /// `_commitNodeMeshes()` finally writes them into the glTF builder, in node
+  /// order, so that the result does not depend on the thread count.
+  /// </summary>
+  struct NodeMeshesJob {
+    fbxsdk::FbxNode *fbxNode = nullptr;
+    std::vector<fbxsdk::FbxMesh *> fbxMeshes;
+    std::string meshName;
+    std::optional<fbxsdk::FbxMatrix> vertexTransform;
+    std::optional<fbxsdk::FbxMatrix> normalTransform;
+    std::optional<NodeMeshesSkinData> skinData;
+    FbxNodeMeshesBumpMeta meta;
+    std::vector<std::vector<fbxsdk::FbxShape *>> meshShapes;
+    std::vector<const fbxsdk::FbxLayerElementMaterial *> materialLayers;
+    /// <summary>
+    /// Primitives of each mesh, one per material.
+    /// </summary>
+    std::vector<std::vector<StagedPrimitive>> primitives;
+    NodeMeshesInstanceKey instanceKey;
+    /// <summary>
+    /// Set if an earlier node has the same `instanceKey`: nothing is then
+    /// staged nor committed, the node references the meshes of that node.
+    /// </summary>
+    bool instance = false;
+    /// <summary>
+    /// When each mesh has been staged, if stats are collected.
+    /// </summary>
+    std::vector<ConvertStats::Span> stagingSpans;
+  };
+
+  /// <summary>
+  /// What the glTF material converted from a material under a usage depends
+  /// on: the transparency flag and, for each UV set its textures reference,
+  /// the texture coordinate set it resolves to.
+  /// </summary>
   struct MaterialConvertKey {
   public:
+    /// <summary>
+    /// `uv_sets_` are the UV sets referenced by the material, sorted.
+    /// </summary>
     MaterialConvertKey(const fbxsdk::FbxSurfaceMaterial &material_,
-                       const MaterialUsage &usage_)
-        : _material(material_.GetUniqueID()), _usage(usage_) {
+                       const MaterialUsage &usage_,
+                       std::span<const std::string> uv_sets_)
+        : _material(material_.GetUniqueID()),
+          _hasTransparentVertex(usage_.hasTransparentVertex) {
+      const auto &channelIndexMap = usage_.texture_context.channel_index_map;
+      _uvChannels.reserve(uv_sets_.size());
+      for (const auto &uvSet : uv_sets_) {
+        const auto rChannel = channelIndexMap.find(uvSet);
+        // As `_findUVIndex()` falls back.
+        _uvChannels.push_back(
+            rChannel == channelIndexMap.end() ? 0 : rChannel->second);
+      }
     }
 
-    bool operator==(const MaterialConvertKey &that_) const {
-      return this->_material == that_._material && this->_usage == that_._usage;
-    }
+    bool operator==(const MaterialConvertKey &) const = default;
 
     struct Hash {
       std::size_t operator()(const MaterialConvertKey &key_) const noexcept {
-        return std::hash<fbxsdk::FbxUInt64>{}(key_._material);
+        std::size_t seed = std::hash<fbxsdk::FbxUInt64>{}(key_._material);
+        const auto combine = [&seed](std::size_t hash_) {
+          seed ^= hash_ + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        };
+        combine(key_._hasTransparentVertex);
+        for (const auto uvChannel : key_._uvChannels) {
+          combine(uvChannel);
+        }
+        return seed;
       }
     };
 
   private:
     fbxsdk::FbxUInt64 _material;
-    MaterialUsage _usage;
+    bool _hasTransparentVertex;
+    /// <summary>
+    /// In the order of the UV sets of the material.
+    /// </summary>
+    std::vector<std::uint32_t> _uvChannels;
   };
 
   GLTFBuilder &_glTFBuilder;
@@ -251,20 +419,76 @@ private:
   fbxsdk::FbxScene &_fbxScene;
   const ConvertOptions &_options;
   const std::u8string _fbxFileName;
+  ConvertSideEffects *_sideEffects;
+  ConvertStats *_stats;
+  const ConvertLimits *_limits;
   fbxsdk::FbxTime::EMode _animationTimeMode = fbxsdk::FbxTime::EMode::eFrames24;
   std::map<fbxsdk::FbxUInt64, GLTFBuilder::XXIndex> _fbxNodeMap;
   std::vector<fbxsdk::FbxNode *> _anncouncedfbxNodes;
+  /// <summary>
+  /// With `ConvertOptions::nodeFilter`, the nodes to convert, mapped to
+  /// whether their meshes are converted: the nodes kept only as ancestors or
+  /// joints are converted without them.
+  /// </summary>
+  std::unordered_map<const fbxsdk::FbxNode *, bool> _keptNodes;
   std::unordered_map<GLTFSamplerKeys, GLTFBuilder::XXIndex, GLTFSamplerHash>
       _uniqueSamplers;
   std::unordered_map<MaterialConvertKey,
                      std::optional<GLTFBuilder::XXIndex>,
                      MaterialConvertKey::Hash>
       _materialConvertCache;
+  /// <summary>
+  /// UV sets referenced by the textures of each material, see
+  /// `_getMaterialUVSets()`.
+  /// </summary>
+  std::unordered_map<fbxsdk::FbxUInt64, std::vector<std::string>>
+      _materialUVSets;
+  /// <summary>
+  /// Empty until the first node of the key is committed.
+  /// </summary>
+  std::map<NodeMeshesInstanceKey, std::optional<NodeMeshesInstance>>
+      _nodeMeshesInstances;
   std::unordered_map<fbxsdk::FbxUInt64,
                      std::optional<fx::gltf::Material::Texture>>
       _textureMap;
+  std::shared_ptr<TextureSearchIndex> _textureSearchIndex;
+  ImageBatch _imageBatch;
+  /// <summary>
+  /// Images whose content is written by `_writeImages()`, with their file in
+  /// `_imageBatch`.
+  /// </summary>
+  std::vector<std::pair<GLTFBuilder::XXIndex, std::size_t>> _pendingImages;
+  /// <summary>
+  /// Transcodes images if `ConvertOptions::textureTranscoding` applies.
+  /// </summary>
+  std::unique_ptr<TextureTranscoder> _textureTranscoder;
+  struct TranscodedImage {
+    std::size_t job;
+    std::optional<GLTFBuilder::XXIndex> texture;
+  };
+  /// <summary>
+  /// Images whose content is written by `_writeTranscodedImages()`, with
+  /// their job in `_textureTranscoder` and the texture using them.
+  /// </summary>
+  std::map<GLTFBuilder::XXIndex, TranscodedImage> _transcodedImages;
   std::unordered_map<const fbxsdk::FbxNode *, FbxNodeDumpMeta> _nodeDumpMetaMap;
+  /// <summary>
+  /// Time accessors of the animation being converted, by the hash of their
+  /// times. Samplers having the same times share their input.
+  /// </summary>
+  std::unordered_map<
+      std::uint64_t,
+      std::vector<std::pair<std::vector<double>, GLTFBuilder::XXIndex>>>
+      _animationTimeAccessors;
   std::optional<fbxsdk::FbxDouble> _unitScaleFactor = 1.0;
+  /// <summary>
+  /// Buffers into which the mesh and the animation stack being converted,
+  /// and the images embedded, go, see `ConvertOptions::bufferPartitioning`.
+  /// </summary>
+  GLTFBuilder::XXIndex _geometryBuffer = 0;
+  GLTFBuilder::XXIndex _morphTargetBuffer = 0;
+  GLTFBuilder::XXIndex _animationBuffer = 0;
+  GLTFBuilder::XXIndex _imageBuffer = 0;
 
   inline fbxsdk::FbxVector4
   _applyUnitScaleFactorV3(const fbxsdk::FbxVector4 &v_) const {
@@ -291,10 +515,38 @@ private:
 
   fbxsdk::FbxGeometryConverter &_getGeometryConverter();
 
+  /// <summary>
+  /// Throws `ConvertAborted` if the limits are exceeded. It may be called
+  /// from worker threads.
+  /// </summary>
+  void _checkLimits() const {
+    if (_limits) {
+      _limits->check();
+    }
+  }
+
+  void _reportProgress(ConvertProgress::Stage stage_,
+                       std::string_view name_,
+                       std::size_t done_,
+                       std::size_t total_) const;
+
+  /// <summary>
+  /// Whether accessors and buffer views get names, see
+  /// `ConvertOptions::naming`.
+  /// </summary>
+  bool _namesBufferObjects() const {
+    return _options.naming == ConvertOptions::NamingPolicy::full;
+  }
+
   void _prepareScene();
 
   void _announceNodes(const fbxsdk::FbxScene &fbx_scene_);
 
+  /// <summary>
+  /// Fills `_keptNodes` as per `ConvertOptions::nodeFilter`.
+  /// </summary>
+  void _filterNodes(fbxsdk::FbxNode &fbx_root_node_);
+
   void _announceNode(fbxsdk::FbxNode &fbx_node_);
 
   void _setNodeMap(const fbxsdk::FbxNode &fbx_node_,
@@ -309,33 +561,63 @@ private:
 
   GLTFBuilder::XXIndex _convertScene(fbxsdk::FbxScene &fbx_scene_);
 
-  void _convertNode(fbxsdk::FbxNode &fbx_node_);
+  /// <summary>
+  /// Converts the node, except its meshes which are returned for
+  /// `_convertNodesMeshes()`.
+  /// </summary>
+  std::optional<NodeMeshesJob> _convertNode(fbxsdk::FbxNode &fbx_node_);
 
   std::string _getName(fbxsdk::FbxNode &fbx_node_);
 
-  std::optional<ConvertMeshResult>
-  _convertNodeMeshes(FbxNodeDumpMeta &node_meta_,
-                     const std::vector<fbxsdk::FbxMesh *> &fbx_meshes_,
-                     fbxsdk::FbxNode &fbx_node_);
+  void _convertNodesMeshes(std::span<NodeMeshesJob> jobs_);
+
+  NodeMeshesInstanceKey _getNodeMeshesInstanceKey(const NodeMeshesJob &job_);
+
+  void _prepareNodeMeshes(NodeMeshesJob &job_);
+
+  /// <summary>
+  /// Writes the meshes, then fills the entry of `_nodeMeshesInstances`.
+  /// </summary>
+  void _commitNodeMeshes(NodeMeshesJob &job_);
+
+  /// <summary>
+  /// The stats of the staged meshes of a node, which is not committed yet.
+  /// Their staging is recorded into the trace.
+  /// </summary>
+  ConvertStats::Mesh _countNodeMeshes(const NodeMeshesJob &job_);
+
+  void _attachNodeMeshes(fbxsdk::FbxNode &fbx_node_,
+                         const NodeMeshesInstance &instance_);
+
+  /// <summary>
+  /// Collapses sibling nodes sharing a mesh, see
+  /// `ConvertOptions::gpuInstancing`. Nodes are then renumbered.
+  /// </summary>
+  void _instanceSiblingNodes();
 
   std::string _getName(fbxsdk::FbxMesh &fbx_mesh_, fbxsdk::FbxNode &fbx_node_);
 
   std::tuple<fbxsdk::FbxMatrix, fbxsdk::FbxMatrix>
   _getGeometrixTransform(fbxsdk::FbxNode &fbx_node_);
 
-  fx::gltf::Primitive _convertMeshAsPrimitive(
+  /// <summary>
+  /// Only reads the FBX mesh and does not touch the glTF builder, so that it
+  /// may be run concurrently on different meshes. Polygons are triangulated
+  /// and there's a primitive for each material of `material_layer_`.
+  /// </summary>
+  std::vector<StagedPrimitive> _stageMeshAsPrimitives(
       fbxsdk::FbxMesh &fbx_mesh_,
-      std::string_view mesh_name_,
-      fbxsdk::FbxMatrix *vertex_transform_,
-      fbxsdk::FbxMatrix *normal_transform_,
+      const fbxsdk::FbxMatrix *vertex_transform_,
+      const fbxsdk::FbxMatrix *normal_transform_,
       std::span<fbxsdk::FbxShape *> fbx_shapes_,
-      std::span<MeshSkinData::InfluenceChannel> skin_influence_channels_,
-      MaterialUsage &material_usage_);
+      const MeshSkinData::Influences *skin_influences_,
+      const fbxsdk::FbxLayerElementMaterial *material_layer_);
 
   FbxMeshVertexLayout _getFbxMeshVertexLayout(
       fbxsdk::FbxMesh &fbx_mesh_,
       std::span<fbxsdk::FbxShape *> fbx_shapes_,
-      std::span<MeshSkinData::InfluenceChannel> skin_influence_channels_);
+      const MeshSkinData::Influences *skin_influences_,
+      const std::vector<bool> &staged_shapes_);
 
   fx::gltf::Primitive _createPrimitive(std::list<VertexBulk> &bulks_,
                                        std::uint32_t target_count_,
@@ -345,11 +627,26 @@ private:
                                        std::span<std::uint32_t> indices_,
                                        std::string_view primitive_name_);
 
+  /// <summary>
+  /// Writes the morph targets of the primitive. Each target attribute is
+  /// written as a sparse accessor if that is smaller than a dense one; normal
+  /// deltas that are all zero are dropped.
+  /// </summary>
+  void _createMorphTargets(fx::gltf::Primitive &glTF_primitive_,
+                           const StagedPrimitive &staged_primitive_,
+                           std::string_view primitive_name_);
+
   std::list<VertexBulk>
-  _typeVertices(const FbxMeshVertexLayout &vertex_layout_);
+  _typeVertices(const FbxMeshVertexLayout &vertex_layout_,
+                const std::byte *untyped_vertices_,
+                std::uint32_t vertex_count_,
+                std::optional<std::uint32_t> &position_quantization_bits_);
 
-  fbxsdk::FbxSurfaceMaterial *_getTheUniqueMaterial(fbxsdk::FbxMesh &fbx_mesh_,
-                                                    fbxsdk::FbxNode &fbx_node_);
+  /// <summary>
+  /// The material layer whose indices assign materials to the polygons.
+  /// </summary>
+  const fbxsdk::FbxLayerElementMaterial *
+  _getMaterialLayer(fbxsdk::FbxMesh &fbx_mesh_);
 
   /// <summary>
   /// Things get even more complicated if there are more than one mesh attached to a node.
@@ -383,6 +680,13 @@ private:
   _convertMaterial(fbxsdk::FbxSurfaceMaterial &fbx_material_,
                    const MaterialUsage &material_usage_);
 
+  /// <summary>
+  /// The UV sets named by the file textures connected to any property of
+  /// `fbx_material_`, sorted, leaving out the default one.
+  /// </summary>
+  const std::vector<std::string> &
+  _getMaterialUVSets(const fbxsdk::FbxSurfaceMaterial &fbx_material_);
+
   std::optional<GLTFBuilder::XXIndex>
   _convertLambertMaterial(fbxsdk::FbxSurfaceLambert &fbx_material_,
                           const MaterialUsage &material_usage_);
@@ -397,14 +701,21 @@ private:
 
   std::optional<fx::gltf::Material::Texture>
   _convertTextureProperty(fbxsdk::FbxProperty &fbx_property_,
-                          const TextureContext &texture_context_);
+                          const TextureContext &texture_context_,
+                          bool normal_map_);
 
+  /// <summary>
+  /// Converts the texture once; later uses share the result. `normal_map_`
+  /// tells how the image is transcoded, so the first use decides.
+  /// </summary>
   std::optional<fx::gltf::Material::Texture>
   _convertFileTextureShared(fbxsdk::FbxFileTexture &fbx_file_texture_,
-                            const TextureContext &texture_context_);
+                            const TextureContext &texture_context_,
+                            bool normal_map_);
 
   std::optional<GLTFBuilder::XXIndex>
-  _convertFileTexture(const fbxsdk::FbxFileTexture &fbx_texture_);
+  _convertFileTexture(const fbxsdk::FbxFileTexture &fbx_texture_,
+                      bool normal_map_);
 
   std::optional<fx::gltf::Material::NormalTexture>
   _convertTexturePropertyAsNormalTexture(
@@ -422,15 +733,35 @@ private:
   _convertTextureUVTransform(const fbxsdk::FbxTexture &fbx_texture_,
                              fx::gltf::Material::Texture &glTF_texture_info_);
 
-  static bool _hasValidImageExtension(const bee::filesystem::path &path_);
+  bool _hasValidImageExtension(const bee::filesystem::path &path_) const;
 
   std::optional<GLTFBuilder::XXIndex>
-  _convertTextureSource(const fbxsdk::FbxFileTexture &fbx_texture_);
+  _convertTextureSource(const fbxsdk::FbxFileTexture &fbx_texture_,
+                        bool normal_map_);
 
-  std::optional<std::string> _searchImage(const std::string_view name_);
+  /// <summary>
+  /// Searches the texture search locations, in order, for an image whose stem
+  /// is `name_`.
+  /// </summary>
+  std::optional<std::u8string> _searchImage(std::u8string_view name_);
 
   std::optional<std::u8string> _processPath(const bee::filesystem::path &path_);
 
+  /// <summary>
+  /// Embeds or copies the image files referenced with `PathMode::embedded` or
+  /// `PathMode::copy`. Each file is read or copied once, content shared by
+  /// several files is stored once, and files are processed with
+  /// `ConvertOptions::ioThreads` threads.
+  /// </summary>
+  void _writeImages();
+
+  /// <summary>
+  /// Waits for the transcoded images and embeds or writes them, referencing
+  /// them from their textures through KHR_texture_basisu. Images which failed
+  /// to transcode are handed to `_writeImages()` as they are.
+  /// </summary>
+  void _writeTranscodedImages();
+
   static std::u8string _getMimeTypeFromExtension(std::u8string_view ext_name_);
 
   std::optional<GLTFBuilder::XXIndex>
@@ -450,15 +781,32 @@ private:
                               fbxsdk::FbxScene &fbx_scene_,
                               const AnimRange &anim_range_);
 
-  void _convertAnimationLayer(fx::gltf::Animation &glTF_animation_,
-                              fbxsdk::FbxAnimLayer &fbx_anim_layer_,
-                              fbxsdk::FbxNode &fbx_node_,
-                              const AnimRange &anim_range_);
+  NodeAnimationBake
+  _bakeNodeAnimation(fbxsdk::FbxAnimLayer &fbx_anim_layer_,
+                     fbxsdk::FbxNode &fbx_node_,
+                     const AnimRange &anim_range_,
+                     fbxsdk::FbxAnimEvaluator &fbx_evaluator_);
 
-  void _extractWeightsAnimation(fx::gltf::Animation &glTF_animation_,
-                                fbxsdk::FbxAnimLayer &fbx_anim_layer_,
-                                fbxsdk::FbxNode &fbx_node_,
-                                const AnimRange &anim_range_);
+  void _writeNodeAnimation(fx::gltf::Animation &glTF_animation_,
+                           const NodeAnimationBake &bake_);
+
+  std::vector<MorphAnimation>
+  _extractWeightsAnimation(fbxsdk::FbxAnimLayer &fbx_anim_layer_,
+                           fbxsdk::FbxNode &fbx_node_,
+                           const AnimRange &anim_range_);
+
+  void
+  _writeWeightsAnimation(fx::gltf::Animation &glTF_animation_,
+                         const fbxsdk::FbxNode &fbx_node_,
+                         std::span<const MorphAnimation> morph_animations_);
+
+  /// <summary>
+  /// The time accessor of `times_`, shared by all samplers of the animation
+  /// having these times; it's hence named after the animation.
+  /// </summary>
+  GLTFBuilder::XXIndex
+  _getAnimationTimeAccessor(const fx::gltf::Animation &glTF_animation_,
+                            std::span<const double> times_);
 
   void _writeMorphAnimtion(fx::gltf::Animation &glTF_animation_,
                            const MorphAnimation &morph_animtion_,
@@ -472,9 +820,14 @@ private:
                            const FbxBlendShapeData &blend_shape_data_,
                            const AnimRange &anim_range_);
 
-  void _extractTrsAnimation(fx::gltf::Animation &glTF_animation_,
-                            fbxsdk::FbxAnimLayer &fbx_anim_layer_,
-                            fbxsdk::FbxNode &fbx_node_,
-                            const AnimRange &anim_range_);
+  std::optional<TrsAnimation>
+  _extractTrsAnimation(fbxsdk::FbxAnimLayer &fbx_anim_layer_,
+                       fbxsdk::FbxNode &fbx_node_,
+                       const AnimRange &anim_range_,
+                       fbxsdk::FbxAnimEvaluator &fbx_evaluator_);
+
+  void _writeTrsAnimation(fx::gltf::Animation &glTF_animation_,
+                          const fbxsdk::FbxNode &fbx_node_,
+                          const TrsAnimation &trs_animation_);
 };
 } // namespace bee
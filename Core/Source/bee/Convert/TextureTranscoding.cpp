@@ -0,0 +1,352 @@
+#include <bee/Convert/ImageIO.h>
+#include <bee/Convert/TextureTranscoding.h>
+#include <bee/Parallel.h>
+#include <bee/TextureCache.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ktx.h>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_NO_STDIO
+#include <stb_image.h>
+
+namespace bee {
+namespace {
+/// <summary>
+/// `VK_FORMAT_R8G8B8A8_UNORM` and `VK_FORMAT_R8G8B8A8_SRGB`.
+/// </summary>
+constexpr std::uint32_t vkFormatRGBA8Unorm = 37;
+constexpr std::uint32_t vkFormatRGBA8Srgb = 43;
+
+struct Image {
+  std::uint32_t width = 0;
+  std::uint32_t height = 0;
+  std::vector<std::uint8_t> pixels;
+};
+
+float decodeSrgb(std::uint8_t value_) {
+  const auto c = value_ / 255.0f;
+  return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+std::uint8_t encodeSrgb(float value_) {
+  const auto c = value_ <= 0.0031308f
+                     ? value_ * 12.92f
+                     : 1.055f * std::pow(value_, 1.0f / 2.4f) - 0.055f;
+  return static_cast<std::uint8_t>(
+      std::lround(std::clamp(c, 0.0f, 1.0f) * 255.0f));
+}
+
+const std::array<float, 256> &getSrgbTable() {
+  static const auto srgbTable = [] {
+    std::array<float, 256> table;
+    for (std::size_t i = 0; i < table.size(); ++i) {
+      table[i] = decodeSrgb(static_cast<std::uint8_t>(i));
+    }
+    return table;
+  }();
+  return srgbTable;
+}
+
+/// <summary>
+/// Halves each dimension of `image_`, down to 1, with a box filter. sRGB
+/// color channels are averaged as linear values; alpha always is linear.
+/// </summary>
+Image halve(const Image &image_, bool srgb_) {
+  const auto &srgbTable = getSrgbTable();
+
+  Image result;
+  result.width = std::max(1u, image_.width / 2);
+  result.height = std::max(1u, image_.height / 2);
+  result.pixels.resize(std::size_t{result.width} * result.height * 4);
+  for (std::uint32_t y = 0; y < result.height; ++y) {
+    const auto y0 = std::min(y * 2, image_.height - 1);
+    const auto y1 = std::min(y * 2 + 1, image_.height - 1);
+    for (std::uint32_t x = 0; x < result.width; ++x) {
+      const auto x0 = std::min(x * 2, image_.width - 1);
+      const auto x1 = std::min(x * 2 + 1, image_.width - 1);
+      const std::array<const std::uint8_t *, 4> texels = {
+          &image_.pixels[(std::size_t{y0} * image_.width + x0) * 4],
+          &image_.pixels[(std::size_t{y0} * image_.width + x1) * 4],
+          &image_.pixels[(std::size_t{y1} * image_.width + x0) * 4],
+          &image_.pixels[(std::size_t{y1} * image_.width + x1) * 4],
+      };
+      auto *target =
+          &result.pixels[(std::size_t{y} * result.width + x) * 4];
+      for (std::size_t iChannel = 0; iChannel < 4; ++iChannel) {
+        if (srgb_ && iChannel != 3) {
+          float sum = 0.0f;
+          for (const auto texel : texels) {
+            sum += srgbTable[texel[iChannel]];
+          }
+          target[iChannel] = encodeSrgb(sum / 4.0f);
+        } else {
+          std::uint32_t sum = 2;
+          for (const auto texel : texels) {
+            sum += texel[iChannel];
+          }
+          target[iChannel] = static_cast<std::uint8_t>(sum / 4);
+        }
+      }
+    }
+  }
+  return result;
+}
+
+/// <summary>
+/// Resamples `image_` to `width_` x `height_` with a bilinear filter, texel
+/// centers aligned so that texture coordinates still address the same
+/// content. sRGB color channels are interpolated as linear values.
+/// </summary>
+Image resize(const Image &image_,
+             std::uint32_t width_,
+             std::uint32_t height_,
+             bool srgb_) {
+  const auto &srgbTable = getSrgbTable();
+  const auto sourceCoordinate = [](std::uint32_t target_,
+                                   std::uint32_t target_size_,
+                                   std::uint32_t source_size_) {
+    const auto coordinate =
+        (target_ + 0.5f) * source_size_ / target_size_ - 0.5f;
+    const auto clamped =
+        std::clamp(coordinate, 0.0f, static_cast<float>(source_size_ - 1));
+    const auto lower = static_cast<std::uint32_t>(clamped);
+    const auto upper = std::min(lower + 1, source_size_ - 1);
+    return std::make_tuple(lower, upper, clamped - lower);
+  };
+
+  Image result;
+  result.width = width_;
+  result.height = height_;
+  result.pixels.resize(std::size_t{width_} * height_ * 4);
+  for (std::uint32_t y = 0; y < height_; ++y) {
+    const auto [y0, y1, fy] = sourceCoordinate(y, height_, image_.height);
+    for (std::uint32_t x = 0; x < width_; ++x) {
+      const auto [x0, x1, fx] = sourceCoordinate(x, width_, image_.width);
+      const auto texel = [&image_](std::uint32_t x_, std::uint32_t y_) {
+        return &image_.pixels[(std::size_t{y_} * image_.width + x_) * 4];
+      };
+      const std::array<const std::uint8_t *, 4> texels = {
+          texel(x0, y0), texel(x1, y0), texel(x0, y1), texel(x1, y1)};
+      const std::array<float, 4> weights = {
+          (1.0f - fx) * (1.0f - fy), fx * (1.0f - fy), (1.0f - fx) * fy,
+          fx * fy};
+      auto *target = &result.pixels[(std::size_t{y} * width_ + x) * 4];
+      for (std::size_t iChannel = 0; iChannel < 4; ++iChannel) {
+        const auto linear = srgb_ && iChannel != 3;
+        float sum = 0.0f;
+        for (std::size_t iTexel = 0; iTexel < texels.size(); ++iTexel) {
+          const auto value = texels[iTexel][iChannel];
+          sum += weights[iTexel] * (linear ? srgbTable[value] : value);
+        }
+        target[iChannel] =
+            linear ? encodeSrgb(sum)
+                   : static_cast<std::uint8_t>(
+                         std::lround(std::clamp(sum, 0.0f, 255.0f)));
+      }
+    }
+  }
+  return result;
+}
+
+/// <summary>
+/// The nearest multiple of 4, at least 4: KHR_texture_basisu requires the
+/// base level dimensions to be such multiples.
+/// </summary>
+std::uint32_t toMultipleOf4(std::uint32_t size_) {
+  return std::max(4u, (size_ + 2) / 4 * 4);
+}
+
+struct KtxTextureDeleter {
+  void operator()(ktxTexture2 *texture_) const {
+    ktxTexture_Destroy(ktxTexture(texture_));
+  }
+};
+
+void checkKtx(KTX_error_code error_code_, const char *what_) {
+  if (error_code_ != KTX_SUCCESS) {
+    throw std::runtime_error(std::string{what_} + ": " +
+                             ktxErrorString(error_code_));
+  }
+}
+
+std::vector<std::byte>
+transcode(std::span<const std::byte> content_,
+          bool normal_map_,
+          const ConvertOptions::TextureTranscoding &options_) {
+  int width = 0;
+  int height = 0;
+  int nChannels = 0;
+  const std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> pixels{
+      stbi_load_from_memory(
+          reinterpret_cast<const stbi_uc *>(content_.data()),
+          static_cast<int>(content_.size()), &width, &height, &nChannels, 4),
+      &stbi_image_free};
+  if (!pixels) {
+    throw std::runtime_error(std::string{"Failed to decode the image: "} +
+                             stbi_failure_reason());
+  }
+
+  const auto srgb = !normal_map_;
+  std::vector<Image> levels(1);
+  levels[0].width = static_cast<std::uint32_t>(width);
+  levels[0].height = static_cast<std::uint32_t>(height);
+  levels[0].pixels.assign(pixels.get(),
+                          pixels.get() + std::size_t{levels[0].width} *
+                                             levels[0].height * 4);
+  if (options_.maxSize) {
+    while (std::max(levels[0].width, levels[0].height) > options_.maxSize) {
+      levels[0] = halve(levels[0], srgb);
+    }
+  }
+  if (const auto width = toMultipleOf4(levels[0].width),
+      height = toMultipleOf4(levels[0].height);
+      width != levels[0].width || height != levels[0].height) {
+    levels[0] = resize(levels[0], width, height, srgb);
+  }
+  if (options_.mipmaps) {
+    while (levels.back().width > 1 || levels.back().height > 1) {
+      levels.push_back(halve(levels.back(), srgb));
+    }
+  }
+
+  ktxTextureCreateInfo createInfo{};
+  createInfo.vkFormat = srgb ? vkFormatRGBA8Srgb : vkFormatRGBA8Unorm;
+  createInfo.baseWidth = levels[0].width;
+  createInfo.baseHeight = levels[0].height;
+  createInfo.baseDepth = 1;
+  createInfo.numDimensions = 2;
+  createInfo.numLevels = static_cast<ktx_uint32_t>(levels.size());
+  createInfo.numLayers = 1;
+  createInfo.numFaces = 1;
+  createInfo.isArray = KTX_FALSE;
+  createInfo.generateMipmaps = KTX_FALSE;
+
+  ktxTexture2 *newTexture = nullptr;
+  checkKtx(ktxTexture2_Create(&createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE,
+                              &newTexture),
+           "Failed to create the texture");
+  const std::unique_ptr<ktxTexture2, KtxTextureDeleter> texture{newTexture};
+
+  for (std::size_t iLevel = 0; iLevel < levels.size(); ++iLevel) {
+    const auto &level = levels[iLevel];
+    checkKtx(ktxTexture_SetImageFromMemory(
+                 ktxTexture(texture.get()), static_cast<ktx_uint32_t>(iLevel),
+                 0, 0, level.pixels.data(), level.pixels.size()),
+             "Failed to set the image");
+  }
+
+  ktxBasisParams basisParams{};
+  basisParams.structSize = sizeof(basisParams);
+  basisParams.uastc =
+      options_.codec == ConvertOptions::TextureTranscoding::Codec::uastc
+          ? KTX_TRUE
+          : KTX_FALSE;
+  // Images are transcoded in parallel, each on a single thread.
+  basisParams.threadCount = 1;
+  basisParams.normalMap = normal_map_ ? KTX_TRUE : KTX_FALSE;
+  checkKtx(ktxTexture2_CompressBasisEx(texture.get(), &basisParams),
+           "Failed to encode the texture");
+
+  ktx_uint8_t *fileData = nullptr;
+  ktx_size_t fileSize = 0;
+  checkKtx(ktxTexture_WriteToMemory(ktxTexture(texture.get()), &fileData,
+                                    &fileSize),
+           "Failed to write the texture");
+  const std::unique_ptr<ktx_uint8_t, decltype(&std::free)> file{fileData,
+                                                                 &std::free};
+  const auto bytes = reinterpret_cast<const std::byte *>(file.get());
+  return {bytes, bytes + fileSize};
+}
+} // namespace
+
+TextureTranscoder::TextureTranscoder(
+    const ConvertOptions::TextureTranscoding &options_)
+    : _options(options_), _threadCount(resolveThreadCount(options_.threads)) {
+}
+
+TextureTranscoder::~TextureTranscoder() {
+  {
+    std::lock_guard lock{_mutex};
+    _stopping = true;
+  }
+  _queued.notify_all();
+  for (auto &thread : _threads) {
+    thread.join();
+  }
+}
+
+std::size_t TextureTranscoder::submit(const bee::filesystem::path &path_,
+                                      bool normal_map_) {
+  const auto normalized = path_.lexically_normal();
+  const auto index = _jobs.size();
+  {
+    std::lock_guard lock{_mutex};
+    const auto [rIndex, inserted] = _jobIndices.emplace(
+        std::make_pair(normalized.generic_u8string(), normal_map_), index);
+    if (!inserted) {
+      return rIndex->second;
+    }
+    auto &job = _jobs.emplace_back();
+    job.path = normalized;
+    job.normalMap = normal_map_;
+  }
+  // Threads are started as jobs come, up to the thread count.
+  if (_threads.size() < _threadCount) {
+    _threads.emplace_back(&TextureTranscoder::_work, this);
+  }
+  _queued.notify_one();
+  return index;
+}
+
+void TextureTranscoder::wait() {
+  std::unique_lock lock{_mutex};
+  _finished.wait(lock, [this] { return _nFinishedJobs == _jobs.size(); });
+}
+
+void TextureTranscoder::_work() {
+  while (true) {
+    Job *job = nullptr;
+    {
+      std::unique_lock lock{_mutex};
+      _queued.wait(lock,
+                   [this] { return _stopping || _nextJob < _jobs.size(); });
+      if (_stopping) {
+        return;
+      }
+      job = &_jobs[_nextJob++];
+    }
+
+    const auto transcodeFile = [this, job]() -> TextureCache::Result {
+      const auto file = MappedFile::open(job->path);
+      if (!file) {
+        throw std::runtime_error("Failed to read the image");
+      }
+      return std::make_shared<const std::vector<std::byte>>(
+          transcode(file->bytes(), job->normalMap, _options));
+    };
+    try {
+      job->result = _options.cache ? _options.cache->getOrTranscode(
+                                         job->path.u8string(), job->normalMap,
+                                         _options, transcodeFile)
+                                   : transcodeFile();
+    } catch (const std::exception &exception_) {
+      job->error = exception_.what();
+    }
+
+    {
+      std::lock_guard lock{_mutex};
+      ++_nFinishedJobs;
+    }
+    _finished.notify_all();
+  }
+}
+} // namespace bee
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <bee/BEE_API.h>
+#include <bee/Converter.h>
+#include <bee/polyfills/filesystem.h>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// Transcodes image files to KTX2 on background threads, so that the images
+/// are transcoded while the rest of the scene is being converted.
+/// </summary>
+class BEE_API TextureTranscoder {
+public:
+  explicit TextureTranscoder(
+      const ConvertOptions::TextureTranscoding &options_);
+
+  TextureTranscoder(const TextureTranscoder &) = delete;
+
+  TextureTranscoder &operator=(const TextureTranscoder &) = delete;
+
+  /// <summary>
+  /// Drops the jobs which have not started and waits for the running ones.
+  /// </summary>
+  ~TextureTranscoder();
+
+  /// <summary>
+  /// Queues the transcoding of the image at `path_` and returns its job.
+  /// Normal maps are encoded as linear data, other images as sRGB colors.
+  /// Submitting the same file the same way again returns the same job.
+  /// </summary>
+  std::size_t submit(const bee::filesystem::path &path_, bool normal_map_);
+
+  /// <summary>
+  /// Waits until all submitted jobs are done.
+  /// </summary>
+  void wait();
+
+  std::size_t size() const {
+    return _jobs.size();
+  }
+
+  const bee::filesystem::path &path(std::size_t job_) const {
+    return _jobs[job_].path;
+  }
+
+  /// <summary>
+  /// The KTX2 file. Empty if the job failed. Valid after `wait()`.
+  /// </summary>
+  const std::vector<std::byte> &result(std::size_t job_) const {
+    static const std::vector<std::byte> empty;
+    const auto &result = _jobs[job_].result;
+    return result ? *result : empty;
+  }
+
+  /// <summary>
+  /// Why the job failed. Valid after `wait()`.
+  /// </summary>
+  const std::string &error(std::size_t job_) const {
+    return _jobs[job_].error;
+  }
+
+private:
+  struct Job {
+    bee::filesystem::path path;
+    bool normalMap = false;
+    /// <summary>
+    /// Shared with `ConvertOptions::TextureTranscoding::cache`, if any.
+    /// </summary>
+    std::shared_ptr<const std::vector<std::byte>> result;
+    std::string error;
+  };
+
+  ConvertOptions::TextureTranscoding _options;
+  std::uint32_t _threadCount;
+  std::vector<std::thread> _threads;
+  std::mutex _mutex;
+  std::condition_variable _queued;
+  std::condition_variable _finished;
+
+  /// <summary>
+  /// A deque, so that running jobs are not moved by `submit()`.
+  /// </summary>
+  std::deque<Job> _jobs;
+
+  std::map<std::pair<std::u8string, bool>, std::size_t> _jobIndices;
+
+  std::size_t _nextJob = 0;
+  std::size_t _nFinishedJobs = 0;
+  bool _stopping = false;
+
+  void _work();
+};
+} // namespace bee
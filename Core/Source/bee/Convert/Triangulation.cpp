@@ -0,0 +1,117 @@
+#include <bee/Convert/Triangulation.h>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+
+namespace bee {
+namespace {
+using Point = std::array<double, 2>;
+
+/// <summary>
+/// Positive if `o_`, `a_` and `b_` turn counter-clockwise.
+/// </summary>
+double cross(const Point &o_, const Point &a_, const Point &b_) {
+  return (a_[0] - o_[0]) * (b_[1] - o_[1]) - (a_[1] - o_[1]) * (b_[0] - o_[0]);
+}
+
+/// <summary>
+/// Whether `p_` is in, or on the border of, the counter-clockwise triangle
+/// `a_`, `b_`, `c_`.
+/// </summary>
+bool contains(const Point &a_,
+              const Point &b_,
+              const Point &c_,
+              const Point &p_) {
+  return cross(a_, b_, p_) >= 0.0 && cross(b_, c_, p_) >= 0.0 &&
+         cross(c_, a_, p_) >= 0.0;
+}
+
+void fan(std::span<const std::uint32_t> corners_,
+         std::vector<std::uint32_t> &triangles_) {
+  for (std::size_t iCorner = 1; iCorner + 1 < corners_.size(); ++iCorner) {
+    triangles_.insert(triangles_.end(), {corners_[0], corners_[iCorner],
+                                         corners_[iCorner + 1]});
+  }
+}
+} // namespace
+
+void triangulatePolygon(std::span<const std::array<double, 3>> positions_,
+                        std::vector<std::uint32_t> &triangles_) {
+  const auto nCorners = positions_.size();
+  std::vector<std::uint32_t> corners(nCorners);
+  std::iota(corners.begin(), corners.end(), 0);
+  if (nCorners <= 3) {
+    fan(corners, triangles_);
+    return;
+  }
+
+  // Newell's normal, which is also fine for concave polygons.
+  std::array<double, 3> normal{};
+  for (std::size_t iCorner = 0; iCorner < nCorners; ++iCorner) {
+    const auto &p = positions_[iCorner];
+    const auto &q = positions_[(iCorner + 1) % nCorners];
+    normal[0] += (p[1] - q[1]) * (p[2] + q[2]);
+    normal[1] += (p[2] - q[2]) * (p[0] + q[0]);
+    normal[2] += (p[0] - q[0]) * (p[1] + q[1]);
+  }
+
+  // Project the polygon onto the axis plane closest to its own plane, such
+  // that it runs counter-clockwise there.
+  std::size_t axis = 0;
+  for (std::size_t i = 1; i < 3; ++i) {
+    if (std::abs(normal[i]) > std::abs(normal[axis])) {
+      axis = i;
+    }
+  }
+  if (!(std::abs(normal[axis]) > 0.0)) {
+    fan(corners, triangles_);
+    return;
+  }
+  auto u = (axis + 1) % 3;
+  auto v = (axis + 2) % 3;
+  if (normal[axis] < 0.0) {
+    std::swap(u, v);
+  }
+  std::vector<Point> points(nCorners);
+  for (std::size_t iCorner = 0; iCorner < nCorners; ++iCorner) {
+    points[iCorner] = {positions_[iCorner][u], positions_[iCorner][v]};
+  }
+
+  // Starting from the second corner, convex polygons are clipped into the
+  // same fan as `fan()` gives.
+  std::size_t iCandidate = 1;
+  std::size_t nRejected = 0;
+  while (corners.size() > 3) {
+    const auto nRemaining = corners.size();
+    if (nRejected == nRemaining) {
+      fan(corners, triangles_);
+      return;
+    }
+    iCandidate %= nRemaining;
+    const auto a = corners[(iCandidate + nRemaining - 1) % nRemaining];
+    const auto b = corners[iCandidate];
+    const auto c = corners[(iCandidate + 1) % nRemaining];
+    const auto &pa = points[a];
+    const auto &pb = points[b];
+    const auto &pc = points[c];
+    auto isEar = cross(pa, pb, pc) > 0.0;
+    for (std::size_t i = 0; isEar && i < nRemaining; ++i) {
+      const auto &p = points[corners[i]];
+      // Also skips corners sharing a position with the candidate's.
+      if (p == pa || p == pb || p == pc) {
+        continue;
+      }
+      isEar = !contains(pa, pb, pc, p);
+    }
+    if (!isEar) {
+      ++iCandidate;
+      ++nRejected;
+      continue;
+    }
+    triangles_.insert(triangles_.end(), {a, b, c});
+    corners.erase(corners.begin() + iCandidate);
+    nRejected = 0;
+  }
+  fan(corners, triangles_);
+}
+} // namespace bee
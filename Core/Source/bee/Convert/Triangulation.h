@@ -0,0 +1,20 @@
+#pragma once
+
+#include <bee/BEE_API.h>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// Triangulates a polygon, given the positions of its corners in order, by
+/// ear clipping in the plane of the polygon. Triangles are appended to
+/// `triangles_` as corner indices and keep the winding of the polygon. Convex
+/// polygons are cut into a fan from the first corner. Degenerate polygons,
+/// and whatever is left of a self-intersecting one, are cut into a fan too.
+/// </summary>
+void BEE_API
+triangulatePolygon(std::span<const std::array<double, 3>> positions_,
+                   std::vector<std::uint32_t> &triangles_);
+} // namespace bee
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <bee/Convert/VertexPacking.h>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace bee {
+namespace {
+using PackKernel = void (*)(std::byte *out_,
+                            std::uint32_t out_stride_,
+                            const std::byte *in_,
+                            std::uint32_t in_stride_,
+                            std::uint32_t vertex_count_,
+                            const VertexPackChannel &channel_);
+
+template <typename Dst_,
+          typename Src_,
+          std::uint32_t N_,
+          bool Bounds_,
+          bool Transform_>
+void packKernel(std::byte *out_,
+                std::uint32_t out_stride_,
+                const std::byte *in_,
+                std::uint32_t in_stride_,
+                std::uint32_t vertex_count_,
+                const VertexPackChannel &channel_) {
+  std::array<float, N_> min, max;
+  if constexpr (Bounds_) {
+    std::copy_n(channel_.bounds->min.begin(), N_, min.begin());
+    std::copy_n(channel_.bounds->max.begin(), N_, max.begin());
+  }
+
+  std::array<float, N_> offset, scale;
+  if constexpr (Transform_) {
+    std::copy_n(channel_.transform->offset.begin(), N_, offset.begin());
+    std::copy_n(channel_.transform->scale.begin(), N_, scale.begin());
+  }
+  [[maybe_unused]] const auto renormalize =
+      Transform_ && std::is_integral_v<Dst_> && channel_.renormalize;
+
+  for (std::uint32_t iVertex = 0; iVertex < vertex_count_; ++iVertex) {
+    Src_ in[N_];
+    std::memcpy(in, in_ + static_cast<std::size_t>(in_stride_) * iVertex,
+                sizeof(in));
+    Dst_ out[N_];
+    if constexpr (std::is_same_v<Dst_, Src_> && !Transform_) {
+      std::memcpy(out, in, sizeof(in));
+    } else if constexpr (Transform_) {
+      for (std::uint32_t i = 0; i < N_; ++i) {
+        auto value = (static_cast<float>(in[i]) + offset[i]) * scale[i];
+        if constexpr (std::is_integral_v<Dst_>) {
+          value = std::clamp(
+              std::round(value),
+              static_cast<float>(std::numeric_limits<Dst_>::lowest()),
+              static_cast<float>(std::numeric_limits<Dst_>::max()));
+        }
+        out[i] = static_cast<Dst_>(value);
+      }
+      if constexpr (std::is_integral_v<Dst_>) {
+        if (renormalize) {
+          std::int64_t sum = 0;
+          std::uint32_t iLargest = 0;
+          for (std::uint32_t i = 0; i < N_; ++i) {
+            sum += out[i];
+            if (out[i] > out[iLargest]) {
+              iLargest = i;
+            }
+          }
+          const auto adjusted = static_cast<std::int64_t>(out[iLargest]) +
+                                std::numeric_limits<Dst_>::max() - sum;
+          if (sum != 0 && adjusted >= 0 &&
+              adjusted <= std::numeric_limits<Dst_>::max()) {
+            out[iLargest] = static_cast<Dst_>(adjusted);
+          }
+        }
+      }
+    } else {
+      for (std::uint32_t i = 0; i < N_; ++i) {
+        out[i] = static_cast<Dst_>(in[i]);
+      }
+    }
+    std::memcpy(out_ + static_cast<std::size_t>(out_stride_) * iVertex, out,
+                sizeof(out));
+    if constexpr (Bounds_) {
+      for (std::uint32_t i = 0; i < N_; ++i) {
+        min[i] = std::min(static_cast<float>(out[i]), min[i]);
+        max[i] = std::max(static_cast<float>(out[i]), max[i]);
+      }
+    }
+  }
+
+  if constexpr (Bounds_) {
+    std::copy_n(min.begin(), N_, channel_.bounds->min.begin());
+    std::copy_n(max.begin(), N_, channel_.bounds->max.begin());
+  }
+}
+
+template <typename Dst_, typename Src_, bool Bounds_, bool Transform_>
+PackKernel selectKernel(std::uint32_t component_count_) {
+  switch (component_count_) {
+  case 1:
+    return packKernel<Dst_, Src_, 1, Bounds_, Transform_>;
+  case 2:
+    return packKernel<Dst_, Src_, 2, Bounds_, Transform_>;
+  case 3:
+    return packKernel<Dst_, Src_, 3, Bounds_, Transform_>;
+  case 4:
+    return packKernel<Dst_, Src_, 4, Bounds_, Transform_>;
+  default:
+    throw std::invalid_argument("Unsupported vertex channel component count");
+  }
+}
+
+template <typename Src_, bool Bounds_, bool Transform_>
+PackKernel selectKernel(fx::gltf::Accessor::ComponentType out_type_,
+                        std::uint32_t component_count_) {
+  using ComponentType = fx::gltf::Accessor::ComponentType;
+  switch (out_type_) {
+  case ComponentType::Float:
+    return selectKernel<float, Src_, Bounds_, Transform_>(component_count_);
+  case ComponentType::UnsignedInt:
+    return selectKernel<std::uint32_t, Src_, Bounds_, Transform_>(
+        component_count_);
+  case ComponentType::UnsignedShort:
+    return selectKernel<std::uint16_t, Src_, Bounds_, Transform_>(
+        component_count_);
+  case ComponentType::Short:
+    return selectKernel<std::int16_t, Src_, Bounds_, Transform_>(
+        component_count_);
+  case ComponentType::UnsignedByte:
+    return selectKernel<std::uint8_t, Src_, Bounds_, Transform_>(
+        component_count_);
+  case ComponentType::Byte:
+    return selectKernel<std::int8_t, Src_, Bounds_, Transform_>(
+        component_count_);
+  default:
+    throw std::invalid_argument("Unsupported vertex channel component type");
+  }
+}
+
+template <typename Src_>
+PackKernel selectKernel(const VertexPackChannel &channel_) {
+  const auto &[outType, nComponents] =
+      std::tuple{channel_.outType, channel_.componentCount};
+  if (channel_.bounds) {
+    return channel_.transform
+               ? selectKernel<Src_, true, true>(outType, nComponents)
+               : selectKernel<Src_, true, false>(outType, nComponents);
+  } else {
+    return channel_.transform
+               ? selectKernel<Src_, false, true>(outType, nComponents)
+               : selectKernel<Src_, false, false>(outType, nComponents);
+  }
+}
+
+PackKernel selectKernel(const VertexPackChannel &channel_) {
+  switch (channel_.inType) {
+  case UntypedComponentType::float32:
+    return selectKernel<float>(channel_);
+  case UntypedComponentType::uint32:
+    return selectKernel<std::uint32_t>(channel_);
+  default:
+    throw std::invalid_argument("Unknown untyped component type");
+  }
+}
+} // namespace
+
+void packVertices(std::byte *out_,
+                  std::uint32_t out_stride_,
+                  const std::byte *in_,
+                  std::uint32_t in_stride_,
+                  std::uint32_t vertex_count_,
+                  std::span<const VertexPackChannel> channels_) {
+  std::vector<PackKernel> kernels(channels_.size());
+  std::transform(channels_.begin(), channels_.end(), kernels.begin(),
+                 [](const VertexPackChannel &channel_) {
+                   return selectKernel(channel_);
+                 });
+
+  constexpr std::uint32_t blockSize = 512;
+  for (std::uint32_t iBlock = 0; iBlock < vertex_count_; iBlock += blockSize) {
+    const auto nBlockVertices = std::min(blockSize, vertex_count_ - iBlock);
+    const auto blockOut = out_ + static_cast<std::size_t>(out_stride_) * iBlock;
+    const auto blockIn = in_ + static_cast<std::size_t>(in_stride_) * iBlock;
+    for (std::size_t iChannel = 0; iChannel < channels_.size(); ++iChannel) {
+      const auto &channel = channels_[iChannel];
+      kernels[iChannel](blockOut + channel.outOffset, out_stride_,
+                        blockIn + channel.inOffset, in_stride_, nBlockVertices,
+                        channel);
+    }
+  }
+}
+
+PackedChannelBounds computeUntypedBounds(const std::byte *in_,
+                                         std::uint32_t in_stride_,
+                                         std::uint32_t vertex_count_,
+                                         std::size_t offset_,
+                                         std::uint32_t component_count_) {
+  PackedChannelBounds bounds;
+  for (std::uint32_t iVertex = 0; iVertex < vertex_count_; ++iVertex) {
+    float in[4];
+    std::memcpy(in,
+                in_ + static_cast<std::size_t>(in_stride_) * iVertex + offset_,
+                sizeof(float) * component_count_);
+    for (std::uint32_t i = 0; i < component_count_; ++i) {
+      bounds.min[i] = std::min(in[i], bounds.min[i]);
+      bounds.max[i] = std::max(in[i], bounds.max[i]);
+    }
+  }
+  return bounds;
+}
+} // namespace bee
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fx/gltf.h>
+#include <limits>
+#include <optional>
+#include <span>
+
+namespace bee {
+/// <summary>
+/// Component type of a channel in the untyped vertices.
+/// </summary>
+enum class UntypedComponentType {
+  float32,
+  uint32,
+};
+
+/// <summary>
+/// Per-component bounds of a packed channel.
+/// </summary>
+struct PackedChannelBounds {
+  std::array<float, 4> min;
+  std::array<float, 4> max;
+
+  PackedChannelBounds() {
+    min.fill(std::numeric_limits<float>::infinity());
+    max.fill(-std::numeric_limits<float>::infinity());
+  }
+};
+
+/// <summary>
+/// How a channel of the untyped vertices is packed into a glTF buffer view.
+/// </summary>
+struct VertexPackChannel {
+  UntypedComponentType inType;
+  fx::gltf::Accessor::ComponentType outType;
+  std::uint32_t componentCount;
+  std::size_t inOffset;
+  std::uint32_t outOffset;
+
+  struct Transform {
+    std::array<float, 4> offset = {0.0f, 0.0f, 0.0f, 0.0f};
+    std::array<float, 4> scale = {1.0f, 1.0f, 1.0f, 1.0f};
+  };
+
+  /// <summary>
+  /// If set, components are mapped by `(in + offset) * scale` before being
+  /// converted; integer outputs are then rounded and clamped. This is how
+  /// attributes are quantized.
+  /// </summary>
+  std::optional<Transform> transform;
+
+  /// <summary>
+  /// With `transform` and an integer output, adjusts the largest component
+  /// so that the components sum up to the maximum of the output type, i.e.
+  /// to 1 once normalized. Used for weights.
+  /// </summary>
+  bool renormalize = false;
+
+  /// <summary>
+  /// If not null, receives the bounds of the packed channel.
+  /// </summary>
+  PackedChannelBounds *bounds = nullptr;
+};
+
+/// <summary>
+/// Interleaves `vertex_count_` untyped vertices into `out_`.
+/// A typed kernel is chosen once per channel, then runs over blocks of
+/// vertices so that each untyped vertex is read while it's still cached.
+/// </summary>
+void packVertices(std::byte *out_,
+                  std::uint32_t out_stride_,
+                  const std::byte *in_,
+                  std::uint32_t in_stride_,
+                  std::uint32_t vertex_count_,
+                  std::span<const VertexPackChannel> channels_);
+
+/// <summary>
+/// Computes the bounds of the first `component_count_` float components at
+/// `offset_` in each of `vertex_count_` untyped vertices.
+/// </summary>
+PackedChannelBounds computeUntypedBounds(const std::byte *in_,
+                                         std::uint32_t in_stride_,
+                                         std::uint32_t vertex_count_,
+                                         std::size_t offset_,
+                                         std::uint32_t component_count_);
+} // namespace bee
@@ -1,8 +1,8 @@
-
 #pragma once
 
 #include <fbxsdk.h>
-#include <functional>
+#include <memory>
+#include <stdexcept>
 
 namespace bee {
 struct FbxLayerElementAccessParams {
@@ -11,45 +11,132 @@ struct FbxLayerElementAccessParams {
   int polygonIndex = 0;
 };
 
+/// <summary>
+/// Locks the array for reading and returns its data, which is released with
+/// the last copy of the returned pointer.
+/// </summary>
 template <typename Value_>
-using FbxLayerElementAccessor =
-    std::function<Value_(const FbxLayerElementAccessParams &params_)>;
+std::shared_ptr<const Value_>
+lockFbxLayerElementArray(fbxsdk::FbxLayerElementArrayTemplate<Value_> &array_) {
+  const auto data = array_.GetLocked(fbxsdk::FbxLayerElementArray::eReadLock);
+  if (!data) {
+    return {};
+  }
+  return {data, [&array_](const Value_ *data_) {
+            auto data = const_cast<Value_ *>(data_);
+            array_.Release(&data);
+          }};
+}
+
+/// <summary>
+/// Reads a layer element for a polygon vertex.
+/// Mapping mode and reference mode are resolved once, on creation; accessing
+/// is then a few inlinable loads from the locked arrays, no indirect call.
+/// </summary>
+template <typename Value_> class FbxLayerElementAccessor {
+public:
+  enum class IndexSource {
+    controlPoint,
+    polygonVertex,
+    polygon,
+    /// <summary>
+    /// Always gives the default value.
+    /// </summary>
+    none,
+  };
+
+  FbxLayerElementAccessor() = default;
+
+  FbxLayerElementAccessor(IndexSource index_source_,
+                          std::shared_ptr<const Value_> direct_array_,
+                          int direct_count_,
+                          std::shared_ptr<const int> index_array_,
+                          int index_count_,
+                          Value_ default_value_)
+      : _indexSource(index_source_), _directArray(std::move(direct_array_)),
+        _directCount(direct_count_), _indexArray(std::move(index_array_)),
+        _indexCount(index_count_), _defaultValue(default_value_) {
+  }
+
+  Value_ operator()(const FbxLayerElementAccessParams &params_) const {
+    int index = 0;
+    switch (_indexSource) {
+    case IndexSource::controlPoint:
+      index = params_.controlPointIndex;
+      break;
+    case IndexSource::polygonVertex:
+      index = params_.polygonVertexIndex;
+      break;
+    case IndexSource::polygon:
+      index = params_.polygonIndex;
+      break;
+    default:
+      return _defaultValue;
+    }
+    if (_indexArray) {
+      if (index < 0 || index >= _indexCount) {
+        return _defaultValue;
+      }
+      index = _indexArray.get()[index];
+    }
+    if (index < 0 || index >= _directCount) {
+      return _defaultValue;
+    }
+    return _directArray.get()[index];
+  }
 
-template <typename Value>
-std::function<Value(const FbxLayerElementAccessParams &params_)>
-create_mapping_mode_visitor(
+private:
+  IndexSource _indexSource = IndexSource::none;
+  std::shared_ptr<const Value_> _directArray;
+  int _directCount = 0;
+  std::shared_ptr<const int> _indexArray;
+  int _indexCount = 0;
+  Value_ _defaultValue = {};
+};
+
+template <typename Value_>
+FbxLayerElementAccessor<Value_> makeFbxLayerElementAccessor(
     fbxsdk::FbxLayerElement::EMappingMode mapping_mode_,
-    std::function<Value(int index_)> reference_mode_visitor_,
-    Value default_value_ = {}) {
+    fbxsdk::FbxLayerElementArrayTemplate<Value_> *direct_array_,
+    fbxsdk::FbxLayerElementArrayTemplate<int> *index_array_,
+    Value_ default_value_) {
+  using Accessor = FbxLayerElementAccessor<Value_>;
+  using IndexSource = typename Accessor::IndexSource;
+
+  const auto makeAccessor = [&](IndexSource index_source_) {
+    std::shared_ptr<const Value_> directArray;
+    int directCount = 0;
+    if (direct_array_) {
+      directArray = lockFbxLayerElementArray(*direct_array_);
+      directCount = directArray ? direct_array_->GetCount() : 0;
+    }
+    std::shared_ptr<const int> indexArray;
+    int indexCount = 0;
+    if (index_array_) {
+      indexArray = lockFbxLayerElementArray(*index_array_);
+      indexCount = indexArray ? index_array_->GetCount() : 0;
+    }
+    return Accessor{index_source_, std::move(directArray), directCount,
+                    std::move(indexArray), indexCount, default_value_};
+  };
+
   switch (mapping_mode_) {
     using EMappingMode = fbxsdk::FbxLayerElement::EMappingMode;
   case EMappingMode::eByControlPoint:
-    return
-        [reference_mode_visitor_](const FbxLayerElementAccessParams &params_) {
-          return reference_mode_visitor_(params_.controlPointIndex);
-        };
+    return makeAccessor(IndexSource::controlPoint);
   case EMappingMode::eByPolygonVertex:
-    return
-        [reference_mode_visitor_](const FbxLayerElementAccessParams &params_) {
-          return reference_mode_visitor_(params_.polygonVertexIndex);
-        };
+    return makeAccessor(IndexSource::polygonVertex);
   case EMappingMode::eByPolygon:
-    return
-        [reference_mode_visitor_](const FbxLayerElementAccessParams &params_) {
-          return reference_mode_visitor_(params_.polygonIndex);
-        };
+    return makeAccessor(IndexSource::polygon);
   case EMappingMode::eByEdge:
     throw std::runtime_error("Unsupported mapping mode: ByEdge");
     break;
   case EMappingMode::eAllSame: {
-    auto first = reference_mode_visitor_(0);
-    return
-        [first](const FbxLayerElementAccessParams &params_) { return first; };
+    const auto first = makeAccessor(IndexSource::polygon)({});
+    return Accessor{IndexSource::none, {}, 0, {}, 0, first};
   }
   case EMappingMode::eNone:
-    return [default_value_](const FbxLayerElementAccessParams &params_) {
-      return default_value_;
-    };
+    return Accessor{IndexSource::none, {}, 0, {}, 0, default_value_};
   default:
     throw std::runtime_error("Unknown mapping mode");
   }
@@ -61,27 +148,20 @@ template <typename Value_,
 FbxLayerElementAccessor<Value_> makeFbxLayerElementAccessor(
     const fbxsdk::FbxLayerElementTemplate<Value_> &layer_element_,
     Value_ default_value_ = Value_{}) {
-
-  const auto getVal = [&layer_element_]() -> std::function<Value_(int i_)> {
-    using EReferenceMode = fbxsdk::FbxLayerElement::EReferenceMode;
-    const auto referenceMode = layer_element_.GetReferenceMode();
-    if (referenceMode == EReferenceMode::eDirect) {
-      auto &directArray = layer_element_.GetDirectArray();
-      return [&directArray](int index_) { return directArray[index_]; };
-    } else if (referenceMode == EReferenceMode::eIndexToDirect ||
-               referenceMode == EReferenceMode::eIndex) {
-      auto &directArray = layer_element_.GetDirectArray();
-      auto &indexArray = layer_element_.GetIndexArray();
-      return [&directArray, &indexArray](int index_) {
-        return directArray[indexArray[index_]];
-      };
-    } else {
-      throw std::runtime_error("Unknown reference mode");
-    }
-  }();
-
-  return create_mapping_mode_visitor(layer_element_.GetMappingMode(), getVal,
-                                     default_value_);
+  using EReferenceMode = fbxsdk::FbxLayerElement::EReferenceMode;
+  const auto referenceMode = layer_element_.GetReferenceMode();
+  if (referenceMode == EReferenceMode::eDirect) {
+    return makeFbxLayerElementAccessor<Value_>(
+        layer_element_.GetMappingMode(), &layer_element_.GetDirectArray(),
+        nullptr, default_value_);
+  } else if (referenceMode == EReferenceMode::eIndexToDirect ||
+             referenceMode == EReferenceMode::eIndex) {
+    return makeFbxLayerElementAccessor<Value_>(
+        layer_element_.GetMappingMode(), &layer_element_.GetDirectArray(),
+        &layer_element_.GetIndexArray(), default_value_);
+  } else {
+    throw std::runtime_error("Unknown reference mode");
+  }
 }
 
 /// <summary>
@@ -94,24 +174,20 @@ inline FbxLayerElementAccessor<int> makeLayerElementMaterialAccessor(
 
   constexpr Value default_value_ = -1;
 
-  const auto getVal = [&layer_element_]() -> std::function<Value(int i_)> {
-    using EReferenceMode = fbxsdk::FbxLayerElement::EReferenceMode;
-    auto &indexArray = layer_element_.GetIndexArray();
-
-    // >> this type of Layer element should have its reference mode set to
-    // >> `eIndexToDirect`.
-    // If we encountered such violation, we return a null material.
-    using EReferenceMode = fbxsdk::FbxLayerElement::EReferenceMode;
-    const auto referenceMode = layer_element_.GetReferenceMode();
-    if (!(referenceMode == EReferenceMode::eIndexToDirect ||
-          referenceMode == EReferenceMode::eIndex)) {
-      return [&indexArray](int index_) { return -1; };
-    }
-
-    return [&indexArray](int index_) { return indexArray[index_]; };
-  }();
+  // >> this type of Layer element should have its reference mode set to
+  // >> `eIndexToDirect`.
+  // If we encountered such violation, we return a null material.
+  using EReferenceMode = fbxsdk::FbxLayerElement::EReferenceMode;
+  const auto referenceMode = layer_element_.GetReferenceMode();
+  if (!(referenceMode == EReferenceMode::eIndexToDirect ||
+        referenceMode == EReferenceMode::eIndex)) {
+    using Accessor = FbxLayerElementAccessor<Value>;
+    return Accessor{Accessor::IndexSource::none, {}, 0, {}, 0, default_value_};
+  }
 
-  return create_mapping_mode_visitor(layer_element_.GetMappingMode(), getVal,
-                                     default_value_);
+  // The index array itself holds the material indices.
+  return makeFbxLayerElementAccessor<Value>(layer_element_.GetMappingMode(),
+                                            &layer_element_.GetIndexArray(),
+                                            nullptr, default_value_);
 }
 } // namespace bee
\ No newline at end of file
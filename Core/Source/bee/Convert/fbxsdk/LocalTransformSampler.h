@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fbxsdk.h>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// Samples the local transform of a node directly from its Lcl T/R/S curves.
+/// `FbxNode::EvaluateLocalTransform()` runs through the whole evaluator on
+/// each call; here each curve is evaluated over all frames at once, walking
+/// its keys in order, and the pivots are composed once:
+/// `T * Roff * Rp * Rpre * R * Rpost^-1 * Rp^-1 * Soff * Sp * S * Sp^-1`.
+/// </summary>
+class FbxLocalTransformSampler {
+public:
+  /// <summary>
+  /// Creates a sampler if the local transform of the node depends only on
+  /// its Lcl curves on the layer; returns nothing otherwise. The sampler is
+  /// checked against `fbx_evaluator_` at `check_times_`.
+  /// </summary>
+  static std::optional<FbxLocalTransformSampler>
+  create(fbxsdk::FbxNode &fbx_node_,
+         fbxsdk::FbxAnimLayer &fbx_anim_layer_,
+         fbxsdk::FbxAnimEvaluator &fbx_evaluator_,
+         std::span<const fbxsdk::FbxTime> check_times_) {
+    const auto fbxScene = fbx_node_.GetScene();
+    const auto fbxAnimStack =
+        fbxScene ? fbxScene->GetCurrentAnimationStack() : nullptr;
+    // Multiple layers are blended by the evaluator.
+    if (!fbxAnimStack ||
+        fbxAnimStack->GetMemberCount<fbxsdk::FbxAnimLayer>() != 1 ||
+        fbx_anim_layer_.Mute.Get() || fbx_anim_layer_.Weight.Get() != 100.0) {
+      return {};
+    }
+
+    if (fbx_node_.GetSrcObjectCount<fbxsdk::FbxConstraint>() != 0 ||
+        fbx_node_.GetDstObjectCount<fbxsdk::FbxConstraint>() != 0) {
+      return {};
+    }
+
+    if (fbx_node_.GetTranslationLimits().GetActive() ||
+        fbx_node_.GetRotationLimits().GetActive() ||
+        fbx_node_.GetScalingLimits().GetActive()) {
+      return {};
+    }
+
+    constexpr auto pivotSet = fbxsdk::FbxNode::eSourcePivot;
+    fbxsdk::EFbxRotationOrder rotationOrder = fbxsdk::eEulerXYZ;
+    fbx_node_.GetRotationOrder(pivotSet, rotationOrder);
+    if (rotationOrder == fbxsdk::eSphericXYZ) {
+      return {};
+    }
+
+    if (fbx_node_.RotationOffset.IsAnimated(&fbx_anim_layer_) ||
+        fbx_node_.RotationPivot.IsAnimated(&fbx_anim_layer_) ||
+        fbx_node_.PreRotation.IsAnimated(&fbx_anim_layer_) ||
+        fbx_node_.PostRotation.IsAnimated(&fbx_anim_layer_) ||
+        fbx_node_.ScalingOffset.IsAnimated(&fbx_anim_layer_) ||
+        fbx_node_.ScalingPivot.IsAnimated(&fbx_anim_layer_)) {
+      return {};
+    }
+
+    FbxLocalTransformSampler sampler;
+    const auto firstTime =
+        check_times_.empty() ? fbxsdk::FbxTime{} : check_times_.front();
+    const std::array<fbxsdk::FbxPropertyT<fbxsdk::FbxDouble3> *, 3>
+        properties = {&fbx_node_.LclTranslation, &fbx_node_.LclRotation,
+                      &fbx_node_.LclScaling};
+    constexpr std::array<const char *, 3> components = {
+        FBXSDK_CURVENODE_COMPONENT_X, FBXSDK_CURVENODE_COMPONENT_Y,
+        FBXSDK_CURVENODE_COMPONENT_Z};
+    for (std::size_t iProperty = 0; iProperty < properties.size();
+         ++iProperty) {
+      auto &property = *properties[iProperty];
+      const auto value = property.EvaluateValue(firstTime);
+      for (std::size_t iComponent = 0; iComponent < components.size();
+           ++iComponent) {
+        auto &channel = sampler._channels[3 * iProperty + iComponent];
+        channel.curve =
+            property.GetCurve(&fbx_anim_layer_, components[iComponent]);
+        channel.value = value[static_cast<int>(iComponent)];
+      }
+    }
+
+    const auto translation = [](const fbxsdk::FbxVector4 &value_) {
+      fbxsdk::FbxAMatrix matrix;
+      matrix.SetT(value_);
+      return matrix;
+    };
+    const auto rotation = [](const fbxsdk::FbxVector4 &value_) {
+      fbxsdk::FbxAMatrix matrix;
+      matrix.SetR(value_);
+      return matrix;
+    };
+    const auto rotationPivot =
+        translation(fbx_node_.GetRotationPivot(pivotSet));
+    const auto scalingPivot = translation(fbx_node_.GetScalingPivot(pivotSet));
+    const auto rotationOffset =
+        translation(fbx_node_.GetRotationOffset(pivotSet));
+    const auto scalingOffset =
+        translation(fbx_node_.GetScalingOffset(pivotSet));
+    const auto preRotation = rotation(fbx_node_.GetPreRotation(pivotSet));
+    const auto postRotation = rotation(fbx_node_.GetPostRotation(pivotSet));
+
+    // Pre/post rotations and the rotation order are documented to apply only
+    // if `RotationActive` is set. Check that reading first, then the other.
+    const auto rotationActive = fbx_node_.GetRotationActive();
+    for (const auto applyRotationExtras : {rotationActive, !rotationActive}) {
+      sampler._rotationOrder =
+          applyRotationExtras ? rotationOrder : fbxsdk::eEulerXYZ;
+      sampler._preRotation = rotationOffset * rotationPivot;
+      sampler._postRotation =
+          rotationPivot.Inverse() * scalingOffset * scalingPivot;
+      if (applyRotationExtras) {
+        sampler._preRotation = sampler._preRotation * preRotation;
+        sampler._postRotation = postRotation.Inverse() * sampler._postRotation;
+      }
+      sampler._postScaling = scalingPivot.Inverse();
+      if (sampler._matches(fbx_node_, fbx_evaluator_, check_times_)) {
+        return sampler;
+      }
+    }
+    return {};
+  }
+
+  std::vector<fbxsdk::FbxAMatrix>
+  sample(std::span<const fbxsdk::FbxTime> times_) const {
+    const auto nTimes = times_.size();
+    std::array<std::vector<double>, 9> values;
+    for (std::size_t iChannel = 0; iChannel < _channels.size(); ++iChannel) {
+      const auto &[curve, value] = _channels[iChannel];
+      auto &channelValues = values[iChannel];
+      if (!curve) {
+        channelValues.assign(nTimes, value);
+        continue;
+      }
+      channelValues.resize(nTimes);
+      int lastKeyIndex = 0;
+      for (std::size_t iTime = 0; iTime < nTimes; ++iTime) {
+        channelValues[iTime] = curve->Evaluate(times_[iTime], &lastKeyIndex);
+      }
+    }
+
+    fbxsdk::FbxRotationOrder rotationOrder{_rotationOrder};
+    std::vector<fbxsdk::FbxAMatrix> result(nTimes);
+    for (std::size_t iTime = 0; iTime < nTimes; ++iTime) {
+      const auto at = [&values, iTime](std::size_t i_) {
+        return fbxsdk::FbxVector4{values[i_][iTime], values[i_ + 1][iTime],
+                                  values[i_ + 2][iTime]};
+      };
+      fbxsdk::FbxAMatrix translation;
+      translation.SetT(at(0));
+      fbxsdk::FbxAMatrix rotation;
+      rotationOrder.V2M(rotation, at(3));
+      fbxsdk::FbxAMatrix scaling;
+      scaling.SetS(at(6));
+      result[iTime] = translation * _preRotation * rotation * _postRotation *
+                      scaling * _postScaling;
+    }
+    return result;
+  }
+
+private:
+  struct Channel {
+    fbxsdk::FbxAnimCurve *curve = nullptr;
+    /// <summary>
+    /// The value if there is no curve.
+    /// </summary>
+    double value = 0.0;
+  };
+
+  /// <summary>
+  /// Translation, rotation and scaling, each X, Y, Z.
+  /// </summary>
+  std::array<Channel, 9> _channels;
+  fbxsdk::EFbxRotationOrder _rotationOrder = fbxsdk::eEulerXYZ;
+  fbxsdk::FbxAMatrix _preRotation;
+  fbxsdk::FbxAMatrix _postRotation;
+  fbxsdk::FbxAMatrix _postScaling;
+
+  FbxLocalTransformSampler() = default;
+
+  bool _matches(fbxsdk::FbxNode &fbx_node_,
+                fbxsdk::FbxAnimEvaluator &fbx_evaluator_,
+                std::span<const fbxsdk::FbxTime> check_times_) const {
+    const auto sampled = sample(check_times_);
+    for (std::size_t iTime = 0; iTime < check_times_.size(); ++iTime) {
+      const auto &expected =
+          fbx_evaluator_.GetNodeLocalTransform(&fbx_node_, check_times_[iTime]);
+      for (int iRow = 0; iRow < 4; ++iRow) {
+        for (int iColumn = 0; iColumn < 4; ++iColumn) {
+          const auto a = expected.Get(iRow, iColumn);
+          const auto b = sampled[iTime].Get(iRow, iColumn);
+          if (std::abs(a - b) > 1e-5 * std::max(1.0, std::abs(a))) {
+            return false;
+          }
+        }
+      }
+    }
+    return true;
+  }
+};
+} // namespace bee
@@ -0,0 +1,406 @@
+#include <bee/Convert/ImageIO.h>
+#include <bee/ConvertCache.h>
+#include <bee/UntypedVertex.h>
+#include <array>
+#include <cppcodec/base64_default_rfc4648.hpp>
+#include <cstring>
+#include <fbxsdk.h>
+#include <fmt/format.h>
+#include <fstream>
+#include <random>
+
+namespace bee {
+namespace {
+namespace fs = bee::filesystem;
+
+std::string toJsonString(const std::u8string &string_) {
+  return {string_.begin(), string_.end()};
+}
+
+std::u8string fromJsonString(const std::string &string_) {
+  return {string_.begin(), string_.end()};
+}
+
+/// <summary>
+/// The options which may change the output of a conversion. An option added
+/// to `ConvertOptions` has to be added here too, unless it can't change the
+/// output, like thread counts.
+/// </summary>
+Json fingerprintOptions(const ConvertOptions &options_) {
+  Json json;
+  json["cacheVersion"] = ConvertCache::cacheVersion;
+  json["fbxsdk"] = FBXSDK_VERSION_STRING_FULL;
+
+  json["out"] = toJsonString(options_.out);
+  json["writer"] = options_.writer != nullptr;
+  json["streaming"] = options_.writer && options_.writer->supportsStreaming();
+  if (options_.fbmDir) {
+    json["fbmDir"] = toJsonString(std::u8string{*options_.fbmDir});
+  }
+  json["useDataUriForBuffers"] = options_.useDataUriForBuffers;
+  json["glb"] = options_.glb;
+  if (const auto &meshQuantization = options_.meshQuantization) {
+    json["meshQuantization"] = {
+        meshQuantization->positionBits, meshQuantization->normalBits,
+        meshQuantization->texCoordBits, meshQuantization->colorBits,
+        meshQuantization->weightBits};
+  }
+  json["noMeshOptimization"] = options_.noMeshOptimization;
+  json["sdkTriangulation"] = options_.sdkTriangulation;
+  json["gpuInstancing"] = options_.gpuInstancing;
+  json["maxSkinInfluences"] = options_.maxSkinInfluences;
+  json["naming"] = static_cast<int>(options_.naming);
+  if (const auto &meshoptCompression = options_.meshoptCompression) {
+    json["meshoptCompression"] = meshoptCompression->excluded;
+  }
+  const auto &bufferPartitioning = options_.bufferPartitioning;
+  json["bufferPartitioning"] = {bufferPartitioning.perMesh,
+                                bufferPartitioning.morphTargets,
+                                bufferPartitioning.perAnimationStack};
+  json["unitConversion"] = static_cast<int>(options_.unitConversion);
+  json["noFlipV"] = options_.noFlipV;
+  json["animationBakeRate"] = options_.animationBakeRate;
+  const auto &animationTolerance = options_.animationTolerance;
+  json["animationTolerance"] = {
+      animationTolerance.translation, animationTolerance.rotation,
+      animationTolerance.scale, animationTolerance.weight};
+  if (const auto &animationQuantization = options_.animationQuantization) {
+    json["animationQuantization"] = {animationQuantization->rotationBits,
+                                     animationQuantization->weightBits};
+  }
+  json["preferLocalTimeSpan"] = options_.prefer_local_time_span;
+  json["textureResolution"]["disabled"] = options_.textureResolution.disabled;
+  auto &locations = json["textureResolution"]["locations"];
+  locations = Json::array();
+  for (const auto &location : options_.textureResolution.locations) {
+    locations.push_back(toJsonString(location));
+  }
+  if (const auto &textureTranscoding = options_.textureTranscoding) {
+    json["textureTranscoding"] = {
+        static_cast<int>(textureTranscoding->codec),
+        textureTranscoding->mipmaps, textureTranscoding->maxSize};
+  }
+  json["pathMode"] = static_cast<int>(options_.pathMode);
+  json["exportSkin"] = options_.export_skin;
+  json["exportBlendShape"] = options_.export_blend_shape;
+  json["exportTrsAnimation"] = options_.export_trs_animation;
+  json["exportBlendShapeAnimation"] = options_.export_blend_shape_animation;
+  json["exportMaterial"] = options_.export_material;
+  auto &nodeFilter = json["nodeFilter"];
+  nodeFilter = Json::array();
+  for (const auto &name : options_.nodeFilter) {
+    nodeFilter.push_back(toJsonString(name));
+  }
+  return json;
+}
+
+/// <summary>
+/// The size and modification time of `path_`, or null if it does not exist.
+/// </summary>
+Json getFileStatus(const fs::path &path_) {
+  std::error_code err;
+  const auto size = fs::file_size(path_, err);
+  if (err) {
+    return nullptr;
+  }
+  const auto time = fs::last_write_time(path_, err);
+  if (err) {
+    return nullptr;
+  }
+  return Json{
+      {"size", size},
+      {"lastWriteTime",
+       static_cast<std::int64_t>(time.time_since_epoch().count())},
+  };
+}
+} // namespace
+
+std::optional<std::u8string>
+RecordingGLTFWriter::buffer(const std::byte *data_,
+                            std::size_t size_,
+                            std::uint32_t index_,
+                            bool multi_) {
+  auto uri = _writer.buffer(data_, size_, index_, multi_);
+  // Buffers without a URI are in the glTF JSON, as data URIs.
+  if (uri) {
+    _buffers.push_back(Buffer{index_, multi_, false, {data_, data_ + size_}});
+  }
+  return uri;
+}
+
+void RecordingGLTFWriter::openBuffer(std::uint32_t index_, bool multi_) {
+  _writer.openBuffer(index_, multi_);
+  _openedBuffers[index_] = Buffer{index_, multi_, true, {}};
+}
+
+void RecordingGLTFWriter::appendBuffer(std::uint32_t index_,
+                                       const std::byte *data_,
+                                       std::size_t size_) {
+  _writer.appendBuffer(index_, data_, size_);
+  auto &data = _openedBuffers.at(index_).data;
+  data.insert(data.end(), data_, data_ + size_);
+}
+
+std::optional<std::u8string>
+RecordingGLTFWriter::closeBuffer(std::uint32_t index_) {
+  auto uri = _writer.closeBuffer(index_);
+  auto openedBuffer = _openedBuffers.extract(index_);
+  if (uri && openedBuffer) {
+    _buffers.push_back(std::move(openedBuffer.mapped()));
+  }
+  return uri;
+}
+
+void RecordingGLTFWriter::glb(
+    std::span<const std::span<const std::byte>> pieces_) {
+  _writer.glb(pieces_);
+  auto &data = _glbData.emplace();
+  for (const auto piece : pieces_) {
+    data.insert(data.end(), piece.begin(), piece.end());
+  }
+}
+
+ConvertCache::ConvertCache(std::u8string_view directory_,
+                           std::u8string_view file_,
+                           const ConvertOptions &options_)
+    : _fingerprint(fingerprintOptions(options_).dump()) {
+  const auto input = MappedFile::open(fs::path{file_});
+  if (!input) {
+    return;
+  }
+  const auto content = input->bytes();
+  _inputSize = content.size();
+  const auto inputHash = hashUntypedVertex(content.data(), content.size());
+  const auto optionsHash = hashUntypedVertex(
+      reinterpret_cast<const std::byte *>(_fingerprint.data()),
+      _fingerprint.size());
+  _entryPath = fs::path{directory_} /
+               fmt::format("{:016x}{:016x}.entry", inputHash, optionsHash);
+}
+
+std::optional<Json> ConvertCache::replay(GLTFWriter &writer_) const {
+  if (!_inputSize) {
+    return {};
+  }
+  const auto entry = MappedFile::open(_entryPath);
+  if (!entry) {
+    return {};
+  }
+
+  // The header size, the header as JSON, then the data the header refers to.
+  const auto bytes = entry->bytes();
+  std::uint64_t headerSize = 0;
+  if (bytes.size() < sizeof(headerSize)) {
+    return {};
+  }
+  std::memcpy(&headerSize, bytes.data(), sizeof(headerSize));
+  if (headerSize > bytes.size() - sizeof(headerSize)) {
+    return {};
+  }
+  const auto headerChars =
+      reinterpret_cast<const char *>(bytes.data() + sizeof(headerSize));
+  const auto header =
+      Json::parse(headerChars, headerChars + headerSize, nullptr, false);
+  const auto blob = bytes.subspan(sizeof(headerSize) + headerSize);
+
+  try {
+    if (!header.is_object() ||
+        header.at("fingerprint").get<std::string>() != _fingerprint ||
+        header.at("inputSize").get<std::uint64_t>() != *_inputSize) {
+      return {};
+    }
+
+    for (const auto &dependency : header.at("dependencies")) {
+      const auto path =
+          fs::path{fromJsonString(dependency.at("path").get<std::string>())};
+      if (getFileStatus(path) != dependency.at("status")) {
+        return {};
+      }
+    }
+
+    using Data = std::span<const std::byte>;
+    const auto getData = [&blob](const Json &slice_) -> std::optional<Data> {
+      const auto offset = slice_.at("offset").get<std::uint64_t>();
+      const auto size = slice_.at("size").get<std::uint64_t>();
+      if (offset > blob.size() || size > blob.size() - offset) {
+        return {};
+      }
+      return blob.subspan(offset, size);
+    };
+
+    // Checked before anything is written.
+    for (const auto &buffer : header.at("buffers")) {
+      if (!getData(buffer.at("data"))) {
+        return {};
+      }
+    }
+    for (const auto &write : header.at("writes")) {
+      if (!getData(write.at("data"))) {
+        return {};
+      }
+    }
+    if (header.contains("glb") && !getData(header["glb"])) {
+      return {};
+    }
+
+    for (const auto &copy : header.at("copies")) {
+      const auto from =
+          fs::path{fromJsonString(copy.at("from").get<std::string>())};
+      const auto to =
+          fs::path{fromJsonString(copy.at("to").get<std::string>())};
+      std::error_code err;
+      fs::create_directories(to.parent_path(), err);
+      if (!copyFileIfChanged(from, to)) {
+        return {};
+      }
+    }
+
+    for (const auto &write : header.at("writes")) {
+      const auto path =
+          fs::path{fromJsonString(write.at("path").get<std::string>())};
+      const auto data = *getData(write.at("data"));
+      std::error_code err;
+      fs::create_directories(path.parent_path(), err);
+      std::ofstream stream(path, std::ios::binary);
+      stream.write(reinterpret_cast<const char *>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+      if (!stream) {
+        return {};
+      }
+    }
+
+    auto glTFJson = header.at("glTF");
+
+    if (header.contains("glb")) {
+      const std::array<std::span<const std::byte>, 1> pieces{
+          *getData(header["glb"])};
+      writer_.glb(pieces);
+      return glTFJson;
+    }
+
+    for (const auto &buffer : header.at("buffers")) {
+      const auto index = buffer.at("index").get<std::uint32_t>();
+      const auto multi = buffer.at("multi").get<bool>();
+      const auto data = *getData(buffer.at("data"));
+      std::optional<std::u8string> uri;
+      if (buffer.at("streamed").get<bool>() && writer_.supportsStreaming()) {
+        writer_.openBuffer(index, multi);
+        writer_.appendBuffer(index, data.data(), data.size());
+        uri = writer_.closeBuffer(index);
+      } else {
+        uri = writer_.buffer(data.data(), data.size(), index, multi);
+      }
+      auto &glTFBuffer = glTFJson.at("buffers").at(index);
+      if (uri) {
+        glTFBuffer["uri"] = toJsonString(*uri);
+      } else {
+        glTFBuffer["uri"] =
+            "data:application/octet-stream;base64," +
+            cppcodec::base64_rfc4648::encode(
+                reinterpret_cast<const char *>(data.data()), data.size());
+      }
+    }
+
+    return glTFJson;
+  } catch (const Json::exception &) {
+    // Not such an entry.
+    return {};
+  }
+}
+
+bool ConvertCache::store(const Json &glTF_json_,
+                         const RecordingGLTFWriter &writer_,
+                         const ConvertSideEffects &side_effects_) const {
+  if (!_inputSize) {
+    return false;
+  }
+
+  std::vector<std::span<const std::byte>> blobPieces;
+  std::uint64_t blobSize = 0;
+  const auto addData = [&](std::span<const std::byte> data_) {
+    Json slice{{"offset", blobSize}, {"size", data_.size()}};
+    blobPieces.push_back(data_);
+    blobSize += data_.size();
+    return slice;
+  };
+
+  Json header;
+  header["fingerprint"] = _fingerprint;
+  header["inputSize"] = *_inputSize;
+  header["glTF"] = glTF_json_;
+
+  auto &dependencies = header["dependencies"];
+  dependencies = Json::array();
+  for (const auto &path : side_effects_.dependencies) {
+    dependencies.push_back(Json{
+        {"path", toJsonString(path.u8string())},
+        {"status", getFileStatus(path)},
+    });
+  }
+
+  auto &copies = header["copies"];
+  copies = Json::array();
+  for (const auto &[from, to] : side_effects_.copies) {
+    copies.push_back(Json{
+        {"from", toJsonString(from.u8string())},
+        {"to", toJsonString(to.u8string())},
+    });
+  }
+
+  auto &writes = header["writes"];
+  writes = Json::array();
+  for (const auto &[path, data] : side_effects_.writes) {
+    writes.push_back(Json{
+        {"path", toJsonString(path.u8string())},
+        {"data", addData(data)},
+    });
+  }
+
+  auto &buffers = header["buffers"];
+  buffers = Json::array();
+  for (const auto &buffer : writer_.buffers()) {
+    buffers.push_back(Json{
+        {"index", buffer.index},
+        {"multi", buffer.multi},
+        {"streamed", buffer.streamed},
+        {"data", addData(buffer.data)},
+    });
+  }
+
+  if (const auto &glbData = writer_.glbData()) {
+    header["glb"] = addData(*glbData);
+  }
+
+  const auto headerText = header.dump();
+  const std::uint64_t headerSize = headerText.size();
+
+  std::error_code err;
+  fs::create_directories(_entryPath.parent_path(), err);
+  // Written aside, then renamed, so that an entry is never seen half written,
+  // even by another process.
+  auto temporaryPath = _entryPath;
+  temporaryPath += fmt::format(".{:08x}.tmp", std::random_device{}());
+  {
+    std::ofstream stream(temporaryPath, std::ios::binary);
+    stream.write(reinterpret_cast<const char *>(&headerSize),
+                 sizeof(headerSize));
+    stream.write(headerText.data(),
+                 static_cast<std::streamsize>(headerText.size()));
+    for (const auto piece : blobPieces) {
+      stream.write(reinterpret_cast<const char *>(piece.data()),
+                   static_cast<std::streamsize>(piece.size()));
+    }
+    if (!stream) {
+      stream.close();
+      fs::remove(temporaryPath, err);
+      return false;
+    }
+  }
+  fs::rename(temporaryPath, _entryPath, err);
+  if (err) {
+    fs::remove(temporaryPath, err);
+    return false;
+  }
+  return true;
+}
+} // namespace bee
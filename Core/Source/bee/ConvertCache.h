@@ -0,0 +1,135 @@
+#pragma once
+
+#include <bee/Converter.h>
+#include <bee/polyfills/filesystem.h>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// What a conversion does besides returning the glTF JSON and giving buffers
+/// to the writer, so that a cache hit can check and redo it.
+/// </summary>
+struct ConvertSideEffects {
+  /// <summary>
+  /// Files, other than the input file, the output depends on.
+  /// </summary>
+  std::vector<bee::filesystem::path> dependencies;
+
+  /// <summary>
+  /// Files copied into the output directory, as (source, target).
+  /// </summary>
+  std::vector<std::pair<bee::filesystem::path, bee::filesystem::path>> copies;
+
+  /// <summary>
+  /// Files written into the output directory.
+  /// </summary>
+  std::vector<std::pair<bee::filesystem::path, std::vector<std::byte>>>
+      writes;
+};
+
+/// <summary>
+/// Forwards to another writer, keeping a copy of the buffers it has given a
+/// URI to and of the binary glTF.
+/// </summary>
+class RecordingGLTFWriter : public GLTFWriter {
+public:
+  struct Buffer {
+    std::uint32_t index = 0;
+    bool multi = false;
+    bool streamed = false;
+    std::vector<std::byte> data;
+  };
+
+  explicit RecordingGLTFWriter(GLTFWriter &writer_) : _writer(writer_) {
+  }
+
+  std::optional<std::u8string> buffer(const std::byte *data_,
+                                      std::size_t size_,
+                                      std::uint32_t index_,
+                                      bool multi_) override;
+
+  bool supportsStreaming() const override {
+    return _writer.supportsStreaming();
+  }
+
+  void openBuffer(std::uint32_t index_, bool multi_) override;
+
+  void appendBuffer(std::uint32_t index_,
+                    const std::byte *data_,
+                    std::size_t size_) override;
+
+  std::optional<std::u8string> closeBuffer(std::uint32_t index_) override;
+
+  void glb(std::span<const std::span<const std::byte>> pieces_) override;
+
+  const std::vector<Buffer> &buffers() const {
+    return _buffers;
+  }
+
+  /// <summary>
+  /// The binary glTF, if it has been written.
+  /// </summary>
+  const std::optional<std::vector<std::byte>> &glbData() const {
+    return _glbData;
+  }
+
+private:
+  GLTFWriter &_writer;
+  std::map<std::uint32_t, Buffer> _openedBuffers;
+  std::vector<Buffer> _buffers;
+  std::optional<std::vector<std::byte>> _glbData;
+};
+
+/// <summary>
+/// The entry of a conversion in the cache of `ConvertOptions::cacheDir`. An
+/// entry is keyed by a hash of the content of the input file, of the options
+/// which affect the output and of `cacheVersion`. It's valid as long as the
+/// files the conversion depended on, like the images it read, have kept their
+/// size and modification time.
+/// </summary>
+class ConvertCache {
+public:
+  /// <summary>
+  /// Bumped whenever a change of the converter changes its output for the
+  /// same input and options, so that older entries are not used.
+  /// </summary>
+  constexpr static std::uint32_t cacheVersion = 3;
+
+  ConvertCache(std::u8string_view directory_,
+               std::u8string_view file_,
+               const ConvertOptions &options_);
+
+  /// <summary>
+  /// Redoes the side effects of the entry and gives its buffers to `writer_`,
+  /// then returns the glTF JSON. Nothing if there's no valid entry, or if the
+  /// input file can't be read.
+  /// </summary>
+  std::optional<Json> replay(GLTFWriter &writer_) const;
+
+  /// <summary>
+  /// Writes the entry. Returns false if it can't be written.
+  /// </summary>
+  bool store(const Json &glTF_json_,
+             const RecordingGLTFWriter &writer_,
+             const ConvertSideEffects &side_effects_) const;
+
+private:
+  /// <summary>
+  /// The options part of the key, kept in the entry so that a hash collision
+  /// is not taken as a hit.
+  /// </summary>
+  std::string _fingerprint;
+
+  std::optional<std::uint64_t> _inputSize;
+
+  bee::filesystem::path _entryPath;
+};
+} // namespace bee
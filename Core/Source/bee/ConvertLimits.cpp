@@ -0,0 +1,47 @@
+#include <bee/ConvertLimits.h>
+#include <bee/ConvertStats.h>
+
+namespace bee {
+ConvertLimits::ConvertLimits(const ConvertOptions &options_)
+    : _cancel(options_.cancel), _cancelPredicate(options_.cancelPredicate),
+      _memoryBudget(options_.memoryBudget) {
+  if (options_.timeBudget) {
+    _deadline = std::chrono::steady_clock::now() +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    *options_.timeBudget);
+  }
+}
+
+std::optional<ConvertAborted::Reason> ConvertLimits::exceeded() const {
+  if ((_cancel && _cancel->load(std::memory_order_relaxed)) ||
+      (_cancelPredicate && _cancelPredicate())) {
+    return ConvertAborted::Reason::cancelled;
+  }
+  if (_deadline && std::chrono::steady_clock::now() > *_deadline) {
+    return ConvertAborted::Reason::timeBudget;
+  }
+  if (_memoryBudget) {
+    if (const auto residentSetSize = getResidentSetSize();
+        residentSetSize && *residentSetSize > _memoryBudget) {
+      return ConvertAborted::Reason::memoryBudget;
+    }
+  }
+  return {};
+}
+
+void ConvertLimits::check() const {
+  const auto reason = exceeded();
+  if (!reason) {
+    return;
+  }
+  switch (*reason) {
+  case ConvertAborted::Reason::cancelled:
+    throw ConvertAborted(*reason, "The conversion has been cancelled.");
+  case ConvertAborted::Reason::timeBudget:
+    throw ConvertAborted(*reason, "The conversion exceeded its time budget.");
+  case ConvertAborted::Reason::memoryBudget:
+    throw ConvertAborted(*reason,
+                         "The conversion exceeded its memory budget.");
+  }
+}
+} // namespace bee
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <bee/Converter.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+namespace bee {
+/// <summary>
+/// Tells whether a conversion must stop, by `ConvertOptions::cancel`,
+/// `ConvertOptions::cancelPredicate`, `ConvertOptions::timeBudget` or
+/// `ConvertOptions::memoryBudget`. The time
+/// budget runs from the construction. It may be checked from any thread.
+/// </summary>
+class ConvertLimits {
+public:
+  explicit ConvertLimits(const ConvertOptions &options_);
+
+  /// <summary>
+  /// Why the conversion must stop, if it must.
+  /// </summary>
+  std::optional<ConvertAborted::Reason> exceeded() const;
+
+  /// <summary>
+  /// Throws `ConvertAborted` if the conversion must stop.
+  /// </summary>
+  void check() const;
+
+private:
+  const std::atomic<bool> *_cancel;
+  std::function<bool()> _cancelPredicate;
+  std::optional<std::chrono::steady_clock::time_point> _deadline;
+  std::uint64_t _memoryBudget;
+};
+} // namespace bee
@@ -0,0 +1,244 @@
+#include <bee/ConvertStats.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#else
+#include <fstream>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace bee {
+namespace {
+double toMicroseconds(ConvertStats::Clock::duration duration_) {
+  return std::chrono::duration<double, std::micro>(duration_).count();
+}
+} // namespace
+
+void ConvertStats::addPhase(std::string_view name_, const Span &span_) {
+  addEvent(name_, "phase", span_);
+}
+
+void ConvertStats::addEvent(std::string_view name_,
+                            std::string_view category_,
+                            const Span &span_) {
+  _events.push_back(Event{std::string{name_}, std::string{category_}, span_});
+}
+
+void ConvertStats::addMesh(Mesh &&mesh_) {
+  _meshes.push_back(std::move(mesh_));
+}
+
+void ConvertStats::addAnimationStack(AnimationStack &&animation_stack_) {
+  _animationStacks.push_back(std::move(animation_stack_));
+}
+
+void ConvertStats::countBufferBytes(const fx::gltf::Document &document_) {
+  // A buffer view counts for what references it first.
+  std::vector<std::string_view> categories(document_.bufferViews.size());
+  const auto assign = [&](std::int64_t buffer_view_,
+                          std::string_view category_) {
+    if (buffer_view_ >= 0 &&
+        static_cast<std::size_t>(buffer_view_) < categories.size() &&
+        categories[buffer_view_].empty()) {
+      categories[buffer_view_] = category_;
+    }
+  };
+  const auto assignAccessor = [&](std::int64_t accessor_,
+                                  std::string_view category_) {
+    if (accessor_ < 0 ||
+        static_cast<std::size_t>(accessor_) >= document_.accessors.size()) {
+      return;
+    }
+    const auto &glTFAccessor = document_.accessors[accessor_];
+    assign(glTFAccessor.bufferView, category_);
+    if (!glTFAccessor.sparse.empty()) {
+      assign(glTFAccessor.sparse.indices.bufferView, category_);
+      assign(glTFAccessor.sparse.values.bufferView, category_);
+    }
+  };
+
+  for (const auto &glTFMesh : document_.meshes) {
+    for (const auto &glTFPrimitive : glTFMesh.primitives) {
+      assignAccessor(glTFPrimitive.indices, "indices");
+      for (const auto &[name, accessor] : glTFPrimitive.attributes) {
+        assignAccessor(accessor, "vertices");
+      }
+      for (const auto &target : glTFPrimitive.targets) {
+        for (const auto &[name, accessor] : target) {
+          assignAccessor(accessor, "morphTargets");
+        }
+      }
+    }
+  }
+  for (const auto &glTFSkin : document_.skins) {
+    assignAccessor(glTFSkin.inverseBindMatrices, "skins");
+  }
+  for (const auto &glTFAnimation : document_.animations) {
+    for (const auto &glTFSampler : glTFAnimation.samplers) {
+      assignAccessor(glTFSampler.input, "animations");
+      assignAccessor(glTFSampler.output, "animations");
+    }
+  }
+  for (const auto &glTFNode : document_.nodes) {
+    const auto &extensionsAndExtras = glTFNode.extensionsAndExtras;
+    if (!extensionsAndExtras.contains("extensions") ||
+        !extensionsAndExtras["extensions"].contains(
+            "EXT_mesh_gpu_instancing")) {
+      continue;
+    }
+    for (const auto &accessor :
+         extensionsAndExtras["extensions"]["EXT_mesh_gpu_instancing"]
+                            ["attributes"]) {
+      assignAccessor(accessor.get<std::int64_t>(), "instancing");
+    }
+  }
+  for (const auto &glTFImage : document_.images) {
+    if (glTFImage.uri.empty()) {
+      assign(glTFImage.bufferView, "images");
+    }
+  }
+
+  for (std::size_t iBufferView = 0; iBufferView < categories.size();
+       ++iBufferView) {
+    const auto category =
+        categories[iBufferView].empty() ? "other" : categories[iBufferView];
+    const auto &glTFBufferView = document_.bufferViews[iBufferView];
+    // A view compressed by EXT_meshopt_compression stores fewer bytes than
+    // it decodes to.
+    std::uint64_t stored = glTFBufferView.byteLength;
+    const auto &extensionsAndExtras = glTFBufferView.extensionsAndExtras;
+    if (extensionsAndExtras.contains("extensions") &&
+        extensionsAndExtras["extensions"].contains("EXT_meshopt_compression")) {
+      stored = extensionsAndExtras["extensions"]["EXT_meshopt_compression"]
+                                  ["byteLength"]
+                                      .get<std::uint64_t>();
+    }
+    _bufferBytes[std::string{category}] += stored;
+  }
+}
+
+Json ConvertStats::toJson() const {
+  auto phases = Json::array();
+  for (const auto &event : _events) {
+    if (event.category == "phase") {
+      phases.push_back(Json{
+          {"name", event.name},
+          {"seconds", std::chrono::duration<double>(event.span.end -
+                                                    event.span.start)
+                          .count()},
+      });
+    }
+  }
+
+  auto meshes = Json::array();
+  for (const auto &mesh : _meshes) {
+    meshes.push_back(Json{
+        {"name", mesh.name},
+        {"seconds", mesh.elapsed.count()},
+        {"polygons", mesh.polygons},
+        {"polygonVertices", mesh.polygonVertices},
+        {"vertices", mesh.vertices},
+        {"triangles", mesh.triangles},
+    });
+  }
+
+  auto animationStacks = Json::array();
+  for (const auto &animationStack : _animationStacks) {
+    animationStacks.push_back(Json{
+        {"name", animationStack.name},
+        {"seconds", animationStack.elapsed.count()},
+        {"channels", animationStack.channels},
+    });
+  }
+
+  Json json{
+      {"seconds",
+       std::chrono::duration<double>(Clock::now() - _start).count()},
+      {"phases", std::move(phases)},
+      {"meshes", std::move(meshes)},
+      {"animationStacks", std::move(animationStacks)},
+      {"bufferBytes", _bufferBytes},
+  };
+  if (const auto peakRss = getPeakResidentSetSize()) {
+    json["peakResidentSetSize"] = *peakRss;
+  } else {
+    json["peakResidentSetSize"] = nullptr;
+  }
+  return json;
+}
+
+Json ConvertStats::toTraceEvents() const {
+  auto traceEvents = Json::array();
+  for (const auto &event : _events) {
+    traceEvents.push_back(Json{
+        {"name", event.name},
+        {"cat", event.category},
+        {"ph", "X"},
+        {"ts", toMicroseconds(event.span.start - _start)},
+        {"dur", toMicroseconds(event.span.end - event.span.start)},
+        {"pid", 0},
+        {"tid", event.span.worker},
+    });
+  }
+  return Json{
+      {"traceEvents", std::move(traceEvents)},
+      {"displayTimeUnit", "ms"},
+  };
+}
+
+std::optional<std::uint64_t> getPeakResidentSetSize() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                            sizeof(counters))) {
+    return {};
+  }
+  return static_cast<std::uint64_t>(counters.PeakWorkingSetSize);
+#else
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return {};
+  }
+#ifdef __APPLE__
+  return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+  // Kilobytes on Linux.
+  return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+std::optional<std::uint64_t> getResidentSetSize() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                            sizeof(counters))) {
+    return {};
+  }
+  return static_cast<std::uint64_t>(counters.WorkingSetSize);
+#elif defined(__APPLE__)
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                reinterpret_cast<task_info_t>(&info),
+                &count) != KERN_SUCCESS) {
+    return {};
+  }
+  return static_cast<std::uint64_t>(info.resident_size);
+#else
+  // Sizes in pages: the whole program, then what's resident.
+  std::ifstream statm{"/proc/self/statm"};
+  std::uint64_t programPages = 0;
+  std::uint64_t residentPages = 0;
+  if (!(statm >> programPages >> residentPages)) {
+    return {};
+  }
+  return residentPages * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+} // namespace bee
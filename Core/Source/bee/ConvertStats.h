@@ -0,0 +1,136 @@
+#pragma once
+
+#include <bee/Converter.h>
+#include <chrono>
+#include <cstdint>
+#include <fx/gltf.h>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// Instrumentation of a conversion, see `ConvertOptions::stats` and
+/// `ConvertOptions::traceFile`. It's not thread-safe: what runs on worker
+/// threads is timed there and recorded afterwards.
+/// </summary>
+class ConvertStats {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /// <summary>
+  /// When something ran, and on which worker: 0 is the converting thread.
+  /// </summary>
+  struct Span {
+    Clock::time_point start;
+    Clock::time_point end;
+    std::uint32_t worker = 0;
+  };
+
+  /// <summary>
+  /// Records its own lifetime as a phase of the conversion. Does nothing if
+  /// the stats are null.
+  /// </summary>
+  class Phase {
+  public:
+    Phase(ConvertStats *stats_, std::string_view name_)
+        : _stats(stats_), _name(name_) {
+      if (_stats) {
+        _start = Clock::now();
+      }
+    }
+
+    Phase(const Phase &) = delete;
+
+    ~Phase() {
+      if (_stats) {
+        _stats->addPhase(_name, {_start, Clock::now()});
+      }
+    }
+
+  private:
+    ConvertStats *_stats;
+    std::string_view _name;
+    Clock::time_point _start;
+  };
+
+  struct Mesh {
+    std::string name;
+    std::chrono::duration<double> elapsed{0.0};
+    std::uint64_t polygons = 0;
+    /// <summary>
+    /// Vertices before deduplication: one per polygon corner.
+    /// </summary>
+    std::uint64_t polygonVertices = 0;
+    /// <summary>
+    /// Vertices after deduplication, summed over the primitives.
+    /// </summary>
+    std::uint64_t vertices = 0;
+    std::uint64_t triangles = 0;
+  };
+
+  struct AnimationStack {
+    std::string name;
+    std::chrono::duration<double> elapsed{0.0};
+    std::uint64_t channels = 0;
+  };
+
+  ConvertStats() : _start(Clock::now()) {
+  }
+
+  void addPhase(std::string_view name_, const Span &span_);
+
+  /// <summary>
+  /// Records a part of the conversion which is not a phase into the trace,
+  /// like the staging of a mesh.
+  /// </summary>
+  void addEvent(std::string_view name_,
+                std::string_view category_,
+                const Span &span_);
+
+  void addMesh(Mesh &&mesh_);
+
+  void addAnimationStack(AnimationStack &&animation_stack_);
+
+  /// <summary>
+  /// Sums the bytes of the buffer views of `document_` by what they hold.
+  /// Views compressed by EXT_meshopt_compression count what they store.
+  /// </summary>
+  void countBufferBytes(const fx::gltf::Document &document_);
+
+  /// <summary>
+  /// The stats record.
+  /// </summary>
+  Json toJson() const;
+
+  /// <summary>
+  /// The phases and events in the Chrome trace event format.
+  /// </summary>
+  Json toTraceEvents() const;
+
+private:
+  struct Event {
+    std::string name;
+    std::string category;
+    Span span;
+  };
+
+  Clock::time_point _start;
+  std::vector<Event> _events;
+  std::vector<Mesh> _meshes;
+  std::vector<AnimationStack> _animationStacks;
+  std::map<std::string, std::uint64_t> _bufferBytes;
+};
+
+/// <summary>
+/// The peak resident set size of the process in bytes, if it can be told.
+/// </summary>
+std::optional<std::uint64_t> getPeakResidentSetSize();
+
+/// <summary>
+/// The current resident set size of the process in bytes, if it can be told.
+/// </summary>
+std::optional<std::uint64_t> getResidentSetSize();
+} // namespace bee
@@ -1,75 +1,214 @@
 
 #include <bee/Convert/SceneConverter.h>
 #include <bee/Convert/fbxsdk/ObjectDestroyer.h>
+#include <bee/ConvertCache.h>
+#include <bee/ConvertLimits.h>
+#include <bee/ConvertStats.h>
 #include <bee/Converter.h>
+#include <bee/GLTFUtilities.h>
+#include <bee/MeshoptCompression.h>
 #include <bee/polyfills/filesystem.h>
 #include <bee/polyfills/json.h>
 #include <cppcodec/base64_default_rfc4648.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
 #include <fbxsdk.h>
 #include <fmt/format.h>
+#include <fstream>
 #include <iostream>
 #include <map>
+#include <mutex>
+#include <thread>
 
 namespace bee {
 class Converter {
 public:
-  Converter(const ConvertOptions &options_) {
+  Converter() {
     _fbxManager = fbxsdk::FbxManager::Create();
     if (!_fbxManager) {
       throw std::runtime_error("Failed to initialize FBX SDK.");
     }
 
-    if (options_.fbmDir) {
-      // TODO: use `FBXImporter::SetEmbeddingExtractionFolder`
-      std::string fbmDirCStr{options_.fbmDir->data(),
-                             options_.fbmDir->data() + options_.fbmDir->size()};
-      auto &xRefManager = _fbxManager->GetXRefManager();
-      if (!xRefManager.AddXRefProject(
-              fbxsdk::FbxXRefManager::sEmbeddedFileProject,
-              fbmDirCStr.data())) {
-        if (options_.logger) {
-          (*options_.logger)(Logger::Level::warning,
-                             u8"Failed to set .fbm dir");
-        }
-      }
-    }
+    auto ioSettings = fbxsdk::FbxIOSettings::Create(_fbxManager, IOSROOT);
+    _fbxManager->SetIOSettings(ioSettings);
   }
 
+  Converter(const Converter &) = delete;
+
   ~Converter() {
     _fbxManager->Destroy();
   }
 
   Json BEE_API convert(std::u8string_view file_,
                        const ConvertOptions &options_) {
-    auto fbxScene = _import(file_, options_);
+    if (!options_.stats && !options_.traceFile) {
+      return _convertCached(file_, options_, nullptr);
+    }
+    ConvertStats stats;
+    Json glTFJson;
+    try {
+      glTFJson = _convertCached(file_, options_, &stats);
+    } catch (...) {
+      // What ran before the failure helps to tell why it failed.
+      _reportStats(stats, options_);
+      throw;
+    }
+    _reportStats(stats, options_);
+    return glTFJson;
+  }
+
+private:
+  fbxsdk::FbxManager *_fbxManager = nullptr;
+
+  Json _convertCached(std::u8string_view file_,
+                      const ConvertOptions &options_,
+                      ConvertStats *stats_) {
+    GLTFWriter defaultWriter;
+    auto glTFWriter = options_.writer ? options_.writer : &defaultWriter;
+
+    if (!options_.cacheDir) {
+      return _convert(file_, options_, *glTFWriter, nullptr, true, stats_);
+    }
+
+    const ConvertCache cache{*options_.cacheDir, file_, options_};
+    auto cachedGLTFJson = [&] {
+      ConvertStats::Phase phase{stats_, "replayCache"};
+      return cache.replay(*glTFWriter);
+    }();
+    if (cachedGLTFJson) {
+      if (options_.logger) {
+        (*options_.logger)(Logger::Level::verbose,
+                           u8"Reproduced the conversion from the cache.");
+      }
+      return _writeJson(std::move(*cachedGLTFJson), options_, *glTFWriter,
+                        stats_);
+    }
+
+    // The entry needs the JSON tree.
+    RecordingGLTFWriter recordingWriter{*glTFWriter};
+    ConvertSideEffects sideEffects;
+    auto glTFJson = _convert(file_, options_, recordingWriter, &sideEffects,
+                             false, stats_);
+    const auto stored = [&] {
+      ConvertStats::Phase phase{stats_, "storeCache"};
+      return cache.store(glTFJson, recordingWriter, sideEffects);
+    }();
+    if (!stored && options_.logger) {
+      (*options_.logger)(Logger::Level::warning,
+                         u8"Failed to write the conversion into the cache.");
+    }
+    return _writeJson(std::move(glTFJson), options_, *glTFWriter, stats_);
+  }
+
+  static void _reportStats(const ConvertStats &stats_,
+                           const ConvertOptions &options_) {
+    if (options_.stats && options_.logger) {
+      (*options_.logger)(Logger::Level::info,
+                         Json{{"stats", stats_.toJson()}});
+    }
+    if (options_.traceFile) {
+      std::ofstream traceStream{bee::filesystem::path{*options_.traceFile}};
+      traceStream << stats_.toTraceEvents().dump();
+      if (!traceStream && options_.logger) {
+        (*options_.logger)(Logger::Level::warning,
+                           u8"Failed to write the trace file.");
+      }
+    }
+  }
+
+  /// <summary>
+  /// Gives the glTF JSON to `writer_` if it takes it, see
+  /// `GLTFWriter::json()`.
+  /// </summary>
+  static Json _writeJson(Json &&glTF_json_,
+                         const ConvertOptions &options_,
+                         GLTFWriter &writer_,
+                         ConvertStats *stats_) {
+    ConvertStats::Phase phase{stats_, "dumpJson"};
+    if (!options_.glb && writer_.json([&](std::ostream &stream_) {
+          stream_ << glTF_json_.dump(options_.jsonIndent);
+        })) {
+      return {};
+    }
+    return std::move(glTF_json_);
+  }
+
+  /// <summary>
+  /// If `stream_json_`, the glTF JSON is written through `GLTFWriter::json()`
+  /// straight from the document when the writer takes it.
+  /// </summary>
+  Json _convert(std::u8string_view file_,
+                const ConvertOptions &options_,
+                GLTFWriter &writer_,
+                ConvertSideEffects *side_effects_,
+                bool stream_json_,
+                ConvertStats *stats_) {
+    const ConvertLimits limits{options_};
+    _setFbmDir(options_);
+    auto fbxScene = [&] {
+      ConvertStats::Phase phase{stats_, "import"};
+      return _import(file_, options_, limits);
+    }();
     FbxObjectDestroyer fbxSceneDestroyer{fbxScene};
     GLTFBuilder glTFBuilder;
-    SceneConverter sceneConverter{*_fbxManager, *fbxScene, options_, file_,
-                                  glTFBuilder};
+    if (!options_.glb && !options_.useDataUriForBuffers &&
+        writer_.supportsStreaming() && !options_.meshoptCompression) {
+      glTFBuilder.setStreamingWriter(&writer_);
+    }
+    SceneConverter sceneConverter{*_fbxManager, *fbxScene,   options_,
+                                  file_,        glTFBuilder, side_effects_,
+                                  stats_,       &limits};
     sceneConverter.convert();
+    limits.check();
 
     GLTFBuilder::BuildOptions buildOptions;
     buildOptions.generator = "FBX-glTF-conv";
     buildOptions.copyright =
         "Copyright (c) 2018-2020 Chukong Technologies Inc.";
-    auto glTFBuildResult = glTFBuilder.build(buildOptions);
+    buildOptions.naming = options_.naming;
+    auto glTFBuildResult = [&] {
+      ConvertStats::Phase phase{stats_, "build"};
+      return glTFBuilder.build(buildOptions);
+    }();
+    if (options_.meshoptCompression) {
+      ConvertStats::Phase phase{stats_, "meshoptCompression"};
+      compressBufferViews(glTFBuilder, glTFBuildResult,
+                          *options_.meshoptCompression, options_.meshThreads);
+    }
     auto &glTFDocument = glTFBuilder.document();
+    if (stats_) {
+      stats_->countBufferBytes(glTFDocument);
+    }
 
-    GLTFWriter defaultWriter;
-    auto glTFWriter = options_.writer ? options_.writer : &defaultWriter;
+    if (options_.glb) {
+      ConvertStats::Phase phase{stats_, "writeGLB"};
+      return _writeGLB(glTFDocument, glTFBuildResult, writer_);
+    }
 
     {
+      ConvertStats::Phase phase{stats_, "writeBuffers"};
       const auto nBuffers =
           static_cast<std::uint32_t>(glTFDocument.buffers.size());
       for (std::remove_const_t<decltype(nBuffers)> iBuffer = 0;
            iBuffer < nBuffers; ++iBuffer) {
         auto &glTFBuffer = glTFDocument.buffers[iBuffer];
-        const auto &bufferData = glTFBuildResult.buffers[iBuffer];
+        if (glTFBuildResult.buffers[iBuffer].fallback) {
+          continue;
+        }
+        if (const auto &streamedUri = glTFBuildResult.buffers[iBuffer].uri) {
+          glTFBuffer.uri = std::string{streamedUri->begin(), streamedUri->end()};
+          continue;
+        }
+        // Both consumers below want one contiguous block.
+        const auto bufferData = glTFBuildResult.buffers[iBuffer].contiguous();
         std::optional<std::string> uri;
         if (!options_.useDataUriForBuffers) {
-          auto u8Uri = glTFWriter->buffer(bufferData.data(), bufferData.size(),
-                                          iBuffer, nBuffers != 1);
+          auto u8Uri = writer_.buffer(
+              bufferData.data(), bufferData.size(), iBuffer,
+              nBuffers != 1 || options_.bufferPartitioning.any());
           if (u8Uri) {
             uri = std::string{u8Uri->begin(), u8Uri->end()};
           }
@@ -84,11 +223,11 @@ public:
       }
     }
 
-    {
-      const auto nImages = glTFDocument.images.size();
-      for (std::remove_const_t<decltype(nImages)> iImage = 0; iImage < nImages;
-           ++iImage) {
-      }
+    ConvertStats::Phase phase{stats_, "writeJson"};
+    if (stream_json_ && writer_.json([&](std::ostream &stream_) {
+          writeGLTFJson(stream_, glTFDocument, options_.jsonIndent);
+        })) {
+      return {};
     }
 
     nlohmann::json glTFJson;
@@ -97,15 +236,127 @@ public:
     return glTFJson;
   }
 
-private:
-  fbxsdk::FbxManager *_fbxManager = nullptr;
+  static Json _writeGLB(fx::gltf::Document &glTF_document_,
+                        const GLTFBuilder::BuildResult &build_result_,
+                        GLTFWriter &writer_) {
+    // GLB carries only one buffer: the BIN chunk. If there are more, they're
+    // laid one after another, only the buffer views are rebased. Fallback
+    // buffers have no content, they're kept after the BIN buffer.
+    constexpr std::array<std::byte, 3> padding{};
+    std::vector<std::span<const std::byte>> binPieces;
+    std::size_t binSize = 0;
+    const auto nBuffers = glTF_document_.buffers.size();
+    std::vector<std::uint32_t> bufferOffsets(nBuffers);
+    std::vector<std::uint32_t> bufferIndices(nBuffers, 0);
+    std::vector<fx::gltf::Buffer> fallbackBuffers;
+    for (std::remove_const_t<decltype(nBuffers)> iBuffer = 0;
+         iBuffer < nBuffers; ++iBuffer) {
+      if (build_result_.buffers[iBuffer].fallback) {
+        bufferIndices[iBuffer] =
+            static_cast<std::uint32_t>(fallbackBuffers.size() + 1);
+        fallbackBuffers.push_back(glTF_document_.buffers[iBuffer]);
+        continue;
+      }
+      const auto alignedSize = alignGLBChunkSize(binSize);
+      if (alignedSize != binSize) {
+        binPieces.push_back(std::span{padding}.first(alignedSize - binSize));
+        binSize = alignedSize;
+      }
+      bufferOffsets[iBuffer] = static_cast<std::uint32_t>(binSize);
+      const auto &buffer = build_result_.buffers[iBuffer];
+      const auto pieces = buffer.pieces();
+      binPieces.insert(binPieces.end(), pieces.begin(), pieces.end());
+      binSize += buffer.byteLength;
+    }
+    if (nBuffers > 1) {
+      for (auto &glTFBufferView : glTF_document_.bufferViews) {
+        glTFBufferView.byteOffset += bufferOffsets[glTFBufferView.buffer];
+        glTFBufferView.buffer =
+            static_cast<std::int32_t>(bufferIndices[glTFBufferView.buffer]);
+        auto &extensionsAndExtras = glTFBufferView.extensionsAndExtras;
+        if (extensionsAndExtras.contains("extensions") &&
+            extensionsAndExtras["extensions"].contains(
+                "EXT_meshopt_compression")) {
+          auto &meshopt =
+              extensionsAndExtras["extensions"]["EXT_meshopt_compression"];
+          const auto iBuffer = meshopt["buffer"].get<std::uint32_t>();
+          meshopt["byteOffset"] = meshopt["byteOffset"].get<std::uint32_t>() +
+                                  bufferOffsets[iBuffer];
+          meshopt["buffer"] = bufferIndices[iBuffer];
+        }
+      }
+      glTF_document_.buffers.resize(1);
+      glTF_document_.buffers[0].byteLength =
+          static_cast<std::uint32_t>(binSize);
+      glTF_document_.buffers.insert(glTF_document_.buffers.end(),
+                                    fallbackBuffers.begin(),
+                                    fallbackBuffers.end());
+    }
 
-  FbxScene *_import(std::u8string_view file_, const ConvertOptions &options_) {
-    auto ioSettings = fbxsdk::FbxIOSettings::Create(_fbxManager, IOSROOT);
-    _fbxManager->SetIOSettings(ioSettings);
+    if (binSize == 0) {
+      // glTF buffers can't be empty: the BIN buffer goes, the fallback
+      // buffers after it move down.
+      glTF_document_.buffers.erase(glTF_document_.buffers.begin());
+      for (auto &glTFBufferView : glTF_document_.bufferViews) {
+        if (glTFBufferView.buffer > 0) {
+          --glTFBufferView.buffer;
+        }
+      }
+    } else {
+      glTF_document_.buffers[0].uri.clear();
+    }
+
+    nlohmann::json glTFJson;
+    fx::gltf::to_json(glTFJson, glTF_document_);
+
+    writeGLB(glTFJson.dump(), binPieces, binSize, writer_);
+
+    return glTFJson;
+  }
+
+  /// <summary>
+  /// The .fbm dir currently registered into the XRef manager.
+  /// </summary>
+  std::optional<std::string> _fbmDir;
+
+  void _setFbmDir(const ConvertOptions &options_) {
+    std::optional<std::string> fbmDir;
+    if (options_.fbmDir) {
+      fbmDir.emplace(options_.fbmDir->data(),
+                     options_.fbmDir->data() + options_.fbmDir->size());
+    }
+    if (fbmDir == _fbmDir) {
+      return;
+    }
+
+    // TODO: use `FBXImporter::SetEmbeddingExtractionFolder`
+    auto &xRefManager = _fbxManager->GetXRefManager();
+    if (_fbmDir) {
+      xRefManager.RemoveXRefProject(
+          fbxsdk::FbxXRefManager::sEmbeddedFileProject);
+      _fbmDir.reset();
+    }
+    if (fbmDir) {
+      if (xRefManager.AddXRefProject(
+              fbxsdk::FbxXRefManager::sEmbeddedFileProject, fbmDir->data())) {
+        _fbmDir = fbmDir;
+      } else if (options_.logger) {
+        (*options_.logger)(Logger::Level::warning, u8"Failed to set .fbm dir");
+      }
+    }
+  }
 
+  FbxScene *_import(std::u8string_view file_,
+                    const ConvertOptions &options_,
+                    const ConvertLimits &limits_) {
     auto fbxImporter = fbxsdk::FbxImporter::Create(_fbxManager, "");
     FbxObjectDestroyer fbxImporterDestroyer{fbxImporter};
+    // Returning false from the callback stops the import.
+    fbxImporter->SetProgressCallback(
+        [](void *limits_, float, const char *) {
+          return !static_cast<const ConvertLimits *>(limits_)->exceeded();
+        },
+        const_cast<ConvertLimits *>(&limits_));
 
     auto inputFileCStr = std::string{file_.data(), file_.data() + file_.size()};
     auto importInitOk = fbxImporter->Initialize(inputFileCStr.c_str(), -1,
@@ -116,6 +367,10 @@ private:
                                std::string() + status.GetErrorString());
     }
 
+    // The settings are shared by the files of the session, so each of them is
+    // set for each file.
+    const auto exportAnimation = options_.export_trs_animation ||
+                                 options_.export_blend_shape_animation;
     if (fbxImporter->IsFBX()) {
       // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_MODEL_COUNT, true);
       // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_DEVICE_COUNT, true);
@@ -135,20 +390,26 @@ private:
       // fbxImporter->GetIOSettings()->SetBoolProp(
       //    IMP_FBX_MERGE_LAYER_AND_TIMEWARP, true);
       // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_GOBO, true);
-      // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_SHAPE, true);
-      // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_LINK, true);
-      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_MATERIAL, true);
-      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_TEXTURE, true);
+      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_SHAPE,
+                                                options_.export_blend_shape);
+      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_LINK,
+                                                options_.export_skin);
+      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_MATERIAL,
+                                                options_.export_material);
+      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_TEXTURE,
+                                                options_.export_material);
       fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_MODEL, true);
       // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_AUDIO, true);
-      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_ANIMATION, true);
+      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_ANIMATION,
+                                                exportAnimation);
       // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_PASSWORD, true);
       // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_PASSWORD_ENABLE,
       // true);
       fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_CURRENT_TAKE_NAME,
                                                 true);
+      // Embedded media are textures.
       fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_EXTRACT_EMBEDDED_DATA,
-                                                true);
+                                                options_.export_material);
     }
 
     if (options_.verbose && options_.logger) {
@@ -181,6 +442,8 @@ private:
     auto importOk = fbxImporter->Import(fbxScene);
     if (!importOk) {
       const auto status = fbxImporter->GetStatus();
+      fbxScene->Destroy();
+      limits_.check();
       throw std::runtime_error("Failed to import scene." + std::string() +
                                status.GetErrorString());
     }
@@ -190,7 +453,235 @@ private:
 };
 
 Json BEE_API convert(std::u8string_view file_, const ConvertOptions &options_) {
-  Converter converter(options_);
+  Converter converter;
   return converter.convert(file_, options_);
 }
+
+ConvertSession::ConvertSession() : _converter(std::make_unique<Converter>()) {
+}
+
+ConvertSession::~ConvertSession() = default;
+
+Json ConvertSession::convert(std::u8string_view file_,
+                             const ConvertOptions &options_) {
+  return _converter->convert(file_, options_);
+}
+
+ConvertSession::BatchItemResult
+ConvertSession::tryConvert(const BatchItem &item_) {
+  BatchItemResult result;
+  const auto startTime = std::chrono::steady_clock::now();
+  try {
+    result.glTFJson = _converter->convert(item_.file, item_.options);
+  } catch (const ConvertAborted &exception) {
+    result.error = exception.what();
+    result.aborted = exception.reason();
+  } catch (const std::exception &exception) {
+    result.error = exception.what();
+  } catch (...) {
+    result.error = "Unknown error.";
+  }
+  result.elapsed = std::chrono::steady_clock::now() - startTime;
+  return result;
+}
+
+void ConvertSession::convert(std::span<const BatchItem> items_,
+                             const BatchCallback &callback_) {
+  const auto nItems = items_.size();
+  for (std::remove_const_t<decltype(nItems)> iItem = 0; iItem < nItems;
+       ++iItem) {
+    const auto &item = items_[iItem];
+    auto result = tryConvert(item);
+    if (callback_) {
+      callback_(iItem, item, std::move(result));
+    }
+  }
+}
+
+namespace {
+/// <summary>
+/// Bounds the summed input size of the files converted at the same time.
+/// </summary>
+class InFlightBudget {
+public:
+  class Scope {
+  public:
+    Scope(InFlightBudget &budget_, std::uintmax_t size_)
+        : _budget(budget_), _size(size_) {
+      _budget._acquire(_size);
+    }
+
+    Scope(const Scope &) = delete;
+
+    ~Scope() {
+      _budget._release(_size);
+    }
+
+  private:
+    InFlightBudget &_budget;
+    std::uintmax_t _size;
+  };
+
+  InFlightBudget(std::uintmax_t limit_) : _limit(limit_) {
+  }
+
+private:
+  std::uintmax_t _limit;
+  std::uintmax_t _inFlight = 0;
+  std::mutex _mutex;
+  std::condition_variable _released;
+
+  void _acquire(std::uintmax_t size_) {
+    if (!_limit) {
+      return;
+    }
+    std::unique_lock lock{_mutex};
+    _released.wait(lock, [this, size_] {
+      return _inFlight == 0 || _inFlight + size_ <= _limit;
+    });
+    _inFlight += size_;
+  }
+
+  void _release(std::uintmax_t size_) {
+    if (!_limit) {
+      return;
+    }
+    {
+      std::lock_guard lock{_mutex};
+      _inFlight -= size_;
+    }
+    _released.notify_all();
+  }
+};
+} // namespace
+
+void BEE_API convertParallel(std::span<const ConvertSession::BatchItem> items_,
+                             const ConvertSession::BatchCallback &callback_,
+                             const ParallelConvertOptions &parallel_options_) {
+  namespace fs = bee::filesystem;
+
+  const auto nItems = items_.size();
+  if (nItems == 0) {
+    return;
+  }
+
+  auto nWorkers = static_cast<std::size_t>(parallel_options_.jobs);
+  if (nWorkers == 0) {
+    nWorkers = std::max(1u, std::thread::hardware_concurrency());
+  }
+  nWorkers = std::min(nWorkers, nItems);
+
+  InFlightBudget budget{parallel_options_.memoryBudget};
+  std::atomic<std::size_t> nextItem{0};
+  std::mutex callbackMutex;
+
+  const auto work = [&]() {
+    std::unique_ptr<ConvertSession> session;
+    std::string sessionError;
+    try {
+      session = std::make_unique<ConvertSession>();
+    } catch (const std::exception &exception) {
+      sessionError = exception.what();
+    }
+
+    while (true) {
+      const auto iItem = nextItem.fetch_add(1);
+      if (iItem >= nItems) {
+        break;
+      }
+      const auto &item = items_[iItem];
+
+      std::error_code errc;
+      auto fileSize = fs::file_size(fs::path{item.file}, errc);
+      if (errc) {
+        fileSize = 0;
+      }
+
+      ConvertSession::BatchItemResult result;
+      {
+        InFlightBudget::Scope budgetScope{budget, fileSize};
+        if (session) {
+          result = session->tryConvert(item);
+        } else {
+          result.error = sessionError;
+        }
+      }
+
+      if (callback_) {
+        std::lock_guard lock{callbackMutex};
+        callback_(iItem, item, std::move(result));
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(nWorkers);
+  for (std::remove_const_t<decltype(nWorkers)> iWorker = 0;
+       iWorker < nWorkers; ++iWorker) {
+    workers.emplace_back(work);
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+struct ConvertJob::State {
+  ConvertSession::BatchItem item;
+  DoneCallback done;
+  std::atomic<bool> cancelled{false};
+  mutable std::mutex mutex;
+  std::condition_variable finished;
+  std::optional<Result> result;
+  std::thread thread;
+};
+
+ConvertJob::ConvertJob(ConvertSession::BatchItem item_, DoneCallback done_)
+    : _state(std::make_unique<State>()) {
+  _state->item = std::move(item_);
+  // The item's own flag and predicate are kept.
+  _state->item.options.cancelPredicate =
+      [cancelled = &_state->cancelled,
+       predicate = std::move(_state->item.options.cancelPredicate)] {
+        return cancelled->load(std::memory_order_relaxed) ||
+               (predicate && predicate());
+      };
+  _state->done = std::move(done_);
+  _state->thread = std::thread([state = _state.get()] {
+    Result result;
+    try {
+      ConvertSession session;
+      result = session.tryConvert(state->item);
+    } catch (const std::exception &exception) {
+      result.error = exception.what();
+    }
+    if (state->done) {
+      state->done(result);
+    }
+    {
+      std::lock_guard lock{state->mutex};
+      state->result = std::move(result);
+    }
+    state->finished.notify_all();
+  });
+}
+
+ConvertJob::~ConvertJob() {
+  cancel();
+  _state->thread.join();
+}
+
+void ConvertJob::cancel() {
+  _state->cancelled = true;
+}
+
+bool ConvertJob::done() const {
+  std::lock_guard lock{_state->mutex};
+  return _state->result.has_value();
+}
+
+const ConvertJob::Result &ConvertJob::wait() {
+  std::unique_lock lock{_state->mutex};
+  _state->finished.wait(lock, [this] { return _state->result.has_value(); });
+  return *_state->result;
+}
 } // namespace bee
@@ -3,12 +3,22 @@
 
 #include <bee/BEE_API.h>
 #include <bee/polyfills/json.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
 #include <optional>
+#include <ostream>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <vector>
 
 namespace bee {
+class TextureCache;
+class TextureSearchIndex;
+
 class GLTFWriter {
 public:
   virtual std::optional<std::u8string> buffer(const std::byte *data_,
@@ -17,6 +27,48 @@ public:
                                               bool multi_) {
     return {};
   }
+
+  /// <summary>
+  /// Whether this writer accepts buffers piece by piece through
+  /// `openBuffer()`, `appendBuffer()` and `closeBuffer()` while the scene is
+  /// being converted. If so, `buffer()` is not called.
+  /// </summary>
+  virtual bool supportsStreaming() const {
+    return false;
+  }
+
+  virtual void openBuffer(std::uint32_t index_, bool multi_) {
+  }
+
+  virtual void appendBuffer(std::uint32_t index_,
+                            const std::byte *data_,
+                            std::size_t size_) {
+  }
+
+  /// <summary>
+  /// Returns the URI of the buffer. Since the content has been dropped, the
+  /// writer must provide one.
+  /// </summary>
+  virtual std::optional<std::u8string> closeBuffer(std::uint32_t index_) {
+    return {};
+  }
+
+  /// <summary>
+  /// Receives the binary glTF when `ConvertOptions::glb` is set.
+  /// The pieces, concatenated in order, form the .glb file.
+  /// </summary>
+  virtual void glb(std::span<const std::span<const std::byte>> pieces_) {
+  }
+
+  /// <summary>
+  /// Takes the glTF JSON as text, unless `ConvertOptions::glb` is set: the
+  /// writer calls `write_` once with the stream to write it into, then the
+  /// conversion returns a null JSON. Returns false, without calling
+  /// `write_`, to have the conversion return the JSON tree instead.
+  /// </summary>
+  virtual bool json(const std::function<void(std::ostream &)> &write_) {
+    return false;
+  }
 };
 
 using Json = nlohmann::json;
@@ -47,6 +99,57 @@ public:
   }
 };
 
+/// <summary>
+/// Progress of a conversion, see `ConvertOptions::progress`.
+/// </summary>
+struct ConvertProgress {
+  enum class Stage {
+    node,
+    mesh,
+    animationStack,
+  };
+
+  Stage stage;
+
+  /// <summary>
+  /// Name of what has just been converted: the node, the mesh or the
+  /// animation stack.
+  /// </summary>
+  std::string name;
+
+  /// <summary>
+  /// How many of the stage have been converted, this one included, out of
+  /// `total`. Meshes are counted by the nodes holding them.
+  /// </summary>
+  std::uint32_t done = 0;
+
+  std::uint32_t total = 0;
+};
+
+/// <summary>
+/// Thrown when a conversion is stopped through `ConvertOptions::cancel` or
+/// by one of its budgets.
+/// </summary>
+class ConvertAborted : public std::runtime_error {
+public:
+  enum class Reason {
+    cancelled,
+    timeBudget,
+    memoryBudget,
+  };
+
+  ConvertAborted(Reason reason_, const std::string &message_)
+      : std::runtime_error(message_), _reason(reason_) {
+  }
+
+  Reason reason() const {
+    return _reason;
+  }
+
+private:
+  Reason _reason;
+};
+
 struct ConvertOptions {
   enum class UnitConversion {
     disabled,
@@ -62,6 +165,167 @@ struct ConvertOptions {
 
   bool useDataUriForBuffers = true;
 
+  /// <summary>
+  /// Outputs binary glTF(.glb) through `GLTFWriter::glb()`.
+  /// All buffers go into the BIN chunk and, with `PathMode::embedded`, so do
+  /// the images. `useDataUriForBuffers` is then ignored.
+  /// </summary>
+  bool glb = false;
+
+  /// <summary>
+  /// Indentation of the glTF JSON written through `GLTFWriter::json()`, as
+  /// for `Json::dump()`: negative for the compact form.
+  /// </summary>
+  int jsonIndent = 2;
+
+  enum class NamingPolicy {
+    /// <summary>
+    /// Names every object. Accessors and buffer views are named after what
+    /// they hold.
+    /// </summary>
+    full,
+
+    /// <summary>
+    /// Names only nodes and meshes.
+    /// </summary>
+    nodesAndMeshes,
+
+    /// <summary>
+    /// Names nothing.
+    /// </summary>
+    none,
+  };
+
+  /// <summary>
+  /// Which glTF objects are named. Names of accessors and buffer views are
+  /// not even generated if they're not kept.
+  /// </summary>
+  NamingPolicy naming = NamingPolicy::full;
+
+  /// <summary>
+  /// Number of threads used to convert meshes and to compress buffer views;
+  /// 0 means the hardware concurrency. Meshes are still written into the
+  /// buffers in node order.
+  /// </summary>
+  std::uint32_t meshThreads = 1;
+
+  /// <summary>
+  /// Number of threads used to sample the animation of nodes; 0 means the
+  /// hardware concurrency. Each thread evaluates with its own animation
+  /// evaluator. Animation stacks are still converted one by one since the
+  /// current stack is per scene.
+  /// </summary>
+  std::uint32_t animationThreads = 1;
+
+  /// <summary>
+  /// Number of threads used to read, embed and copy image files; 0 means the
+  /// hardware concurrency. Embedded images are laid out in the buffer before
+  /// they're copied in.
+  /// </summary>
+  std::uint32_t ioThreads = 1;
+
+  /// <summary>
+  /// Quantizes vertex attributes, as per KHR_mesh_quantization.
+  /// For each attribute, 0 bits keeps it as float.
+  /// </summary>
+  struct MeshQuantization {
+    /// <summary>
+    /// 2 to 16; other non-zero values are clamped into that range, a single
+    /// bit leaving no room for the sign. Positions are normalized into the
+    /// bounds of their mesh, which are restored by a node transform. Skinned
+    /// meshes keep float positions since their node transforms are ignored.
+    /// </summary>
+    std::uint32_t positionBits = 16;
+
+    /// <summary>
+    /// 8 or 16.
+    /// </summary>
+    std::uint32_t normalBits = 8;
+
+    /// <summary>
+    /// 8 or 16. UV sets out of [0, 1] are kept as float.
+    /// </summary>
+    std::uint32_t texCoordBits = 16;
+
+    /// <summary>
+    /// 8 or 16.
+    /// </summary>
+    std::uint32_t colorBits = 8;
+
+    /// <summary>
+    /// 8 or 16.
+    /// </summary>
+    std::uint32_t weightBits = 8;
+  };
+
+  std::optional<MeshQuantization> meshQuantization;
+
+  /// <summary>
+  /// Do not reorder triangles and vertices of primitives for the
+  /// post-transform vertex cache, overdraw and vertex fetch.
+  /// </summary>
+  bool noMeshOptimization = false;
+
+  /// <summary>
+  /// Triangulate and split meshes per material with the FBX SDK, as a whole
+  /// scene pass before conversion, rather than while reading the vertices.
+  /// </summary>
+  bool sdkTriangulation = false;
+
+  /// <summary>
+  /// Collapses sibling nodes sharing a mesh into a single node drawing it at
+  /// each of their transforms, as per `EXT_mesh_gpu_instancing`. Only leaf
+  /// nodes which are neither animated, skinned nor joints are collapsed.
+  /// </summary>
+  bool gpuInstancing = false;
+
+  /// <summary>
+  /// Compresses buffer views with meshoptimizer, as per
+  /// EXT_meshopt_compression. Buffers are then not streamed.
+  /// </summary>
+  struct MeshoptCompression {
+    /// <summary>
+    /// Buffer views holding any of these are left uncompressed. Names are
+    /// attribute semantics, or `INDICES` and `ANIMATION`. A semantic without
+    /// set index, like `TEXCOORD`, stands for all of its sets.
+    /// </summary>
+    std::vector<std::string> excluded;
+  };
+
+  std::optional<MeshoptCompression> meshoptCompression;
+
+  /// <summary>
+  /// Splits the binary data into buffers, so that a runtime can render the
+  /// base geometry before fetching the rest. Buffers are named after what
+  /// they hold and given to `GLTFWriter` under their index, `multi_` set.
+  /// Instance transforms go with their mesh and, when split in any way,
+  /// images into a buffer of their own; buffers left empty are dropped. With
+  /// `glb`, buffers are merged into the BIN chunk all the same.
+  /// </summary>
+  struct BufferPartitioning {
+    /// <summary>
+    /// Each mesh, with its skin, goes into a buffer of its own.
+    /// </summary>
+    bool perMesh = false;
+
+    /// <summary>
+    /// Morph targets go apart from the base geometry: into one buffer for
+    /// all meshes, or one per mesh with `perMesh`.
+    /// </summary>
+    bool morphTargets = false;
+
+    /// <summary>
+    /// Each animation stack goes into a buffer of its own.
+    /// </summary>
+    bool perAnimationStack = false;
+
+    bool any() const {
+      return perMesh || morphTargets || perAnimationStack;
+    }
+  };
+
+  BufferPartitioning bufferPartitioning;
+
   UnitConversion unitConversion = UnitConversion::geometryLevel;
 
   bool noFlipV = false;
@@ -71,6 +335,49 @@ struct ConvertOptions {
   /// </summary>
   std::uint32_t animationBakeRate = 0;
 
+  /// <summary>
+  /// Tolerances of the keyframe reduction of baked animations. Keys are
+  /// dropped as long as interpolating across them deviates from the baked
+  /// samples by at most these. Channels that keep the node's own value
+  /// throughout are dropped.
+  /// </summary>
+  struct AnimationTolerance {
+    /// <summary>
+    /// Distance, in the output unit.
+    /// </summary>
+    double translation = 1e-4;
+
+    /// <summary>
+    /// Angle, in degrees.
+    /// </summary>
+    double rotation = 1e-2;
+
+    double scale = 1e-4;
+
+    double weight = 1e-4;
+  } animationTolerance;
+
+  /// <summary>
+  /// Writes animation outputs as normalized integers. Channels whose values,
+  /// restored, are off by more than `animationTolerance`, rotations by their
+  /// angle and morph weights by their difference, are kept as float. Both
+  /// default to 16 bits: with the default tolerances, 8 bits are too few for
+  /// either.
+  /// </summary>
+  struct AnimationQuantization {
+    /// <summary>
+    /// 0(float), 8 or 16. Rotations are signed.
+    /// </summary>
+    std::uint32_t rotationBits = 16;
+
+    /// <summary>
+    /// 0(float), 8 or 16. Morph weights are unsigned.
+    /// </summary>
+    std::uint32_t weightBits = 16;
+  };
+
+  std::optional<AnimationQuantization> animationQuantization;
+
   /// <summary>
   /// Whether to prefer local time spans recorded in FBX file for animation exporting.
   /// </summary>
@@ -79,8 +386,57 @@ struct ConvertOptions {
   struct TextureResolution {
     bool disabled = false;
     std::vector<std::u8string> locations;
+
+    /// <summary>
+    /// The index to look texture files up in. It may be shared by several
+    /// conversions so that each directory is listed only once. If null, each
+    /// conversion uses its own.
+    /// </summary>
+    std::shared_ptr<TextureSearchIndex> index;
   } textureResolution;
 
+  /// <summary>
+  /// Transcodes images to KTX2 with Basis Universal, as per
+  /// KHR_texture_basisu, while the rest of the scene is converted. Only the
+  /// images written with `PathMode::embedded` or `PathMode::copy` are
+  /// transcoded; TGA files are then accepted as well. Normal maps are encoded
+  /// as linear data, other images as sRGB colors.
+  /// </summary>
+  struct TextureTranscoding {
+    enum class Codec {
+      etc1s,
+      uastc,
+    };
+
+    Codec codec = Codec::etc1s;
+
+    /// <summary>
+    /// Generates mip levels down to 1x1.
+    /// </summary>
+    bool mipmaps = false;
+
+    /// <summary>
+    /// Images larger than this, in pixels, are halved until they fit. 0 means
+    /// no limit. The base level is then resampled to the nearest multiples
+    /// of 4, as required by KHR_texture_basisu.
+    /// </summary>
+    std::uint32_t maxSize = 0;
+
+    /// <summary>
+    /// Number of background threads; 0 means the hardware concurrency.
+    /// </summary>
+    std::uint32_t threads = 1;
+
+    /// <summary>
+    /// The transcoded images to reuse. It may be shared by several
+    /// conversions so that each image is transcoded only once. If null, each
+    /// conversion transcodes its own images.
+    /// </summary>
+    std::shared_ptr<TextureCache> cache;
+  };
+
+  std::optional<TextureTranscoding> textureTranscoding;
+
   enum class PathMode {
     /// <summary>
     /// Uses relative paths for files which are in a subdirectory of the exported location, absolute for any directories outside that.
@@ -115,14 +471,95 @@ struct ConvertOptions {
 
   PathMode pathMode = PathMode::prefer_relative;
 
+  // The export options below also tell the FBX SDK what to import: what is
+  // not exported is not read either.
+
   bool export_skin = true;
 
+  /// <summary>
+  /// Keeps at most this many joints per vertex, those of the largest
+  /// weights, which are then renormalized. 0 keeps them all.
+  /// </summary>
+  std::uint32_t maxSkinInfluences = 0;
+
   bool export_blend_shape = true;
 
   bool export_trs_animation = true;
 
   bool export_blend_shape_animation = true;
 
+  /// <summary>
+  /// Materials and textures. Without them, primitives have no material.
+  /// </summary>
+  bool export_material = true;
+
+  /// <summary>
+  /// If not empty, only the subtrees rooted at the nodes of these names, or
+  /// at the nodes having meshes of these names, are converted. Their
+  /// ancestors, and the joints of their skins, are kept without their meshes
+  /// so that the subtrees keep their transforms and skins.
+  /// </summary>
+  std::vector<std::u8string> nodeFilter;
+
+  /// <summary>
+  /// Directory of the conversion cache. A conversion of the same file content
+  /// with the same options is then reproduced from the cache, without
+  /// importing the file: the same buffers are given to `writer`, the same
+  /// images are copied or written and the same glTF JSON is returned. An entry
+  /// is used only if the image files the conversion looked up still have
+  /// their size and modification time; files added to texture search
+  /// locations since are not noticed. Messages are not logged again.
+  /// </summary>
+  std::optional<std::u8string> cacheDir;
+
+  /// <summary>
+  /// Logs, at info level, one `{"stats": ...}` record of the conversion: the
+  /// time of each phase, the cost and vertex counts of each mesh, the cost of
+  /// each animation stack, the buffer bytes by what they hold and the peak
+  /// resident set size of the process.
+  /// </summary>
+  bool stats = false;
+
+  /// <summary>
+  /// If set, the phases of the conversion, the staging of meshes included,
+  /// are written into this file in the Chrome trace event format.
+  /// </summary>
+  std::optional<std::u8string> traceFile;
+
+  /// <summary>
+  /// Called on the converting thread after each node, each node's meshes and
+  /// each animation stack are converted. It's not called when the conversion
+  /// is reproduced from the cache.
+  /// </summary>
+  std::function<void(const ConvertProgress &)> progress;
+
+  /// <summary>
+  /// If set, another thread may raise it to stop the conversion: it's checked
+  /// while importing, between nodes, meshes and animated nodes, then the
+  /// conversion throws `ConvertAborted`. Nothing is written after that point
+  /// but the images written before are kept.
+  /// </summary>
+  const std::atomic<bool> *cancel = nullptr;
+
+  /// <summary>
+  /// If set, checked along with `cancel`: the conversion stops once it
+  /// returns true. It may be called from any thread converting the scene.
+  /// </summary>
+  std::function<bool()> cancelPredicate;
+
+  /// <summary>
+  /// If set, the conversion is aborted, as by `cancel`, once it has run for
+  /// this long.
+  /// </summary>
+  std::optional<std::chrono::duration<double>> timeBudget;
+
+  /// <summary>
+  /// If not 0, the conversion is aborted, as by `cancel`, once the resident
+  /// set size of the process exceeds this many bytes. Conversions running at
+  /// the same time share the process, hence the budget.
+  /// </summary>
+  std::uint64_t memoryBudget = 0;
+
   Logger *logger = nullptr;
 
   bool verbose = false;
@@ -130,4 +567,152 @@ struct ConvertOptions {
 
 Json BEE_API convert(std::u8string_view file_, const ConvertOptions &options_);
 
-} // namespace bee
\ No newline at end of file
+class Converter;
+
+/// <summary>
+/// A long-lived converter which keeps the FBX SDK manager and IO settings alive
+/// across files. Prefer this over `bee::convert()` when converting many files,
+/// the SDK startup is then paid only once.
+/// </summary>
+class BEE_API ConvertSession {
+public:
+  struct BatchItem {
+    std::u8string file;
+
+    ConvertOptions options;
+  };
+
+  struct BatchItemResult {
+    /// <summary>
+    /// The glTF JSON. Empty if the conversion failed, null if it has been
+    /// written through `GLTFWriter::json()`.
+    /// </summary>
+    std::optional<Json> glTFJson;
+
+    /// <summary>
+    /// The error message if the conversion failed.
+    /// </summary>
+    std::optional<std::string> error;
+
+    /// <summary>
+    /// Set if the conversion failed because it has been aborted, see
+    /// `ConvertAborted`.
+    /// </summary>
+    std::optional<ConvertAborted::Reason> aborted;
+
+    /// <summary>
+    /// Wall time spent on this item.
+    /// </summary>
+    std::chrono::duration<double> elapsed{0.0};
+  };
+
+  /// <summary>
+  /// Called once for each item, in order, right after the item is converted.
+  /// </summary>
+  using BatchCallback = std::function<void(
+      std::size_t index_, const BatchItem &item_, BatchItemResult &&result_)>;
+
+  ConvertSession();
+
+  ConvertSession(const ConvertSession &) = delete;
+
+  ConvertSession &operator=(const ConvertSession &) = delete;
+
+  ~ConvertSession();
+
+  Json convert(std::u8string_view file_, const ConvertOptions &options_);
+
+  /// <summary>
+  /// Converts a single item. Errors are captured into the result instead of
+  /// being thrown.
+  /// </summary>
+  BatchItemResult tryConvert(const BatchItem &item_);
+
+  /// <summary>
+  /// Converts the items in sequence. A failure in one item is captured into
+  /// its result and does not stop the remaining items.
+  /// </summary>
+  void convert(std::span<const BatchItem> items_,
+               const BatchCallback &callback_);
+
+private:
+  std::unique_ptr<Converter> _converter;
+};
+
+struct ParallelConvertOptions {
+  /// <summary>
+  /// Number of worker threads. 0 means the hardware concurrency.
+  /// </summary>
+  std::uint32_t jobs = 0;
+
+  /// <summary>
+  /// Upper bound, in bytes, of the summed sizes of the input files which are
+  /// being converted at the same time. 0 means unlimited.
+  /// A file larger than the budget is still converted, but only when nothing
+  /// else is in flight.
+  /// </summary>
+  std::uintmax_t memoryBudget = 0;
+};
+
+/// <summary>
+/// Converts the items using a pool of worker threads. Each worker owns its own
+/// `ConvertSession`, so FBX SDK objects are never shared between threads.
+/// The callback is serialized but is invoked in completion order, not in item
+/// order. Loggers and writers referenced by the items must tolerate being
+/// used from different threads.
+/// </summary>
+void BEE_API convertParallel(std::span<const ConvertSession::BatchItem> items_,
+                             const ConvertSession::BatchCallback &callback_,
+                             const ParallelConvertOptions &parallel_options_);
+
+/// <summary>
+/// A conversion running on a thread of its own, so that the caller, an event
+/// loop for example, is not blocked. Each job owns its own `ConvertSession`,
+/// so many jobs may run in a process; the loggers, writers and progress
+/// callbacks of their options are called on the jobs' threads.
+/// </summary>
+class BEE_API ConvertJob {
+public:
+  using Result = ConvertSession::BatchItemResult;
+
+  /// <summary>
+  /// Called once, on the job's thread, when the conversion ends, whether it
+  /// succeeded or not.
+  /// </summary>
+  using DoneCallback = std::function<void(const Result &result_)>;
+
+  /// <summary>
+  /// Starts converting the item. It stops on the item's own
+  /// `ConvertOptions::cancel` and `ConvertOptions::cancelPredicate` as well as
+  /// on `cancel()`.
+  /// </summary>
+  ConvertJob(ConvertSession::BatchItem item_, DoneCallback done_ = {});
+
+  ConvertJob(const ConvertJob &) = delete;
+
+  ConvertJob &operator=(const ConvertJob &) = delete;
+
+  /// <summary>
+  /// Cancels the conversion if it's still running, and waits for it.
+  /// </summary>
+  ~ConvertJob();
+
+  /// <summary>
+  /// Asks the conversion to stop, which then fails with
+  /// `ConvertAborted::Reason::cancelled` unless it has already ended.
+  /// </summary>
+  void cancel();
+
+  bool done() const;
+
+  /// <summary>
+  /// Waits for the conversion to end.
+  /// </summary>
+  const Result &wait();
+
+private:
+  struct State;
+
+  std::unique_ptr<State> _state;
+};
+} // namespace bee
\ No newline at end of file
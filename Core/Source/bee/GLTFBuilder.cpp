@@ -1,10 +1,40 @@
-
 #include <cassert>
 #include <bee/GLTFBuilder.h>
+#include <cstring>
+#include <stdexcept>
+#include <string>
 
 namespace bee {
+std::vector<std::span<const std::byte>> GLTFBuilder::Buffer::pieces() const {
+  std::vector<std::span<const std::byte>> result;
+  result.reserve(chunks.size());
+  for (const auto &chunk : chunks) {
+    result.emplace_back(chunk.data.get(), chunk.size);
+  }
+  return result;
+}
+
+std::span<const std::byte> GLTFBuilder::Buffer::contiguous() {
+  if (chunks.size() > 1) {
+    BufferChunk merged;
+    merged.data = std::make_unique<std::byte[]>(byteLength);
+    merged.capacity = byteLength;
+    for (const auto &chunk : chunks) {
+      std::memcpy(merged.data.get() + merged.size, chunk.data.get(),
+                  chunk.size);
+      merged.size += chunk.size;
+    }
+    chunks.clear();
+    chunks.push_back(std::move(merged));
+  }
+  if (chunks.empty()) {
+    return {};
+  }
+  return {chunks.front().data.get(), chunks.front().size};
+}
+
 GLTFBuilder::GLTFBuilder() {
-  _bufferKeeps.emplace_back();
+  _buffers.emplace_back();
 }
 
 GLTFBuilder::BuildResult GLTFBuilder::build(BuildOptions options) {
@@ -16,68 +46,188 @@ GLTFBuilder::BuildResult GLTFBuilder::build(BuildOptions options) {
   if (options.generator) {
     _glTFDocument.asset.generator = *options.generator;
   }
+  if (options.naming != ConvertOptions::NamingPolicy::full) {
+    _clearNames(options.naming);
+  }
 
-  const auto nBuffers = static_cast<std::uint32_t>(_bufferKeeps.size());
-  _glTFDocument.buffers.resize(nBuffers);
-  buildResult.buffers.resize(nBuffers);
-  for (std::remove_const_t<decltype(nBuffers)> iBuffer = 0; iBuffer < nBuffers;
-       ++iBuffer) {
-    const auto &bufferKeep = _bufferKeeps[iBuffer];
-    std::uint32_t bufferByteLength = 0;
-    for (const auto &bufferViewKeep : bufferKeep.bufferViews) {
-      bufferByteLength +=
-          static_cast<std::uint32_t>(bufferViewKeep.data.size());
+  // Buffers left empty, the first one if everything went elsewhere for
+  // example, are dropped.
+  const auto nAllBuffers = static_cast<std::uint32_t>(_buffers.size());
+  std::vector<std::uint32_t> keptBuffers;
+  for (std::remove_const_t<decltype(nAllBuffers)> iBuffer = 0;
+       iBuffer < nAllBuffers; ++iBuffer) {
+    if (_buffers[iBuffer].byteLength != 0) {
+      keptBuffers.push_back(iBuffer);
+    }
+  }
+  if (keptBuffers.empty()) {
+    keptBuffers.push_back(0);
+  }
+
+  if (_streamingWriter) {
+    flush();
+    // Streamed buffers are closed under the index they've been opened with.
+    for (const auto iBuffer : keptBuffers) {
+      if (!_streamingOpened[iBuffer]) {
+        _streamingWriter->openBuffer(iBuffer,
+                                     _multipleBuffers || nAllBuffers != 1);
+      }
+      auto uri = _streamingWriter->closeBuffer(iBuffer);
+      if (!uri) {
+        throw std::runtime_error(
+            "The streaming writer did not provide an URI for buffer " +
+            std::to_string(iBuffer));
+      }
+      _buffers[iBuffer].uri = std::move(uri);
     }
+  }
 
-    std::vector<std::byte> bufferStorage(bufferByteLength);
-    std::uint32_t bufferOffset = 0;
-    for (const auto &bufferViewKeep : bufferKeep.bufferViews) {
-      auto &bufferView = _glTFDocument.bufferViews[bufferViewKeep.index];
-      auto bufferViewSize =
-          static_cast<std::uint32_t>(bufferViewKeep.data.size());
-      bufferView.byteOffset = bufferOffset;
-      bufferView.buffer = iBuffer;
-      std::memcpy(bufferStorage.data() + bufferOffset,
-                  bufferViewKeep.data.data(), bufferViewSize);
-      bufferOffset += bufferViewSize;
+  if (keptBuffers.size() != nAllBuffers) {
+    std::vector<std::uint32_t> bufferIndices(nAllBuffers);
+    std::vector<Buffer> buffers;
+    for (const auto iBuffer : keptBuffers) {
+      bufferIndices[iBuffer] = static_cast<std::uint32_t>(buffers.size());
+      buffers.push_back(std::move(_buffers[iBuffer]));
     }
-    buildResult.buffers[iBuffer] = std::move(bufferStorage);
+    for (auto &glTFBufferView : _glTFDocument.bufferViews) {
+      glTFBufferView.buffer =
+          static_cast<std::int32_t>(bufferIndices[glTFBufferView.buffer]);
+    }
+    _buffers = std::move(buffers);
+  }
 
+  const auto nBuffers = static_cast<std::uint32_t>(_buffers.size());
+  _glTFDocument.buffers.resize(nBuffers);
+  for (std::remove_const_t<decltype(nBuffers)> iBuffer = 0; iBuffer < nBuffers;
+       ++iBuffer) {
     fx::gltf::Buffer glTFBuffer;
-    glTFBuffer.byteLength = bufferByteLength;
+    glTFBuffer.byteLength =
+        static_cast<std::uint32_t>(_buffers[iBuffer].byteLength);
+    if (options.naming == ConvertOptions::NamingPolicy::full) {
+      glTFBuffer.name = _buffers[iBuffer].name;
+    }
     _glTFDocument.buffers[iBuffer] = glTFBuffer;
   }
+  buildResult.buffers = std::move(_buffers);
+  _buffers.clear();
 
   return buildResult;
 }
 
+void GLTFBuilder::_clearNames(ConvertOptions::NamingPolicy naming_) {
+  const auto clear = [](auto &objects_) {
+    for (auto &object : objects_) {
+      object.name.clear();
+    }
+  };
+  clear(_glTFDocument.accessors);
+  clear(_glTFDocument.bufferViews);
+  clear(_glTFDocument.materials);
+  clear(_glTFDocument.textures);
+  clear(_glTFDocument.images);
+  clear(_glTFDocument.samplers);
+  clear(_glTFDocument.skins);
+  clear(_glTFDocument.animations);
+  clear(_glTFDocument.scenes);
+  clear(_glTFDocument.cameras);
+  if (naming_ == ConvertOptions::NamingPolicy::none) {
+    clear(_glTFDocument.nodes);
+    clear(_glTFDocument.meshes);
+  }
+}
+
+void GLTFBuilder::setStreamingWriter(GLTFWriter *writer_) {
+  _streamingWriter = writer_;
+  _streamingOpened.assign(_buffers.size(), false);
+}
+
+void GLTFBuilder::flush() {
+  if (!_streamingWriter) {
+    return;
+  }
+  const auto nBuffers = static_cast<std::uint32_t>(_buffers.size());
+  for (std::remove_const_t<decltype(nBuffers)> iBuffer = 0; iBuffer < nBuffers;
+       ++iBuffer) {
+    auto &buffer = _buffers[iBuffer];
+    for (const auto &chunk : buffer.chunks) {
+      if (chunk.size == 0) {
+        continue;
+      }
+      if (!_streamingOpened[iBuffer]) {
+        _streamingWriter->openBuffer(iBuffer,
+                                     _multipleBuffers || nBuffers != 1);
+        _streamingOpened[iBuffer] = true;
+      }
+      _streamingWriter->appendBuffer(iBuffer, chunk.data.get(), chunk.size);
+    }
+    if (buffer.chunks.empty()) {
+      continue;
+    }
+    // Reuse the last chunk unless it's an oversized one.
+    auto lastChunk = std::move(buffer.chunks.back());
+    buffer.chunks.clear();
+    if (lastChunk.capacity == _defaultChunkCapacity) {
+      std::memset(lastChunk.data.get(), 0, lastChunk.size);
+      lastChunk.size = 0;
+      buffer.chunks.push_back(std::move(lastChunk));
+    }
+  }
+}
+
+GLTFBuilder::XXIndex GLTFBuilder::createBuffer(std::string_view name_) {
+  const auto index = static_cast<XXIndex>(_buffers.size());
+  _buffers.emplace_back().name = name_;
+  if (_streamingWriter) {
+    _streamingOpened.push_back(false);
+  }
+  return index;
+}
+
 const GLTFBuilder::BufferViewInfo GLTFBuilder::createBufferView(
     std::uint32_t byte_length_, std::uint32_t align_, XXIndex buffer_) {
-  assert(buffer_ < _bufferKeeps.size());
-  auto &bufferKeep = _bufferKeeps[buffer_];
+  assert(buffer_ < _buffers.size());
+  auto &buffer = _buffers[buffer_];
+
+  const std::size_t align = std::max(align_, 1u);
+  const auto padding = (align - buffer.byteLength % align) % align;
+  const auto required = padding + byte_length_;
+  if (buffer.chunks.empty() ||
+      buffer.chunks.back().capacity - buffer.chunks.back().size < required) {
+    BufferChunk chunk;
+    chunk.capacity = std::max(_defaultChunkCapacity, required);
+    chunk.data = std::make_unique<std::byte[]>(chunk.capacity);
+    buffer.chunks.push_back(std::move(chunk));
+  }
+  auto &chunk = buffer.chunks.back();
+  const auto pData = chunk.data.get() + chunk.size + padding;
+  const auto byteOffset = buffer.byteLength + padding;
+  chunk.size += required;
+  buffer.byteLength += required;
+
   auto index = static_cast<std::uint32_t>(_glTFDocument.bufferViews.size());
   fx::gltf::BufferView bufferView;
+  bufferView.buffer = buffer_;
+  bufferView.byteOffset = static_cast<std::uint32_t>(byteOffset);
   bufferView.byteLength = byte_length_;
   _glTFDocument.bufferViews.push_back(std::move(bufferView));
-  std::vector<std::byte> data(byte_length_);
-  auto pData = data.data();
-  BufferViewKeep bufferViewKeep;
-  bufferViewKeep.index = index;
-  bufferViewKeep.align = align_;
-  bufferViewKeep.data = std::move(data);
-  bufferKeep.bufferViews.push_back(std::move(bufferViewKeep));
+
   BufferViewInfo bufferViewInfo;
   bufferViewInfo.data = pData;
   bufferViewInfo.index = index;
   return bufferViewInfo;
 }
 
-void GLTFBuilder::useExtension(std::string_view extension_name_) {
-  std::string extName{extension_name_};
-  if (_glTFDocument.extensionsUsed.cend() ==
-      std::find(_glTFDocument.extensionsUsed.cbegin(),
-                _glTFDocument.extensionsUsed.cend(), extName)) {
-    _glTFDocument.extensionsUsed.push_back(std::move(extName));
+void GLTFBuilder::useExtension(std::string_view extension_name_,
+                               bool required_) {
+  const auto addOnce = [extension_name_](std::vector<std::string> &list_) {
+    if (list_.cend() ==
+        std::find(list_.cbegin(), list_.cend(), extension_name_)) {
+      list_.emplace_back(extension_name_);
+    }
+  };
+  addOnce(_glTFDocument.extensionsUsed);
+  if (required_) {
+    addOnce(_glTFDocument.extensionsRequired);
   }
 }
 } // namespace bee
\ No newline at end of file
@@ -1,10 +1,13 @@
 
 #pragma once
 
+#include <bee/Converter.h>
 #include <bee/GLTFUtilities.h>
 #include <cstddef>
+#include <algorithm>
 #include <fx/gltf.h>
 #include <list>
+#include <memory>
 #include <optional>
 #include <span>
 #include <string>
@@ -36,18 +39,99 @@ public:
   struct BuildOptions {
     std::optional<std::string> copyright;
     std::optional<std::string> generator;
+    /// <summary>
+    /// Names not kept by the policy are cleared.
+    /// </summary>
+    ConvertOptions::NamingPolicy naming = ConvertOptions::NamingPolicy::full;
+  };
+
+  /// <summary>
+  /// A piece of a buffer. Chunks never move once allocated, so the pointers
+  /// handed out by `createBufferView()` stay valid.
+  /// </summary>
+  struct BufferChunk {
+    std::unique_ptr<std::byte[]> data;
+    std::size_t size = 0;
+    std::size_t capacity = 0;
+  };
+
+  /// <summary>
+  /// A buffer stored as consecutive chunks.
+  /// The buffer content is the concatenation of the chunks' used bytes.
+  /// </summary>
+  struct Buffer {
+    std::vector<BufferChunk> chunks;
+
+    std::size_t byteLength = 0;
+
+    std::string name;
+
+    /// <summary>
+    /// Set if the buffer has been streamed out, `chunks` is then empty.
+    /// </summary>
+    std::optional<std::u8string> uri;
+
+    /// <summary>
+    /// Set if the buffer is the fallback buffer of EXT_meshopt_compression.
+    /// It has no content and is never written.
+    /// </summary>
+    bool fallback = false;
+
+    std::vector<std::span<const std::byte>> pieces() const;
+
+    /// <summary>
+    /// Returns the content as one contiguous block. No copy is made if the
+    /// buffer has only one chunk.
+    /// </summary>
+    std::span<const std::byte> contiguous();
   };
 
   struct BuildResult {
-    std::vector<std::vector<std::byte>> buffers;
+    std::vector<Buffer> buffers;
   };
 
   fx::gltf::Document &document() {
     return _glTFDocument;
   }
 
+  /// <summary>
+  /// Moves the buffers out of the builder, the builder shall not be used to
+  /// create buffer views afterwards. Empty buffers are dropped, unless all
+  /// are, since glTF buffers can't be empty; the remaining ones are
+  /// renumbered.
+  /// </summary>
   BuildResult build(BuildOptions options = {});
 
+  /// <summary>
+  /// Streams the buffers through `writer_`. See `flush()`.
+  /// </summary>
+  void setStreamingWriter(GLTFWriter *writer_);
+
+  /// <summary>
+  /// Hands everything written into the buffers so far to the streaming writer
+  /// and releases the memory; does nothing if there is no streaming writer.
+  /// Pointers returned by `createBufferView()` are invalidated.
+  /// </summary>
+  void flush();
+
+  /// <summary>
+  /// Appends a buffer; the builder starts with one, buffer 0.
+  /// </summary>
+  XXIndex createBuffer(std::string_view name_);
+
+  /// <summary>
+  /// Has the streaming writer open buffers as one of many, the `multi_` of
+  /// `GLTFWriter::openBuffer()`, even while there's only one: buffers created
+  /// later would otherwise be named unlike the first one.
+  /// </summary>
+  void expectMultipleBuffers() {
+    _multipleBuffers = true;
+  }
+
+  /// <summary>
+  /// Allocates a zero-initialized buffer view in place. Its offset is fixed at
+  /// this point and is a multiple of `align_`(0 is taken as 1).
+  /// </summary>
   const BufferViewInfo createBufferView(std::uint32_t byte_length_,
                                         std::uint32_t align_,
                                         XXIndex buffer_);
@@ -68,7 +152,8 @@ public:
     auto [bufferViewData, bufferViewIndex] =
         createBufferView(countBytes(ComponentType_) * nComponents *
                              static_cast<std::uint32_t>(values_.size()),
-                         align_, buffer_index_);
+                         std::max(align_, countBytes(ComponentType_)),
+                         buffer_index_);
     for (decltype(values_.size()) i = 0; i < values_.size(); ++i) {
       Spreader_::spread(values_[i],
                         reinterpret_cast<TargetTy *>(bufferViewData) +
@@ -104,7 +189,11 @@ public:
     return glTFAccessorIndex;
   }
 
-  void useExtension(std::string_view extension_name_);
+  /// <summary>
+  /// Adds the extension into `extensionsUsed` and, if `required_`, into
+  /// `extensionsRequired`.
+  /// </summary>
+  void useExtension(std::string_view extension_name_, bool required_ = false);
 
   template <typename T> struct GLTFDocumentMemberPtrValueType {};
   template <typename T>
@@ -131,18 +220,21 @@ public:
   }
 
 private:
-  struct BufferViewKeep {
-    std::size_t index;
-    std::size_t align;
-    std::vector<std::byte> data;
-  };
+  /// <summary>
+  /// Clears the names `naming_` doesn't keep.
+  /// </summary>
+  void _clearNames(ConvertOptions::NamingPolicy naming_);
 
-  struct BufferKeep {
-    std::list<BufferViewKeep> bufferViews;
-  };
+  /// <summary>
+  /// Capacity of a new chunk unless a single buffer view requires more.
+  /// </summary>
+  static constexpr std::size_t _defaultChunkCapacity = 4 * 1024 * 1024;
 
   fx::gltf::Document _glTFDocument;
-  std::vector<BufferKeep> _bufferKeeps;
+  std::vector<Buffer> _buffers;
+  bool _multipleBuffers = false;
+  GLTFWriter *_streamingWriter = nullptr;
+  std::vector<bool> _streamingOpened;
   std::list<ImageData> _images;
 };
 } // namespace bee
\ No newline at end of file
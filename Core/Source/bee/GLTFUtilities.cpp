@@ -0,0 +1,179 @@
+#include <array>
+#include <bee/GLTFUtilities.h>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bee {
+namespace {
+using GLBHeader = std::array<std::uint32_t, 3>;
+
+using GLBChunkHeader = std::array<std::uint32_t, 2>;
+
+template <typename T> std::span<const std::byte> asBytes(const T &value_) {
+  return {reinterpret_cast<const std::byte *>(&value_), sizeof(value_)};
+}
+
+/// <summary>
+/// Writes JSON values as `Json::dump()` would if they were nested.
+/// </summary>
+class NestedJsonWriter {
+public:
+  NestedJsonWriter(std::ostream &stream_, int indent_)
+      : _stream(stream_), _indent(indent_) {
+  }
+
+  bool pretty() const {
+    return _indent >= 0;
+  }
+
+  void newLine(int level_) {
+    if (pretty()) {
+      _stream << '\n' << std::string(level_ * _indent, ' ');
+    }
+  }
+
+  void write(std::string_view text_) {
+    _stream << text_;
+  }
+
+  void write(const Json &value_, int level_) {
+    const auto text = value_.dump(_indent);
+    if (!pretty()) {
+      _stream << text;
+      return;
+    }
+    // Strings are escaped, so line breaks are all between values.
+    std::size_t begin = 0;
+    for (auto end = text.find('\n'); end != std::string::npos;
+         begin = end + 1, end = text.find('\n', begin)) {
+      _stream.write(text.data() + begin, end - begin);
+      newLine(level_);
+    }
+    _stream.write(text.data() + begin, text.size() - begin);
+  }
+
+private:
+  std::ostream &_stream;
+  int _indent;
+};
+} // namespace
+
+void writeGLB(std::string_view json_,
+              std::span<const std::span<const std::byte>> bin_pieces_,
+              std::size_t bin_size_,
+              GLTFWriter &writer_) {
+  constexpr std::array<std::byte, 3> jsonPadding{
+      std::byte{' '}, std::byte{' '}, std::byte{' '}};
+  constexpr std::array<std::byte, 3> binPadding{};
+
+  const auto jsonChunkLength = alignGLBChunkSize(json_.size());
+  const auto binChunkLength = alignGLBChunkSize(bin_size_);
+
+  std::size_t totalLength =
+      sizeof(GLBHeader) + sizeof(GLBChunkHeader) + jsonChunkLength;
+  if (bin_size_ != 0) {
+    totalLength += sizeof(GLBChunkHeader) + binChunkLength;
+  }
+  if (totalLength > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::runtime_error("The glTF is too large to be stored as GLB.");
+  }
+
+  const GLBHeader header{fx::gltf::detail::GLBHeaderMagic, 2,
+                         static_cast<std::uint32_t>(totalLength)};
+  const GLBChunkHeader jsonChunkHeader{
+      static_cast<std::uint32_t>(jsonChunkLength),
+      fx::gltf::detail::GLBChunkJSON};
+  const GLBChunkHeader binChunkHeader{
+      static_cast<std::uint32_t>(binChunkLength),
+      fx::gltf::detail::GLBChunkBIN};
+
+  std::vector<std::span<const std::byte>> pieces;
+  pieces.push_back(asBytes(header));
+  pieces.push_back(asBytes(jsonChunkHeader));
+  pieces.push_back(std::as_bytes(std::span{json_}));
+  pieces.push_back(std::span{jsonPadding}.first(jsonChunkLength - json_.size()));
+  if (bin_size_ != 0) {
+    pieces.push_back(asBytes(binChunkHeader));
+    pieces.insert(pieces.end(), bin_pieces_.begin(), bin_pieces_.end());
+    pieces.push_back(std::span{binPadding}.first(binChunkLength - bin_size_));
+  }
+
+  writer_.glb(pieces);
+}
+
+void writeGLTFJson(std::ostream &stream_,
+                   const fx::gltf::Document &glTF_document_,
+                   int indent_) {
+  NestedJsonWriter writer{stream_, indent_};
+
+  // Fields are written in key order, as they're in a `Json` object.
+  std::map<std::string, std::function<void()>> fields;
+  const auto addArray = [&](const char *key_, const auto &elements_) {
+    if (elements_.empty()) {
+      return;
+    }
+    fields[key_] = [&writer, &elements = elements_]() {
+      writer.write("[");
+      for (std::size_t iElement = 0; iElement < elements.size(); ++iElement) {
+        if (iElement != 0) {
+          writer.write(",");
+        }
+        writer.newLine(2);
+        writer.write(Json(elements[iElement]), 2);
+      }
+      writer.newLine(1);
+      writer.write("]");
+    };
+  };
+  const auto addValue = [&](const std::string &key_, const Json &value_) {
+    fields[key_] = [&writer, &value_]() { writer.write(value_, 1); };
+  };
+
+  addArray("accessors", glTF_document_.accessors);
+  addArray("animations", glTF_document_.animations);
+  const Json asset = glTF_document_.asset;
+  addValue("asset", asset);
+  addArray("buffers", glTF_document_.buffers);
+  addArray("bufferViews", glTF_document_.bufferViews);
+  addArray("cameras", glTF_document_.cameras);
+  addArray("images", glTF_document_.images);
+  addArray("materials", glTF_document_.materials);
+  addArray("meshes", glTF_document_.meshes);
+  addArray("nodes", glTF_document_.nodes);
+  addArray("samplers", glTF_document_.samplers);
+  const Json scene = glTF_document_.scene;
+  if (glTF_document_.scene != -1) {
+    addValue("scene", scene);
+  }
+  addArray("scenes", glTF_document_.scenes);
+  addArray("skins", glTF_document_.skins);
+  addArray("textures", glTF_document_.textures);
+  addArray("extensionsUsed", glTF_document_.extensionsUsed);
+  addArray("extensionsRequired", glTF_document_.extensionsRequired);
+  const auto &extensionsAndExtras = glTF_document_.extensionsAndExtras;
+  for (auto rField = extensionsAndExtras.begin();
+       rField != extensionsAndExtras.end(); ++rField) {
+    addValue(rField.key(), rField.value());
+  }
+
+  writer.write("{");
+  bool first = true;
+  for (const auto &[key, writeField] : fields) {
+    if (!first) {
+      writer.write(",");
+    }
+    first = false;
+    writer.newLine(1);
+    writer.write(Json(key).dump());
+    writer.write(writer.pretty() ? ": " : ":");
+    writeField();
+  }
+  if (!fields.empty()) {
+    writer.newLine(0);
+  }
+  writer.write("}");
+}
+} // namespace bee
\ No newline at end of file
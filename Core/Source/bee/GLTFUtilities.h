@@ -1,8 +1,13 @@
 
 #pragma once
 
+#include <bee/Converter.h>
+#include <cstddef>
 #include <cstdint>
 #include <fx/gltf.h>
+#include <ostream>
+#include <span>
+#include <string_view>
 
 namespace bee {
 inline constexpr std::uint32_t countComponents(fx::gltf::Accessor::Type type_) {
@@ -69,8 +74,48 @@ struct GetGLTFComponentTypeStorage<
     fx::gltf::Accessor::ComponentType::UnsignedShort> {
   using type = std::uint16_t;
 };
+template <>
+struct GetGLTFComponentTypeStorage<fx::gltf::Accessor::ComponentType::Short> {
+  using type = std::int16_t;
+};
+template <>
+struct GetGLTFComponentTypeStorage<
+    fx::gltf::Accessor::ComponentType::UnsignedByte> {
+  using type = std::uint8_t;
+};
+template <>
+struct GetGLTFComponentTypeStorage<fx::gltf::Accessor::ComponentType::Byte> {
+  using type = std::int8_t;
+};
 
 template <fx::gltf::Accessor::ComponentType Component_>
 using GLTFComponentTypeStorage =
     typename GetGLTFComponentTypeStorage<Component_>::type;
+
+/// <summary>
+/// GLB chunks are 4-byte aligned.
+/// </summary>
+inline constexpr std::size_t alignGLBChunkSize(std::size_t size_) {
+  return (size_ + 3) & ~static_cast<std::size_t>(3);
+}
+
+/// <summary>
+/// Writes a binary glTF container made of the JSON chunk and, if not empty,
+/// the BIN chunk whose content is the concatenation of `bin_pieces_`.
+/// Nothing is copied, the pieces are handed to `writer_` as is.
+/// </summary>
+void writeGLB(std::string_view json_,
+              std::span<const std::span<const std::byte>> bin_pieces_,
+              std::size_t bin_size_,
+              GLTFWriter &writer_);
+
+/// <summary>
+/// Writes the glTF JSON of `glTF_document_` into `stream_`, the same as
+/// `fx::gltf::to_json()` then `Json::dump(indent_)` would, but one top-level
+/// element at a time instead of building the whole tree and text first. A
+/// negative `indent_` writes the compact form.
+/// </summary>
+void writeGLTFJson(std::ostream &stream_,
+                   const fx::gltf::Document &glTF_document_,
+                   int indent_);
 } // namespace bee
\ No newline at end of file
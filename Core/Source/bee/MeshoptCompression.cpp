@@ -0,0 +1,335 @@
+#include <bee/GLTFUtilities.h>
+#include <bee/MeshoptCompression.h>
+#include <bee/Parallel.h>
+#include <algorithm>
+#include <cstring>
+#include <meshoptimizer.h>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace bee {
+namespace {
+enum class MeshoptMode {
+  attributes,
+  triangles,
+  indices,
+};
+
+struct MeshoptBufferViewJob {
+  MeshoptMode mode = MeshoptMode::attributes;
+  std::uint32_t byteStride = 0;
+  bool excluded = false;
+  bool conflicted = false;
+  std::vector<std::byte> encoded;
+};
+
+// The extension requires these bitstream versions. They are global to
+// meshoptimizer, and conversions may run alongside each other.
+void setBitstreamVersions() {
+  static std::once_flag once;
+  std::call_once(once, [] {
+    meshopt_encodeVertexVersion(0);
+    meshopt_encodeIndexVersion(1);
+  });
+}
+
+bool isExcluded(std::string_view name_,
+                const ConvertOptions::MeshoptCompression &options_) {
+  return std::any_of(
+      options_.excluded.begin(), options_.excluded.end(),
+      [name_](const std::string &excluded_) {
+        if (name_ == excluded_) {
+          return true;
+        }
+        // `TEXCOORD` excludes `TEXCOORD_0`, `TEXCOORD_1`...
+        return name_.size() > excluded_.size() &&
+               name_.substr(0, excluded_.size()) == excluded_ &&
+               name_[excluded_.size()] == '_';
+      });
+}
+
+std::size_t alignTo4(std::size_t offset_) {
+  return (offset_ + 3) / 4 * 4;
+}
+
+std::vector<std::byte> encode(const MeshoptBufferViewJob &job_,
+                              const std::byte *data_,
+                              std::uint32_t byte_length_) {
+  const auto count = byte_length_ / job_.byteStride;
+  std::vector<std::byte> encoded;
+  if (job_.mode == MeshoptMode::attributes) {
+    encoded.resize(meshopt_encodeVertexBufferBound(count, job_.byteStride));
+    encoded.resize(meshopt_encodeVertexBuffer(
+        reinterpret_cast<unsigned char *>(encoded.data()), encoded.size(),
+        data_, count, job_.byteStride));
+    return encoded;
+  }
+
+  std::vector<unsigned int> indices(count);
+  if (job_.byteStride == 2) {
+    for (std::uint32_t iIndex = 0; iIndex < count; ++iIndex) {
+      std::uint16_t index = 0;
+      std::memcpy(&index, data_ + 2 * iIndex, 2);
+      indices[iIndex] = index;
+    }
+  } else {
+    std::memcpy(indices.data(), data_, byte_length_);
+  }
+  const auto nVertices =
+      indices.empty() ? 0
+                      : *std::max_element(indices.begin(), indices.end()) + 1;
+  if (job_.mode == MeshoptMode::triangles) {
+    encoded.resize(meshopt_encodeIndexBufferBound(count, nVertices));
+    encoded.resize(meshopt_encodeIndexBuffer(
+        reinterpret_cast<unsigned char *>(encoded.data()), encoded.size(),
+        indices.data(), count));
+  } else {
+    encoded.resize(meshopt_encodeIndexSequenceBound(count, nVertices));
+    encoded.resize(meshopt_encodeIndexSequence(
+        reinterpret_cast<unsigned char *>(encoded.data()), encoded.size(),
+        indices.data(), count));
+  }
+  return encoded;
+}
+
+const char *getModeName(MeshoptMode mode_) {
+  switch (mode_) {
+  case MeshoptMode::triangles:
+    return "TRIANGLES";
+  case MeshoptMode::indices:
+    return "INDICES";
+  default:
+    return "ATTRIBUTES";
+  }
+}
+} // namespace
+
+void compressBufferViews(
+    GLTFBuilder &glTF_builder_,
+    GLTFBuilder::BuildResult &build_result_,
+    const ConvertOptions::MeshoptCompression &options_,
+    std::uint32_t thread_count_) {
+  auto &glTF_document_ = glTF_builder_.document();
+  auto &glTFBufferViews = glTF_document_.bufferViews;
+  const auto &glTFAccessors = glTF_document_.accessors;
+  std::vector<std::optional<MeshoptBufferViewJob>> jobs(glTFBufferViews.size());
+
+  const auto addAccessor = [&](std::int32_t accessor_index_, MeshoptMode mode_,
+                               std::string_view name_) {
+    if (accessor_index_ < 0) {
+      return;
+    }
+    const auto &glTFAccessor = glTFAccessors[accessor_index_];
+    if (glTFAccessor.bufferView < 0) {
+      return;
+    }
+    const auto &glTFBufferView = glTFBufferViews[glTFAccessor.bufferView];
+    const auto elementSize =
+        countBytes(glTFAccessor.type, glTFAccessor.componentType);
+    const auto byteStride = mode_ == MeshoptMode::attributes &&
+                                    glTFBufferView.byteStride != 0
+                                ? glTFBufferView.byteStride
+                                : elementSize;
+
+    auto &job = jobs[glTFAccessor.bufferView];
+    if (!job) {
+      job.emplace();
+      job->mode = mode_;
+      job->byteStride = byteStride;
+    } else if (job->mode != mode_ || job->byteStride != byteStride) {
+      job->conflicted = true;
+    }
+    if (isExcluded(name_, options_)) {
+      job->excluded = true;
+    }
+  };
+
+  for (const auto &glTFMesh : glTF_document_.meshes) {
+    for (const auto &glTFPrimitive : glTFMesh.primitives) {
+      for (const auto &[name, accessorIndex] : glTFPrimitive.attributes) {
+        addAccessor(static_cast<std::int32_t>(accessorIndex),
+                    MeshoptMode::attributes, name);
+      }
+      for (const auto &target : glTFPrimitive.targets) {
+        for (const auto &[name, accessorIndex] : target) {
+          addAccessor(static_cast<std::int32_t>(accessorIndex),
+                      MeshoptMode::attributes, name);
+        }
+      }
+      addAccessor(glTFPrimitive.indices,
+                  glTFPrimitive.mode == fx::gltf::Primitive::Mode::Triangles
+                      ? MeshoptMode::triangles
+                      : MeshoptMode::indices,
+                  "INDICES");
+    }
+  }
+  for (const auto &glTFAnimation : glTF_document_.animations) {
+    for (const auto &glTFSampler : glTFAnimation.samplers) {
+      addAccessor(glTFSampler.input, MeshoptMode::attributes, "ANIMATION");
+      addAccessor(glTFSampler.output, MeshoptMode::attributes, "ANIMATION");
+    }
+  }
+
+  std::vector<std::span<const std::byte>> bufferDatas;
+  for (auto &buffer : build_result_.buffers) {
+    // Streamed out buffers can't be rewritten.
+    bufferDatas.push_back(buffer.uri ? std::span<const std::byte>{}
+                                     : buffer.contiguous());
+  }
+
+  std::vector<std::size_t> encodedBufferViews;
+  for (std::size_t iBufferView = 0; iBufferView < jobs.size(); ++iBufferView) {
+    auto &job = jobs[iBufferView];
+    if (!job || job->excluded || job->conflicted) {
+      job.reset();
+      continue;
+    }
+    const auto &glTFBufferView = glTFBufferViews[iBufferView];
+    const auto supported =
+        job->mode == MeshoptMode::attributes
+            ? job->byteStride % 4 == 0 && job->byteStride <= 256
+            : job->byteStride == 2 || job->byteStride == 4;
+    if (!supported || glTFBufferView.byteLength == 0 ||
+        glTFBufferView.byteLength % job->byteStride != 0 ||
+        (job->mode == MeshoptMode::triangles &&
+         glTFBufferView.byteLength / job->byteStride % 3 != 0) ||
+        bufferDatas[glTFBufferView.buffer].empty()) {
+      job.reset();
+      continue;
+    }
+    encodedBufferViews.push_back(iBufferView);
+  }
+  if (encodedBufferViews.empty()) {
+    return;
+  }
+
+  setBitstreamVersions();
+
+  parallelFor(encodedBufferViews.size(), thread_count_,
+              [&](std::size_t iJob_) {
+                const auto iBufferView = encodedBufferViews[iJob_];
+                auto &job = *jobs[iBufferView];
+                const auto &glTFBufferView = glTFBufferViews[iBufferView];
+                job.encoded =
+                    encode(job,
+                           bufferDatas[glTFBufferView.buffer].data() +
+                               glTFBufferView.byteOffset,
+                           glTFBufferView.byteLength);
+                if (job.encoded.empty() ||
+                    job.encoded.size() >= glTFBufferView.byteLength) {
+                  job.encoded.clear();
+                }
+              });
+  if (std::none_of(encodedBufferViews.begin(), encodedBufferViews.end(),
+                   [&jobs](std::size_t iBufferView_) {
+                     return !jobs[iBufferView_]->encoded.empty();
+                   })) {
+    return;
+  }
+
+  // New contents: uncompressed buffer views first, then encoded data.
+  const auto nBuffers = build_result_.buffers.size();
+  const auto fallbackBufferIndex = static_cast<std::int32_t>(nBuffers);
+  std::vector<std::size_t> bufferSizes(nBuffers, 0);
+  std::vector<std::size_t> newOffsets(glTFBufferViews.size(), 0);
+  std::vector<std::size_t> encodedOffsets(glTFBufferViews.size(), 0);
+  const auto isEncoded = [&](std::size_t iBufferView_) {
+    return jobs[iBufferView_] && !jobs[iBufferView_]->encoded.empty();
+  };
+  for (std::size_t iBufferView = 0; iBufferView < glTFBufferViews.size();
+       ++iBufferView) {
+    const auto &glTFBufferView = glTFBufferViews[iBufferView];
+    if (isEncoded(iBufferView) || bufferDatas[glTFBufferView.buffer].empty()) {
+      continue;
+    }
+    auto &size = bufferSizes[glTFBufferView.buffer];
+    size = alignTo4(size);
+    newOffsets[iBufferView] = size;
+    size += glTFBufferView.byteLength;
+  }
+  for (std::size_t iBufferView = 0; iBufferView < glTFBufferViews.size();
+       ++iBufferView) {
+    if (!isEncoded(iBufferView)) {
+      continue;
+    }
+    auto &size = bufferSizes[glTFBufferViews[iBufferView].buffer];
+    size = alignTo4(size);
+    encodedOffsets[iBufferView] = size;
+    size += jobs[iBufferView]->encoded.size();
+  }
+
+  std::vector<GLTFBuilder::Buffer> newBuffers(nBuffers);
+  for (std::size_t iBuffer = 0; iBuffer < nBuffers; ++iBuffer) {
+    if (bufferDatas[iBuffer].empty()) {
+      continue;
+    }
+    GLTFBuilder::BufferChunk chunk;
+    chunk.data = std::make_unique<std::byte[]>(bufferSizes[iBuffer]);
+    chunk.size = bufferSizes[iBuffer];
+    chunk.capacity = bufferSizes[iBuffer];
+    newBuffers[iBuffer].chunks.push_back(std::move(chunk));
+    newBuffers[iBuffer].byteLength = bufferSizes[iBuffer];
+  }
+
+  std::size_t fallbackSize = 0;
+  for (std::size_t iBufferView = 0; iBufferView < glTFBufferViews.size();
+       ++iBufferView) {
+    auto &glTFBufferView = glTFBufferViews[iBufferView];
+    const auto iBuffer = glTFBufferView.buffer;
+    if (bufferDatas[iBuffer].empty()) {
+      continue;
+    }
+    const auto newData = newBuffers[iBuffer].chunks.front().data.get();
+    if (!isEncoded(iBufferView)) {
+      std::memcpy(newData + newOffsets[iBufferView],
+                  bufferDatas[iBuffer].data() + glTFBufferView.byteOffset,
+                  glTFBufferView.byteLength);
+      glTFBufferView.byteOffset =
+          static_cast<std::uint32_t>(newOffsets[iBufferView]);
+      continue;
+    }
+
+    const auto &job = *jobs[iBufferView];
+    std::memcpy(newData + encodedOffsets[iBufferView], job.encoded.data(),
+                job.encoded.size());
+    auto &extension =
+        glTFBufferView.extensionsAndExtras["extensions"]
+                                          ["EXT_meshopt_compression"];
+    extension["buffer"] = iBuffer;
+    extension["byteOffset"] = encodedOffsets[iBufferView];
+    extension["byteLength"] = job.encoded.size();
+    extension["byteStride"] = job.byteStride;
+    extension["count"] = glTFBufferView.byteLength / job.byteStride;
+    extension["mode"] = getModeName(job.mode);
+
+    fallbackSize = alignTo4(fallbackSize);
+    glTFBufferView.buffer = fallbackBufferIndex;
+    glTFBufferView.byteOffset = static_cast<std::uint32_t>(fallbackSize);
+    fallbackSize += glTFBufferView.byteLength;
+  }
+
+  for (std::size_t iBuffer = 0; iBuffer < nBuffers; ++iBuffer) {
+    if (bufferDatas[iBuffer].empty()) {
+      continue;
+    }
+    build_result_.buffers[iBuffer] = std::move(newBuffers[iBuffer]);
+    glTF_document_.buffers[iBuffer].byteLength =
+        static_cast<std::uint32_t>(bufferSizes[iBuffer]);
+  }
+
+  auto &fallbackBuffer = build_result_.buffers.emplace_back();
+  fallbackBuffer.byteLength = fallbackSize;
+  fallbackBuffer.fallback = true;
+  fx::gltf::Buffer glTFFallbackBuffer;
+  glTFFallbackBuffer.byteLength = static_cast<std::uint32_t>(fallbackSize);
+  glTFFallbackBuffer
+      .extensionsAndExtras["extensions"]["EXT_meshopt_compression"]
+                          ["fallback"] = true;
+  glTF_document_.buffers.push_back(std::move(glTFFallbackBuffer));
+
+  // The fallback buffer has no content.
+  glTF_builder_.useExtension("EXT_meshopt_compression", true);
+}
+} // namespace bee
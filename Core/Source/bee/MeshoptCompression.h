@@ -0,0 +1,21 @@
+#pragma once
+
+#include <bee/Converter.h>
+#include <bee/GLTFBuilder.h>
+#include <fx/gltf.h>
+
+namespace bee {
+/// <summary>
+/// Encodes the built buffer views of vertex attributes, indices and animation
+/// samplers with meshoptimizer's codecs, as per EXT_meshopt_compression.
+/// The encoded data replaces the original data in its buffer; the original
+/// buffer views are moved into an appended fallback buffer, which has no
+/// content. Buffer views are encoded in parallel with `thread_count_` threads.
+/// Buffer views that do not get smaller are kept as is.
+/// </summary>
+void compressBufferViews(
+    GLTFBuilder &glTF_builder_,
+    GLTFBuilder::BuildResult &build_result_,
+    const ConvertOptions::MeshoptCompression &options_,
+    std::uint32_t thread_count_);
+} // namespace bee
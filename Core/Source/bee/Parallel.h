@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// Resolves a thread count option: 0 means the hardware concurrency.
+/// </summary>
+inline std::uint32_t resolveThreadCount(std::uint32_t threads_) {
+  if (threads_ != 0) {
+    return threads_;
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/// <summary>
+/// Calls `fn_(i, worker)` for each `i` in `[0, count_)` using up to `threads_`
+/// threads, the calling thread included. `worker` identifies the calling
+/// thread within `[0, resolveThreadCount(threads_))`, the calling thread being
+/// 0, so that per-thread state can be kept. Returns when all calls finished;
+/// the first exception thrown by `fn_`, if any, is then rethrown.
+/// </summary>
+template <typename Fn_>
+void parallelForWorkers(std::size_t count_, std::uint32_t threads_, Fn_ &&fn_) {
+  const auto nThreads =
+      std::min(static_cast<std::size_t>(resolveThreadCount(threads_)), count_);
+  if (nThreads <= 1) {
+    for (std::size_t i = 0; i < count_; ++i) {
+      fn_(i, std::uint32_t{0});
+    }
+    return;
+  }
+
+  std::atomic<std::size_t> next{0};
+  std::exception_ptr exception;
+  std::mutex exceptionMutex;
+  const auto work = [&](std::uint32_t worker_) {
+    while (true) {
+      const auto i = next.fetch_add(1);
+      if (i >= count_) {
+        break;
+      }
+      try {
+        fn_(i, worker_);
+      } catch (...) {
+        std::lock_guard lock{exceptionMutex};
+        if (!exception) {
+          exception = std::current_exception();
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(nThreads - 1);
+  for (std::size_t iThread = 1; iThread < nThreads; ++iThread) {
+    threads.emplace_back(work, static_cast<std::uint32_t>(iThread));
+  }
+  work(0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+/// <summary>
+/// Calls `fn_(i)` for each `i` in `[0, count_)` using up to `threads_` threads,
+/// the calling thread included. Returns when all calls finished; the first
+/// exception thrown by `fn_`, if any, is then rethrown.
+/// </summary>
+template <typename Fn_>
+void parallelFor(std::size_t count_, std::uint32_t threads_, Fn_ &&fn_) {
+  parallelForWorkers(count_, threads_,
+                     [&fn_](std::size_t i_, std::uint32_t) { fn_(i_); });
+}
+} // namespace bee
@@ -0,0 +1,107 @@
+#include <bee/TextureCache.h>
+#include <bee/polyfills/filesystem.h>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+
+namespace bee {
+namespace {
+namespace fs = bee::filesystem;
+
+using Key = std::tuple<std::u8string,
+                       std::uintmax_t,
+                       std::int64_t,
+                       bool,
+                       ConvertOptions::TextureTranscoding::Codec,
+                       bool,
+                       std::uint32_t>;
+
+/// <summary>
+/// The key of `file_`, or nothing if its status can't be read. The thread
+/// count is left out: it's how many images are transcoded at once, each one
+/// on a single thread.
+/// </summary>
+std::optional<Key>
+makeKey(std::u8string_view file_,
+        bool normal_map_,
+        const ConvertOptions::TextureTranscoding &options_) {
+  const fs::path path{file_};
+  std::error_code err;
+  const auto size = fs::file_size(path, err);
+  if (err) {
+    return {};
+  }
+  const auto time = fs::last_write_time(path, err);
+  if (err) {
+    return {};
+  }
+  auto absolute = fs::absolute(path, err);
+  if (err) {
+    absolute = path;
+  }
+  return Key{absolute.lexically_normal().generic_u8string(),
+             size,
+             static_cast<std::int64_t>(time.time_since_epoch().count()),
+             normal_map_,
+             options_.codec,
+             options_.mipmaps,
+             options_.maxSize};
+}
+} // namespace
+
+struct TextureCache::Impl {
+  std::mutex mutex;
+  std::map<Key, std::shared_future<Result>> entries;
+};
+
+TextureCache::TextureCache() : _impl(std::make_unique<Impl>()) {
+}
+
+TextureCache::~TextureCache() = default;
+
+TextureCache::Result TextureCache::getOrTranscode(
+    std::u8string_view file_,
+    bool normal_map_,
+    const ConvertOptions::TextureTranscoding &options_,
+    const std::function<Result()> &transcode_) {
+  auto key = makeKey(file_, normal_map_, options_);
+  if (!key) {
+    return transcode_();
+  }
+
+  std::promise<Result> promise;
+  std::shared_future<Result> entry;
+  {
+    std::lock_guard lock{_impl->mutex};
+    const auto [rEntry, inserted] = _impl->entries.try_emplace(*key);
+    if (inserted) {
+      rEntry->second = promise.get_future().share();
+    } else {
+      entry = rEntry->second;
+    }
+  }
+  if (entry.valid()) {
+    // Waited for without holding the lock.
+    return entry.get();
+  }
+
+  try {
+    auto result = transcode_();
+    promise.set_value(result);
+    return result;
+  } catch (...) {
+    // Only the callers already waiting get the failure; the next one tries
+    // again, the failure may have been transient.
+    {
+      std::lock_guard lock{_impl->mutex};
+      _impl->entries.erase(*key);
+    }
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+}
+} // namespace bee
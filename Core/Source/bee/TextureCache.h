@@ -0,0 +1,49 @@
+#pragma once
+
+#include <bee/BEE_API.h>
+#include <bee/Converter.h>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// KTX2 files transcoded from image files, so that an image used by several
+/// conversions, a shared material library for example, is transcoded once.
+/// An entry is keyed by the image file, its size and modification time, and
+/// the transcoding options the output depends on. All members may be called
+/// concurrently: one cache is meant to be shared by all conversions of a
+/// batch through `ConvertOptions::TextureTranscoding::cache`.
+/// </summary>
+class BEE_API TextureCache {
+public:
+  using Result = std::shared_ptr<const std::vector<std::byte>>;
+
+  TextureCache();
+
+  TextureCache(const TextureCache &) = delete;
+
+  TextureCache &operator=(const TextureCache &) = delete;
+
+  ~TextureCache();
+
+  /// <summary>
+  /// Returns the KTX2 file transcoded from `file_`, calling `transcode_` only
+  /// if it's the first to ask for it; who asks meanwhile waits for that call.
+  /// What `transcode_` throws is rethrown to each of them but is not kept:
+  /// the next call transcodes again. A file whose status can't be read is
+  /// transcoded every time.
+  /// </summary>
+  Result getOrTranscode(std::u8string_view file_,
+                        bool normal_map_,
+                        const ConvertOptions::TextureTranscoding &options_,
+                        const std::function<Result()> &transcode_);
+
+private:
+  struct Impl;
+
+  std::unique_ptr<Impl> _impl;
+};
+} // namespace bee
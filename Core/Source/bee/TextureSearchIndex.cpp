@@ -0,0 +1,246 @@
+#include <bee/Converter.h>
+#include <bee/TextureSearchIndex.h>
+#include <bee/polyfills/filesystem.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace bee {
+namespace {
+namespace fs = bee::filesystem;
+
+std::string toJsonString(const std::u8string &string_) {
+  return {string_.begin(), string_.end()};
+}
+
+std::u8string fromJsonString(const std::string &string_) {
+  return {string_.begin(), string_.end()};
+}
+
+/// <summary>
+/// The key of `directory_` in the index.
+/// </summary>
+std::u8string normalizeDirectory(const fs::path &directory_) {
+  auto normalized = directory_.lexically_normal();
+  // Trailing separators.
+  if (!normalized.has_filename() && normalized.has_relative_path()) {
+    normalized = normalized.parent_path();
+  }
+  return normalized.generic_u8string();
+}
+
+/// <summary>
+/// The modification time of `directory_`, or nothing if it does not exist.
+/// </summary>
+std::optional<std::int64_t> getLastWriteTime(const fs::path &directory_) {
+  std::error_code err;
+  const auto time = fs::last_write_time(directory_, err);
+  if (err) {
+    return {};
+  }
+  return static_cast<std::int64_t>(time.time_since_epoch().count());
+}
+
+struct DirectoryListing {
+  std::optional<std::int64_t> lastWriteTime;
+
+  std::unordered_set<std::u8string> files;
+
+  /// <summary>
+  /// File names by stem, sorted by name.
+  /// </summary>
+  std::unordered_map<std::u8string, std::vector<std::u8string>> stems;
+
+  void add(std::u8string file_name_) {
+    const auto stem = fs::path{file_name_}.stem().u8string();
+    files.insert(file_name_);
+    stems[stem].push_back(std::move(file_name_));
+  }
+
+  void sort() {
+    for (auto &[stem, fileNames] : stems) {
+      std::sort(fileNames.begin(), fileNames.end());
+    }
+  }
+};
+
+DirectoryListing listDirectory(const fs::path &directory_) {
+  DirectoryListing listing;
+  // Read the time first: a change during the listing then invalidates it.
+  listing.lastWriteTime = getLastWriteTime(directory_);
+  std::error_code err;
+  fs::directory_iterator dirIter{directory_, err};
+  if (err) {
+    return listing;
+  }
+  for (const auto &dirEntry : dirIter) {
+    std::error_code typeErr;
+    if (dirEntry.is_regular_file(typeErr) && !typeErr) {
+      listing.add(dirEntry.path().filename().u8string());
+    }
+  }
+  listing.sort();
+  return listing;
+}
+} // namespace
+
+struct TextureSearchIndex::Impl {
+  struct Entry {
+    std::shared_ptr<const DirectoryListing> listing;
+
+    /// <summary>
+    /// Whether the listing is known to be up to date in this session. Loaded
+    /// listings are checked against the directory the first time they're
+    /// used.
+    /// </summary>
+    bool checked = false;
+  };
+
+  mutable std::mutex mutex;
+
+  std::unordered_map<std::u8string, Entry> directories;
+
+  std::shared_ptr<const DirectoryListing> get(const fs::path &directory_) {
+    const auto key = normalizeDirectory(directory_);
+    std::shared_ptr<const DirectoryListing> loaded;
+    {
+      std::lock_guard lock{mutex};
+      if (const auto rEntry = directories.find(key);
+          rEntry != directories.end()) {
+        if (rEntry->second.checked) {
+          return rEntry->second.listing;
+        }
+        loaded = rEntry->second.listing;
+      }
+    }
+
+    // The directory is read without holding the lock, so that other
+    // directories can be looked up meanwhile. Concurrent misses of the same
+    // directory may list it more than once, with the same result.
+    std::shared_ptr<const DirectoryListing> listing;
+    if (loaded && loaded->lastWriteTime &&
+        loaded->lastWriteTime == getLastWriteTime(directory_)) {
+      listing = std::move(loaded);
+    } else {
+      listing = std::make_shared<DirectoryListing>(listDirectory(directory_));
+    }
+
+    std::lock_guard lock{mutex};
+    auto &entry = directories[key];
+    entry.listing = listing;
+    entry.checked = true;
+    return listing;
+  }
+};
+
+TextureSearchIndex::TextureSearchIndex() : _impl(std::make_unique<Impl>()) {
+}
+
+TextureSearchIndex::~TextureSearchIndex() = default;
+
+std::vector<std::u8string>
+TextureSearchIndex::findByStem(std::u8string_view directory_,
+                               std::u8string_view stem_) {
+  const fs::path directory{directory_};
+  const auto listing = _impl->get(directory);
+  const auto rStem = listing->stems.find(std::u8string{stem_});
+  if (rStem == listing->stems.end()) {
+    return {};
+  }
+  std::vector<std::u8string> result;
+  result.reserve(rStem->second.size());
+  for (const auto &fileName : rStem->second) {
+    result.push_back((directory / fs::path{fileName}).u8string());
+  }
+  return result;
+}
+
+bool TextureSearchIndex::isRegularFile(std::u8string_view file_) {
+  const fs::path file{file_};
+  const auto listing = _impl->get(file.parent_path());
+  if (listing->files.count(file.filename().u8string())) {
+    return true;
+  }
+  std::error_code err;
+  const auto status = fs::status(file, err);
+  return !err && status.type() == fs::file_type::regular;
+}
+
+bool TextureSearchIndex::load(std::u8string_view file_) {
+  std::ifstream stream(fs::path{file_}, std::ios::binary);
+  if (!stream) {
+    return false;
+  }
+  const auto json = Json::parse(stream, nullptr, false);
+  if (!json.is_object() || !json.contains("directories") ||
+      !json["directories"].is_array()) {
+    return false;
+  }
+
+  std::unordered_map<std::u8string, Impl::Entry> loaded;
+  try {
+    for (const auto &directory : json["directories"]) {
+      auto listing = std::make_shared<DirectoryListing>();
+      if (directory.contains("lastWriteTime")) {
+        listing->lastWriteTime =
+            directory.at("lastWriteTime").get<std::int64_t>();
+      }
+      for (const auto &fileName : directory.at("files")) {
+        listing->add(fromJsonString(fileName.get<std::string>()));
+      }
+      listing->sort();
+      const auto &path = directory.at("path").get_ref<const std::string &>();
+      loaded[fromJsonString(path)].listing = std::move(listing);
+    }
+  } catch (const Json::exception &) {
+    return false;
+  }
+
+  std::lock_guard lock{_impl->mutex};
+  // Listings of this session are more recent.
+  _impl->directories.merge(loaded);
+  return true;
+}
+
+bool TextureSearchIndex::save(std::u8string_view file_) const {
+  // Sorted, so that the same listings are written to the same file.
+  std::map<std::u8string, std::shared_ptr<const DirectoryListing>> listings;
+  {
+    std::lock_guard lock{_impl->mutex};
+    for (const auto &[path, entry] : _impl->directories) {
+      listings.emplace(path, entry.listing);
+    }
+  }
+
+  auto directories = Json::array();
+  for (const auto &[path, pListing] : listings) {
+    const auto &listing = *pListing;
+    // Without a time, the listing could never be used again.
+    if (!listing.lastWriteTime) {
+      continue;
+    }
+    std::vector<std::string> fileNames;
+    fileNames.reserve(listing.files.size());
+    for (const auto &fileName : listing.files) {
+      fileNames.push_back(toJsonString(fileName));
+    }
+    std::sort(fileNames.begin(), fileNames.end());
+    directories.push_back(Json{
+        {"path", toJsonString(path)},
+        {"lastWriteTime", *listing.lastWriteTime},
+        {"files", std::move(fileNames)},
+    });
+  }
+
+  std::ofstream stream(fs::path{file_}, std::ios::binary);
+  if (!stream) {
+    return false;
+  }
+  stream << Json{{"directories", std::move(directories)}}.dump();
+  return static_cast<bool>(stream);
+}
+} // namespace bee
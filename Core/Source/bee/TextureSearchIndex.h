@@ -0,0 +1,60 @@
+#pragma once
+
+#include <bee/BEE_API.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// Index of the files of texture search directories, so that resolving a
+/// texture is a hash lookup rather than a directory scan. Each directory is
+/// listed once, the first time it's asked for. All members may be called
+/// concurrently: one index is meant to be shared by all conversions of a batch
+/// through `ConvertOptions::TextureResolution::index`.
+/// </summary>
+class BEE_API TextureSearchIndex {
+public:
+  TextureSearchIndex();
+
+  TextureSearchIndex(const TextureSearchIndex &) = delete;
+
+  TextureSearchIndex &operator=(const TextureSearchIndex &) = delete;
+
+  ~TextureSearchIndex();
+
+  /// <summary>
+  /// Returns the paths of the regular files in `directory_` whose stem is
+  /// `stem_`, sorted by file name.
+  /// </summary>
+  std::vector<std::u8string> findByStem(std::u8string_view directory_,
+                                        std::u8string_view stem_);
+
+  /// <summary>
+  /// Whether `file_` is a regular file. Files that are not found in the
+  /// listing of their directory are checked against the file system, which
+  /// may match names case-insensitively.
+  /// </summary>
+  bool isRegularFile(std::u8string_view file_);
+
+  /// <summary>
+  /// Loads the listings written by `save()`. A loaded listing is used only if
+  /// the modification time of its directory has not changed since; the
+  /// directory is listed again otherwise. Returns false if the file can't be
+  /// read or is not such a cache.
+  /// </summary>
+  bool load(std::u8string_view file_);
+
+  /// <summary>
+  /// Writes the listings so far, including the loaded ones, to `file_`.
+  /// Returns false if the file can't be written.
+  /// </summary>
+  bool save(std::u8string_view file_) const;
+
+private:
+  struct Impl;
+
+  std::unique_ptr<Impl> _impl;
+};
+} // namespace bee
@@ -1,41 +1,41 @@
 #include <bee/UntypedVertex.h>
+#include <algorithm>
+#include <bit>
 #include <cassert>
 
 namespace bee {
+void UntypedVertexVector::reserve(std::uint32_t capacity_) {
+  if (capacity_ <= _capacity) {
+    return;
+  }
+  std::unique_ptr<std::byte[]> data{
+      new std::byte[static_cast<std::size_t>(_vertexSize) * capacity_]};
+  if (_size) {
+    std::memcpy(data.get(), _data.get(),
+                static_cast<std::size_t>(_vertexSize) * _size);
+  }
+  _data = std::move(data);
+  _capacity = capacity_;
+}
+
 std::tuple<UntypedVertex, std::uint32_t> UntypedVertexVector::allocate() {
-  if (_nLastPageVertices >= _nVerticesPerPage || _vertexPages.empty()) {
-    _vertexPages.emplace_back(
-        std::make_unique<std::byte[]>(_vertexSize * _nVerticesPerPage));
-    _nLastPageVertices = 0;
+  if (_size == _capacity) {
+    reserve(std::max<std::uint32_t>(1024, _capacity * 2));
   }
-  return {_vertexPages.back().get() + _vertexSize * _nLastPageVertices++,
-          _nextVertexIndex++};
+  const auto vertex = at(_size);
+  std::memset(vertex, 0, _vertexSize);
+  return {vertex, _size++};
 }
 
 void UntypedVertexVector::pop_back() {
-  assert((!_vertexPages.empty()) && _nLastPageVertices);
-  --_nLastPageVertices;
-  if (_nLastPageVertices == 0) {
-    _vertexPages.pop_back();
-    _nLastPageVertices = _nVerticesPerPage;
-  }
-  --_nextVertexIndex;
-}
-
-std::unique_ptr<std::byte[]> UntypedVertexVector::merge() {
-  auto data = std::make_unique<std::byte[]>(_vertexSize * size());
-  if (!_vertexPages.empty()) {
-    auto iPage = _vertexPages.begin();
-    auto iLastFullPage = _vertexPages.end();
-    --iLastFullPage;
-    auto pData = data.get();
-    const auto fullPageBytes = _vertexSize * _nVerticesPerPage;
-    for (; iPage != iLastFullPage; ++iPage, pData += fullPageBytes) {
-      std::memcpy(pData, (*iPage).get(), fullPageBytes);
-    }
-    std::memcpy(pData, (*iPage).get(), _vertexSize * _nLastPageVertices);
-  }
-  return data;
+  assert(_size);
+  --_size;
+}
+
+std::unique_ptr<std::byte[]> UntypedVertexVector::release() {
+  _capacity = 0;
+  _size = 0;
+  return std::move(_data);
 }
 
 std::size_t UntypedVertexHasher::operator()(const UntypedVertex &vertex_) const  {
@@ -49,4 +49,83 @@ std::size_t UntypedVertexHasher::operator()(const UntypedVertex &vertex_) const
   seed ^= hasher(position[2]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
   return seed;
 }
-} // namespace bee
+
+std::uint64_t hashUntypedVertex(const std::byte *vertex_, std::size_t size_) {
+  // Multiply-xorshift over 8-byte words, finalized with the splitmix64 mixer.
+  constexpr std::uint64_t multiplier = 0x9fb21c651e98df25ull;
+  std::uint64_t hash = 0x9e3779b97f4a7c15ull ^ size_;
+  std::size_t iByte = 0;
+  for (; iByte + 8 <= size_; iByte += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, vertex_ + iByte, 8);
+    hash = (hash ^ word) * multiplier;
+    hash ^= hash >> 32;
+  }
+  if (iByte < size_) {
+    std::uint64_t word = 0;
+    std::memcpy(&word, vertex_ + iByte, size_ - iByte);
+    hash = (hash ^ word) * multiplier;
+    hash ^= hash >> 32;
+  }
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ull;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebull;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+UntypedVertexDedup::UntypedVertexDedup(const UntypedVertexVector &vertices_,
+                                       std::uint32_t vertex_size_,
+                                       std::size_t expected_count_)
+    : _vertices(vertices_), _vertexSize(vertex_size_) {
+  // Keep the load factor below 3/4.
+  _rehash(
+      std::bit_ceil(std::max<std::size_t>(16, expected_count_ * 4 / 3 + 1)));
+}
+
+std::tuple<std::uint32_t, bool>
+UntypedVertexDedup::tryEmplace(std::uint32_t vertex_index_) {
+  if ((_count + 1) * 4 > _slots.size() * 3) {
+    _rehash(_slots.size() * 2);
+  }
+
+  const auto vertex = _vertices.at(vertex_index_);
+  const auto hash = hashUntypedVertex(vertex, _vertexSize);
+  const auto shortHash = static_cast<std::uint32_t>(hash);
+  for (auto iSlot = static_cast<std::size_t>(hash >> 32) & _mask;;
+       iSlot = (iSlot + 1) & _mask) {
+    auto &slot = _slots[iSlot];
+    if (slot.vertexIndex == _emptySlot) {
+      slot.vertexIndex = vertex_index_;
+      slot.hash = shortHash;
+      ++_count;
+      return {vertex_index_, true};
+    }
+    if (slot.hash == shortHash &&
+        0 == std::memcmp(_vertices.at(slot.vertexIndex), vertex, _vertexSize)) {
+      return {slot.vertexIndex, false};
+    }
+  }
+}
+
+void UntypedVertexDedup::_rehash(std::size_t capacity_) {
+  std::vector<Slot> slots(capacity_);
+  const auto mask = capacity_ - 1;
+  for (const auto &slot : _slots) {
+    if (slot.vertexIndex == _emptySlot) {
+      continue;
+    }
+    // Only the low half of the hash is kept: rehash from the vertex.
+    const auto hash =
+        hashUntypedVertex(_vertices.at(slot.vertexIndex), _vertexSize);
+    auto iSlot = static_cast<std::size_t>(hash >> 32) & mask;
+    while (slots[iSlot].vertexIndex != _emptySlot) {
+      iSlot = (iSlot + 1) & mask;
+    }
+    slots[iSlot] = slot;
+  }
+  _slots = std::move(slots);
+  _mask = mask;
+}
+} // namespace bee
\ No newline at end of file
@@ -2,36 +2,52 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
-#include <list>
 #include <memory>
+#include <tuple>
 #include <vector>
 
 namespace bee {
 using UntypedVertex = std::byte *;
 
+/// <summary>
+/// Vertices of the same size stored in a single, geometrically growing block.
+/// As with `std::vector`, indices are the stable handles: vertex pointers are
+/// invalidated by `allocate()` and `reserve()`.
+/// </summary>
 class UntypedVertexVector {
 public:
   UntypedVertexVector(std::uint32_t vertex_size_) : _vertexSize(vertex_size_) {
   }
 
   std::uint32_t size() const {
-    return _nextVertexIndex;
+    return _size;
   }
 
+  void reserve(std::uint32_t capacity_);
+
+  /// <summary>
+  /// Appends a zero-filled vertex.
+  /// </summary>
   std::tuple<UntypedVertex, std::uint32_t> allocate();
 
+  UntypedVertex at(std::uint32_t index_) const {
+    return _data.get() + static_cast<std::size_t>(_vertexSize) * index_;
+  }
+
   void pop_back();
 
-  std::unique_ptr<std::byte[]> merge();
+  /// <summary>
+  /// Gives up the vertices, without copying them. The vector is then empty.
+  /// </summary>
+  std::unique_ptr<std::byte[]> release();
 
 private:
-  using VertexPage = std::unique_ptr<std::byte[]>;
   std::uint32_t _vertexSize;
-  std::list<VertexPage> _vertexPages;
-  std::uint32_t _nVerticesPerPage = 1024;
-  std::uint32_t _nLastPageVertices = 0;
-  std::uint32_t _nextVertexIndex = 0;
+  std::unique_ptr<std::byte[]> _data;
+  std::uint32_t _capacity = 0;
+  std::uint32_t _size = 0;
 };
 
 class UntypedVertexHasher {
@@ -52,4 +68,50 @@ public:
 private:
   std::size_t _vertexSize;
 };
+
+/// <summary>
+/// Hashes all of the `size_` bytes of a vertex.
+/// </summary>
+std::uint64_t hashUntypedVertex(const std::byte *vertex_, std::size_t size_);
+
+/// <summary>
+/// Set of the unique vertices of an `UntypedVertexVector`, used to weld
+/// vertices. It's an open addressing table holding vertex indices along with
+/// their hashes, so that neither a node is allocated per vertex nor the
+/// vertex data is touched but for the final comparison.
+/// </summary>
+class UntypedVertexDedup {
+public:
+  /// <param name="expected_count_">
+  /// Upper bound of the vertices to be added, e.g. the polygon vertex count.
+  /// The table is sized so that it never grows below that bound.
+  /// </param>
+  UntypedVertexDedup(const UntypedVertexVector &vertices_,
+                     std::uint32_t vertex_size_,
+                     std::size_t expected_count_);
+
+  /// <summary>
+  /// Looks up a vertex equal to the vertex at `vertex_index_`.
+  /// If there's none, the vertex is added.
+  /// </summary>
+  /// <returns>The index of the unique vertex and whether the vertex at
+  /// `vertex_index_` was added.</returns>
+  std::tuple<std::uint32_t, bool> tryEmplace(std::uint32_t vertex_index_);
+
+private:
+  constexpr static std::uint32_t _emptySlot = ~std::uint32_t{0};
+
+  struct Slot {
+    std::uint32_t vertexIndex = _emptySlot;
+    std::uint32_t hash = 0;
+  };
+
+  const UntypedVertexVector &_vertices;
+  std::uint32_t _vertexSize;
+  std::vector<Slot> _slots;
+  std::size_t _mask = 0;
+  std::size_t _count = 0;
+
+  void _rehash(std::size_t capacity_);
+};
 } // namespace bee
\ No newline at end of file
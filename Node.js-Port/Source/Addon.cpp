@@ -0,0 +1,298 @@
+#include <bee/Converter.h>
+#include <atomic>
+#include <memory>
+#include <node_api.h>
+#include <optional>
+#include <string>
+
+namespace {
+#define BEE_NAPI_CALL(env_, call_)                                             \
+  do {                                                                         \
+    if ((call_) != napi_ok) {                                                  \
+      throwLastError(env_);                                                    \
+      return nullptr;                                                          \
+    }                                                                          \
+  } while (false)
+
+void throwLastError(napi_env env_) {
+  bool pending = false;
+  napi_is_exception_pending(env_, &pending);
+  if (pending) {
+    return;
+  }
+  const napi_extended_error_info *errorInfo = nullptr;
+  napi_get_last_error_info(env_, &errorInfo);
+  napi_throw_error(env_, nullptr,
+                   errorInfo && errorInfo->error_message
+                       ? errorInfo->error_message
+                       : "Unknown N-API error.");
+}
+
+struct Job {
+  bee::ConvertSession::BatchItem item;
+  std::atomic<bool> cancelled{false};
+  napi_async_work work = nullptr;
+  napi_deferred deferred = nullptr;
+  napi_threadsafe_function progress = nullptr;
+  bee::ConvertSession::BatchItemResult result;
+  std::string glTFJson;
+};
+
+/// <summary>
+/// Held by the async work and by the JS job object, whichever outlives the
+/// other.
+/// </summary>
+using JobPtr = std::shared_ptr<Job>;
+
+std::optional<napi_value>
+getProperty(napi_env env_, napi_value object_, const char *name_) {
+  bool has = false;
+  if (napi_has_named_property(env_, object_, name_, &has) != napi_ok || !has) {
+    return {};
+  }
+  napi_value value = nullptr;
+  napi_get_named_property(env_, object_, name_, &value);
+  napi_valuetype type = napi_undefined;
+  napi_typeof(env_, value, &type);
+  if (type == napi_undefined || type == napi_null) {
+    return {};
+  }
+  return value;
+}
+
+std::optional<std::u8string> getString(napi_env env_, napi_value value_) {
+  std::size_t length = 0;
+  if (napi_get_value_string_utf8(env_, value_, nullptr, 0, &length) !=
+      napi_ok) {
+    return {};
+  }
+  std::string value(length, '\0');
+  napi_get_value_string_utf8(env_, value_, value.data(), length + 1, &length);
+  return std::u8string{value.begin(), value.end()};
+}
+
+const char *getStageName(bee::ConvertProgress::Stage stage_) {
+  switch (stage_) {
+  case bee::ConvertProgress::Stage::node:
+    return "node";
+  case bee::ConvertProgress::Stage::mesh:
+    return "mesh";
+  case bee::ConvertProgress::Stage::animationStack:
+    return "animationStack";
+  }
+  return "";
+}
+
+const char *getAbortedCode(bee::ConvertAborted::Reason reason_) {
+  switch (reason_) {
+  case bee::ConvertAborted::Reason::cancelled:
+    return "CANCELLED";
+  case bee::ConvertAborted::Reason::timeBudget:
+    return "TIME_BUDGET";
+  case bee::ConvertAborted::Reason::memoryBudget:
+    return "MEMORY_BUDGET";
+  }
+  return "";
+}
+
+/// <summary>
+/// Calls `onProgress` on the main thread with what a worker reported.
+/// </summary>
+void callProgress(napi_env env_,
+                  napi_value js_callback_,
+                  void *context_,
+                  void *data_) {
+  const std::unique_ptr<bee::ConvertProgress> progress{
+      static_cast<bee::ConvertProgress *>(data_)};
+  if (!env_) {
+    return;
+  }
+  napi_value progressObject = nullptr;
+  napi_value stage = nullptr;
+  napi_value name = nullptr;
+  napi_value done = nullptr;
+  napi_value total = nullptr;
+  napi_create_object(env_, &progressObject);
+  napi_create_string_utf8(env_, getStageName(progress->stage),
+                          NAPI_AUTO_LENGTH, &stage);
+  napi_create_string_utf8(env_, progress->name.data(), progress->name.size(),
+                          &name);
+  napi_create_uint32(env_, progress->done, &done);
+  napi_create_uint32(env_, progress->total, &total);
+  napi_set_named_property(env_, progressObject, "stage", stage);
+  napi_set_named_property(env_, progressObject, "name", name);
+  napi_set_named_property(env_, progressObject, "done", done);
+  napi_set_named_property(env_, progressObject, "total", total);
+  napi_value undefined = nullptr;
+  napi_get_undefined(env_, &undefined);
+  napi_call_function(env_, undefined, js_callback_, 1, &progressObject,
+                     nullptr);
+}
+
+/// <summary>
+/// Runs on a worker of the libuv pool, each job in a session of its own so
+/// that FBX SDK objects are not shared.
+/// </summary>
+void executeJob(napi_env env_, void *data_) {
+  auto &job = **static_cast<JobPtr *>(data_);
+  try {
+    bee::ConvertSession session;
+    job.result = session.tryConvert(job.item);
+  } catch (const std::exception &exception) {
+    job.result.error = exception.what();
+  }
+  if (job.result.glTFJson) {
+    job.glTFJson = job.result.glTFJson->dump();
+    job.result.glTFJson.reset();
+  }
+}
+
+void completeJob(napi_env env_, napi_status status_, void *data_) {
+  const std::unique_ptr<JobPtr> jobPtr{static_cast<JobPtr *>(data_)};
+  auto &job = **jobPtr;
+  if (job.progress) {
+    napi_release_threadsafe_function(job.progress, napi_tsfn_release);
+  }
+  napi_delete_async_work(env_, job.work);
+
+  if (!job.result.error) {
+    napi_value glTFJson = nullptr;
+    napi_create_string_utf8(env_, job.glTFJson.data(), job.glTFJson.size(),
+                            &glTFJson);
+    napi_resolve_deferred(env_, job.deferred, glTFJson);
+    return;
+  }
+  napi_value message = nullptr;
+  napi_value error = nullptr;
+  napi_create_string_utf8(env_, job.result.error->data(),
+                          job.result.error->size(), &message);
+  napi_value code = nullptr;
+  if (job.result.aborted) {
+    napi_create_string_utf8(env_, getAbortedCode(*job.result.aborted),
+                            NAPI_AUTO_LENGTH, &code);
+  }
+  napi_create_error(env_, code, message, &error);
+  napi_reject_deferred(env_, job.deferred, error);
+}
+
+/// <summary>
+/// The job comes from the callback data rather than from `this`, so that
+/// `cancel` may be called detached from the job object.
+/// </summary>
+napi_value cancelJob(napi_env env_, napi_callback_info info_) {
+  void *data = nullptr;
+  BEE_NAPI_CALL(
+      env_, napi_get_cb_info(env_, info_, nullptr, nullptr, nullptr, &data));
+  (*static_cast<JobPtr *>(data))->cancelled = true;
+  return nullptr;
+}
+
+/// <summary>
+/// `convert(file, options)` starts converting on a worker of the libuv pool
+/// and returns `{ promise, cancel }`. The promise resolves to the glTF JSON
+/// text, buffers embedded, or rejects with an error whose `code` is
+/// `CANCELLED`, `TIME_BUDGET` or `MEMORY_BUDGET` if the conversion has been
+/// aborted. Options are `out`, `timeBudget` in seconds, `memoryBudget` in
+/// bytes and `onProgress`, called with `{ stage, name, done, total }`.
+/// </summary>
+napi_value convert(napi_env env_, napi_callback_info info_) {
+  std::size_t argc = 2;
+  napi_value argv[2] = {nullptr, nullptr};
+  BEE_NAPI_CALL(env_,
+                napi_get_cb_info(env_, info_, &argc, argv, nullptr, nullptr));
+  const auto file = argc >= 1 ? getString(env_, argv[0]) : std::nullopt;
+  if (!file) {
+    napi_throw_type_error(env_, nullptr, "The file must be a string.");
+    return nullptr;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->item.file = *file;
+  auto &options = job->item.options;
+  options.cancel = &job->cancelled;
+  napi_value progressCallback = nullptr;
+  if (argc >= 2) {
+    if (const auto out = getProperty(env_, argv[1], "out")) {
+      if (const auto outString = getString(env_, *out)) {
+        options.out = *outString;
+      }
+    }
+    if (const auto timeBudget = getProperty(env_, argv[1], "timeBudget")) {
+      double seconds = 0.0;
+      BEE_NAPI_CALL(env_, napi_get_value_double(env_, *timeBudget, &seconds));
+      options.timeBudget.emplace(seconds);
+    }
+    if (const auto memoryBudget = getProperty(env_, argv[1], "memoryBudget")) {
+      double bytes = 0.0;
+      BEE_NAPI_CALL(env_, napi_get_value_double(env_, *memoryBudget, &bytes));
+      options.memoryBudget = static_cast<std::uint64_t>(bytes);
+    }
+    if (const auto onProgress = getProperty(env_, argv[1], "onProgress")) {
+      progressCallback = *onProgress;
+    }
+  }
+
+  napi_value resourceName = nullptr;
+  BEE_NAPI_CALL(env_, napi_create_string_utf8(env_, "FBX-glTF-conv",
+                                              NAPI_AUTO_LENGTH, &resourceName));
+  if (progressCallback) {
+    BEE_NAPI_CALL(env_, napi_create_threadsafe_function(
+                            env_, progressCallback, nullptr, resourceName, 0,
+                            1, nullptr, nullptr, nullptr, callProgress,
+                            &job->progress));
+    options.progress = [progress = job->progress](
+                           const bee::ConvertProgress &progress_) {
+      napi_call_threadsafe_function(progress,
+                                    new bee::ConvertProgress{progress_},
+                                    napi_tsfn_nonblocking);
+    };
+  }
+
+  napi_value promise = nullptr;
+  BEE_NAPI_CALL(env_, napi_create_promise(env_, &job->deferred, &promise));
+
+  const auto cancelData = new JobPtr{job};
+  napi_value cancelFunction = nullptr;
+  if (napi_create_function(env_, "cancel", NAPI_AUTO_LENGTH, cancelJob,
+                           cancelData, &cancelFunction) != napi_ok) {
+    delete cancelData;
+    throwLastError(env_);
+    return nullptr;
+  }
+  BEE_NAPI_CALL(env_, napi_add_finalizer(
+                          env_, cancelFunction, cancelData,
+                          [](napi_env, void *data_, void *) {
+                            delete static_cast<JobPtr *>(data_);
+                          },
+                          nullptr, nullptr));
+
+  napi_value jobObject = nullptr;
+  BEE_NAPI_CALL(env_, napi_create_object(env_, &jobObject));
+  const napi_property_descriptor properties[] = {
+      {"promise", nullptr, nullptr, nullptr, nullptr, promise, napi_enumerable,
+       nullptr},
+      {"cancel", nullptr, nullptr, nullptr, nullptr, cancelFunction,
+       napi_enumerable, nullptr},
+  };
+  BEE_NAPI_CALL(env_, napi_define_properties(env_, jobObject, 2, properties));
+
+  const auto workData = new JobPtr{job};
+  BEE_NAPI_CALL(env_,
+                napi_create_async_work(env_, nullptr, resourceName, executeJob,
+                                       completeJob, workData, &job->work));
+  BEE_NAPI_CALL(env_, napi_queue_async_work(env_, job->work));
+  return jobObject;
+}
+
+napi_value init(napi_env env_, napi_value exports_) {
+  napi_value convertFunction = nullptr;
+  BEE_NAPI_CALL(env_,
+                napi_create_function(env_, "convert", NAPI_AUTO_LENGTH, convert,
+                                     nullptr, &convertFunction));
+  BEE_NAPI_CALL(env_, napi_set_named_property(env_, exports_, "convert",
+                                              convertFunction));
+  return exports_;
+}
+} // namespace
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, init)